@@ -209,6 +209,13 @@ else()
   endif()
 endif()
 
+#-------------------------------------------------------------------------------------------------------------------------------------------
+# Find zlib.
+
+if(UNIX)
+  find_package(ZLIB REQUIRED)
+endif()
+
 #-------------------------------------------------------------------------------------------------------------------------------------------
 # Find zstd.
 
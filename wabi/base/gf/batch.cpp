@@ -0,0 +1,449 @@
+/*
+ * Copyright 2021 Pixar. All Rights Reserved.
+ *
+ * Portions of this file are derived from original work by Pixar
+ * distributed with Universal Scene Description, a project of the
+ * Academy Software Foundation (ASWF). https://www.aswf.io/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "Apache License")
+ * with the following modification; you may not use this file except in
+ * compliance with the Apache License and the following modification:
+ * Section 6. Trademarks. is deleted and replaced with:
+ *
+ * 6. Trademarks. This License does not grant permission to use the trade
+ *    names, trademarks, service marks, or product names of the Licensor
+ *    and its affiliates, except as required to comply with Section 4(c)
+ *    of the License and to reproduce the content of the NOTICE file.
+ *
+ * You may obtain a copy of the Apache License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the Apache License with the above modification is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the Apache License for the
+ * specific language governing permissions and limitations under the
+ * Apache License.
+ *
+ * Modifications copyright (C) 2020-2021 Wabi.
+ */
+
+#include "wabi/base/gf/batch.h"
+#include "wabi/wabi.h"
+
+#include "wabi/base/arch/defines.h"
+#include "wabi/base/gf/matrix4d.h"
+#include "wabi/base/gf/vec3d.h"
+#include "wabi/base/gf/vec3f.h"
+#include "wabi/base/tf/envSetting.h"
+
+#include <limits>
+
+#if defined(ARCH_CPU_INTEL)
+#  include <immintrin.h>
+#  define GF_BATCH_SSE2
+#  if defined(ARCH_COMPILER_GCC) || defined(ARCH_COMPILER_CLANG)
+#    define GF_BATCH_AVX
+#    define GF_BATCH_TARGET_AVX __attribute__((target("avx")))
+#  endif
+#endif
+
+WABI_NAMESPACE_BEGIN
+
+TF_DEFINE_ENV_SETTING(GF_BATCH_DISABLE_SIMD,
+                      false,
+                      "Use scalar loops instead of SIMD instructions in the gf "
+                      "batch kernels.");
+
+namespace
+{
+
+  ////////////////////////////////////////////////////////////////////////
+  // Scalar kernels.
+
+  void _TransformPointsScalar(const GfMatrix4d &m, const GfVec3f *points, size_t n, GfVec3f *result)
+  {
+    for (size_t i = 0; i != n; ++i) {
+      result[i] = m.Transform(points[i]);
+    }
+  }
+
+  void _TransformDirsScalar(const GfMatrix4d &m, const GfVec3f *dirs, size_t n, GfVec3f *result)
+  {
+    for (size_t i = 0; i != n; ++i) {
+      result[i] = m.TransformDir(dirs[i]);
+    }
+  }
+
+  void _MultiplyMatricesScalar(const GfMatrix4d *lhs,
+                               const GfMatrix4d *rhs,
+                               size_t n,
+                               GfMatrix4d *result)
+  {
+    for (size_t i = 0; i != n; ++i) {
+      result[i] = lhs[i] * rhs[i];
+    }
+  }
+
+  GfRange3d _ComputeRangeScalar(const GfVec3f *points, size_t n)
+  {
+    GfRange3d range;
+    for (size_t i = 0; i != n; ++i) {
+      range.UnionWith(GfVec3d(points[i]));
+    }
+    return range;
+  }
+
+  GfRange3d _ComputeTransformedRangeScalar(const GfMatrix4d &m, const GfVec3f *points, size_t n)
+  {
+    GfRange3d range;
+    for (size_t i = 0; i != n; ++i) {
+      range.UnionWith(GfVec3d(m.Transform(points[i])));
+    }
+    return range;
+  }
+
+#if defined(GF_BATCH_SSE2)
+
+  // The SIMD kernels below evaluate the same expressions in the same order
+  // as GfMatrix4d, and without fused multiply-adds, so their results are
+  // identical to the scalar kernels.
+
+  ////////////////////////////////////////////////////////////////////////
+  // Helpers shared by the SIMD kernels.  Ranges are accumulated in float,
+  // which is exact since the points are floats.
+
+  inline __m128 _LoadVec3f(const GfVec3f &v)
+  {
+    return _mm_setr_ps(v[0], v[1], v[2], 0.0f);
+  }
+
+  inline void _StoreVec3f(__m128 v, GfVec3f *result)
+  {
+    alignas(16) float tmp[4];
+    _mm_store_ps(tmp, v);
+    result->Set(tmp[0], tmp[1], tmp[2]);
+  }
+
+  inline GfRange3d _MakeRange(__m128 min, __m128 max)
+  {
+    alignas(16) float tmpMin[4], tmpMax[4];
+    _mm_store_ps(tmpMin, min);
+    _mm_store_ps(tmpMax, max);
+    return GfRange3d(GfVec3d(tmpMin[0], tmpMin[1], tmpMin[2]),
+                     GfVec3d(tmpMax[0], tmpMax[1], tmpMax[2]));
+  }
+
+  inline double _GetInverseW(double w)
+  {
+    // As in GfProject().
+    return (w != 0.0) ? 1.0 / w : 1.0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  // SSE2 kernels.  Each matrix row is held in two registers, lo holding
+  // columns 0 and 1 and hi columns 2 and 3.
+
+  struct _RowsSSE2
+  {
+    explicit _RowsSSE2(const GfMatrix4d &m)
+    {
+      const double *data = m.GetArray();
+      for (int i = 0; i != 4; ++i) {
+        lo[i] = _mm_loadu_pd(data + 4 * i);
+        hi[i] = _mm_loadu_pd(data + 4 * i + 2);
+      }
+    }
+    __m128d lo[4], hi[4];
+  };
+
+  inline __m128 _TransformPointSSE2(const _RowsSSE2 &rows, const GfVec3f &p)
+  {
+    const __m128d x = _mm_set1_pd(p[0]), y = _mm_set1_pd(p[1]), z = _mm_set1_pd(p[2]);
+    __m128d lo = _mm_add_pd(
+      _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, rows.lo[0]), _mm_mul_pd(y, rows.lo[1])),
+                 _mm_mul_pd(z, rows.lo[2])),
+      rows.lo[3]);
+    __m128d hi = _mm_add_pd(
+      _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, rows.hi[0]), _mm_mul_pd(y, rows.hi[1])),
+                 _mm_mul_pd(z, rows.hi[2])),
+      rows.hi[3]);
+    const __m128d inv = _mm_set1_pd(_GetInverseW(_mm_cvtsd_f64(_mm_unpackhi_pd(hi, hi))));
+    lo = _mm_mul_pd(inv, lo);
+    hi = _mm_mul_pd(inv, hi);
+    return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+  }
+
+  inline __m128 _TransformDirSSE2(const _RowsSSE2 &rows, const GfVec3f &d)
+  {
+    const __m128d x = _mm_set1_pd(d[0]), y = _mm_set1_pd(d[1]), z = _mm_set1_pd(d[2]);
+    const __m128d lo = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, rows.lo[0]), _mm_mul_pd(y, rows.lo[1])),
+                                  _mm_mul_pd(z, rows.lo[2]));
+    const __m128d hi = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, rows.hi[0]), _mm_mul_pd(y, rows.hi[1])),
+                                  _mm_mul_pd(z, rows.hi[2]));
+    return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+  }
+
+  void _TransformPointsSSE2(const GfMatrix4d &m, const GfVec3f *points, size_t n, GfVec3f *result)
+  {
+    const _RowsSSE2 rows(m);
+    for (size_t i = 0; i != n; ++i) {
+      _StoreVec3f(_TransformPointSSE2(rows, points[i]), result + i);
+    }
+  }
+
+  void _TransformDirsSSE2(const GfMatrix4d &m, const GfVec3f *dirs, size_t n, GfVec3f *result)
+  {
+    const _RowsSSE2 rows(m);
+    for (size_t i = 0; i != n; ++i) {
+      _StoreVec3f(_TransformDirSSE2(rows, dirs[i]), result + i);
+    }
+  }
+
+  void _MultiplyMatricesSSE2(const GfMatrix4d *lhs,
+                             const GfMatrix4d *rhs,
+                             size_t n,
+                             GfMatrix4d *result)
+  {
+    for (size_t i = 0; i != n; ++i) {
+      const _RowsSSE2 b(rhs[i]);
+      const double *a = lhs[i].GetArray();
+      __m128d lo[4], hi[4];
+      for (int r = 0; r != 4; ++r) {
+        const __m128d a0 = _mm_set1_pd(a[4 * r]), a1 = _mm_set1_pd(a[4 * r + 1]),
+                      a2 = _mm_set1_pd(a[4 * r + 2]), a3 = _mm_set1_pd(a[4 * r + 3]);
+        lo[r] = _mm_add_pd(
+          _mm_add_pd(_mm_add_pd(_mm_mul_pd(a0, b.lo[0]), _mm_mul_pd(a1, b.lo[1])),
+                     _mm_mul_pd(a2, b.lo[2])),
+          _mm_mul_pd(a3, b.lo[3]));
+        hi[r] = _mm_add_pd(
+          _mm_add_pd(_mm_add_pd(_mm_mul_pd(a0, b.hi[0]), _mm_mul_pd(a1, b.hi[1])),
+                     _mm_mul_pd(a2, b.hi[2])),
+          _mm_mul_pd(a3, b.hi[3]));
+      }
+      // Store only once all rows are computed, result may alias lhs or rhs.
+      double *c = result[i].GetArray();
+      for (int r = 0; r != 4; ++r) {
+        _mm_storeu_pd(c + 4 * r, lo[r]);
+        _mm_storeu_pd(c + 4 * r + 2, hi[r]);
+      }
+    }
+  }
+
+  GfRange3d _ComputeRangeSSE2(const GfVec3f *points, size_t n)
+  {
+    if (n == 0) {
+      return GfRange3d();
+    }
+    __m128 min = _mm_set1_ps(std::numeric_limits<float>::max());
+    __m128 max = _mm_set1_ps(std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i != n; ++i) {
+      const __m128 p = _LoadVec3f(points[i]);
+      min = _mm_min_ps(p, min);
+      max = _mm_max_ps(p, max);
+    }
+    return _MakeRange(min, max);
+  }
+
+  GfRange3d _ComputeTransformedRangeSSE2(const GfMatrix4d &m, const GfVec3f *points, size_t n)
+  {
+    if (n == 0) {
+      return GfRange3d();
+    }
+    const _RowsSSE2 rows(m);
+    __m128 min = _mm_set1_ps(std::numeric_limits<float>::max());
+    __m128 max = _mm_set1_ps(std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i != n; ++i) {
+      const __m128 p = _TransformPointSSE2(rows, points[i]);
+      min = _mm_min_ps(p, min);
+      max = _mm_max_ps(p, max);
+    }
+    return _MakeRange(min, max);
+  }
+
+#endif  // GF_BATCH_SSE2
+
+#if defined(GF_BATCH_AVX)
+
+  ////////////////////////////////////////////////////////////////////////
+  // AVX kernels.  Each matrix row is held in one register.
+
+  struct _RowsAVX
+  {
+    GF_BATCH_TARGET_AVX explicit _RowsAVX(const GfMatrix4d &m)
+    {
+      const double *data = m.GetArray();
+      for (int i = 0; i != 4; ++i) {
+        row[i] = _mm256_loadu_pd(data + 4 * i);
+      }
+    }
+    __m256d row[4];
+  };
+
+  GF_BATCH_TARGET_AVX inline __m128 _TransformPointAVX(const _RowsAVX &rows, const GfVec3f &p)
+  {
+    __m256d r = _mm256_add_pd(
+      _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(p[0]), rows.row[0]),
+                                  _mm256_mul_pd(_mm256_set1_pd(p[1]), rows.row[1])),
+                    _mm256_mul_pd(_mm256_set1_pd(p[2]), rows.row[2])),
+      rows.row[3]);
+    const __m128d hi = _mm256_extractf128_pd(r, 1);
+    r = _mm256_mul_pd(_mm256_set1_pd(_GetInverseW(_mm_cvtsd_f64(_mm_unpackhi_pd(hi, hi)))), r);
+    return _mm256_cvtpd_ps(r);
+  }
+
+  GF_BATCH_TARGET_AVX inline __m128 _TransformDirAVX(const _RowsAVX &rows, const GfVec3f &d)
+  {
+    return _mm256_cvtpd_ps(
+      _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(d[0]), rows.row[0]),
+                                  _mm256_mul_pd(_mm256_set1_pd(d[1]), rows.row[1])),
+                    _mm256_mul_pd(_mm256_set1_pd(d[2]), rows.row[2])));
+  }
+
+  GF_BATCH_TARGET_AVX
+  void _TransformPointsAVX(const GfMatrix4d &m, const GfVec3f *points, size_t n, GfVec3f *result)
+  {
+    const _RowsAVX rows(m);
+    for (size_t i = 0; i != n; ++i) {
+      _StoreVec3f(_TransformPointAVX(rows, points[i]), result + i);
+    }
+  }
+
+  GF_BATCH_TARGET_AVX
+  void _TransformDirsAVX(const GfMatrix4d &m, const GfVec3f *dirs, size_t n, GfVec3f *result)
+  {
+    const _RowsAVX rows(m);
+    for (size_t i = 0; i != n; ++i) {
+      _StoreVec3f(_TransformDirAVX(rows, dirs[i]), result + i);
+    }
+  }
+
+  GF_BATCH_TARGET_AVX
+  void _MultiplyMatricesAVX(const GfMatrix4d *lhs,
+                            const GfMatrix4d *rhs,
+                            size_t n,
+                            GfMatrix4d *result)
+  {
+    for (size_t i = 0; i != n; ++i) {
+      const _RowsAVX b(rhs[i]);
+      const double *a = lhs[i].GetArray();
+      __m256d c[4];
+      for (int r = 0; r != 4; ++r) {
+        c[r] = _mm256_add_pd(
+          _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(a[4 * r]), b.row[0]),
+                                      _mm256_mul_pd(_mm256_set1_pd(a[4 * r + 1]), b.row[1])),
+                        _mm256_mul_pd(_mm256_set1_pd(a[4 * r + 2]), b.row[2])),
+          _mm256_mul_pd(_mm256_set1_pd(a[4 * r + 3]), b.row[3]));
+      }
+      // Store only once all rows are computed, result may alias lhs or rhs.
+      double *out = result[i].GetArray();
+      for (int r = 0; r != 4; ++r) {
+        _mm256_storeu_pd(out + 4 * r, c[r]);
+      }
+    }
+  }
+
+  GF_BATCH_TARGET_AVX
+  GfRange3d _ComputeTransformedRangeAVX(const GfMatrix4d &m, const GfVec3f *points, size_t n)
+  {
+    if (n == 0) {
+      return GfRange3d();
+    }
+    const _RowsAVX rows(m);
+    __m128 min = _mm_set1_ps(std::numeric_limits<float>::max());
+    __m128 max = _mm_set1_ps(std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i != n; ++i) {
+      const __m128 p = _TransformPointAVX(rows, points[i]);
+      min = _mm_min_ps(p, min);
+      max = _mm_max_ps(p, max);
+    }
+    return _MakeRange(min, max);
+  }
+
+#endif  // GF_BATCH_AVX
+
+  ////////////////////////////////////////////////////////////////////////
+  // Dispatch.
+
+  struct _Kernels
+  {
+    const char *name;
+    void (*transformPoints)(const GfMatrix4d &, const GfVec3f *, size_t, GfVec3f *);
+    void (*transformDirs)(const GfMatrix4d &, const GfVec3f *, size_t, GfVec3f *);
+    void (*multiplyMatrices)(const GfMatrix4d *, const GfMatrix4d *, size_t, GfMatrix4d *);
+    GfRange3d (*computeRange)(const GfVec3f *, size_t);
+    GfRange3d (*computeTransformedRange)(const GfMatrix4d &, const GfVec3f *, size_t);
+  };
+
+  _Kernels _SelectKernels()
+  {
+    if (!TfGetEnvSetting(GF_BATCH_DISABLE_SIMD)) {
+#if defined(GF_BATCH_AVX)
+      if (__builtin_cpu_supports("avx")) {
+        // There is nothing to gain from AVX when computing the range of
+        // untransformed points, which is done in single precision.
+        return {"avx",
+                _TransformPointsAVX,
+                _TransformDirsAVX,
+                _MultiplyMatricesAVX,
+                _ComputeRangeSSE2,
+                _ComputeTransformedRangeAVX};
+      }
+#endif
+#if defined(GF_BATCH_SSE2)
+      return {"sse2",
+              _TransformPointsSSE2,
+              _TransformDirsSSE2,
+              _MultiplyMatricesSSE2,
+              _ComputeRangeSSE2,
+              _ComputeTransformedRangeSSE2};
+#endif
+    }
+    return {"scalar",
+            _TransformPointsScalar,
+            _TransformDirsScalar,
+            _MultiplyMatricesScalar,
+            _ComputeRangeScalar,
+            _ComputeTransformedRangeScalar};
+  }
+
+  const _Kernels &_GetKernels()
+  {
+    static const _Kernels kernels = _SelectKernels();
+    return kernels;
+  }
+
+}  // namespace
+
+void GfTransformPoints(const GfMatrix4d &m, const GfVec3f *points, size_t n, GfVec3f *result)
+{
+  _GetKernels().transformPoints(m, points, n, result);
+}
+
+void GfTransformDirs(const GfMatrix4d &m, const GfVec3f *dirs, size_t n, GfVec3f *result)
+{
+  _GetKernels().transformDirs(m, dirs, n, result);
+}
+
+void GfMultiplyMatrices(const GfMatrix4d *lhs, const GfMatrix4d *rhs, size_t n, GfMatrix4d *result)
+{
+  _GetKernels().multiplyMatrices(lhs, rhs, n, result);
+}
+
+GfRange3d GfComputeRange(const GfVec3f *points, size_t n)
+{
+  return _GetKernels().computeRange(points, n);
+}
+
+GfRange3d GfComputeTransformedRange(const GfMatrix4d &m, const GfVec3f *points, size_t n)
+{
+  return _GetKernels().computeTransformedRange(m, points, n);
+}
+
+const char *GfGetBatchInstructionSet()
+{
+  return _GetKernels().name;
+}
+
+WABI_NAMESPACE_END
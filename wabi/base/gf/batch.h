@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021 Pixar. All Rights Reserved.
+ *
+ * Portions of this file are derived from original work by Pixar
+ * distributed with Universal Scene Description, a project of the
+ * Academy Software Foundation (ASWF). https://www.aswf.io/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "Apache License")
+ * with the following modification; you may not use this file except in
+ * compliance with the Apache License and the following modification:
+ * Section 6. Trademarks. is deleted and replaced with:
+ *
+ * 6. Trademarks. This License does not grant permission to use the trade
+ *    names, trademarks, service marks, or product names of the Licensor
+ *    and its affiliates, except as required to comply with Section 4(c)
+ *    of the License and to reproduce the content of the NOTICE file.
+ *
+ * You may obtain a copy of the Apache License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the Apache License with the above modification is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the Apache License for the
+ * specific language governing permissions and limitations under the
+ * Apache License.
+ *
+ * Modifications copyright (C) 2020-2021 Wabi.
+ */
+#ifndef WABI_BASE_GF_BATCH_H
+#define WABI_BASE_GF_BATCH_H
+
+/// \file gf/batch.h
+/// Kernels that apply common operations to arrays of points and matrices.
+///
+/// These use SIMD instructions when the CPU supports them, selected at
+/// runtime, and scalar loops otherwise.  Either way the results match those
+/// of the corresponding GfMatrix4d and GfRange3d operations applied to one
+/// element at a time.  Setting GF_BATCH_DISABLE_SIMD forces the scalar loops.
+
+#include "wabi/base/gf/api.h"
+#include "wabi/base/gf/range3d.h"
+#include "wabi/wabi.h"
+
+#include <cstddef>
+
+WABI_NAMESPACE_BEGIN
+
+class GfMatrix4d;
+class GfVec3f;
+
+/// Transform the \p n points in \p points by \p m, as with
+/// GfMatrix4d::Transform(), and store the results in \p result.  \p result
+/// may be the same as \p points.
+GF_API
+void GfTransformPoints(const GfMatrix4d &m, const GfVec3f *points, size_t n, GfVec3f *result);
+
+/// Transform the \p n direction vectors in \p dirs by \p m, as with
+/// GfMatrix4d::TransformDir(), and store the results in \p result.
+/// \p result may be the same as \p dirs.
+GF_API
+void GfTransformDirs(const GfMatrix4d &m, const GfVec3f *dirs, size_t n, GfVec3f *result);
+
+/// Store the products \p lhs[i] * \p rhs[i] of the \p n matrices in \p lhs
+/// and \p rhs in \p result.  \p result may be the same as \p lhs or \p rhs.
+GF_API
+void GfMultiplyMatrices(const GfMatrix4d *lhs, const GfMatrix4d *rhs, size_t n, GfMatrix4d *result);
+
+/// Return the smallest range that contains the \p n points in \p points.
+GF_API
+GfRange3d GfComputeRange(const GfVec3f *points, size_t n);
+
+/// Return the smallest range that contains the \p n points in \p points
+/// transformed by \p m, as with GfMatrix4d::Transform().
+GF_API
+GfRange3d GfComputeTransformedRange(const GfMatrix4d &m, const GfVec3f *points, size_t n);
+
+/// Return the name of the instruction set the batch kernels use, for
+/// diagnostics.  One of "avx", "sse2" or "scalar".
+GF_API
+const char *GfGetBatchInstructionSet();
+
+WABI_NAMESPACE_END
+
+#endif  // WABI_BASE_GF_BATCH_H
@@ -0,0 +1,180 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// Times the gf batch kernels against the equivalent per-element GfMatrix4d
+// and GfRange3d loops, and checks that both produce identical results.
+//
+// Usage: testGfBatchBenchmark [numElements] [numIterations]
+//
+// Set GF_BATCH_DISABLE_SIMD=1 to time the kernels' scalar fallback.
+
+#include "wabi/base/gf/batch.h"
+#include "wabi/base/gf/matrix4d.h"
+#include "wabi/base/gf/range3d.h"
+#include "wabi/base/gf/rotation.h"
+#include "wabi/base/gf/vec3d.h"
+#include "wabi/base/gf/vec3f.h"
+#include "wabi/base/tf/stopwatch.h"
+#include "wabi/base/tf/stringUtils.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+WABI_NAMESPACE_USING
+
+struct _Timers
+{
+  TfStopwatch batch;
+  TfStopwatch scalar;
+};
+
+static GfMatrix4d _MakeMatrix(std::mt19937 &rng)
+{
+  std::uniform_real_distribution<double> dist(-10.0, 10.0);
+  GfMatrix4d m;
+  m.SetTransform(GfRotation(GfVec3d(dist(rng), dist(rng), dist(rng)).GetNormalized(), dist(rng)),
+                 GfVec3d(dist(rng), dist(rng), dist(rng)));
+  return m;
+}
+
+static void _Report(const std::string &name, const _Timers &timers, size_t numIterations)
+{
+  const double batch = timers.batch.GetSeconds() / numIterations;
+  const double scalar = timers.scalar.GetSeconds() / numIterations;
+  std::cout << name << ": batch " << batch << " s, per-element " << scalar << " s";
+  if (batch > 0.0) {
+    std::cout << " (" << scalar / batch << "x)";
+  }
+  std::cout << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+  const size_t numElements = argc > 1 ? TfStringToUInt64(argv[1]) : 1000000;
+  const size_t numIterations = argc > 2 ? TfStringToUInt64(argv[2]) : 10;
+
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+
+  std::vector<GfVec3f> points(numElements);
+  for (GfVec3f &p : points) {
+    p.Set(dist(rng), dist(rng), dist(rng));
+  }
+
+  std::vector<GfMatrix4d> lhs(numElements), rhs(numElements);
+  for (size_t i = 0; i < numElements; ++i) {
+    lhs[i] = _MakeMatrix(rng);
+    rhs[i] = _MakeMatrix(rng);
+  }
+
+  GfMatrix4d m = _MakeMatrix(rng);
+  // Exercise the projective divide as well.
+  m[0][3] = 0.001;
+  m[1][3] = -0.002;
+
+  std::vector<GfVec3f> batchPoints(numElements), scalarPoints(numElements);
+  std::vector<GfMatrix4d> batchMatrices(numElements), scalarMatrices(numElements);
+  GfRange3d batchRange, scalarRange;
+
+  _Timers transformPoints, transformDirs, multiplyMatrices, computeRange, transformedRange;
+  bool success = true;
+
+  for (size_t iteration = 0; iteration < numIterations; ++iteration) {
+    transformPoints.batch.Start();
+    GfTransformPoints(m, points.data(), numElements, batchPoints.data());
+    transformPoints.batch.Stop();
+    transformPoints.scalar.Start();
+    for (size_t i = 0; i < numElements; ++i) {
+      scalarPoints[i] = m.Transform(points[i]);
+    }
+    transformPoints.scalar.Stop();
+    success &= batchPoints == scalarPoints;
+
+    transformDirs.batch.Start();
+    GfTransformDirs(m, points.data(), numElements, batchPoints.data());
+    transformDirs.batch.Stop();
+    transformDirs.scalar.Start();
+    for (size_t i = 0; i < numElements; ++i) {
+      scalarPoints[i] = m.TransformDir(points[i]);
+    }
+    transformDirs.scalar.Stop();
+    success &= batchPoints == scalarPoints;
+
+    multiplyMatrices.batch.Start();
+    GfMultiplyMatrices(lhs.data(), rhs.data(), numElements, batchMatrices.data());
+    multiplyMatrices.batch.Stop();
+    multiplyMatrices.scalar.Start();
+    for (size_t i = 0; i < numElements; ++i) {
+      scalarMatrices[i] = lhs[i] * rhs[i];
+    }
+    multiplyMatrices.scalar.Stop();
+    success &= batchMatrices == scalarMatrices;
+
+    computeRange.batch.Start();
+    batchRange = GfComputeRange(points.data(), numElements);
+    computeRange.batch.Stop();
+    computeRange.scalar.Start();
+    scalarRange = GfRange3d();
+    for (size_t i = 0; i < numElements; ++i) {
+      scalarRange.UnionWith(GfVec3d(points[i]));
+    }
+    computeRange.scalar.Stop();
+    success &= batchRange == scalarRange;
+
+    transformedRange.batch.Start();
+    batchRange = GfComputeTransformedRange(m, points.data(), numElements);
+    transformedRange.batch.Stop();
+    transformedRange.scalar.Start();
+    scalarRange = GfRange3d();
+    for (size_t i = 0; i < numElements; ++i) {
+      scalarRange.UnionWith(GfVec3d(m.Transform(points[i])));
+    }
+    transformedRange.scalar.Stop();
+    success &= batchRange == scalarRange;
+
+    if (!success) {
+      std::cerr << "Batch and per-element results differ\n";
+      break;
+    }
+  }
+
+  std::cout << "instruction set: " << GfGetBatchInstructionSet() << "\n"
+            << "elements: " << numElements << ", iterations: " << numIterations << "\n";
+  _Report("GfTransformPoints", transformPoints, numIterations);
+  _Report("GfTransformDirs", transformDirs, numIterations);
+  _Report("GfMultiplyMatrices", multiplyMatrices, numIterations);
+  _Report("GfComputeRange", computeRange, numIterations);
+  _Report("GfComputeTransformedRange", transformedRange, numIterations);
+
+  if (success) {
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -40,10 +40,15 @@
 #include "wabi/base/arch/inttypes.h"
 #include "wabi/base/arch/mallocHook.h"
 #include "wabi/base/arch/stackTrace.h"
+#include "wabi/base/arch/timing.h"
 
 #include <tbb/spin_mutex.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <string>
 #include <stdlib.h>
 #include <thread>
@@ -79,6 +84,10 @@ static const size_t _MaxMallocStackDepth = 64;
 // long) #2   TfMallocTag::_MallocWrapper(unsigned long, void const*)
 static const size_t _IgnoreStackFramesCount = 3;
 
+// The max number of entries in the per-thread cache of path nodes used to
+// push tags without taking the global lock.
+static const size_t _MaxCachedPathNodes = 4096;
+
 struct Tf_MallocPathNode;
 struct Tf_MallocGlobalData;
 
@@ -349,6 +358,58 @@ namespace
   }
 }  // namespace
 
+// Hash functor for a captured call stack.
+struct Tf_MallocStackHash
+{
+  size_t operator()(const vector<uintptr_t> &stack) const
+  {
+    return ArchHash((const char *)stack.data(), sizeof(uintptr_t) * stack.size());
+  }
+};
+
+/*
+ * Bookkeeping for a live allocation recorded in sampling mode.  The weighted
+ * values are the estimated number of bytes and allocations the sample
+ * stands for, which are billed to the path node.
+ */
+struct Tf_MallocSampledBlock
+{
+  uint32_t pathNodeIndex;
+  uint32_t stackIndex;
+  size_t blockSize;
+  int64_t weightedBytes;
+  int64_t weightedCount;
+};
+
+/*
+ * Raw sample counts for a unique call stack in sampling mode, as written to
+ * heap profiles.
+ */
+struct Tf_MallocSampledStack
+{
+  vector<uintptr_t> frames;
+  size_t liveSamples = 0;
+  size_t liveBytes = 0;
+  size_t totalSamples = 0;
+  size_t totalBytes = 0;
+};
+
+/*
+ * Counting filter over the addresses of live sampled blocks.  It lets the
+ * free hook skip the global lock for all blocks whose filter count is zero,
+ * which is the vast majority of them when sampling.  A non-zero count only
+ * means that the block may have been sampled.
+ */
+static const unsigned _SampledBlockFilterBits = 16;
+static std::atomic<uint32_t> _sampledBlockFilter[1 << _SampledBlockFilterBits];
+
+static inline std::atomic<uint32_t> &_GetSampledBlockFilterEntry(const void *ptr)
+{
+  const uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr)) *
+                     0x9E3779B97F4A7C15ULL;
+  return _sampledBlockFilter[h >> (64 - _SampledBlockFilterBits)];
+}
+
 /*
  * This is a singleton.  Because access to this structure is gated via checks
  * to TfMallocTag::_doTagging, we forego the usual TfSingleton pattern and just
@@ -365,6 +426,7 @@ struct Tf_MallocGlobalData
     _warned = false;
     _captureCallSiteCount = 0;
     _captureStack.reserve(_MaxMallocStackDepth);
+    _sampleInterval = 0;
   }
 
   Tf_MallocCallSite *_GetOrCreateCallSite(const char *name)
@@ -397,6 +459,14 @@ struct Tf_MallocGlobalData
   void _SetDebugNames(const std::string &matchList);
   bool _MatchesDebugName(const std::string &name);
 
+  bool _IsSampling() const
+  {
+    return _sampleInterval != 0;
+  }
+
+  void _RecordSample(TfMallocTag::_ThreadData *td, void *ptr, size_t nBytes) ARCH_NOINLINE;
+  void _ReleaseSample(void *ptr);
+
   typedef TfHashMap<const void *, TfMallocTag::CallStackInfo, TfHash> _CallStackTableType;
 
   tbb::spin_mutex _mutex;
@@ -424,6 +494,15 @@ struct Tf_MallocGlobalData
 
   // Pre-allocated space for getting stack traces.
   vector<uintptr_t> _captureStack;
+
+  // Mean number of bytes between samples, or 0 if every allocation is
+  // accounted for.  Set once at initialization.
+  size_t _sampleInterval;
+
+  // Live sampled blocks and the call stacks of all samples.
+  TfHashMap<const void *, Tf_MallocSampledBlock, TfHash> _sampledBlockTable;
+  vector<Tf_MallocSampledStack> _sampledStacks;
+  TfHashMap<vector<uintptr_t>, uint32_t, Tf_MallocStackHash> _sampledStackIndices;
 };
 
 /*
@@ -814,6 +893,18 @@ struct TfMallocTag::_ThreadData
   _Tagging _tagState;
   std::vector<Tf_MallocPathNode *> _tagStack;
   std::vector<unsigned int> _callSiteOnStack;
+
+  // Path nodes of the tags previously pushed by this thread, keyed by the
+  // parent node and the address of the tag name.
+  typedef std::pair<const Tf_MallocPathNode *, const void *> _PathNodeCacheKey;
+  TfHashMap<_PathNodeCacheKey, Tf_MallocPathNode *, TfHash> _pathNodeCache;
+
+  // Sampling mode state: the number of bytes left to allocate before the
+  // next sample, the state of the generator for the sample distances, and
+  // space for capturing the stack of a sample.
+  int64_t _bytesUntilSample = 0;
+  uint64_t _sampleRandomState = 0;
+  std::vector<uintptr_t> _sampleStack;
 };
 
 class TfMallocTag::Tls
@@ -879,6 +970,148 @@ inline Tf_MallocPathNode *TfMallocTag::_GetCurrentPathNodeNoLock(
   return _mallocGlobalData->_rootNode;
 }
 
+// Returns the distance in bytes to the next sample, drawn from an
+// exponential distribution with a mean of \p sampleInterval bytes.
+static int64_t _PickNextSampleDistance(uint64_t *state, size_t sampleInterval)
+{
+  // xorshift64*
+  uint64_t x = *state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *state = x;
+  const uint64_t r = x * 0x2545F4914F6CDD1DULL;
+
+  // Uniform in (0, 1].
+  const double u = static_cast<double>((r >> 11) + 1) * (1.0 / 9007199254740992.0);
+  return static_cast<int64_t>(-std::log(u) * static_cast<double>(sampleInterval)) + 1;
+}
+
+// Returns true if an allocation of \p nBytes on the thread with data \p td
+// contains a sampled byte.  This is the lock-free fast path of every
+// allocation in sampling mode.
+inline bool TfMallocTag::_ShouldSample(_ThreadData *td, size_t nBytes)
+{
+  td->_bytesUntilSample -= static_cast<int64_t>(nBytes);
+  if (ARCH_LIKELY(td->_bytesUntilSample > 0)) {
+    return false;
+  }
+
+  const size_t sampleInterval = _mallocGlobalData->_sampleInterval;
+  if (ARCH_UNLIKELY(td->_sampleRandomState == 0)) {
+    // First allocation on this thread: seed the generator and start the
+    // count from this allocation.
+    td->_sampleRandomState = (ArchGetTickTime() ^ reinterpret_cast<uintptr_t>(td)) | 1;
+    td->_bytesUntilSample = _PickNextSampleDistance(&td->_sampleRandomState, sampleInterval) -
+                            static_cast<int64_t>(nBytes);
+    if (td->_bytesUntilSample > 0) {
+      return false;
+    }
+  }
+
+  // Several sample points may fall into a large allocation; it is recorded
+  // once, with a weight accounting for its size.
+  do {
+    td->_bytesUntilSample += _PickNextSampleDistance(&td->_sampleRandomState, sampleInterval);
+  } while (td->_bytesUntilSample <= 0);
+  return true;
+}
+
+// Returns false if \p ptr is definitely not a live sampled block.
+inline bool TfMallocTag::_MaybeSampled(const void *ptr)
+{
+  return _GetSampledBlockFilterEntry(ptr).load(std::memory_order_relaxed) != 0;
+}
+
+void Tf_MallocGlobalData::_RecordSample(TfMallocTag::_ThreadData *td, void *ptr, size_t nBytes)
+{
+  // Disable tagging for this thread so any allocations caused
+  // here do not get intercepted and cause recursion.
+  TfMallocTag::_TemporaryTaggingState tmpState(TfMallocTag::_TaggingDisabled);
+
+  // Capture the stack before taking the lock.
+  td->_sampleStack.clear();
+  ArchGetStackFrames(_MaxMallocStackDepth, _IgnoreStackFramesCount, &td->_sampleStack);
+
+  // An allocation of n bytes is sampled with probability 1 - exp(-n / T),
+  // so each sample stands for 1 / (1 - exp(-n / T)) such allocations.
+  const size_t blockSize = Tf_GetMallocBlockSize(ptr, nBytes);
+  const double scale = 1.0 / -std::expm1(-static_cast<double>(blockSize) /
+                                         static_cast<double>(_sampleInterval));
+  const int64_t weightedBytes = std::llround(scale * static_cast<double>(blockSize));
+  const int64_t weightedCount = std::llround(scale);
+
+  tbb::spin_mutex::scoped_lock lock(_mutex);
+
+  Tf_MallocPathNode *node = TfMallocTag::_GetCurrentPathNodeNoLock(td);
+
+  uint32_t stackIndex;
+  auto stackIt = _sampledStackIndices.find(td->_sampleStack);
+  if (stackIt == _sampledStackIndices.end()) {
+    stackIndex = static_cast<uint32_t>(_sampledStacks.size());
+    _sampledStacks.emplace_back();
+    _sampledStacks.back().frames = td->_sampleStack;
+    _sampledStackIndices.insert(std::make_pair(td->_sampleStack, stackIndex));
+  } else {
+    stackIndex = stackIt->second;
+  }
+
+  const Tf_MallocSampledBlock block = {
+    node->_index, stackIndex, blockSize, weightedBytes, weightedCount};
+  if (!_sampledBlockTable.insert(std::make_pair(ptr, block)).second) {
+    return;
+  }
+  _GetSampledBlockFilterEntry(ptr).fetch_add(1, std::memory_order_relaxed);
+
+  Tf_MallocSampledStack &stack = _sampledStacks[stackIndex];
+  ++stack.liveSamples;
+  stack.liveBytes += blockSize;
+  ++stack.totalSamples;
+  stack.totalBytes += blockSize;
+
+  _CaptureMallocStack(node, ptr, blockSize);
+
+  node->_totalBytes += weightedBytes;
+  node->_numAllocations += weightedCount;
+  node->_callSite->_totalBytes += weightedBytes;
+  _totalBytes += weightedBytes;
+
+  _maxTotalBytes = std::max(_totalBytes, _maxTotalBytes);
+
+  _RunDebugHookForNode(node, ptr, blockSize);
+}
+
+void Tf_MallocGlobalData::_ReleaseSample(void *ptr)
+{
+  // Disable tagging for this thread so any allocations caused
+  // here do not get intercepted and cause recursion.
+  TfMallocTag::_TemporaryTaggingState tmpState(TfMallocTag::_TaggingDisabled);
+
+  tbb::spin_mutex::scoped_lock lock(_mutex);
+
+  auto it = _sampledBlockTable.find(ptr);
+  if (it == _sampledBlockTable.end()) {
+    return;
+  }
+  const Tf_MallocSampledBlock block = it->second;
+  _sampledBlockTable.erase(it);
+  _GetSampledBlockFilterEntry(ptr).fetch_sub(1, std::memory_order_relaxed);
+
+  Tf_MallocSampledStack &stack = _sampledStacks[block.stackIndex];
+  --stack.liveSamples;
+  stack.liveBytes -= block.blockSize;
+
+  Tf_MallocPathNode *node = _allPathNodes[block.pathNodeIndex];
+
+  _RunDebugHookForNode(node, ptr, block.blockSize);
+  _ReleaseMallocStack(node, ptr);
+
+  node->_totalBytes -= block.weightedBytes;
+  node->_numAllocations -= (_DECREMENT_ALLOCATION_COUNTS) ? block.weightedCount : 0;
+  node->_callSite->_totalBytes -= block.weightedBytes;
+  _totalBytes -= block.weightedBytes;
+}
+
 void TfMallocTag::SetDebugMatchList(const std::string &matchList)
 {
   if (TfMallocTag::IsInitialized()) {
@@ -1273,12 +1506,116 @@ void TfMallocTag::_FreeWrapper_ptmalloc(void *ptr, const void *)
   _mallocHook.Free(ptr);
 }
 
+void *TfMallocTag::_MallocWrapper_sampling(size_t nBytes, const void *)
+{
+  void *ptr = _mallocHook.Malloc(nBytes);
+
+  _ThreadData *td;
+  if (_ShouldNotTag(&td) || ARCH_UNLIKELY(!ptr) || !_ShouldSample(td, nBytes))
+    return ptr;
+
+  _mallocGlobalData->_RecordSample(td, ptr, nBytes);
+  return ptr;
+}
+
+void *TfMallocTag::_ReallocWrapper_sampling(void *oldPtr, size_t nBytes, const void *)
+{
+  // See comment in _ReallocWrapper.
+  if (!oldPtr)
+    return _MallocWrapper_sampling(nBytes, NULL);
+
+  _ThreadData *td = NULL;
+  _Tagging tagState;
+  const bool shouldNotTag = _ShouldNotTag(&td, &tagState);
+
+  // See comment in _ReallocWrapper.
+  if (tagState == _TaggingDisabled) {
+    return _mallocHook.Realloc(oldPtr, nBytes);
+  }
+
+  if (_MaybeSampled(oldPtr)) {
+    _mallocGlobalData->_ReleaseSample(oldPtr);
+  }
+
+  void *newPtr = _mallocHook.Realloc(oldPtr, nBytes);
+
+  if (shouldNotTag || ARCH_UNLIKELY(!newPtr) || !_ShouldSample(td, nBytes))
+    return newPtr;
+
+  _mallocGlobalData->_RecordSample(td, newPtr, nBytes);
+  return newPtr;
+}
+
+void *TfMallocTag::_MemalignWrapper_sampling(size_t alignment, size_t nBytes, const void *)
+{
+  void *ptr = _mallocHook.Memalign(alignment, nBytes);
+
+  _ThreadData *td;
+  if (_ShouldNotTag(&td) || ARCH_UNLIKELY(!ptr) || !_ShouldSample(td, nBytes))
+    return ptr;
+
+  _mallocGlobalData->_RecordSample(td, ptr, nBytes);
+  return ptr;
+}
+
+void TfMallocTag::_FreeWrapper_sampling(void *ptr, const void *)
+{
+  if (!ptr)
+    return;
+
+  // Blocks are only sampled while tagging is enabled on the allocating
+  // thread, so blocks freed while tagging is disabled, i.e. by the
+  // bookkeeping itself, were never sampled.
+  if (_MaybeSampled(ptr)) {
+    _ThreadData *td;
+    _Tagging tagState;
+    _ShouldNotTag(&td, &tagState);
+    if (tagState != _TaggingDisabled) {
+      _mallocGlobalData->_ReleaseSample(ptr);
+    }
+  }
+
+  _mallocHook.Free(ptr);
+}
+
+// The sample interval requested by InitializeSampling, or -1 to use the
+// TF_MALLOC_TAG_SAMPLE_INTERVAL environment variable.
+static int64_t _requestedSampleInterval = -1;
+
 bool TfMallocTag::Initialize(string *errMsg)
 {
-  static bool status = _Initialize(errMsg);
+  static bool status = _Initialize(
+    _requestedSampleInterval >= 0 ?
+      static_cast<size_t>(_requestedSampleInterval) :
+      static_cast<size_t>(std::max(TfGetenvInt("TF_MALLOC_TAG_SAMPLE_INTERVAL", 0), 0)),
+    errMsg);
   return status;
 }
 
+bool TfMallocTag::InitializeSampling(size_t sampleInterval, string *errMsg)
+{
+  if (!_mallocGlobalData) {
+    _requestedSampleInterval = static_cast<int64_t>(sampleInterval);
+  }
+  if (!Initialize(errMsg)) {
+    return false;
+  }
+  if (_mallocGlobalData->_sampleInterval != sampleInterval) {
+    if (errMsg) {
+      *errMsg = TfStringPrintf(
+        "TfMallocTag is already initialized with a sample interval of %zu bytes",
+        _mallocGlobalData->_sampleInterval);
+    }
+    return false;
+  }
+  return true;
+}
+
+size_t TfMallocTag::GetSampleInterval()
+{
+  return _mallocGlobalData ? _mallocGlobalData->_sampleInterval : 0;
+}
+
 
 bool TfMallocTag::GetCallTree(CallTree *tree, bool skipRepeated)
 {
@@ -1334,6 +1671,61 @@ size_t TfMallocTag::GetMaxTotalBytes()
   return _mallocGlobalData->_maxTotalBytes;
 }
 
+bool TfMallocTag::WriteSampledHeapProfile(std::ostream &out)
+{
+  if (!_mallocGlobalData || !_mallocGlobalData->_IsSampling())
+    return false;
+
+  // Copy the stacks with live samples while holding the lock and write them
+  // afterwards.
+  vector<Tf_MallocSampledStack> stacks;
+  size_t liveSamples = 0, liveBytes = 0, totalSamples = 0, totalBytes = 0;
+  {
+    _TemporaryTaggingState tmpState(_TaggingDisabled);
+    tbb::spin_mutex::scoped_lock lock(_mallocGlobalData->_mutex);
+
+    for (const Tf_MallocSampledStack &stack : _mallocGlobalData->_sampledStacks) {
+      liveSamples += stack.liveSamples;
+      liveBytes += stack.liveBytes;
+      totalSamples += stack.totalSamples;
+      totalBytes += stack.totalBytes;
+      if (stack.liveSamples) {
+        stacks.push_back(stack);
+      }
+    }
+  }
+
+  // The pprof legacy heap profile format.  The heap_v2 header tells pprof
+  // that the counts are raw samples taken with the given mean interval.
+  out << TfStringPrintf("heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n",
+                        liveSamples,
+                        liveBytes,
+                        totalSamples,
+                        totalBytes,
+                        _mallocGlobalData->_sampleInterval);
+  for (const Tf_MallocSampledStack &stack : stacks) {
+    out << TfStringPrintf("%zu: %zu [%zu: %zu] @",
+                          stack.liveSamples,
+                          stack.liveBytes,
+                          stack.totalSamples,
+                          stack.totalBytes);
+    for (uintptr_t frame : stack.frames) {
+      out << TfStringPrintf(" 0x%016" PRIxPTR, frame);
+    }
+    out << '\n';
+  }
+
+#if defined(ARCH_OS_LINUX)
+  // pprof symbolizes the addresses using the mappings of the process.
+  std::ifstream maps("/proc/self/maps");
+  if (maps) {
+    out << "\nMAPPED_LIBRARIES:\n" << maps.rdbuf();
+  }
+#endif
+
+  return true;
+}
+
 void TfMallocTag::_SetTagging(_Tagging status)
 {
   TfMallocTag::Tls::Find()->_tagState = status;
@@ -1344,7 +1736,7 @@ TfMallocTag::_Tagging TfMallocTag::_GetTagging()
   return TfMallocTag::Tls::Find()->_tagState;
 }
 
-bool TfMallocTag::_Initialize(std::string *errMsg)
+bool TfMallocTag::_Initialize(size_t sampleInterval, std::string *errMsg)
 {
   /*
    * This is called from an EXECUTE_ONCE block, so no
@@ -1358,7 +1750,10 @@ bool TfMallocTag::_Initialize(std::string *errMsg)
   // of this function so that all subsequent memory allocations are captured.
   _SetTagging(_TaggingDisabled);
 
-  bool usePtmalloc = _UsePtmalloc();
+  // The ptmalloc-specific implementation marks every block, so sampling
+  // always uses the allocator-agnostic implementation.
+  _mallocGlobalData->_sampleInterval = sampleInterval;
+  bool usePtmalloc = !sampleInterval && _UsePtmalloc();
 
   if (usePtmalloc) {
     // index 0 is reserved for untracked malloc/free's:
@@ -1376,7 +1771,13 @@ bool TfMallocTag::_Initialize(std::string *errMsg)
 
   TfMallocTag::_doTagging = true;
 
-  if (usePtmalloc) {
+  if (sampleInterval) {
+    return _mallocHook.Initialize(_MallocWrapper_sampling,
+                                  _ReallocWrapper_sampling,
+                                  _MemalignWrapper_sampling,
+                                  _FreeWrapper_sampling,
+                                  errMsg);
+  } else if (usePtmalloc) {
     return _mallocHook.Initialize(_MallocWrapper_ptmalloc,
                                   _ReallocWrapper_ptmalloc,
                                   _MemalignWrapper_ptmalloc,
@@ -1404,10 +1805,31 @@ void TfMallocTag::Auto::_Begin(const char *name)
   _threadData = TfMallocTag::Tls::Find();
 
   _threadData->_tagState = _TaggingDisabled;
-  Tf_MallocPathNode *thisNode;
+  Tf_MallocPathNode *thisNode = NULL;
   Tf_MallocCallSite *site;
+  bool foundInCache = false;
+
+  // Look for a path node this thread pushed before to avoid taking the
+  // global lock.  Path nodes are never destroyed, but the name may be at an
+  // address previously used by a different name, so the name is compared
+  // as well.  Repeated call sites need the lock to update the node.
+  Tf_MallocPathNode *parentNode = _threadData->_tagStack.empty() ?
+                                    _mallocGlobalData->_rootNode :
+                                    _threadData->_tagStack.back();
+  const _ThreadData::_PathNodeCacheKey cacheKey(parentNode, name);
+  auto cacheIt = _threadData->_pathNodeCache.find(cacheKey);
+  if (cacheIt != _threadData->_pathNodeCache.end() &&
+      strcmp(cacheIt->second->_callSite->_name.c_str(), name) == 0) {
+    Tf_MallocPathNode *cachedNode = cacheIt->second;
+    site = cachedNode->_callSite;
+    if (site->_index < _threadData->_callSiteOnStack.size() &&
+        !_threadData->_callSiteOnStack[site->_index]) {
+      thisNode = cachedNode;
+      foundInCache = true;
+    }
+  }
 
-  {
+  if (!thisNode) {
     tbb::spin_mutex::scoped_lock lock(_mallocGlobalData->_mutex);
     site = _mallocGlobalData->_GetOrCreateCallSite(name);
 
@@ -1423,11 +1845,18 @@ void TfMallocTag::Auto::_Begin(const char *name)
     else
       thisNode = _threadData->_tagStack.back()->_GetOrCreateChild(site);
 
-    if (_threadData->_callSiteOnStack[site->_index]) {
+    if (thisNode && _threadData->_callSiteOnStack[site->_index]) {
       thisNode->_repeated = true;
     }
   }
 
+  if (thisNode && !foundInCache) {
+    if (_threadData->_pathNodeCache.size() >= _MaxCachedPathNodes) {
+      _threadData->_pathNodeCache.clear();
+    }
+    _threadData->_pathNodeCache[cacheKey] = thisNode;
+  }
+
   if (thisNode) {
     _threadData->_tagStack.push_back(thisNode);
     _threadData->_callSiteOnStack[site->_index] += 1;
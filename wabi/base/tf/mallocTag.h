@@ -188,6 +188,30 @@ class TfMallocTag
   /// Initialize().
   TF_API static bool Initialize(std::string *errMsg);
 
+  /// Initialize the memory tagging system in sampling mode.
+  ///
+  /// Instead of accounting for every allocation, only allocations that
+  /// contain a sampled byte are recorded, where bytes are sampled as a
+  /// Poisson process with a mean distance of \p sampleInterval bytes
+  /// between samples.  Each recorded allocation is weighted so that the byte
+  /// and allocation counts reported by \c GetTotalBytes() and \c
+  /// GetCallTree() are unbiased estimates of the exact values.  Allocations
+  /// that are not sampled and pushing tags that were pushed before on the
+  /// same thread do not take any lock, which makes this mode cheap enough to
+  /// leave enabled in long-running sessions.
+  ///
+  /// \c Initialize() also enables sampling mode if the environment variable
+  /// \c TF_MALLOC_TAG_SAMPLE_INTERVAL is set to a positive number of bytes.
+  /// Like \c Initialize(), this function may only take effect once; it
+  /// returns \c false and sets \p *errMsg if the system was already
+  /// initialized with a different sample interval.
+  TF_API static bool InitializeSampling(size_t sampleInterval, std::string *errMsg);
+
+  /// Return the mean number of bytes between samples if the tagging system
+  /// was initialized in sampling mode, or 0 if every allocation is
+  /// accounted for.
+  TF_API static size_t GetSampleInterval();
+
   /// Return true if the tagging system is active.
   ///
   /// If \c Initialize() has been successfully called, this function returns
@@ -225,6 +249,15 @@ class TfMallocTag
   /// details.
   TF_API static bool GetCallTree(CallTree *tree, bool skipRepeated = true);
 
+  /// Write a heap profile of the sampled allocations that are still live.
+  ///
+  /// The profile is written to \p out in the text heap profile format
+  /// understood by pprof, with the raw sample counts for each call stack
+  /// and the sample interval in the header so that pprof can scale them, and
+  /// with the mapped libraries of the process for symbolization.  Returns
+  /// \c false if the tagging system was not initialized in sampling mode.
+  TF_API static bool WriteSampledHeapProfile(std::ostream &out);
+
  private:
 
   // Enum describing whether allocations are being tagged in an associated
@@ -499,9 +532,11 @@ class TfMallocTag
   static void _SetTagging(_Tagging state);
   static _Tagging _GetTagging();
 
-  static bool _Initialize(std::string *errMsg);
+  static bool _Initialize(size_t sampleInterval, std::string *errMsg);
 
   static inline bool _ShouldNotTag(_ThreadData **, _Tagging *t = NULL);
+  static inline bool _ShouldSample(_ThreadData *, size_t);
+  static inline bool _MaybeSampled(const void *);
   static inline Tf_MallocPathNode *_GetCurrentPathNodeNoLock(const _ThreadData *threadData);
 
   static void *_MallocWrapper_ptmalloc(size_t, const void *);
@@ -514,6 +549,11 @@ class TfMallocTag
   static void *_MemalignWrapper(size_t, size_t, const void *);
   static void _FreeWrapper(void *, const void *);
 
+  static void *_MallocWrapper_sampling(size_t, const void *);
+  static void *_ReallocWrapper_sampling(void *, size_t, const void *);
+  static void *_MemalignWrapper_sampling(size_t, size_t, const void *);
+  static void _FreeWrapper_sampling(void *, const void *);
+
   friend class TfMallocTag::Auto;
   class Tls;
   friend class TfMallocTag::Tls;
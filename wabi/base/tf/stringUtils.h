@@ -551,6 +551,13 @@ TF_API std::string TfStringify(double);
 /// Returns whether the conversion was successful.
 TF_API bool TfDoubleToString(double d, char *buffer, int len, bool emitTrailingZero);
 
+/// Writes the string representation of \c f to \c buffer of length \c len,
+/// using the fewest digits that round-trip as a single precision value.
+/// This matches the output of TfStringify(float) when \c emitTrailingZero is
+/// false.  The buffer length must be at least 25.
+/// Returns whether the conversion was successful.
+TF_API bool TfFloatToString(float f, char *buffer, int len, bool emitTrailingZero);
+
 /// \struct TfStreamFloat
 ///
 /// A type which offers streaming for floats in a canonical
@@ -0,0 +1,135 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// Measures how looking up existing tokens scales with the number of
+// threads.  Each thread constructs TfTokens from the same set of strings,
+// all of which are already registered, and checks that it gets back the
+// registered token.
+//
+// Usage: testTfTokenBenchmark [maxThreads] [numTokens] [numRounds]
+//
+// Thread counts double from 1 up to maxThreads, which defaults to 64.
+
+#include "wabi/base/tf/stopwatch.h"
+#include "wabi/base/tf/stringUtils.h"
+#include "wabi/base/tf/token.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+WABI_NAMESPACE_USING
+
+// Returns the time taken by \p numThreads threads to each construct a token
+// from every string in \p strings \p numRounds times.
+static double _LookUpTokens(size_t numThreads,
+                            const std::vector<std::string> &strings,
+                            const std::vector<TfToken> &tokens,
+                            size_t numRounds,
+                            std::atomic<bool> *mismatch)
+{
+  std::atomic<size_t> ready(0);
+  std::atomic<bool> go(false);
+
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads);
+  for (size_t t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      ++ready;
+      while (!go) {
+        std::this_thread::yield();
+      }
+      // Start each thread at a different offset so they don't all hit the
+      // same registry set at once.
+      const size_t numStrings = strings.size();
+      const size_t offset = t * numStrings / numThreads;
+      for (size_t round = 0; round < numRounds; ++round) {
+        for (size_t i = 0; i < numStrings; ++i) {
+          const size_t index = (i + offset) % numStrings;
+          if (TfToken(strings[index]) != tokens[index]) {
+            *mismatch = true;
+          }
+        }
+      }
+    });
+  }
+
+  while (ready != numThreads) {
+    std::this_thread::yield();
+  }
+
+  TfStopwatch timer;
+  timer.Start();
+  go = true;
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  timer.Stop();
+  return timer.GetSeconds();
+}
+
+int main(int argc, char *argv[])
+{
+  const size_t maxThreads = argc > 1 ? TfStringToUInt64(argv[1]) : 64;
+  const size_t numTokens = argc > 2 ? TfStringToUInt64(argv[2]) : 100000;
+  const size_t numRounds = argc > 3 ? TfStringToUInt64(argv[3]) : 10;
+
+  std::vector<std::string> strings;
+  std::vector<TfToken> tokens;
+  strings.reserve(numTokens);
+  tokens.reserve(numTokens);
+  for (size_t i = 0; i < numTokens; ++i) {
+    strings.push_back(TfStringPrintf("testTfTokenBenchmark_%zu", i));
+    tokens.emplace_back(strings.back());
+  }
+
+  std::cout << "tokens: " << numTokens << ", rounds: " << numRounds << "\n";
+
+  std::atomic<bool> mismatch(false);
+  double singleThreadRate = 0.0;
+  for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+    const double seconds = _LookUpTokens(numThreads, strings, tokens, numRounds, &mismatch);
+    const double rate = seconds > 0.0 ? numThreads * numTokens * numRounds / seconds : 0.0;
+    if (numThreads == 1) {
+      singleThreadRate = rate;
+    }
+    std::cout << numThreads << " threads: " << seconds << " s, " << rate << " lookups/s";
+    if (singleThreadRate > 0.0) {
+      std::cout << " (" << rate / singleThreadRate << "x)";
+    }
+    std::cout << "\n";
+  }
+
+  if (!mismatch) {
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    std::cerr << "Constructed a token that differs from the registered one\n";
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
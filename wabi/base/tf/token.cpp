@@ -28,7 +28,6 @@
 #include "wabi/base/tf/token.h"
 
 #include "wabi/base/tf/diagnostic.h"
-#include "wabi/base/tf/hashset.h"
 #include "wabi/base/tf/instantiateSingleton.h"
 #include "wabi/base/tf/iterator.h"
 #include "wabi/base/tf/registryManager.h"
@@ -39,6 +38,9 @@
 
 #include <tbb/spin_mutex.h>
 
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <string>
 #include <ostream>
 #include <vector>
@@ -52,29 +54,175 @@ using std::vector;
 
 WABI_NAMESPACE_BEGIN
 
-struct Tf_TokenRegistry
+namespace
 {
-  typedef TfToken::_Rep const *_RepPtr;
-  typedef TfPointerAndBits<const TfToken::_Rep> _RepPtrAndBits;
 
-  struct _Eq
+  /*
+   * Epoch-based reclamation for the reps and tables of the token registry.
+   *
+   * Lookups read the registry's tables without taking a lock, so reps and
+   * tables that are removed from the registry cannot be deleted immediately:
+   * a concurrent lookup may still be looking at them.  Each lookup announces
+   * the global epoch it started in, and removed objects are tagged with the
+   * epoch they were retired in and deleted once no lookup that started at or
+   * before that epoch is still running.
+   */
+  class Tf_TokenReclamation
   {
-    inline size_t operator()(TfToken::_Rep const &rep1, TfToken::_Rep const &rep2) const
+   public:
+
+    // Per-thread announcement of the epoch a lookup started in, or 0 if the
+    // thread is not looking anything up.  Records are never deleted; they
+    // are reused when their thread exits.
+    struct alignas(ARCH_CACHE_LINE_SIZE) _ThreadRecord
+    {
+      std::atomic<uint64_t> epoch{0};
+      std::atomic<bool> inUse{false};
+      _ThreadRecord *next = nullptr;
+    };
+
+    // Scoped announcement of a lookup on the calling thread.
+    class ReadGuard
+    {
+     public:
+
+      explicit ReadGuard(Tf_TokenReclamation &domain) : _record(domain._GetThreadRecord())
+      {
+        _record->epoch.store(domain._epoch.load(std::memory_order_acquire),
+                             std::memory_order_relaxed);
+        // Make the announcement visible before reading any table.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+
+      ~ReadGuard()
+      {
+        _record->epoch.store(0, std::memory_order_release);
+      }
+
+      ReadGuard(const ReadGuard &) = delete;
+      ReadGuard &operator=(const ReadGuard &) = delete;
+
+     private:
+
+      _ThreadRecord *_record;
+    };
+
+    Tf_TokenReclamation() : _epoch(1), _records(nullptr) {}
+
+    // Schedule \p ptr for deletion.  Must be called after \p ptr has been
+    // made unreachable from the registry's tables.
+    template<class T> void Retire(T *ptr)
     {
-      return (*this)(rep1._cstr, rep2._cstr);
+      _Retired item;
+      item.epoch = _epoch.fetch_add(1, std::memory_order_seq_cst);
+      item.ptr = ptr;
+      item.deleter = [](void *p) {
+        delete static_cast<T *>(p);
+      };
+
+      vector<_Retired> reclaimable;
+      {
+        tbb::spin_mutex::scoped_lock lock(_retiredMutex);
+        _retired.push_back(item);
+        if (_retired.size() >= _ReclaimThreshold) {
+          // Everything retired before the oldest running lookup started
+          // can be deleted.
+          const uint64_t oldestEpoch = _GetOldestActiveEpoch();
+          auto it = std::partition(_retired.begin(), _retired.end(), [oldestEpoch](const _Retired &r) {
+            return r.epoch >= oldestEpoch;
+          });
+          reclaimable.assign(it, _retired.end());
+          _retired.erase(it, _retired.end());
+        }
+      }
+
+      for (const _Retired &r : reclaimable) {
+        r.deleter(r.ptr);
+      }
     }
-    inline bool operator()(const char *s1, const char *s2) const
+
+   private:
+
+    struct _Retired
     {
-      return !strcmp(s1, s2);
+      uint64_t epoch;
+      void *ptr;
+      void (*deleter)(void *);
+    };
+
+    // Releases a thread's record when the thread exits.
+    struct _ThreadRecordHolder
+    {
+      ~_ThreadRecordHolder()
+      {
+        if (record) {
+          record->epoch.store(0, std::memory_order_relaxed);
+          record->inUse.store(false, std::memory_order_release);
+        }
+      }
+      _ThreadRecord *record = nullptr;
+    };
+
+    static const size_t _ReclaimThreshold = 64;
+
+    _ThreadRecord *_GetThreadRecord()
+    {
+      static thread_local _ThreadRecordHolder holder;
+      if (ARCH_UNLIKELY(!holder.record)) {
+        holder.record = _AcquireRecord();
+      }
+      return holder.record;
     }
+
+    _ThreadRecord *_AcquireRecord()
+    {
+      // Reuse the record of an exited thread if there is one.
+      for (_ThreadRecord *r = _records.load(std::memory_order_acquire); r; r = r->next) {
+        bool expected = false;
+        if (!r->inUse.load(std::memory_order_relaxed) &&
+            r->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+          return r;
+        }
+      }
+
+      _ThreadRecord *r = new _ThreadRecord;
+      r->inUse.store(true, std::memory_order_relaxed);
+      _ThreadRecord *head = _records.load(std::memory_order_relaxed);
+      do {
+        r->next = head;
+      } while (!_records.compare_exchange_weak(head, r, std::memory_order_release,
+                                               std::memory_order_relaxed));
+      return r;
+    }
+
+    uint64_t _GetOldestActiveEpoch() const
+    {
+      uint64_t oldest = std::numeric_limits<uint64_t>::max();
+      for (_ThreadRecord *r = _records.load(std::memory_order_acquire); r; r = r->next) {
+        const uint64_t epoch = r->epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0 && epoch < oldest) {
+          oldest = epoch;
+        }
+      }
+      return oldest;
+    }
+
+    std::atomic<uint64_t> _epoch;
+    std::atomic<_ThreadRecord *> _records;
+
+    tbb::spin_mutex _retiredMutex;
+    vector<_Retired> _retired;
   };
 
+}  // namespace
+
+struct Tf_TokenRegistry
+{
+  typedef TfToken::_Rep const *_RepPtr;
+  typedef TfPointerAndBits<const TfToken::_Rep> _RepPtrAndBits;
+
   template<int Mul> struct _Hash
   {
-    inline size_t operator()(TfToken::_Rep const &rep) const
-    {
-      return (*this)(rep._cstr);
-    }
     inline size_t operator()(char const *s) const
     {
       // Matches STL original implementation for now.  Switch to something
@@ -99,17 +247,52 @@ struct Tf_TokenRegistry
     T val;
   };
 
-  // It's not ideal to use TfHashSet here.  It would be better to use
-  // boost::multi_index from boost 1.56 or newer: it lets us lookup an element
-  // by a key more easily.  It also has better performance.  Earlier versions
-  // suffer from the issue where erase(iterator) has to return an iterator to
-  // the next element, which has to scan forward to find the next, so we use
-  // TfHashSet for now.
-  typedef TfHashSet<TfToken::_Rep, _InnerHash, _Eq> _RepSet;
+  /*
+   * An open-addressing table of reps with linear probing.  Lookups read
+   * the slots without locking; insertions and removals are done while
+   * holding the lock of the set.  Removed entries are replaced by a
+   * tombstone so that probe sequences stay intact, and the table is
+   * replaced by a rehashed copy when live entries and tombstones fill
+   * half of it.
+   */
+  struct _RepTable
+  {
+    explicit _RepTable(size_t capacity)
+      : mask(capacity - 1),
+        slots(new std::atomic<_RepPtr>[capacity])
+    {
+      for (size_t i = 0; i != capacity; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    size_t mask;
+    std::unique_ptr<std::atomic<_RepPtr>[]> slots;
+  };
+
+  struct _RepSet
+  {
+    std::atomic<_RepTable *> table{nullptr};
+    size_t size = 0;
+    size_t numTombstones = 0;
+  };
+
+  static const size_t _MinTableCapacity = 64;
 
   // Data members.
   _RepSet _sets[_NumSets];
   mutable _CacheLinePadded<tbb::spin_mutex> _locks[_NumSets];
+  mutable Tf_TokenReclamation _reclamation;
+
+  // Placeholder for removed entries.
+  TfToken::_Rep _tombstone;
+
+  Tf_TokenRegistry()
+  {
+    for (_RepSet &set : _sets) {
+      set.table.store(new _RepTable(_MinTableCapacity), std::memory_order_relaxed);
+    }
+  }
 
   static Tf_TokenRegistry &_GetInstance()
   {
@@ -167,7 +350,7 @@ struct Tf_TokenRegistry
       if (--rep->_refCount != 0)
         return;
 
-      if (!_sets[setNum].erase(*rep)) {
+      if (!_Erase(&_sets[setNum], rep)) {
         repFoundInSet = false;
         repString = rep->_str;
       }
@@ -181,7 +364,8 @@ struct Tf_TokenRegistry
   {
     std::vector<std::pair<size_t, size_t>> sizesWithSet;
     for (size_t i = 0; i != _NumSets; ++i) {
-      sizesWithSet.push_back(std::make_pair(_sets[i].size(), i));
+      tbb::spin_mutex::scoped_lock lock(_locks[i].val);
+      sizesWithSet.push_back(std::make_pair(_sets[i].size, i));
     }
     std::sort(sizesWithSet.begin(), sizesWithSet.end());
     printf("Set # -- Size\n");
@@ -210,13 +394,6 @@ struct Tf_TokenRegistry
     return s.c_str();
   }
 
-  static TfToken::_Rep _LookupRep(char const *cstr)
-  {
-    TfToken::_Rep ret;
-    ret._cstr = cstr;
-    return ret;
-  }
-
   static inline uint64_t _ComputeCompareCode(char const *p)
   {
     uint64_t compCode = 0;
@@ -230,6 +407,137 @@ struct Tf_TokenRegistry
     return compCode;
   }
 
+  /*
+   * Returns the rep for s in table, or null if there is none.  Safe to call
+   * without holding the lock of the set as long as the table and its reps
+   * cannot be reclaimed, i.e. while holding a ReadGuard.
+   */
+  _RepPtr _Find(const _RepTable *table, char const *s, size_t hash, uint64_t compareCode) const
+  {
+    for (size_t i = hash & table->mask, n = 0; n <= table->mask; i = (i + 1) & table->mask, ++n) {
+      _RepPtr rep = table->slots[i].load(std::memory_order_acquire);
+      if (!rep) {
+        return nullptr;
+      }
+      if (rep != &_tombstone && rep->_compareCode == compareCode && !strcmp(rep->_cstr, s)) {
+        return rep;
+      }
+    }
+    return nullptr;
+  }
+
+  /*
+   * Looks up s without locking.  Returns the rep with a reference added if
+   * it is counted, or null if s is not in the table, if the rep is dying,
+   * or if the caller needs to make a counted rep immortal, all of which
+   * must be handled while holding the lock.
+   */
+  _RepPtr _FindWithoutLock(size_t setNum,
+                           char const *s,
+                           bool makeImmortal,
+                           bool *isCounted) const
+  {
+    Tf_TokenReclamation::ReadGuard guard(_reclamation);
+
+    _RepPtr rep = _Find(_sets[setNum].table.load(std::memory_order_acquire),
+                        s,
+                        _InnerHash()(s),
+                        _ComputeCompareCode(s));
+    if (!rep) {
+      return nullptr;
+    }
+
+    *isCounted = rep->_isCounted;
+    if (!*isCounted) {
+      return rep;
+    }
+    if (makeImmortal) {
+      return nullptr;
+    }
+
+    // Only add a reference if there is one already.  A count of zero
+    // means the rep is being destroyed, or was leaked by a racing
+    // TfToken::_RemoveRef(), and is resurrected under the lock.
+    int count = rep->_refCount.load(std::memory_order_relaxed);
+    while (count > 0) {
+      if (rep->_refCount.compare_exchange_weak(count, count + 1, std::memory_order_relaxed)) {
+        return rep;
+      }
+    }
+    return nullptr;
+  }
+
+  // Inserts rep into set.  Must hold the lock of the set.
+  void _Insert(_RepSet *set, _RepPtr rep, size_t hash)
+  {
+    _RepTable *table = set->table.load(std::memory_order_relaxed);
+    if ((set->size + set->numTombstones + 1) * 2 > table->mask + 1) {
+      table = _Rehash(set);
+    }
+
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+      _RepPtr slot = table->slots[i].load(std::memory_order_relaxed);
+      if (!slot || slot == &_tombstone) {
+        if (slot) {
+          --set->numTombstones;
+        }
+        table->slots[i].store(rep, std::memory_order_release);
+        ++set->size;
+        return;
+      }
+    }
+  }
+
+  // Removes rep from set and retires it.  Must hold the lock of the set.
+  bool _Erase(_RepSet *set, _RepPtr rep)
+  {
+    _RepTable *table = set->table.load(std::memory_order_relaxed);
+    for (size_t i = _InnerHash()(rep->_cstr) & table->mask, n = 0; n <= table->mask;
+         i = (i + 1) & table->mask, ++n) {
+      _RepPtr slot = table->slots[i].load(std::memory_order_relaxed);
+      if (!slot) {
+        return false;
+      }
+      if (slot == rep) {
+        table->slots[i].store(&_tombstone, std::memory_order_seq_cst);
+        --set->size;
+        ++set->numTombstones;
+        _reclamation.Retire(const_cast<TfToken::_Rep *>(rep));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Replaces the table of set with a rehashed copy without tombstones,
+  // sized for its live entries.  Must hold the lock of the set.
+  _RepTable *_Rehash(_RepSet *set)
+  {
+    _RepTable *oldTable = set->table.load(std::memory_order_relaxed);
+
+    size_t capacity = _MinTableCapacity;
+    while (capacity < (set->size + 1) * 4) {
+      capacity *= 2;
+    }
+
+    _RepTable *newTable = new _RepTable(capacity);
+    for (size_t i = 0; i <= oldTable->mask; ++i) {
+      _RepPtr rep = oldTable->slots[i].load(std::memory_order_relaxed);
+      if (rep && rep != &_tombstone) {
+        size_t j = _InnerHash()(rep->_cstr) & newTable->mask;
+        while (newTable->slots[j].load(std::memory_order_relaxed)) {
+          j = (j + 1) & newTable->mask;
+        }
+        newTable->slots[j].store(rep, std::memory_order_relaxed);
+      }
+    }
+
+    set->table.store(newTable, std::memory_order_seq_cst);
+    set->numTombstones = 0;
+    _reclamation.Retire(oldTable);
+    return newTable;
+  }
+
   /*
    * Either finds a key that is stringwise-equal to s,
    * or puts a new _Rep into the map for s.
@@ -241,13 +549,23 @@ struct Tf_TokenRegistry
 
     size_t setNum = _GetSetNum(_CStr(s));
 
+    // Look up an existing rep without locking first.
+    bool isCounted = false;
+    if (_RepPtr rep = _FindWithoutLock(setNum, _CStr(s), makeImmortal, &isCounted)) {
+      return _RepPtrAndBits(rep, isCounted);
+    }
+
     tbb::spin_mutex::scoped_lock lock(_locks[setNum].val);
 
     // Insert or lookup an existing.
-    _RepSet::iterator iter = _sets[setNum].find(_LookupRep(_CStr(s)));
-    if (iter != _sets[setNum].end()) {
-      _RepPtr rep = &(*iter);
-      bool isCounted = rep->_isCounted;
+    _RepSet &set = _sets[setNum];
+    const size_t hash = _InnerHash()(_CStr(s));
+    const uint64_t compareCode = _ComputeCompareCode(_CStr(s));
+    if (_RepPtr rep = _Find(set.table.load(std::memory_order_relaxed),
+                            _CStr(s),
+                            hash,
+                            compareCode)) {
+      isCounted = rep->_isCounted;
       if (isCounted) {
         if (makeImmortal)
           isCounted = rep->_isCounted = false;
@@ -258,13 +576,13 @@ struct Tf_TokenRegistry
     } else {
       // No entry present, add a new entry.
       TfAutoMallocTag noname("TfToken");
-      _RepPtr rep = &(*_sets[setNum].insert(TfToken::_Rep(s)).first);
-      rep->_isCounted = !makeImmortal;
-      rep->_setNum = setNum;
-      rep->_compareCode = _ComputeCompareCode(rep->_cstr);
-      if (!makeImmortal)
-        rep->_refCount = 1;
-      return _RepPtrAndBits(rep, !makeImmortal);
+      TfToken::_Rep *newRep = new TfToken::_Rep(s);
+      newRep->_isCounted = !makeImmortal;
+      newRep->_setNum = setNum;
+      newRep->_compareCode = compareCode;
+      newRep->_refCount = makeImmortal ? 0 : 1;
+      _Insert(&set, newRep, hash);
+      return _RepPtrAndBits(newRep, !makeImmortal);
     }
   }
 
@@ -275,13 +593,21 @@ struct Tf_TokenRegistry
 
     size_t setNum = _GetSetNum(_CStr(s));
 
+    bool isCounted = false;
+    if (_RepPtr rep = _FindWithoutLock(setNum, _CStr(s), /*makeImmortal*/ false, &isCounted)) {
+      return _RepPtrAndBits(rep, isCounted);
+    }
+
     tbb::spin_mutex::scoped_lock lock(_locks[setNum].val);
 
-    _RepSet::const_iterator iter = _sets[setNum].find(_LookupRep(_CStr(s)));
-    if (iter == _sets[setNum].end())
+    _RepPtr rep = _Find(_sets[setNum].table.load(std::memory_order_relaxed),
+                        _CStr(s),
+                        _InnerHash()(_CStr(s)),
+                        _ComputeCompareCode(_CStr(s)));
+    if (!rep)
       return _RepPtrAndBits();
 
-    return _RepPtrAndBits(&(*iter), iter->IncrementIfCounted());
+    return _RepPtrAndBits(rep, rep->IncrementIfCounted());
   }
 };
 
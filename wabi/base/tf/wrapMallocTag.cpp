@@ -67,6 +67,18 @@ namespace
     return result;
   }
 
+  static bool _InitializeSampling(size_t sampleInterval)
+  {
+    string reason;
+    return TfMallocTag::InitializeSampling(sampleInterval, &reason);
+  }
+
+  static bool _WriteSampledHeapProfile(std::string const &fileName)
+  {
+    std::ofstream os(fileName.c_str());
+    return os && TfMallocTag::WriteSampledHeapProfile(os);
+  }
+
   static TfMallocTag::CallTree _GetCallTree()
   {
     TfMallocTag::CallTree ret;
@@ -161,6 +173,10 @@ void wrapMallocTag()
       .def("Initialize", _Initialize2)
       .def("Initialize", _Initialize)
       .staticmethod("Initialize")
+      .def("InitializeSampling", _InitializeSampling)
+      .staticmethod("InitializeSampling")
+      .def("GetSampleInterval", This::GetSampleInterval)
+      .staticmethod("GetSampleInterval")
       .def("IsInitialized", This::IsInitialized)
       .staticmethod("IsInitialized")
       .def("GetTotalBytes", This::GetTotalBytes)
@@ -169,6 +185,8 @@ void wrapMallocTag()
       .staticmethod("GetMaxTotalBytes")
       .def("GetCallTree", _GetCallTree)
       .staticmethod("GetCallTree")
+      .def("WriteSampledHeapProfile", _WriteSampledHeapProfile)
+      .staticmethod("WriteSampledHeapProfile")
 
       .def("SetCapturedMallocStacksMatchList", This::SetCapturedMallocStacksMatchList)
       .staticmethod("SetCapturedMallocStacksMatchList")
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2021 Pixar. All Rights Reserved.
+ *
+ * Portions of this file are derived from original work by Pixar
+ * distributed with Universal Scene Description, a project of the
+ * Academy Software Foundation (ASWF). https://www.aswf.io/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "Apache License")
+ * with the following modification; you may not use this file except in
+ * compliance with the Apache License and the following modification:
+ * Section 6. Trademarks. is deleted and replaced with:
+ *
+ * 6. Trademarks. This License does not grant permission to use the trade
+ *    names, trademarks, service marks, or product names of the Licensor
+ *    and its affiliates, except as required to comply with Section 4(c)
+ *    of the License and to reproduce the content of the NOTICE file.
+ *
+ * You may obtain a copy of the Apache License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the Apache License with the above modification is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the Apache License for the
+ * specific language governing permissions and limitations under the
+ * Apache License.
+ *
+ * Modifications copyright (C) 2020-2021 Wabi.
+ */
+
+#include "wabi/base/trace/flow.h"
+
+#include "wabi/wabi.h"
+
+#include <atomic>
+
+WABI_NAMESPACE_BEGIN
+
+TF_DEFINE_PUBLIC_TOKENS(TraceFlowTokens, TRACE_FLOW_TOKENS);
+
+// The key names must match the TraceFlowTokens values.
+constexpr static TraceStaticKeyData _flowBeginKey("TraceFlowBegin");
+constexpr static TraceStaticKeyData _flowEndKey("TraceFlowEnd");
+
+static std::atomic<uint64_t> _nextFlowId(1);
+
+uint64_t Trace_FlowBegin()
+{
+  const uint64_t flowId = _nextFlowId.fetch_add(1, std::memory_order_relaxed);
+  TraceCollector::GetInstance().StoreData(_flowBeginKey, flowId);
+  return flowId;
+}
+
+void Trace_FlowEnd(uint64_t flowId)
+{
+  TraceCollector::GetInstance().StoreData(_flowEndKey, flowId);
+}
+
+WABI_NAMESPACE_END
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2021 Pixar. All Rights Reserved.
+ *
+ * Portions of this file are derived from original work by Pixar
+ * distributed with Universal Scene Description, a project of the
+ * Academy Software Foundation (ASWF). https://www.aswf.io/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "Apache License")
+ * with the following modification; you may not use this file except in
+ * compliance with the Apache License and the following modification:
+ * Section 6. Trademarks. is deleted and replaced with:
+ *
+ * 6. Trademarks. This License does not grant permission to use the trade
+ *    names, trademarks, service marks, or product names of the Licensor
+ *    and its affiliates, except as required to comply with Section 4(c)
+ *    of the License and to reproduce the content of the NOTICE file.
+ *
+ * You may obtain a copy of the Apache License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the Apache License with the above modification is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the Apache License for the
+ * specific language governing permissions and limitations under the
+ * Apache License.
+ *
+ * Modifications copyright (C) 2020-2021 Wabi.
+ */
+
+#ifndef WABI_BASE_TRACE_FLOW_H
+#define WABI_BASE_TRACE_FLOW_H
+
+/// \file trace/flow.h
+
+#include "wabi/wabi.h"
+
+#include "wabi/base/trace/api.h"
+#include "wabi/base/trace/collector.h"
+#include "wabi/base/trace/staticKeyData.h"
+
+#include "wabi/base/arch/hints.h"
+#include "wabi/base/tf/staticTokens.h"
+
+#include <cstdint>
+
+WABI_NAMESPACE_BEGIN
+
+/// Keys of the data events that mark the two ends of a flow.  Reporters that
+/// understand flows, like TraceStreamingExporter, use these to connect the
+/// scope that started a piece of work with the scope that executed it.
+#define TRACE_FLOW_TOKENS ((flowBegin, "TraceFlowBegin"))((flowEnd, "TraceFlowEnd"))
+
+TF_DECLARE_PUBLIC_TOKENS(TraceFlowTokens, TRACE_API, TRACE_FLOW_TOKENS);
+
+// Out-of-line implementation details of TraceFlowBegin and TraceFlowScope.
+TRACE_API uint64_t Trace_FlowBegin();
+TRACE_API void Trace_FlowEnd(uint64_t flowId);
+
+/// Records the start of a new flow in the currently open scope of the calling
+/// thread and returns its id.  Returns 0 without recording anything if the
+/// TraceCollector is not enabled.
+inline uint64_t TraceFlowBegin()
+{
+  if (ARCH_LIKELY(!TraceCollector::IsEnabled())) {
+    return 0;
+  }
+  return Trace_FlowBegin();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class TraceFlowScope
+///
+/// Records a scope named \p key for the lifetime of the object which
+/// terminates the flow \p flowId returned by TraceFlowBegin.  Does nothing if
+/// \p flowId is 0 or the TraceCollector is not enabled.
+///
+class TraceFlowScope
+{
+ public:
+
+  TraceFlowScope(const TraceStaticKeyData &key, uint64_t flowId) : _key(nullptr), _start(0)
+  {
+    if (ARCH_UNLIKELY(flowId && TraceCollector::IsEnabled())) {
+      _key = &key;
+      _start = ArchGetTickTime();
+      Trace_FlowEnd(flowId);
+    }
+  }
+
+  ~TraceFlowScope()
+  {
+    if (ARCH_UNLIKELY(_key)) {
+      TraceCollector::GetInstance().Scope(*_key, _start);
+    }
+  }
+
+  TraceFlowScope(const TraceFlowScope &) = delete;
+  TraceFlowScope &operator=(const TraceFlowScope &) = delete;
+
+ private:
+
+  const TraceStaticKeyData *_key;
+  TraceEvent::TimeStamp _start;
+};
+
+WABI_NAMESPACE_END
+
+#endif  // WABI_BASE_TRACE_FLOW_H
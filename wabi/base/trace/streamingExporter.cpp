@@ -0,0 +1,540 @@
+/*
+ * Copyright 2021 Pixar. All Rights Reserved.
+ *
+ * Portions of this file are derived from original work by Pixar
+ * distributed with Universal Scene Description, a project of the
+ * Academy Software Foundation (ASWF). https://www.aswf.io/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "Apache License")
+ * with the following modification; you may not use this file except in
+ * compliance with the Apache License and the following modification:
+ * Section 6. Trademarks. is deleted and replaced with:
+ *
+ * 6. Trademarks. This License does not grant permission to use the trade
+ *    names, trademarks, service marks, or product names of the Licensor
+ *    and its affiliates, except as required to comply with Section 4(c)
+ *    of the License and to reproduce the content of the NOTICE file.
+ *
+ * You may obtain a copy of the Apache License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the Apache License with the above modification is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the Apache License for the
+ * specific language governing permissions and limitations under the
+ * Apache License.
+ *
+ * Modifications copyright (C) 2020-2021 Wabi.
+ */
+
+#include "wabi/base/trace/streamingExporter.h"
+
+#include "wabi/base/trace/category.h"
+#include "wabi/base/trace/collection.h"
+#include "wabi/base/trace/collectionNotice.h"
+#include "wabi/base/trace/collector.h"
+#include "wabi/base/trace/eventData.h"
+#include "wabi/base/trace/flow.h"
+#include "wabi/base/trace/threads.h"
+#include "wabi/wabi.h"
+
+#include "wabi/base/arch/systemInfo.h"
+#include "wabi/base/arch/timing.h"
+#include "wabi/base/js/json.h"
+#include "wabi/base/tf/diagnostic.h"
+#include "wabi/base/tf/envSetting.h"
+#include "wabi/base/tf/notice.h"
+#include "wabi/base/tf/stringUtils.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+WABI_NAMESPACE_BEGIN
+
+TF_DEFINE_ENV_SETTING(TRACE_STREAMING_FLUSH_INTERVAL_MS,
+                      250,
+                      "Interval in milliseconds at which TraceStreamingExporter "
+                      "writes recorded events to its file.");
+
+TF_DEFINE_ENV_SETTING(TRACE_STREAMING_MEMORY_LIMIT_KB,
+                      16384,
+                      "Maximum size in kilobytes of the events TraceStreamingExporter "
+                      "keeps in memory between flushes.");
+
+// Chrome trace format uses timestamps in microseconds.
+static double _TimeStampToChromeTraceValue(TraceEvent::TimeStamp t)
+{
+  return ArchTicksToNanoseconds(t) / 1000.0;
+}
+
+// Chrome trace format has a pid for each event.  We use a dummy pid, like
+// TraceEventTree::WriteChromeTraceObject.
+static const int _pid = 0;
+
+// Name and category shared by both ends of a flow so that the viewer binds
+// them together.
+static const char _flowName[] = "TraceFlow";
+static const char _flowCategory[] = "flow";
+
+// Name of the counter track reporting events dropped because of the memory
+// limit.
+static const char _droppedEventsCounter[] = "TraceStreamingExporter Dropped Events";
+
+class TraceStreamingExporter::_Impl : public TraceCollection::Visitor
+{
+ public:
+
+  _Impl()
+    : flushInterval(TfGetEnvSetting(TRACE_STREAMING_FLUSH_INTERVAL_MS) / 1000.0),
+      memoryLimit(static_cast<size_t>(std::max(TfGetEnvSetting(TRACE_STREAMING_MEMORY_LIMIT_KB), 1))
+                  * 1024),
+      running(false),
+      dropped(0)
+  {}
+
+  // Resets the conversion state for a new file and writes the file header.
+  void BeginFile()
+  {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    _pending.clear();
+    _wroteFirstEvent = false;
+    _threadIndices.clear();
+    _openScopes.clear();
+    _counterValues.clear();
+    _categories.clear();
+    _reportedDropped = 0;
+    dropped = 0;
+
+    file << "[\n";
+    _AppendEvent(
+      [](JsWriter &js) {
+        js.WriteKeyValue("name", "process_name");
+        js.WriteKeyValue("ph", "M");
+        js.WriteKeyValue("pid", _pid);
+        js.WriteKey("args");
+        js.WriteObject("name", TfGetBaseName(ArchGetExecutablePath()));
+      },
+      /* bypassLimit = */ true);
+  }
+
+  // Converts the events in \p collection and appends them to the pending
+  // buffer.
+  void AddCollection(const TraceCollection &collection)
+  {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    collection.Iterate(*this);
+  }
+
+  // Writes the pending buffer to the file.
+  void WritePending()
+  {
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+
+    std::string pending;
+    {
+      std::lock_guard<std::mutex> lock(bufferMutex);
+      const size_t numDropped = dropped.load();
+      if (numDropped != _reportedDropped) {
+        _reportedDropped = numDropped;
+        _AppendEvent(
+          [numDropped](JsWriter &js) {
+            js.WriteKeyValue("name", _droppedEventsCounter);
+            js.WriteKeyValue("ph", "C");
+            js.WriteKeyValue("pid", _pid);
+            js.WriteKeyValue("tid", 0);
+            js.WriteKeyValue("ts", _TimeStampToChromeTraceValue(ArchGetTickTime()));
+            js.WriteKey("args");
+            js.WriteObject("value", static_cast<uint64_t>(numDropped));
+          },
+          /* bypassLimit = */ true);
+      }
+      pending.swap(_pending);
+    }
+
+    if (!pending.empty()) {
+      file.write(pending.data(), pending.size());
+      file.flush();
+    }
+  }
+
+  // Terminates the trace and closes the file.
+  void EndFile()
+  {
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+    {
+      // Scopes that are still open are written as begin events, which
+      // viewers extend to the end of the trace.
+      std::lock_guard<std::mutex> lock(bufferMutex);
+      for (const auto &threadScopes : _openScopes) {
+        const int tid = threadScopes.first;
+        for (const _OpenScope &scope : threadScopes.second) {
+          _AppendEvent(
+            [&](JsWriter &js) {
+              _WriteCommonFields(js, scope.key, scope.category, tid);
+              js.WriteKeyValue("ph", "B");
+              js.WriteKeyValue("ts", _TimeStampToChromeTraceValue(scope.start));
+            },
+            /* bypassLimit = */ true);
+        }
+      }
+      _openScopes.clear();
+      file.write(_pending.data(), _pending.size());
+      _pending.clear();
+    }
+    file << "\n]\n";
+    file.close();
+  }
+
+  // TraceCollection::Visitor interface
+  void OnBeginCollection() override {}
+  void OnEndCollection() override {}
+  void OnEndThread(const TraceThreadId &threadId) override {}
+
+  bool AcceptsCategory(TraceCategoryId categoryId) override
+  {
+    return true;
+  }
+
+  void OnBeginThread(const TraceThreadId &threadId) override
+  {
+    _currentThread = _GetThreadIndex(threadId);
+  }
+
+  void OnEvent(const TraceThreadId &threadId,
+               const TfToken &key,
+               const TraceEvent &event) override
+  {
+    const int tid = _currentThread;
+
+    switch (event.GetType()) {
+      case TraceEvent::EventType::Begin:
+        // Scopes are written as complete events once they end, possibly in
+        // a later collection, so that dropping events over the memory limit
+        // never leaves unbalanced begin and end events in the trace.
+        _openScopes[tid].push_back({key, event.GetCategory(), event.GetTimeStamp()});
+        break;
+      case TraceEvent::EventType::End: {
+        std::vector<_OpenScope> &scopes = _openScopes[tid];
+        // Ends of scopes that began before the exporter started are skipped.
+        if (scopes.empty()) {
+          break;
+        }
+        const _OpenScope scope = scopes.back();
+        scopes.pop_back();
+        _AppendEvent([&](JsWriter &js) {
+          _WriteCommonFields(js, scope.key, scope.category, tid);
+          js.WriteKeyValue("ph", "X");
+          js.WriteKeyValue("ts", _TimeStampToChromeTraceValue(scope.start));
+          js.WriteKeyValue("dur",
+                           _TimeStampToChromeTraceValue(event.GetTimeStamp() - scope.start));
+        });
+        break;
+      }
+      case TraceEvent::EventType::Timespan:
+        _AppendEvent([&](JsWriter &js) {
+          _WriteCommonFields(js, key, event.GetCategory(), tid);
+          js.WriteKeyValue("ph", "X");
+          js.WriteKeyValue("ts", _TimeStampToChromeTraceValue(event.GetStartTimeStamp()));
+          js.WriteKeyValue(
+            "dur",
+            _TimeStampToChromeTraceValue(event.GetEndTimeStamp() - event.GetStartTimeStamp()));
+        });
+        break;
+      case TraceEvent::EventType::Marker:
+        _AppendEvent([&](JsWriter &js) {
+          _WriteCommonFields(js, key, event.GetCategory(), tid);
+          js.WriteKeyValue("ph", "i");
+          js.WriteKeyValue("s", "t");
+          js.WriteKeyValue("ts", _TimeStampToChromeTraceValue(event.GetTimeStamp()));
+        });
+        break;
+      case TraceEvent::EventType::CounterDelta:
+      case TraceEvent::EventType::CounterValue: {
+        // Counter deltas are accumulated across collections so that the
+        // track shows absolute values, like TraceEventTree does.
+        double &value = _counterValues[key];
+        if (event.GetType() == TraceEvent::EventType::CounterDelta) {
+          value += event.GetCounterValue();
+        } else {
+          value = event.GetCounterValue();
+        }
+        const double currentValue = value;
+        _AppendEvent([&](JsWriter &js) {
+          js.WriteKeyValue("name", key.GetString());
+          js.WriteKeyValue("ph", "C");
+          js.WriteKeyValue("pid", _pid);
+          // Chrome counters are process scoped.
+          js.WriteKeyValue("tid", 0);
+          js.WriteKeyValue("ts", _TimeStampToChromeTraceValue(event.GetTimeStamp()));
+          js.WriteKey("args");
+          js.WriteObject("value", currentValue);
+        });
+        break;
+      }
+      case TraceEvent::EventType::ScopeData: {
+        // Scope data other than flows is only meaningful as an attribute of
+        // the enclosing scope, which may have been written already.
+        const bool isBegin = key == TraceFlowTokens->flowBegin;
+        if (!isBegin && key != TraceFlowTokens->flowEnd) {
+          break;
+        }
+        const TraceEventData data = event.GetData();
+        const uint64_t *flowId = data.GetUInt();
+        if (!flowId) {
+          break;
+        }
+        _AppendEvent([&](JsWriter &js) {
+          js.WriteKeyValue("name", _flowName);
+          js.WriteKeyValue("cat", _flowCategory);
+          js.WriteKeyValue("ph", isBegin ? "s" : "f");
+          if (!isBegin) {
+            // Bind to the enclosing slice rather than the next one.
+            js.WriteKeyValue("bp", "e");
+          }
+          js.WriteKeyValue("id", *flowId);
+          js.WriteKeyValue("pid", _pid);
+          js.WriteKeyValue("tid", tid);
+          js.WriteKeyValue("ts", _TimeStampToChromeTraceValue(event.GetTimeStamp()));
+        });
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  double flushInterval;
+  size_t memoryLimit;
+
+  std::ofstream file;
+  std::thread thread;
+
+  std::mutex stateMutex;
+  std::condition_variable stateChanged;
+  bool stopRequested = false;
+  std::atomic<bool> running;
+
+  std::atomic<size_t> dropped;
+  TfNotice::Key noticeKey;
+
+  // Guards the conversion state and the pending buffer.
+  std::mutex bufferMutex;
+  // Serializes writes to the file.
+  std::mutex fileMutex;
+
+ private:
+
+  // Formats one event with \p writeFields and appends it to the pending
+  // buffer, unless that would exceed the memory limit.
+  template<class Fn> void _AppendEvent(const Fn &writeFields, bool bypassLimit = false)
+  {
+    if (!bypassLimit && _pending.size() >= memoryLimit) {
+      ++dropped;
+      return;
+    }
+
+    _scratch.str(std::string());
+    _scratch.clear();
+    {
+      JsWriter js(_scratch);
+      js.BeginObject();
+      writeFields(js);
+      js.EndObject();
+    }
+    const std::string event = _scratch.str();
+
+    if (!bypassLimit && _pending.size() + event.size() + 2 > memoryLimit) {
+      ++dropped;
+      return;
+    }
+
+    if (_wroteFirstEvent) {
+      _pending.append(",\n");
+    }
+    _wroteFirstEvent = true;
+    _pending.append(event);
+  }
+
+  void _WriteCommonFields(JsWriter &js,
+                          const TfToken &key,
+                          TraceCategoryId category,
+                          int tid)
+  {
+    js.WriteKeyValue("name", key.GetString());
+    js.WriteKeyValue("cat", _GetCategoryList(category));
+    js.WriteKeyValue("pid", _pid);
+    js.WriteKeyValue("tid", tid);
+  }
+
+  const std::string &_GetCategoryList(TraceCategoryId id)
+  {
+    auto it = _categories.find(id);
+    if (it == _categories.end()) {
+      it = _categories
+             .emplace(id, TfStringJoin(TraceCategory::GetInstance().GetCategories(id), ","))
+             .first;
+    }
+    return it->second;
+  }
+
+  // Returns a stable integer id for \p threadId, writing its name metadata
+  // the first time it is seen.
+  int _GetThreadIndex(const TraceThreadId &threadId)
+  {
+    const std::string &name = threadId.ToString();
+    auto it = _threadIndices.find(name);
+    if (it != _threadIndices.end()) {
+      return it->second;
+    }
+
+    const int tid = static_cast<int>(_threadIndices.size()) + 1;
+    _threadIndices.emplace(name, tid);
+    _AppendEvent(
+      [&](JsWriter &js) {
+        js.WriteKeyValue("name", "thread_name");
+        js.WriteKeyValue("ph", "M");
+        js.WriteKeyValue("pid", _pid);
+        js.WriteKeyValue("tid", tid);
+        js.WriteKey("args");
+        js.WriteObject("name", name);
+      },
+      /* bypassLimit = */ true);
+    return tid;
+  }
+
+  std::string _pending;
+  std::ostringstream _scratch;
+  bool _wroteFirstEvent = false;
+  size_t _reportedDropped = 0;
+  int _currentThread = 0;
+
+  // A scope whose begin event has been seen but not its end event.
+  struct _OpenScope
+  {
+    TfToken key;
+    TraceCategoryId category;
+    TraceEvent::TimeStamp start;
+  };
+
+  std::unordered_map<std::string, int> _threadIndices;
+  std::unordered_map<int, std::vector<_OpenScope>> _openScopes;
+  std::unordered_map<TfToken, double, TfToken::HashFunctor> _counterValues;
+  std::unordered_map<TraceCategoryId, std::string> _categories;
+};
+
+TraceStreamingExporter::TraceStreamingExporter() : _impl(new _Impl) {}
+
+TraceStreamingExporter::~TraceStreamingExporter()
+{
+  Stop();
+}
+
+void TraceStreamingExporter::SetFlushInterval(double seconds)
+{
+  if (!IsRunning()) {
+    _impl->flushInterval = seconds;
+  }
+}
+
+void TraceStreamingExporter::SetMemoryLimit(size_t bytes)
+{
+  if (!IsRunning()) {
+    _impl->memoryLimit = bytes;
+  }
+}
+
+bool TraceStreamingExporter::Start(const std::string &filePath)
+{
+  if (IsRunning()) {
+    TF_CODING_ERROR("TraceStreamingExporter is already running");
+    return false;
+  }
+
+  _impl->file.open(filePath, std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!_impl->file) {
+    TF_RUNTIME_ERROR("Could not open '%s' for writing", filePath.c_str());
+    return false;
+  }
+
+  _impl->BeginFile();
+  _impl->stopRequested = false;
+  _impl->running = true;
+  _impl->noticeKey = TfNotice::Register(TraceStreamingExporterPtr(this),
+                                        &TraceStreamingExporter::_OnTraceCollection);
+
+  _impl->thread = std::thread([this]() {
+    const auto interval = std::chrono::duration<double>(std::max(_impl->flushInterval, 0.001));
+    std::unique_lock<std::mutex> lock(_impl->stateMutex);
+    while (!_impl->stopRequested) {
+      if (_impl->stateChanged.wait_for(lock, interval, [this]() {
+            return _impl->stopRequested;
+          })) {
+        break;
+      }
+      lock.unlock();
+      Flush();
+      lock.lock();
+    }
+  });
+
+  return true;
+}
+
+void TraceStreamingExporter::Stop()
+{
+  if (!IsRunning()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_impl->stateMutex);
+    _impl->stopRequested = true;
+  }
+  _impl->stateChanged.notify_all();
+  _impl->thread.join();
+
+  Flush();
+
+  TfNotice::Revoke(_impl->noticeKey);
+  _impl->running = false;
+  _impl->EndFile();
+}
+
+void TraceStreamingExporter::Flush()
+{
+  if (!IsRunning()) {
+    return;
+  }
+  // The collector sends the TraceCollectionAvailable notice synchronously,
+  // so the drained events are in the pending buffer when this returns.
+  TraceCollector::GetInstance().CreateCollection();
+  _impl->WritePending();
+}
+
+bool TraceStreamingExporter::IsRunning() const
+{
+  return _impl->running;
+}
+
+size_t TraceStreamingExporter::GetDroppedEventCount() const
+{
+  return _impl->dropped;
+}
+
+void TraceStreamingExporter::_OnTraceCollection(const TraceCollectionAvailable &notice)
+{
+  if (IsRunning() && notice.GetCollection()) {
+    _impl->AddCollection(*notice.GetCollection());
+  }
+}
+
+WABI_NAMESPACE_END
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2021 Pixar. All Rights Reserved.
+ *
+ * Portions of this file are derived from original work by Pixar
+ * distributed with Universal Scene Description, a project of the
+ * Academy Software Foundation (ASWF). https://www.aswf.io/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "Apache License")
+ * with the following modification; you may not use this file except in
+ * compliance with the Apache License and the following modification:
+ * Section 6. Trademarks. is deleted and replaced with:
+ *
+ * 6. Trademarks. This License does not grant permission to use the trade
+ *    names, trademarks, service marks, or product names of the Licensor
+ *    and its affiliates, except as required to comply with Section 4(c)
+ *    of the License and to reproduce the content of the NOTICE file.
+ *
+ * You may obtain a copy of the Apache License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the Apache License with the above modification is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the Apache License for the
+ * specific language governing permissions and limitations under the
+ * Apache License.
+ *
+ * Modifications copyright (C) 2020-2021 Wabi.
+ */
+
+#ifndef WABI_BASE_TRACE_STREAMING_EXPORTER_H
+#define WABI_BASE_TRACE_STREAMING_EXPORTER_H
+
+#include "wabi/wabi.h"
+
+#include "wabi/base/trace/api.h"
+
+#include "wabi/base/tf/declarePtrs.h"
+#include "wabi/base/tf/weakBase.h"
+
+#include <memory>
+#include <string>
+
+WABI_NAMESPACE_BEGIN
+
+class TraceCollectionAvailable;
+
+TF_DECLARE_WEAK_PTRS(TraceStreamingExporter);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class TraceStreamingExporter
+///
+/// Writes the events recorded by the TraceCollector to a file in the Chrome
+/// trace event format while the application runs.  The file can be loaded
+/// in Perfetto (ui.perfetto.dev) or chrome://tracing.
+///
+/// Unlike TraceReporter::ReportChromeTracing, the exporter does not keep the
+/// recorded events in memory.  A background thread periodically drains the
+/// TraceCollector and appends the converted events to a pending buffer that
+/// is written to the file and cleared on every flush.  If the buffer reaches
+/// its memory limit between flushes, further events are dropped until the
+/// next flush and the number of dropped events is reported as a counter in
+/// the trace.  Scopes are written as complete events when they end, so
+/// dropped events never leave unbalanced scopes in the trace.
+///
+/// Besides scopes and markers, the exporter writes counter tracks for the
+/// TRACE_COUNTER_* macros, thread name metadata, and flow arrows for flows
+/// recorded with TraceFlowBegin and TraceFlowScope, such as the ones between
+/// the tasks added with WorkDispatcher::Run and their execution.
+///
+/// The exporter does not enable the TraceCollector.  Note that any other
+/// listener for TraceCollectionAvailable, e.g. the global TraceReporter,
+/// also receives the drained collections.
+///
+class TraceStreamingExporter : public TfWeakBase
+{
+ public:
+
+  /// Creates an exporter that flushes at the interval given by the
+  /// TRACE_STREAMING_FLUSH_INTERVAL_MS environment setting and buffers at
+  /// most TRACE_STREAMING_MEMORY_LIMIT_KB of events between flushes.
+  TRACE_API TraceStreamingExporter();
+
+  /// Stops the exporter if it is running.
+  TRACE_API ~TraceStreamingExporter();
+
+  TraceStreamingExporter(const TraceStreamingExporter &) = delete;
+  TraceStreamingExporter &operator=(const TraceStreamingExporter &) = delete;
+
+  /// Sets the interval between flushes. Has no effect while running.
+  TRACE_API void SetFlushInterval(double seconds);
+
+  /// Sets the maximum number of bytes of converted events kept in memory
+  /// between flushes. Has no effect while running.
+  TRACE_API void SetMemoryLimit(size_t bytes);
+
+  /// Opens \p filePath for writing and starts streaming events to it.
+  /// Returns false and issues an error if the exporter is already running or
+  /// the file could not be opened.
+  TRACE_API bool Start(const std::string &filePath);
+
+  /// Writes the remaining events, terminates the trace, and closes the file.
+  TRACE_API void Stop();
+
+  /// Drains the TraceCollector and writes the pending events to the file
+  /// without waiting for the next periodic flush.
+  TRACE_API void Flush();
+
+  /// Returns true if the exporter is running.
+  TRACE_API bool IsRunning() const;
+
+  /// Returns the number of events dropped since Start() because the memory
+  /// limit was reached.
+  TRACE_API size_t GetDroppedEventCount() const;
+
+ private:
+
+  void _OnTraceCollection(const TraceCollectionAvailable &);
+
+  class _Impl;
+  std::unique_ptr<_Impl> _impl;
+};
+
+WABI_NAMESPACE_END
+
+#endif  // WABI_BASE_TRACE_STREAMING_EXPORTER_H
@@ -111,4 +111,10 @@ void WorkDispatcher::_TransportErrors(const TfErrorMark &mark, _ErrorTransports
   errors->grow_by(1)->swap(transport);
 }
 
+const TraceStaticKeyData &WorkDispatcher::_GetTaskKey()
+{
+  constexpr static TraceStaticKeyData taskKey("WorkDispatcher Task");
+  return taskKey;
+}
+
 WABI_NAMESPACE_END
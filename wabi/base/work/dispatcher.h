@@ -40,6 +40,7 @@
 
 #include "wabi/base/tf/errorMark.h"
 #include "wabi/base/tf/errorTransport.h"
+#include "wabi/base/trace/flow.h"
 
 #include <tbb/concurrent_vector.h>
 #include <tbb/task.h>
@@ -127,16 +128,19 @@ class WorkDispatcher
   {
     explicit _InvokerTask(Fn &&fn,  _ErrorTransports *err)
       : _fn(std::move(fn)), 
-        _errors(err)
+        _errors(err),
+        _flowId(TraceFlowBegin())
     {}
 
     explicit _InvokerTask(Fn const &fn, _ErrorTransports *err) 
       : _fn(fn), 
-        _errors(err)
+        _errors(err),
+        _flowId(TraceFlowBegin())
     {}
 
     void operator()() const
     {
+      TraceFlowScope flow(_GetTaskKey(), _flowId);
       TfErrorMark m;
       _fn();
       if (!m.IsClean())
@@ -146,12 +150,18 @@ class WorkDispatcher
    private:
     Fn _fn;
     _ErrorTransports *_errors;
+    // Connects the Run() call that added this task to its execution in
+    // trace reports.
+    uint64_t _flowId;
   };
 
   // Helper function that removes errors from \p m and stores them in a new
   // entry in \p errors.
   WORK_API static void _TransportErrors(const TfErrorMark &m, _ErrorTransports *errors);
 
+  // Returns the trace key for the scope around the execution of a task.
+  WORK_API static const TraceStaticKeyData &_GetTaskKey();
+
   // Task group.
   tbb::task_group _tg;
 
@@ -257,12 +267,21 @@ class WorkDispatcher
   // to complete.
   template<class Fn> struct _InvokerTask : public tbb::task
   {
-    explicit _InvokerTask(Fn &&fn, _ErrorTransports *err) : _fn(std::move(fn)), _errors(err) {}
+    explicit _InvokerTask(Fn &&fn, _ErrorTransports *err)
+      : _fn(std::move(fn)),
+        _errors(err),
+        _flowId(TraceFlowBegin())
+    {}
 
-    explicit _InvokerTask(Fn const &fn, _ErrorTransports *err) : _fn(fn), _errors(err) {}
+    explicit _InvokerTask(Fn const &fn, _ErrorTransports *err)
+      : _fn(fn),
+        _errors(err),
+        _flowId(TraceFlowBegin())
+    {}
 
     virtual tbb::task *execute()
     {
+      TraceFlowScope flow(_GetTaskKey(), _flowId);
       TfErrorMark m;
       _fn();
       if (!m.IsClean())
@@ -274,6 +293,9 @@ class WorkDispatcher
 
     Fn _fn;
     _ErrorTransports *_errors;
+    // Connects the Run() call that added this task to its execution in
+    // trace reports.
+    uint64_t _flowId;
   };
 
   // Make an _InvokerTask instance, letting the function template deduce Fn.
@@ -288,6 +310,9 @@ class WorkDispatcher
   // entry in \p errors.
   WORK_API static void _TransportErrors(const TfErrorMark &m, _ErrorTransports *errors);
 
+  // Returns the trace key for the scope around the execution of a task.
+  WORK_API static const TraceStaticKeyData &_GetTaskKey();
+
   // Task group context and associated root task that allows us to cancel
   // tasks invoked directly by this dispatcher.
   tbb::task_group_context _context;
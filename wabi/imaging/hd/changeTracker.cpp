@@ -33,6 +33,7 @@
 
 #include "wabi/base/tf/debug.h"
 #include "wabi/base/tf/token.h"
+#include "wabi/base/work/loops.h"
 
 #include <iostream>
 #include <sstream>
@@ -55,6 +56,9 @@ HdChangeTracker::HdChangeTracker()
     // This is to cause a version mismatch during first-time processing.
     ,
     _varyingStateVersion(1),
+    _newVaryingRprims(),
+    _newVaryingRprimsOverflowed(false),
+    _newVaryingRprimsBaseVersion(1),
     _rprimIndexVersion(1),
     _sprimIndexVersion(1),
     _bprimIndexVersion(1),
@@ -144,15 +148,75 @@ void HdChangeTracker::MarkRprimDirty(SdfPath const &id, HdDirtyBits bits)
   }
 }
 
+void HdChangeTracker::MarkRprimsDirty(SdfPathVector const &ids,
+                                      std::vector<HdDirtyBits> const &bits)
+{
+  HD_TRACE_FUNCTION();
+
+  if (!TF_VERIFY(ids.size() == bits.size())) {
+    return;
+  }
+
+  if (!_emulationSceneIndex) {
+    WorkParallelForN(ids.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        HdDirtyBits rprimBits = bits[i];
+        if (rprimBits == Clean) {
+          continue;
+        }
+        // XXX: During the migration, "DirtyPrimvar" implies DirtyPoints/etc.
+        if (rprimBits & DirtyPrimvar) {
+          rprimBits |= DirtyPoints | DirtyNormals | DirtyWidths;
+        }
+        _MarkRprimDirty(ids[i], rprimBits);
+      }
+    });
+    return;
+  }
+
+  // As in MarkRprimDirty, internal bits are passed through directly and the
+  // rest are translated to locators, which are then sent to the emulation
+  // scene index in one DirtyPrims call rather than one per rprim.
+  const HdDirtyBits internalDirtyBits = HdChangeTracker::InitRepr | HdChangeTracker::Varying |
+                                        HdChangeTracker::NewRepr |
+                                        HdChangeTracker::CustomBitsMask;
+
+  std::vector<HdDataSourceLocatorSet> locators(ids.size());
+  WorkParallelForN(ids.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const HdDirtyBits rprimBits = bits[i];
+      if (rprimBits & internalDirtyBits) {
+        _MarkRprimDirty(ids[i], rprimBits & internalDirtyBits);
+      }
+      if ((rprimBits & ~internalDirtyBits) == 0) {
+        continue;
+      }
+      const HdSceneIndexPrim prim = _emulationSceneIndex->GetPrim(ids[i]);
+      HdDirtyBitsTranslator::RprimDirtyBitsToLocatorSet(prim.primType, rprimBits, &locators[i]);
+    }
+  });
+
+  HdSceneIndexObserver::DirtiedPrimEntries entries;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (!locators[i].IsEmpty()) {
+      entries.emplace_back(ids[i], locators[i]);
+    }
+  }
+  if (!entries.empty()) {
+    _emulationSceneIndex->DirtyPrims(entries);
+  }
+}
+
 void HdChangeTracker::_MarkRprimDirty(SdfPath const &id, HdDirtyBits bits)
 {
-  _IDStateMap::iterator it = _rprimState.find(id);
+  _RprimStateMap::iterator it = _rprimState.find(id);
   if (!TF_VERIFY(it != _rprimState.end(), "%s\n", id.GetText())) {
     return;
   }
+  std::atomic<HdDirtyBits> &rprimDirtyBits = it->second.value;
 
   // Early out if no new bits are being set.
-  if ((bits & (~it->second)) == 0) {
+  if ((bits & (~rprimDirtyBits.load(std::memory_order_relaxed))) == 0) {
     // Can not early out if the change represents
     // a change to the prim filter.  These need to
     // trigger a re-evaluation of the dirty list so need
@@ -166,21 +230,22 @@ void HdChangeTracker::_MarkRprimDirty(SdfPath const &id, HdDirtyBits bits)
 
   // Used to ensure the repr has been created. Don't touch scene state version
   if (bits == HdChangeTracker::InitRepr) {
-    it->second |= HdChangeTracker::InitRepr;
+    rprimDirtyBits.fetch_or(HdChangeTracker::InitRepr, std::memory_order_relaxed);
     return;
   }
 
-  // set Varying bit if it's not set
-  HdDirtyBits oldBits = it->second;
+  // set Varying bit if it's not set.  Only one of several threads marking
+  // the same rprim concurrently observes the transition.
+  const HdDirtyBits oldBits = rprimDirtyBits.fetch_or(bits | HdChangeTracker::Varying,
+                                                      std::memory_order_relaxed);
   if ((oldBits & HdChangeTracker::Varying) == 0) {
     TF_DEBUG(HD_VARYING_STATE)
       .Msg("New Varying State %s: %s\n", id.GetText(), StringifyDirtyBits(bits).c_str());
 
     // varying state changed.
     bits |= HdChangeTracker::Varying;
-    ++_varyingStateVersion;
+    _LogNewVaryingRprim(++_varyingStateVersion, id);
   }
-  it->second = oldBits | bits;
   ++_sceneStateVersion;
 
   if ((bits & DirtyVisibility) != 0) {
@@ -211,24 +276,59 @@ void HdChangeTracker::ResetVaryingState()
 
   TF_DEBUG(HD_VARYING_STATE)
     .Msg("Resetting Rprim Varying State: varyingStateVersion (%d -> %d)\n",
-         _varyingStateVersion,
-         _varyingStateVersion + 1);
+         _varyingStateVersion.load(),
+         _varyingStateVersion.load() + 1);
 
   ++_varyingStateVersion;
+  _ResetNewVaryingRprims();
 
   // reset all variability bit
   TF_FOR_ALL (it, _rprimState) {
-    if (IsClean(it->second)) {
-      it->second &= ~Varying;
+    const HdDirtyBits bits = it->second.value.load(std::memory_order_relaxed);
+    if (IsClean(bits)) {
+      it->second.value.store(bits & ~Varying, std::memory_order_relaxed);
+    }
+  }
+}
+
+void HdChangeTracker::_LogNewVaryingRprim(unsigned varyingStateVersion, SdfPath const &id)
+{
+  if (_newVaryingRprimsOverflowed.load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (_newVaryingRprims.size() >= _maxNewVaryingRprims) {
+    _newVaryingRprimsOverflowed.store(true, std::memory_order_relaxed);
+    return;
+  }
+  _newVaryingRprims.emplace_back(varyingStateVersion, id);
+}
+
+void HdChangeTracker::_ResetNewVaryingRprims()
+{
+  _newVaryingRprims.clear();
+  _newVaryingRprimsOverflowed = false;
+  _newVaryingRprimsBaseVersion = _varyingStateVersion;
+}
+
+bool HdChangeTracker::GetRprimsMadeVaryingSince(unsigned varyingStateVersion,
+                                                SdfPathVector *rprimIds) const
+{
+  if (varyingStateVersion < _newVaryingRprimsBaseVersion || _newVaryingRprimsOverflowed) {
+    return false;
+  }
+  for (const _NewVaryingRprim &entry : _newVaryingRprims) {
+    if (entry.first > varyingStateVersion) {
+      rprimIds->push_back(entry.second);
     }
   }
+  return true;
 }
 
 void HdChangeTracker::ResetRprimVaryingState(SdfPath const &id)
 {
   TF_DEBUG(HD_VARYING_STATE).Msg("Resetting Rprim Varying State: %s\n", id.GetText());
 
-  _IDStateMap::iterator it = _rprimState.find(id);
+  _RprimStateMap::iterator it = _rprimState.find(id);
   if (!TF_VERIFY(it != _rprimState.end(), "%s\n", id.GetText())) {
     return;
   }
@@ -237,17 +337,22 @@ void HdChangeTracker::ResetRprimVaryingState(SdfPath const &id)
   // cause re-evaluation of the varying state now, but
   // want to pick up the possible change on the next iteration.
 
-  it->second &= ~Varying;
+  it->second.value.fetch_and(~Varying, std::memory_order_relaxed);
 }
 
 void HdChangeTracker::MarkRprimClean(SdfPath const &id, HdDirtyBits newBits)
 {
   TF_DEBUG(HD_RPRIM_CLEANED).Msg("Rprim Cleaned: %s\n", id.GetText());
-  _IDStateMap::iterator it = _rprimState.find(id);
+  _RprimStateMap::iterator it = _rprimState.find(id);
   if (!TF_VERIFY(it != _rprimState.end()))
     return;
   // preserve the variability bit
-  it->second = (it->second & Varying) | newBits;
+  std::atomic<HdDirtyBits> &rprimDirtyBits = it->second.value;
+  HdDirtyBits oldBits = rprimDirtyBits.load(std::memory_order_relaxed);
+  while (!rprimDirtyBits.compare_exchange_weak(oldBits,
+                                               (oldBits & Varying) | newBits,
+                                               std::memory_order_relaxed)) {
+  }
 }
 
 void HdChangeTracker::InstancerInserted(SdfPath const &id, HdDirtyBits initialDirtyState)
@@ -880,7 +985,7 @@ void HdChangeTracker::MarkAllRprimsDirty(HdDirtyBits bits)
   if (_emulationSceneIndex) {
     // Since bit -> locator translation is dependent on prim type,
     // we can't do much better than devolving to MarkRprimDirty.
-    for (_IDStateMap::iterator it = _rprimState.begin(); it != _rprimState.end(); ++it) {
+    for (_RprimStateMap::iterator it = _rprimState.begin(); it != _rprimState.end(); ++it) {
       MarkRprimDirty(it->first, bits);
     }
     return;
@@ -910,9 +1015,9 @@ void HdChangeTracker::MarkAllRprimsDirty(HdDirtyBits bits)
 
   bool varyingStateUpdated = false;
 
-  for (_IDStateMap::iterator it = _rprimState.begin(); it != _rprimState.end(); ++it) {
+  for (_RprimStateMap::iterator it = _rprimState.begin(); it != _rprimState.end(); ++it) {
 
-    HdDirtyBits &rprimDirtyBits = it->second;
+    HdDirtyBits rprimDirtyBits = it->second.value.load(std::memory_order_relaxed);
 
     // If RenderTag or Repr are marked dirty, we always want to update
     // the varying state (This matches the don't early out condition in
@@ -924,11 +1029,14 @@ void HdChangeTracker::MarkAllRprimsDirty(HdDirtyBits bits)
         rprimDirtyBits |= HdChangeTracker::Varying;
         varyingStateUpdated = true;
       }
+      it->second.value.store(rprimDirtyBits, std::memory_order_relaxed);
     }
   }
 
   if (varyingStateUpdated) {
     ++_varyingStateVersion;
+    // The rprims made varying here aren't logged individually.
+    _ResetNewVaryingRprims();
   }
 
   // These counters get updated every time, even if no prims
@@ -966,14 +1074,14 @@ void HdChangeTracker::MarkPrimvarDirty(HdDirtyBits *dirtyBits, TfToken const &na
 
 HdDirtyBits HdChangeTracker::GetRprimDirtyBits(SdfPath const &id) const
 {
-  _IDStateMap::const_iterator it = _rprimState.find(id);
+  _RprimStateMap::const_iterator it = _rprimState.find(id);
   if (!TF_VERIFY(it != _rprimState.end()))
     return Clean;
 
   // not masking the varying bit, since we use that bit
   // in HdRenderIndex::GetDelegateIDsWithDirtyRprims to extract
   // all varying rprims.
-  return it->second;  // & (~Varying);
+  return it->second.value.load(std::memory_order_relaxed);  // & (~Varying);
 }
 
 void HdChangeTracker::AddCollection(TfToken const &collectionName)
@@ -33,6 +33,7 @@
 #include "wabi/base/tf/hashmap.h"
 
 #include <tbb/concurrent_hash_map.h>
+#include <tbb/concurrent_vector.h>
 #include <atomic>
 
 WABI_NAMESPACE_BEGIN
@@ -134,9 +135,23 @@ class HdChangeTracker
 
   /// Flag the Rprim with the given \p id as being dirty. Multiple calls with
   /// different dirty bits accumulate.
+  ///
+  /// Unless legacy scene delegate emulation is active, this may be called
+  /// from multiple threads at once, as long as no rprims are inserted or
+  /// removed concurrently.
   HD_API
   void MarkRprimDirty(SdfPath const &id, HdDirtyBits bits = AllDirty);
 
+  /// Flag each Rprim in \p ids as dirty with the corresponding entry of
+  /// \p bits; entries with clean bits are ignored.
+  ///
+  /// This is equivalent to calling MarkRprimDirty() for each rprim, except
+  /// that the rprims are marked in parallel and, when legacy scene delegate
+  /// emulation is active, the changes reach the emulation scene index as a
+  /// single batch. No rprims may be inserted or removed concurrently.
+  HD_API
+  void MarkRprimsDirty(SdfPathVector const &ids, std::vector<HdDirtyBits> const &bits);
+
   /// Clear the dirty flags for an HdRprim. if inSync is true, set OutOfSync
   /// flag to notify dirtyList will discover the prim to sync the residual
   /// data for new repr.
@@ -486,6 +501,18 @@ class HdChangeTracker
     return _varyingStateVersion;
   }
 
+  /// Appends to \p rprimIds the ids of the rprims that were made varying
+  /// since the varying state version was \p varyingStateVersion, and
+  /// returns true.  Returns false if that isn't known, e.g. because the
+  /// varying state was reset or too many rprims were made varying since,
+  /// in which case all rprims need to be inspected.
+  ///
+  /// The ids are not sorted and may include rprims that have since had
+  /// their varying state reset.
+  HD_API
+  bool GetRprimsMadeVaryingSince(unsigned varyingStateVersion,
+                                 SdfPathVector *rprimIds) const;
+
   // ---------------------------------------------------------------------- //
   /// @}
   /// \name Render Index Versioning
@@ -577,6 +604,22 @@ class HdChangeTracker
   static void _LogCacheAccess(TfToken const &cacheName, SdfPath const &id, bool hit);
 
   typedef TfHashMap<SdfPath, HdDirtyBits, SdfPath::Hash> _IDStateMap;
+
+  // Rprim dirty bits are updated atomically so that rprims can be marked
+  // dirty from multiple threads.  The map itself is only modified when
+  // rprims are inserted or removed.
+  struct _AtomicDirtyBits
+  {
+    _AtomicDirtyBits(HdDirtyBits bits = 0) : value(bits) {}
+    _AtomicDirtyBits(const _AtomicDirtyBits &rhs) : value(rhs.value.load()) {}
+    _AtomicDirtyBits &operator=(const _AtomicDirtyBits &rhs)
+    {
+      value.store(rhs.value.load());
+      return *this;
+    }
+    std::atomic<HdDirtyBits> value;
+  };
+  typedef TfHashMap<SdfPath, _AtomicDirtyBits, SdfPath::Hash> _RprimStateMap;
   typedef TfHashMap<TfToken, int, TfToken::HashFunctor> _CollectionStateMap;
   typedef TfHashMap<TfToken, unsigned, TfToken::HashFunctor> _GeneralStateMap;
 
@@ -595,7 +638,7 @@ class HdChangeTracker
   typedef tbb::concurrent_hash_map<SdfPath, SdfPathSet, _PathHashCompare> _DependencyMap;
 
   // Core dirty state.
-  _IDStateMap _rprimState;
+  _RprimStateMap _rprimState;
   _IDStateMap _instancerState;
   _IDStateMap _taskState;
   _IDStateMap _sprimState;
@@ -626,12 +669,25 @@ class HdChangeTracker
   // being a stable set of objects; to leverage this fact, we require the
   // delegate notify the change tracker when that state changes, which bumps
   // the varyingStateVersion, which triggers downstream invalidation.
-  unsigned _varyingStateVersion;
+  std::atomic<unsigned> _varyingStateVersion;
+
+  // Log of the rprims made varying since the varying state was last reset,
+  // along with the varying state version that they bumped.  This lets dirty
+  // lists pick up newly varying rprims without scanning every rprim.
+  // Logging stops once the log grows past _maxNewVaryingRprims entries.
+  typedef std::pair<unsigned, SdfPath> _NewVaryingRprim;
+  tbb::concurrent_vector<_NewVaryingRprim> _newVaryingRprims;
+  std::atomic<bool> _newVaryingRprimsOverflowed;
+  unsigned _newVaryingRprimsBaseVersion;
+  static const size_t _maxNewVaryingRprims = 4096;
+
+  void _LogNewVaryingRprim(unsigned varyingStateVersion, SdfPath const &id);
+  void _ResetNewVaryingRprims();
 
   // Tracks changes (insertions/removals) of prims in the render index.
   // This is used to indicating that cached gather operations need to be
   // re-evaluated, such as dirty lists or batch building.
-  unsigned _rprimIndexVersion;
+  std::atomic<unsigned> _rprimIndexVersion;
   unsigned _sprimIndexVersion;
   unsigned _bprimIndexVersion;
   unsigned _instancerIndexVersion;
@@ -639,13 +695,13 @@ class HdChangeTracker
   // The following tracks any changes of state.  As a result it is very broad.
   // The use case to detect, when no changes have been made, as to
   // avoid the need to sync or reset progressive renderers.
-  unsigned _sceneStateVersion;
+  std::atomic<unsigned> _sceneStateVersion;
 
   // Used to detect that visibility changed somewhere in the render index.
-  unsigned _visChangeCount;
+  std::atomic<unsigned> _visChangeCount;
 
   // Used to detect changes to the render tag opinion of rprims.
-  unsigned _rprimRenderTagVersion;
+  std::atomic<unsigned> _rprimRenderTagVersion;
 
   // Used to detect changes to the render tags opinion of tasks.
   unsigned _taskRenderTagsVersion;
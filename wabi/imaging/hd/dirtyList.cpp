@@ -30,6 +30,7 @@
 #include "wabi/imaging/hd/renderIndex.h"
 #include "wabi/imaging/hd/tokens.h"
 
+#include <algorithm>
 #include <iostream>
 
 WABI_NAMESPACE_BEGIN
@@ -205,6 +206,47 @@ HdChangeTracker &HdDirtyList::_GetChangeTracker() const
   return _renderIndex.GetChangeTracker();
 }
 
+void HdDirtyList::_MergeNewlyVaryingIds(SdfPathVector *newlyVaryingIds)
+{
+  TRACE_FUNCTION();
+
+  _DirtyFilterParam filterParam = {&_renderIndex, _trackedRenderTags, HdChangeTracker::Varying};
+
+  SdfPathVector &ids = *newlyVaryingIds;
+  ids.erase(std::remove_if(ids.begin(),
+                           ids.end(),
+                           [&filterParam](const SdfPath &id) {
+                             return !_DirtyRprimIdsFilterPredicate(id, &filterParam);
+                           }),
+            ids.end());
+  if (ids.empty()) {
+    return;
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  // The prim gather doesn't preserve order when it filters in parallel.
+  if (!std::is_sorted(_dirtyIds.begin(), _dirtyIds.end())) {
+    std::sort(_dirtyIds.begin(), _dirtyIds.end());
+  }
+
+  SdfPathVector mergedIds;
+  mergedIds.reserve(_dirtyIds.size() + ids.size());
+  std::set_union(_dirtyIds.cbegin(),
+                 _dirtyIds.cend(),
+                 ids.cbegin(),
+                 ids.cend(),
+                 std::back_inserter(mergedIds));
+  _dirtyIds.swap(mergedIds);
+
+  if (TfDebug::IsEnabled(HD_DIRTY_LIST)) {
+    TF_DEBUG(HD_DIRTY_LIST).Msg("  newly varying dirtyRprimIds:\n");
+    for (const SdfPath &dirtyRprimId : ids) {
+      TF_DEBUG(HD_DIRTY_LIST).Msg("    %s\n", dirtyRprimId.GetText());
+    }
+  }
+}
+
 void HdDirtyList::_UpdateDirtyIdsIfNeeded()
 {
   // NOTE: We omit sceneStateVersion here,  since it is bumped on up any
@@ -265,6 +307,17 @@ void HdDirtyList::_UpdateDirtyIdsIfNeeded()
           _varyingStateVersion,
           currentVaryingStateVersion);
 
+      // Unless the dirty list still needs pruning, the dirty ids are the
+      // varying rprims as of the previous varying state version, so only
+      // the rprims made varying since need to be added.
+      SdfPathVector newlyVaryingIds;
+      if (!_pruneDirtyList && _GetChangeTracker().GetRprimsMadeVaryingSince(
+                                _varyingStateVersion, &newlyVaryingIds)) {
+        _varyingStateVersion = currentVaryingStateVersion;
+        _MergeNewlyVaryingIds(&newlyVaryingIds);
+        return;
+      }
+
       _varyingStateVersion = currentVaryingStateVersion;
       _pruneDirtyList = false;
 
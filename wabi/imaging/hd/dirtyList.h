@@ -136,6 +136,7 @@ class HdDirtyList
 
   HdChangeTracker &_GetChangeTracker() const;
   void _UpdateDirtyIdsIfNeeded();
+  void _MergeNewlyVaryingIds(SdfPathVector *newlyVaryingIds);
 
   // Note: Can't use a const ref to the renderIndex because
   // HdRenderIndex::GetRprimIds() isn't a const member fn.
@@ -22,6 +22,7 @@
 // language governing permissions and limitations under the Apache License.
 //
 #include "wabi/imaging/hd/flatteningSceneIndex.h"
+#include "wabi/imaging/hd/perfLog.h"
 #include "wabi/imaging/hd/retainedDataSource.h"
 #include "wabi/imaging/hd/tokens.h"
 #include "wabi/imaging/hd/xformSchema.h"
@@ -110,15 +111,11 @@ void HdFlatteningSceneIndex::_PrimsAdded(const HdSceneIndexBase &sender,
     }
 
     // If we're inserting somewhere in the existing hierarchy, we need to
-    // invalidate descendant flattened attributes.
+    // invalidate descendant flattened attributes.  A resync can change
+    // anything below the prim, so this invalidates every cached value in
+    // the subtree, not just the inherited ones.
     if (!iterBoolPair.second) {
-      static HdDataSourceLocatorSet locators = {
-        HdXformSchema::GetDefaultLocator(),
-        HdVisibilitySchema::GetDefaultLocator(),
-        HdPurposeSchema::GetDefaultLocator(),
-      };
-
-      _DirtyHierarchy(entry.primPath, locators, &dirtyEntries);
+      _DirtyHierarchy(entry.primPath, _FlattenedAll, /* resync = */ true, &dirtyEntries);
     }
   }
 
@@ -160,19 +157,9 @@ void HdFlatteningSceneIndex::_PrimsDirtied(const HdSceneIndexBase &sender,
   HdSceneIndexObserver::DirtiedPrimEntries dirtyEntries;
 
   for (const HdSceneIndexObserver::DirtiedPrimEntry &entry : entries) {
-    HdDataSourceLocatorSet locators;
-    if (entry.dirtyLocators.Intersects(HdXformSchema::GetDefaultLocator())) {
-      locators.insert(HdXformSchema::GetDefaultLocator());
-    }
-    if (entry.dirtyLocators.Intersects(HdVisibilitySchema::GetDefaultLocator())) {
-      locators.insert(HdVisibilitySchema::GetDefaultLocator());
-    }
-    if (entry.dirtyLocators.Intersects(HdPurposeSchema::GetDefaultLocator())) {
-      locators.insert(HdPurposeSchema::GetDefaultLocator());
-    }
-
-    if (!locators.IsEmpty()) {
-      _DirtyHierarchy(entry.primPath, locators, &dirtyEntries);
+    const uint8_t flattenedBits = _GetFlattenedBits(entry.dirtyLocators);
+    if (flattenedBits) {
+      _DirtyHierarchy(entry.primPath, flattenedBits, /* resync = */ false, &dirtyEntries);
     }
   }
 
@@ -182,41 +169,97 @@ void HdFlatteningSceneIndex::_PrimsDirtied(const HdSceneIndexBase &sender,
   }
 }
 
+/*static*/
+uint8_t HdFlatteningSceneIndex::_GetFlattenedBits(const HdDataSourceLocatorSet &locators)
+{
+  uint8_t flattenedBits = 0;
+  if (locators.Intersects(HdXformSchema::GetDefaultLocator())) {
+    flattenedBits |= _FlattenedXform;
+  }
+  if (locators.Intersects(HdVisibilitySchema::GetDefaultLocator())) {
+    flattenedBits |= _FlattenedVis;
+  }
+  if (locators.Intersects(HdPurposeSchema::GetDefaultLocator())) {
+    flattenedBits |= _FlattenedPurpose;
+  }
+  return flattenedBits;
+}
+
+/*static*/
+HdDataSourceLocatorSet HdFlatteningSceneIndex::_GetFlattenedLocators(uint8_t flattenedBits)
+{
+  HdDataSourceLocatorSet locators;
+  if (flattenedBits & _FlattenedXform) {
+    locators.insert(HdXformSchema::GetDefaultLocator());
+  }
+  if (flattenedBits & _FlattenedVis) {
+    locators.insert(HdVisibilitySchema::GetDefaultLocator());
+  }
+  if (flattenedBits & _FlattenedPurpose) {
+    locators.insert(HdPurposeSchema::GetDefaultLocator());
+  }
+  return locators;
+}
+
 void HdFlatteningSceneIndex::_DirtyHierarchy(
   const SdfPath &primPath,
-  const HdDataSourceLocatorSet &dirtyLocators,
+  uint8_t flattenedBits,
+  bool resync,
   HdSceneIndexObserver::DirtiedPrimEntries *dirtyEntries)
 {
-  // XXX: here and elsewhere, if a parent xform is dirtied and the child has
-  // resetXformStack, we could skip dirtying the child...
+  // The flattened values invalidated at each prim on the path from
+  // "primPath" to the current prim, which are the values that need to be
+  // invalidated on its children.  The table is traversed depth first, so
+  // entries for prims that aren't ancestors of the current prim can be
+  // popped off the back.
+  std::vector<std::pair<size_t, uint8_t>> invalidatedStack;
+  size_t numInvalidatedPrims = 0;
 
   auto startEndIt = _prims.FindSubtreeRange(primPath);
   auto it = startEndIt.first;
   for (; it != startEndIt.second;) {
+    const SdfPath &path = it->first;
+    const size_t depth = path.GetPathElementCount();
+    while (!invalidatedStack.empty() && invalidatedStack.back().first >= depth) {
+      invalidatedStack.pop_back();
+    }
+    const uint8_t inheritedBits = invalidatedStack.empty() ? flattenedBits :
+                                                             invalidatedStack.back().second;
+
     _PrimEntry &entry = it->second;
 
     if (_PrimLevelWrappingDataSourceHandle dataSource = _PrimLevelWrappingDataSource::Cast(
           entry.prim.dataSource)) {
-      if (dataSource->PrimDirtied(dirtyLocators)) {
+      const uint8_t invalidatedBits = dataSource->PrimDirtied(resync ? flattenedBits :
+                                                                       inheritedBits,
+                                                              resync || path == primPath);
+      if (invalidatedBits) {
+        ++numInvalidatedPrims;
         // If we invalidated any data for any prim besides "primPath"
         // (which already has a notice), generate a new PrimsDirtied
         // notice.
-        if (it->first != primPath) {
-          dirtyEntries->emplace_back(it->first, dirtyLocators);
+        if (path != primPath) {
+          dirtyEntries->emplace_back(path, _GetFlattenedLocators(invalidatedBits));
         }
+        invalidatedStack.emplace_back(depth, invalidatedBits);
         ++it;
       } else {
-        // If we didn't invalidate any data, we can safely assume that
-        // no downstream prims depended on this prim for their
-        // flattened result, and skip to the next subtree. This is
-        // an important optimization for (e.g.) scene population,
-        // where no data is cached yet...
+        // If we didn't invalidate any data, no downstream prims
+        // depended on this prim for their flattened result, since they
+        // either weren't computed yet or were computed without it, and
+        // we can skip to the next subtree. This is an important
+        // optimization for (e.g.) scene population, where no data is
+        // cached yet, and for edits above prims that reset the
+        // inherited state...
         it = it.GetNextSubtree();
       }
     } else {
+      invalidatedStack.emplace_back(depth, inheritedBits);
       ++it;
     }
   }
+
+  HD_PERF_COUNTER_ADD(HdPerfTokens->flatteningSceneIndexInvalidations, numInvalidatedPrims);
 }
 
 HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::_PrimLevelWrappingDataSource(
@@ -228,7 +271,8 @@ HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::_PrimLevelWrappingDataSour
     _inputDataSource(inputDataSource),
     _computedXformDataSource(nullptr),
     _computedVisDataSource(nullptr),
-    _computedPurposeDataSource(nullptr)
+    _computedPurposeDataSource(nullptr),
+    _dependsOnParent(0)
 {}
 
 void HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::UpdateInputDataSource(
@@ -237,32 +281,49 @@ void HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::UpdateInputDataSource
   _inputDataSource = inputDataSource;
 }
 
-bool HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::PrimDirtied(
-  const HdDataSourceLocatorSet &set)
+uint8_t HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::PrimDirtied(
+  uint8_t flattenedBits,
+  bool isDirtiedPrim)
 {
-  bool anyDirtied = false;
+  // Values that weren't inherited are still valid on descendants.
+  if (!isDirtiedPrim) {
+    flattenedBits &= _dependsOnParent.load(std::memory_order_relaxed);
+  }
+
+  uint8_t invalidatedBits = 0;
   HdContainerDataSourceHandle null(nullptr);
 
-  if (set.Intersects(HdXformSchema::GetDefaultLocator())) {
+  if (flattenedBits & _FlattenedXform) {
     if (HdContainerDataSource::AtomicLoad(_computedXformDataSource)) {
-      anyDirtied = true;
+      invalidatedBits |= _FlattenedXform;
     }
     HdContainerDataSource::AtomicStore(_computedXformDataSource, null);
   }
-  if (set.Intersects(HdVisibilitySchema::GetDefaultLocator())) {
+  if (flattenedBits & _FlattenedVis) {
     if (HdContainerDataSource::AtomicLoad(_computedVisDataSource)) {
-      anyDirtied = true;
+      invalidatedBits |= _FlattenedVis;
     }
     HdContainerDataSource::AtomicStore(_computedVisDataSource, null);
   }
-  if (set.Intersects(HdPurposeSchema::GetDefaultLocator())) {
+  if (flattenedBits & _FlattenedPurpose) {
     if (HdContainerDataSource::AtomicLoad(_computedPurposeDataSource)) {
-      anyDirtied = true;
+      invalidatedBits |= _FlattenedPurpose;
     }
     HdContainerDataSource::AtomicStore(_computedPurposeDataSource, null);
   }
 
-  return anyDirtied;
+  return invalidatedBits;
+}
+
+void HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::_SetDependsOnParent(
+  uint8_t flattenedBit,
+  bool dependsOnParent)
+{
+  if (dependsOnParent) {
+    _dependsOnParent.fetch_or(flattenedBit, std::memory_order_relaxed);
+  } else {
+    _dependsOnParent.fetch_and(~flattenedBit, std::memory_order_relaxed);
+  }
 }
 
 bool HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::Has(const TfToken &name)
@@ -349,10 +410,17 @@ HdDataSourceBaseHandle HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::_Ge
     _computedPurposeDataSource);
 
   if (computedPurposeDataSource) {
+    HD_PERF_CACHE_HIT_TAG(HdPerfTokens->flatteningSceneIndex,
+                          _primPath,
+                          HdPurposeSchemaTokens->purpose);
     return computedPurposeDataSource;
   }
+  HD_PERF_CACHE_MISS_TAG(HdPerfTokens->flatteningSceneIndex,
+                         _primPath,
+                         HdPurposeSchemaTokens->purpose);
 
   HdPurposeSchema inputPurpose = HdPurposeSchema::GetFromParent(_inputDataSource);
+  _SetDependsOnParent(_FlattenedPurpose, !inputPurpose);
 
   if (inputPurpose) {
     if (inputPurpose.GetPurpose()) {
@@ -387,10 +455,17 @@ HdDataSourceBaseHandle HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::_Ge
     _computedVisDataSource);
 
   if (computedVisDataSource) {
+    HD_PERF_CACHE_HIT_TAG(HdPerfTokens->flatteningSceneIndex,
+                          _primPath,
+                          HdVisibilitySchemaTokens->visibility);
     return computedVisDataSource;
   }
+  HD_PERF_CACHE_MISS_TAG(HdPerfTokens->flatteningSceneIndex,
+                         _primPath,
+                         HdVisibilitySchemaTokens->visibility);
 
   HdVisibilitySchema inputVis = HdVisibilitySchema::GetFromParent(_inputDataSource);
+  _SetDependsOnParent(_FlattenedVis, !inputVis);
 
   if (inputVis) {
     if (inputVis.GetVisibility()) {
@@ -426,8 +501,14 @@ HdDataSourceBaseHandle HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::_Ge
 
   // previously cached value
   if (computedXformDataSource) {
+    HD_PERF_CACHE_HIT_TAG(HdPerfTokens->flatteningSceneIndex,
+                          _primPath,
+                          HdXformSchemaTokens->xform);
     return computedXformDataSource;
   }
+  HD_PERF_CACHE_MISS_TAG(HdPerfTokens->flatteningSceneIndex,
+                         _primPath,
+                         HdXformSchemaTokens->xform);
 
   HdXformSchema inputXform = HdXformSchema::GetFromParent(_inputDataSource);
 
@@ -442,6 +523,7 @@ HdDataSourceBaseHandle HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::_Ge
       } else {
         computedXformDataSource = _sceneIndex._identityXform;
       }
+      _SetDependsOnParent(_FlattenedXform, false);
       HdContainerDataSource::AtomicStore(_computedXformDataSource, computedXformDataSource);
 
       return computedXformDataSource;
@@ -483,6 +565,7 @@ HdDataSourceBaseHandle HdFlatteningSceneIndex::_PrimLevelWrappingDataSource::_Ge
     computedXformDataSource = _sceneIndex._identityXform;
   }
 
+  _SetDependsOnParent(_FlattenedXform, true);
   HdContainerDataSource::AtomicStore(_computedXformDataSource, computedXformDataSource);
 
   return computedXformDataSource;
@@ -30,6 +30,9 @@
 
 #include "wabi/usd/sdf/pathTable.h"
 
+#include <atomic>
+#include <cstdint>
+
 WABI_NAMESPACE_BEGIN
 
 class HdFlatteningSceneIndex;
@@ -45,6 +48,14 @@ TF_DECLARE_REF_PTRS(HdFlatteningSceneIndex);
 /// render delegates that require all the information to be available at the
 /// leaf prims.
 ///
+/// Flattened values are computed lazily and cached per prim.  GetPrim and
+/// the returned data sources may be used from multiple threads at once, but
+/// not concurrently with the processing of change notices.  When a prim is
+/// dirtied, only the cached values of descendants that inherited the dirtied
+/// value are invalidated.  Cache hits and misses are recorded in HdPerfLog
+/// under HdPerfTokens->flatteningSceneIndex, and the number of invalidated
+/// prims under HdPerfTokens->flatteningSceneIndexInvalidations.
+///
 class HdFlatteningSceneIndex : public HdSingleInputFilteringSceneIndexBase
 {
  public:
@@ -96,9 +107,25 @@ class HdFlatteningSceneIndex : public HdSingleInputFilteringSceneIndexBase
   HdContainerDataSourceHandle _identityVis;
   HdContainerDataSourceHandle _identityPurpose;
 
+  // Bits identifying the flattened data sources.
+  enum _FlattenedBits : uint8_t
+  {
+    _FlattenedXform = 1 << 0,
+    _FlattenedVis = 1 << 1,
+    _FlattenedPurpose = 1 << 2,
+    _FlattenedAll = _FlattenedXform | _FlattenedVis | _FlattenedPurpose
+  };
+
   // methods
+  static uint8_t _GetFlattenedBits(const HdDataSourceLocatorSet &locators);
+  static HdDataSourceLocatorSet _GetFlattenedLocators(uint8_t flattenedBits);
+
+  // Invalidates the flattened values for \p flattenedBits on \p primPath
+  // and on the descendants that inherited them.  If \p resync is true,
+  // they're invalidated on every descendant.
   void _DirtyHierarchy(const SdfPath &primPath,
-                       const HdDataSourceLocatorSet &dirtyLocators,
+                       uint8_t flattenedBits,
+                       bool resync,
                        HdSceneIndexObserver::DirtiedPrimEntries *dirtyEntries);
 
   // ------------------------------------------------------------------------
@@ -119,7 +146,10 @@ class HdFlatteningSceneIndex : public HdSingleInputFilteringSceneIndexBase
 
     void UpdateInputDataSource(HdContainerDataSourceHandle inputDataSource);
 
-    bool PrimDirtied(const HdDataSourceLocatorSet &locators);
+    // Invalidates the cached values for \p flattenedBits and returns the
+    // bits that were invalidated.  For a descendant of the dirtied prim,
+    // only values that were inherited from the parent are invalidated.
+    uint8_t PrimDirtied(uint8_t flattenedBits, bool isDirtiedPrim);
 
     bool Has(const TfToken &name) override;
     TfTokenVector GetNames() override;
@@ -131,12 +161,17 @@ class HdFlatteningSceneIndex : public HdSingleInputFilteringSceneIndexBase
     HdDataSourceBaseHandle _GetVis();
     HdDataSourceBaseHandle _GetPurpose();
 
+    void _SetDependsOnParent(uint8_t flattenedBit, bool dependsOnParent);
+
     const HdFlatteningSceneIndex &_sceneIndex;
     SdfPath _primPath;
     HdContainerDataSourceHandle _inputDataSource;
     HdContainerDataSourceAtomicHandle _computedXformDataSource;
     HdContainerDataSourceAtomicHandle _computedVisDataSource;
     HdContainerDataSourceAtomicHandle _computedPurposeDataSource;
+
+    // The flattened values whose cached value was inherited from the parent.
+    std::atomic<uint8_t> _dependsOnParent;
   };
 
   HD_DECLARE_DATASOURCE_HANDLES(_PrimLevelWrappingDataSource);
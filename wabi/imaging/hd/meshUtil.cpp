@@ -35,10 +35,171 @@
 #include "wabi/base/gf/vec3d.h"
 #include "wabi/base/gf/vec4d.h"
 
+#include "wabi/base/work/loops.h"
+
+#include <algorithm>
+#include <atomic>
 #include <unordered_set>
 
 WABI_NAMESPACE_BEGIN
 
+//-------------------------------------------------------------------------
+// Face ranges
+//
+// Triangulation and quadrangulation write a variable number of outputs per
+// face, so large meshes are processed in two passes: the faces are split
+// into fixed size ranges and the outputs of each range are counted in
+// parallel, then a prefix sum over the ranges gives each one its starting
+// offsets and the ranges are filled in parallel.
+
+// Meshes with fewer faces than this are processed as a single range on the
+// calling thread.
+static const int _NumFacesPerRange = 16384;
+
+// The running offsets at the start of a range of faces.
+struct _FaceRange
+{
+  int faceBegin;
+  int faceEnd;
+  int holeIndex;    // first hole face index not less than faceBegin
+  int vertIndex;    // first face-vertex index of faceBegin
+  int outputIndex;  // first output (triangle, quad, value) of faceBegin
+  int extraIndex;   // first additional point of faceBegin
+};
+
+struct _FaceRanges
+{
+  std::vector<_FaceRange> ranges;
+  int numOutputs = 0;
+  int numExtra = 0;
+  bool degenerateFaceFound = false;
+};
+
+// Returns true if the faces can be split into ranges that reproduce the
+// serial walk over faceVertexCounts and holeFaces.  The serial walk only
+// advances through holeFaces when it finds a matching face, so this requires
+// that the hole face indices are sorted, unique, in range and not degenerate.
+static bool _CanSplitFaces(int const *numVertsPtr,
+                           int numFaces,
+                           int const *holeFacesPtr,
+                           int numHoleFaces)
+{
+  int prevHoleFace = -1;
+  for (int i = 0; i < numHoleFaces; ++i) {
+    int holeFace = holeFacesPtr[i];
+    if (holeFace <= prevHoleFace || holeFace >= numFaces || numVertsPtr[holeFace] < 3) {
+      return false;
+    }
+    prevHoleFace = holeFace;
+  }
+  return true;
+}
+
+// Split the faces into ranges and compute their starting offsets.
+// countFn(nv, &numOutputs, &numExtra) returns the number of outputs and
+// additional points generated for a face with nv >= 3 vertices that is not
+// a hole.
+template<typename CountFn>
+static _FaceRanges _ComputeFaceRanges(VtIntArray const &faceVertexCounts,
+                                      VtIntArray const &holeFaces,
+                                      CountFn const &countFn)
+{
+  int const *numVertsPtr = faceVertexCounts.cdata();
+  int const *holeFacesPtr = holeFaces.cdata();
+  int numFaces = faceVertexCounts.size();
+  int numHoleFaces = holeFaces.size();
+
+  int numRanges = 1;
+  if (numFaces >= 2 * _NumFacesPerRange &&
+      _CanSplitFaces(numVertsPtr, numFaces, holeFacesPtr, numHoleFaces)) {
+    numRanges = (numFaces + _NumFacesPerRange - 1) / _NumFacesPerRange;
+  }
+
+  _FaceRanges result;
+  result.ranges.resize(numRanges);
+  std::vector<char> degenerate(numRanges, 0);
+
+  // First pass: count the face-vertices, outputs and additional points of
+  // each range, storing the counts in place of the offsets.
+  auto countRange = [&](size_t r) {
+    _FaceRange &range = result.ranges[r];
+    range.faceBegin = numRanges == 1 ? 0 : r * _NumFacesPerRange;
+    range.faceEnd = numRanges == 1 ? numFaces : std::min(numFaces, range.faceBegin + _NumFacesPerRange);
+    range.holeIndex = (r == 0) ? 0 :
+                                 std::lower_bound(holeFacesPtr,
+                                                  holeFacesPtr + numHoleFaces,
+                                                  range.faceBegin) -
+                                   holeFacesPtr;
+
+    int holeIndex = range.holeIndex;
+    int numVerts = 0, numOutputs = 0, numExtra = 0;
+    for (int i = range.faceBegin; i < range.faceEnd; ++i) {
+      int nv = numVertsPtr[i];
+      numVerts += nv;
+      if (nv < 3) {
+        // skip degenerated face
+        degenerate[r] = 1;
+      } else if (holeIndex < numHoleFaces && holeFacesPtr[holeIndex] == i) {
+        // skip hole face
+        ++holeIndex;
+      } else {
+        int faceOutputs = 0, faceExtra = 0;
+        countFn(nv, &faceOutputs, &faceExtra);
+        numOutputs += faceOutputs;
+        numExtra += faceExtra;
+      }
+    }
+    range.vertIndex = numVerts;
+    range.outputIndex = numOutputs;
+    range.extraIndex = numExtra;
+  };
+  if (numRanges == 1) {
+    countRange(0);
+  } else {
+    WorkParallelForN(numRanges, [&countRange](size_t begin, size_t end) {
+      for (size_t r = begin; r != end; ++r) {
+        countRange(r);
+      }
+    });
+  }
+
+  // Exclusive prefix sum over the ranges.
+  int vertIndex = 0;
+  for (int r = 0; r < numRanges; ++r) {
+    _FaceRange &range = result.ranges[r];
+    int numVerts = range.vertIndex;
+    int numOutputs = range.outputIndex;
+    int numExtra = range.extraIndex;
+    range.vertIndex = vertIndex;
+    range.outputIndex = result.numOutputs;
+    range.extraIndex = result.numExtra;
+    vertIndex += numVerts;
+    result.numOutputs += numOutputs;
+    result.numExtra += numExtra;
+    result.degenerateFaceFound |= degenerate[r] != 0;
+  }
+  return result;
+}
+
+// Second pass: call fillFn on each range, in parallel when there are several.
+// fillFn returns true if it found inconsistent topology, as does this.
+template<typename FillFn>
+static bool _FillFaceRanges(_FaceRanges const &faceRanges, FillFn const &fillFn)
+{
+  if (faceRanges.ranges.size() == 1) {
+    return fillFn(faceRanges.ranges[0]);
+  }
+  std::atomic<bool> invalidTopology(false);
+  WorkParallelForN(faceRanges.ranges.size(), [&](size_t begin, size_t end) {
+    for (size_t r = begin; r != end; ++r) {
+      if (fillFn(faceRanges.ranges[r])) {
+        invalidTopology = true;
+      }
+    }
+  });
+  return invalidTopology;
+}
+
 //-------------------------------------------------------------------------
 // Triangulation
 
@@ -93,31 +254,21 @@ void HdMeshUtil::ComputeTriangleIndices(VtVec3iArray *indices,
 
   // generate triangle index buffer
 
-  int const *numVertsPtr = _topology->GetFaceVertexCounts().cdata();
   int const *vertsPtr = _topology->GetFaceVertexIndices().cdata();
+  int const *numVertsPtr = _topology->GetFaceVertexCounts().cdata();
   int const *holeFacesPtr = _topology->GetHoleIndices().cdata();
-  int numFaces = _topology->GetFaceVertexCounts().size();
   int numVertIndices = _topology->GetFaceVertexIndices().size();
-  int numTris = 0;
   int numHoleFaces = _topology->GetHoleIndices().size();
-  bool invalidTopology = false;
-  int holeIndex = 0;
-  for (int i = 0; i < numFaces; ++i) {
-    int nv = numVertsPtr[i] - 2;
-    if (nv < 1) {
-      // skip degenerated face
-      invalidTopology = true;
-    } else if (holeIndex < numHoleFaces && holeFacesPtr[holeIndex] == i) {
-      // skip hole face
-      ++holeIndex;
-    } else {
-      numTris += nv;
-    }
-  }
-  if (invalidTopology) {
+
+  _FaceRanges faceRanges = _ComputeFaceRanges(_topology->GetFaceVertexCounts(),
+                                              _topology->GetHoleIndices(),
+                                              [](int nv, int *numTris, int *) {
+                                                *numTris = nv - 2;
+                                              });
+  if (faceRanges.degenerateFaceFound) {
     TF_WARN("degenerated face found [%s]", _id.GetText());
-    invalidTopology = false;
   }
+  int numTris = faceRanges.numOutputs;
 
   indices->resize(numTris);          // vec3 per face
   primitiveParams->resize(numTris);  // int per face
@@ -125,85 +276,94 @@ void HdMeshUtil::ComputeTriangleIndices(VtVec3iArray *indices,
     edgeIndices->resize(numTris);  // int per face
   }
 
-  bool flip = (_topology->GetOrientation() != HdTokens->rightHanded);
+  GfVec3i *indicesPtr = indices->data();
+  int *primitiveParamsPtr = primitiveParams->data();
+  int *edgeIndicesPtr = edgeIndices ? edgeIndices->data() : nullptr;
 
-  // reset holeIndex
-  holeIndex = 0;
+  bool flip = (_topology->GetOrientation() != HdTokens->rightHanded);
 
-  // i  -> authored face index [0, numFaces)
-  // tv -> triangulated face index [0, numTris)
-  // v  -> index to the first vertex (index) for face i
-  // ev -> edges visited
-  for (int i = 0, tv = 0, v = 0, ev = 0; i < numFaces; ++i) {
-    int nv = numVertsPtr[i];
-    if (nv < 3) {
-      // Skip degenerate faces.
-    } else if (holeIndex < numHoleFaces && holeFacesPtr[holeIndex] == i) {
-      // Skip hole faces.
-      ++holeIndex;
-    } else {
-      // edgeFlag is used for inner-line removal of non-triangle
-      // faces on wireframe shading.
-      //
-      //          0__                0  0   0__
-      //        _/|\ \_            _/.  ..   . \_
-      //      _/  | \  \_   ->   _/  .  . .   .  \_
-      //     /  A |C \ B \_     /  A .  .C .   . B \_
-      //    1-----2---3----4   1-----2  1---2   1----2
-      //
-      //  Type   EdgeFlag    Draw
-      //    -       0        show all edges
-      //    A       1        hide [2-0]
-      //    B       2        hide [0-1]
-      //    C       3        hide [0-1] and [2-0]
-      //
-      int edgeFlag = 0;
-      int edgeIndex = ev;
-      for (int j = 0; j < nv - 2; ++j) {
-        if (!_FanTriangulate(&(*indices)[tv], vertsPtr, v, j, numVertIndices, flip)) {
-          invalidTopology = true;
-        }
+  bool invalidTopology = _FillFaceRanges(faceRanges, [&](_FaceRange const &range) {
+    bool invalid = false;
+    int holeIndex = range.holeIndex;
+
+    // i  -> authored face index [0, numFaces)
+    // tv -> triangulated face index [0, numTris)
+    // v  -> index to the first vertex (index) for face i
+    // ev -> edges visited
+    for (int i = range.faceBegin, tv = range.outputIndex, v = range.vertIndex, ev = v;
+         i < range.faceEnd;
+         ++i) {
+      int nv = numVertsPtr[i];
+      if (nv < 3) {
+        // Skip degenerate faces.
+      } else if (holeIndex < numHoleFaces && holeFacesPtr[holeIndex] == i) {
+        // Skip hole faces.
+        ++holeIndex;
+      } else {
+        // edgeFlag is used for inner-line removal of non-triangle
+        // faces on wireframe shading.
+        //
+        //          0__                0  0   0__
+        //        _/|\ \_            _/.  ..   . \_
+        //      _/  | \  \_   ->   _/  .  . .   .  \_
+        //     /  A |C \ B \_     /  A .  .C .   . B \_
+        //    1-----2---3----4   1-----2  1---2   1----2
+        //
+        //  Type   EdgeFlag    Draw
+        //    -       0        show all edges
+        //    A       1        hide [2-0]
+        //    B       2        hide [0-1]
+        //    C       3        hide [0-1] and [2-0]
+        //
+        int edgeFlag = 0;
+        int edgeIndex = ev;
+        for (int j = 0; j < nv - 2; ++j) {
+          if (!_FanTriangulate(&indicesPtr[tv], vertsPtr, v, j, numVertIndices, flip)) {
+            invalid = true;
+          }
 
-        if (nv > 3) {
-          if (j == 0) {
-            if (flip) {
-              // If the topology is flipped, we get the triangle
-              // 021 instead of 012, and we'd hide edge 0-1
-              // instead of 0-2; so we rotate the indices to
-              // produce triangle 210.
-              GfVec3i &index = (*indices)[tv];
-              index.Set(index[1], index[2], index[0]);
+          if (nv > 3) {
+            if (j == 0) {
+              if (flip) {
+                // If the topology is flipped, we get the triangle
+                // 021 instead of 012, and we'd hide edge 0-1
+                // instead of 0-2; so we rotate the indices to
+                // produce triangle 210.
+                GfVec3i &index = indicesPtr[tv];
+                index.Set(index[1], index[2], index[0]);
+              }
+              edgeFlag = 1;
+            } else if (j == nv - 3) {
+              if (flip) {
+                // If the topology is flipped, we get the triangle
+                // 043 instead of 034, and we'd hide edge 0-4
+                // instead of 0-3; so we rotate the indices to
+                // produce triangle 304.
+                GfVec3i &index = indicesPtr[tv];
+                index.Set(index[2], index[0], index[1]);
+              }
+              edgeFlag = 2;
+            } else {
+              edgeFlag = 3;
             }
-            edgeFlag = 1;
-          } else if (j == nv - 3) {
-            if (flip) {
-              // If the topology is flipped, we get the triangle
-              // 043 instead of 034, and we'd hide edge 0-4
-              // instead of 0-3; so we rotate the indices to
-              // produce triangle 304.
-              GfVec3i &index = (*indices)[tv];
-              index.Set(index[2], index[0], index[1]);
-            }
-            edgeFlag = 2;
-          } else {
-            edgeFlag = 3;
+            ++edgeIndex;
           }
-          ++edgeIndex;
-        }
 
-        (*primitiveParams)[tv] = EncodeCoarseFaceParam(i, edgeFlag);
-        if (edgeIndices) {
-          (*edgeIndices)[tv] = edgeIndex;
-        }
+          primitiveParamsPtr[tv] = EncodeCoarseFaceParam(i, edgeFlag);
+          if (edgeIndicesPtr) {
+            edgeIndicesPtr[tv] = edgeIndex;
+          }
 
-        ++tv;
+          ++tv;
+        }
       }
+      // When the face is degenerate and nv > 0, we need to increment the v
+      // pointer to walk past the degenerate verts.
+      v += nv;
+      ev += nv;
     }
-    // When the face is degenerate and nv > 0, we need to increment the v
-    // pointer to walk past the degenerate verts.
-    v += nv;
-    ev += nv;
-  }
+    return invalid;
+  });
   if (invalidTopology) {
     TF_WARN("numVerts and verts are incosistent [%s]", _id.GetText());
   }
@@ -222,64 +382,59 @@ static void _TriangulateFaceVarying(SdfPath const &id,
   T const *source = static_cast<T const *>(sourceUntyped);
 
   // CPU face-varying triangulation
-  bool invalidTopology = false;
-  int numFVarValues = 0;
-  int holeIndex = 0;
-  int numHoleFaces = holeFaces.size();
-  for (int i = 0; i < (int)faceVertexCounts.size(); ++i) {
-    int nv = faceVertexCounts[i] - 2;
-    if (nv < 1) {
-      // skip degenerated face
-      invalidTopology = true;
-    } else if (holeIndex < numHoleFaces && holeFaces[holeIndex] == i) {
-      // skip hole face
-      ++holeIndex;
-    } else {
-      numFVarValues += 3 * nv;
-    }
-  }
-  if (invalidTopology) {
+  _FaceRanges faceRanges = _ComputeFaceRanges(faceVertexCounts,
+                                              holeFaces,
+                                              [](int nv, int *numFVarValues, int *) {
+                                                *numFVarValues = 3 * (nv - 2);
+                                              });
+  if (faceRanges.degenerateFaceFound) {
     TF_WARN("degenerated face found [%s]", id.GetText());
-    invalidTopology = false;
   }
 
-  VtArray<T> results(numFVarValues);
-  // reset holeIndex
-  holeIndex = 0;
-
-  int dstIndex = 0;
-  for (int i = 0, v = 0; i < (int)faceVertexCounts.size(); ++i) {
-    int nVerts = faceVertexCounts[i];
+  VtArray<T> results(faceRanges.numOutputs);
+  T *resultsPtr = results.data();
+  int const *numVertsPtr = faceVertexCounts.cdata();
+  int const *holeFacesPtr = holeFaces.cdata();
+  int numHoleFaces = holeFaces.size();
 
-    if (nVerts < 3) {
-      // Skip degenerate faces.
-    } else if (holeIndex < numHoleFaces && holeFaces[holeIndex] == i) {
-      // Skip hole faces.
-      ++holeIndex;
-    } else {
-      // triangulate.
-      // apply same triangulation as index does
-      for (int j = 0; j < nVerts - 2; ++j) {
-        if (!_FanTriangulate(&results[dstIndex], source, v, j, numElements, flip)) {
-          invalidTopology = true;
-        }
-        // To keep edge flags consistent, when a face is triangulated
-        // and the topology is flipped we rotate the first and last
-        // triangle indices. See ComputeTriangleIndices.
-        if (nVerts > 3 && flip) {
-          if (j == 0) {
-            std::swap(results[dstIndex], results[dstIndex + 1]);
-            std::swap(results[dstIndex + 1], results[dstIndex + 2]);
-          } else if (j == nVerts - 3) {
-            std::swap(results[dstIndex + 1], results[dstIndex + 2]);
-            std::swap(results[dstIndex], results[dstIndex + 1]);
+  bool invalidTopology = _FillFaceRanges(faceRanges, [&](_FaceRange const &range) {
+    bool invalid = false;
+    int holeIndex = range.holeIndex;
+    int dstIndex = range.outputIndex;
+    for (int i = range.faceBegin, v = range.vertIndex; i < range.faceEnd; ++i) {
+      int nVerts = numVertsPtr[i];
+
+      if (nVerts < 3) {
+        // Skip degenerate faces.
+      } else if (holeIndex < numHoleFaces && holeFacesPtr[holeIndex] == i) {
+        // Skip hole faces.
+        ++holeIndex;
+      } else {
+        // triangulate.
+        // apply same triangulation as index does
+        for (int j = 0; j < nVerts - 2; ++j) {
+          if (!_FanTriangulate(&resultsPtr[dstIndex], source, v, j, numElements, flip)) {
+            invalid = true;
+          }
+          // To keep edge flags consistent, when a face is triangulated
+          // and the topology is flipped we rotate the first and last
+          // triangle indices. See ComputeTriangleIndices.
+          if (nVerts > 3 && flip) {
+            if (j == 0) {
+              std::swap(resultsPtr[dstIndex], resultsPtr[dstIndex + 1]);
+              std::swap(resultsPtr[dstIndex + 1], resultsPtr[dstIndex + 2]);
+            } else if (j == nVerts - 3) {
+              std::swap(resultsPtr[dstIndex + 1], resultsPtr[dstIndex + 2]);
+              std::swap(resultsPtr[dstIndex], resultsPtr[dstIndex + 1]);
+            }
           }
+          dstIndex += 3;
         }
-        dstIndex += 3;
       }
+      v += nVerts;
     }
-    v += nVerts;
-  }
+    return invalid;
+  });
   if (invalidTopology) {
     TF_WARN("numVerts and verts are incosistent [%s]", id.GetText());
   }
@@ -519,170 +674,186 @@ void HdMeshUtil::_ComputeQuadIndices(VtIntArray *indices,
   int const *numVertsPtr = _topology->GetFaceVertexCounts().cdata();
   int const *vertsPtr = _topology->GetFaceVertexIndices().cdata();
   int const *holeFacesPtr = _topology->GetHoleIndices().cdata();
-  int numFaces = _topology->GetFaceVertexCounts().size();
   int numVertIndices = _topology->GetFaceVertexIndices().size();
   int numHoleFaces = _topology->GetHoleIndices().size();
   int numPoints = _topology->GetNumPoints();
 
-  // count num quads
-  bool invalidTopology = false;
-  int numQuads = _ComputeNumQuads(_topology->GetFaceVertexCounts(),
-                                  _topology->GetHoleIndices(),
-                                  &invalidTopology);
-  if (invalidTopology) {
+  // count num quads, and the additional (edge and center) points before
+  // each face.
+  _FaceRanges faceRanges = _ComputeFaceRanges(_topology->GetFaceVertexCounts(),
+                                              _topology->GetHoleIndices(),
+                                              [](int nv, int *numQuads, int *numExtra) {
+                                                // non-quad n-gons are quadrangulated
+                                                // into n-quads.
+                                                *numQuads = (nv == 4 ? 1 : nv);
+                                                *numExtra = (nv == 4 ? 0 : nv + 1);
+                                              });
+  if (faceRanges.degenerateFaceFound) {
     TF_WARN("degenerated face found [%s]", _id.GetText());
-    invalidTopology = false;
   }
-
-  int holeIndex = 0;
+  int numQuads = faceRanges.numOutputs;
 
   int const numIndicesPerQuad = triangulate ? HdMeshTriQuadBuilder::NumIndicesPerTriQuad :
                                               HdMeshTriQuadBuilder::NumIndicesPerQuad;
   indices->resize(numQuads * numIndicesPerQuad);
 
-  HdMeshTriQuadBuilder outputIndices(indices->data(), triangulate);
-
   primitiveParams->resize(numQuads);
   if (edgeIndices) {
     edgeIndices->resize(numQuads);
   }
 
-  // quadrangulated verts is added to the end.
+  int *indicesPtr = indices->data();
+  int *primitiveParamsPtr = primitiveParams->data();
+  GfVec2i *edgeIndicesPtr = edgeIndices ? edgeIndices->data() : nullptr;
+
   bool flip = (_topology->GetOrientation() != HdTokens->rightHanded);
-  int vertIndex = numPoints;
-
-  // i  -> authored face index [0, numFaces)
-  // qv -> quadrangulated face index [0, numQuads)
-  // v  -> index to the first vertex (index) for face i
-  // ev -> edges visited
-  // vertIndex -> index to the start of the additional verts (edge, center)
-  //              for face i
-  for (int i = 0, qv = 0, v = 0, ev = 0; i < numFaces; ++i) {
-    int nv = numVertsPtr[i];
-    if (nv < 3) {
-      v += nv;
-      ev += nv;
-      continue;  // skip degenerated face
-    }
-    if (holeIndex < numHoleFaces && holeFacesPtr[holeIndex] == i) {
-      // skip hole faces.
-      ++holeIndex;
-      v += nv;
-      ev += nv;
-      continue;
-    }
 
-    if (v + nv > numVertIndices) {
-      invalidTopology = true;
-      if (nv == 4) {
-        outputIndices.EmitQuadFace(GfVec4i(0));
-      } else {
-        for (int j = 0; j < nv; ++j) {
-          outputIndices.EmitQuadFace(GfVec4i(0));
-        }
+  bool invalidTopology = _FillFaceRanges(faceRanges, [&](_FaceRange const &range) {
+    bool invalid = false;
+    int holeIndex = range.holeIndex;
+
+    HdMeshTriQuadBuilder outputIndices(indicesPtr + range.outputIndex * numIndicesPerQuad,
+                                       triangulate);
+
+    // quadrangulated verts is added to the end.
+    int vertIndex = numPoints + range.extraIndex;
+
+    // i  -> authored face index [0, numFaces)
+    // qv -> quadrangulated face index [0, numQuads)
+    // v  -> index to the first vertex (index) for face i
+    // ev -> edges visited
+    // vertIndex -> index to the start of the additional verts (edge, center)
+    //              for face i
+    for (int i = range.faceBegin, qv = range.outputIndex, v = range.vertIndex, ev = v;
+         i < range.faceEnd;
+         ++i) {
+      int nv = numVertsPtr[i];
+      if (nv < 3) {
+        v += nv;
+        ev += nv;
+        continue;  // skip degenerated face
       }
-      v += nv;
-      ev += nv;
-      continue;
-    }
-
-    int edgeIndex = ev;
-    if (nv == 4) {
-      GfVec4i quadIndices;
-      if (flip) {
-        quadIndices[0] = (vertsPtr[v + 0]);
-        quadIndices[1] = (vertsPtr[v + 3]);
-        quadIndices[2] = (vertsPtr[v + 2]);
-        quadIndices[3] = (vertsPtr[v + 1]);
-      } else {
-        quadIndices[0] = (vertsPtr[v + 0]);
-        quadIndices[1] = (vertsPtr[v + 1]);
-        quadIndices[2] = (vertsPtr[v + 2]);
-        quadIndices[3] = (vertsPtr[v + 3]);
+      if (holeIndex < numHoleFaces && holeFacesPtr[holeIndex] == i) {
+        // skip hole faces.
+        ++holeIndex;
+        v += nv;
+        ev += nv;
+        continue;
       }
-      outputIndices.EmitQuadFace(quadIndices);
 
-      //  Case             EdgeFlag    Draw
-      //  Quad/Refined face   0        hide common edge for the tri-pair
-      //  Non-Quad face       1/2/3    hide common edge for the tri-pair &
-      //                               hide interior quadrangulated edges
-      //
-      //  The first quad of a non-quad face is marked 1; the last as 2; and
-      //  intermediate quads as 3.
-
-      (*primitiveParams)[qv] = EncodeCoarseFaceParam(i, /*edgeFlag=*/0);
-
-      if (edgeIndices) {
-        (*edgeIndices)[qv][0] = edgeIndex;
-        (*edgeIndices)[qv][1] = edgeIndex + 3;
+      if (v + nv > numVertIndices) {
+        invalid = true;
+        if (nv == 4) {
+          outputIndices.EmitQuadFace(GfVec4i(0));
+        } else {
+          for (int j = 0; j < nv; ++j) {
+            outputIndices.EmitQuadFace(GfVec4i(0));
+          }
+        }
+        v += nv;
+        ev += nv;
+        continue;
       }
 
-      ++qv;
-    } else {
-      // quadrangulate non-quad faces
-      // the additional points (edge and center) are stored at the end of
-      // original points, as
-      //   last point, e0, e1, ..., en, center, e0, e1, ...
-      // so each sub-quads become
-      // *first non-quad
-      //   v0, e0, center, e(-1),
-      //   v1, e1, center, e0,
-      //...
-      // *second non-quad
-      //   ...
-      for (int j = 0; j < nv; ++j) {
+      int edgeIndex = ev;
+      if (nv == 4) {
         GfVec4i quadIndices;
-        // vertex
-        quadIndices[0] = vertsPtr[v + j];
         if (flip) {
-          // edge prev
-          quadIndices[1] = vertIndex + (j + nv - 1) % nv;
-          // center
-          quadIndices[2] = vertIndex + nv;
-          // edge next
-          quadIndices[3] = vertIndex + j;
+          quadIndices[0] = (vertsPtr[v + 0]);
+          quadIndices[1] = (vertsPtr[v + 3]);
+          quadIndices[2] = (vertsPtr[v + 2]);
+          quadIndices[3] = (vertsPtr[v + 1]);
         } else {
-          // edge next
-          quadIndices[1] = vertIndex + j;
-          // center
-          quadIndices[2] = vertIndex + nv;
-          // edge prev
-          quadIndices[3] = vertIndex + (j + nv - 1) % nv;
+          quadIndices[0] = (vertsPtr[v + 0]);
+          quadIndices[1] = (vertsPtr[v + 1]);
+          quadIndices[2] = (vertsPtr[v + 2]);
+          quadIndices[3] = (vertsPtr[v + 3]);
         }
         outputIndices.EmitQuadFace(quadIndices);
 
-        // edge flag != 0 => quad face is from quadrangulation
-        // it is used to hide internal edges (edge-center) of the quad
-        // The first quad gets flag = 1, intermediate quads get flag = 3
-        // and the last quad gets flag = 2, so computations can tell
-        // how quads are grouped by looking at edge flags.
-        int edgeFlag = 0;
-        if (j == 0) {
-          edgeFlag = 1;
-        } else if (j == nv - 1) {
-          edgeFlag = 2;
-        } else {
-          edgeFlag = 3;
+        //  Case             EdgeFlag    Draw
+        //  Quad/Refined face   0        hide common edge for the tri-pair
+        //  Non-Quad face       1/2/3    hide common edge for the tri-pair &
+        //                               hide interior quadrangulated edges
+        //
+        //  The first quad of a non-quad face is marked 1; the last as 2; and
+        //  intermediate quads as 3.
+
+        primitiveParamsPtr[qv] = EncodeCoarseFaceParam(i, /*edgeFlag=*/0);
+
+        if (edgeIndicesPtr) {
+          edgeIndicesPtr[qv][0] = edgeIndex;
+          edgeIndicesPtr[qv][1] = edgeIndex + 3;
         }
-        (*primitiveParams)[qv] = EncodeCoarseFaceParam(i, edgeFlag);
 
-        if (edgeIndices) {
+        ++qv;
+      } else {
+        // quadrangulate non-quad faces
+        // the additional points (edge and center) are stored at the end of
+        // original points, as
+        //   last point, e0, e1, ..., en, center, e0, e1, ...
+        // so each sub-quads become
+        // *first non-quad
+        //   v0, e0, center, e(-1),
+        //   v1, e1, center, e0,
+        //...
+        // *second non-quad
+        //   ...
+        for (int j = 0; j < nv; ++j) {
+          GfVec4i quadIndices;
+          // vertex
+          quadIndices[0] = vertsPtr[v + j];
           if (flip) {
-            (*edgeIndices)[qv][0] = edgeIndex + (j + nv - 1) % nv;
-            (*edgeIndices)[qv][1] = edgeIndex + j;
+            // edge prev
+            quadIndices[1] = vertIndex + (j + nv - 1) % nv;
+            // center
+            quadIndices[2] = vertIndex + nv;
+            // edge next
+            quadIndices[3] = vertIndex + j;
           } else {
-            (*edgeIndices)[qv][0] = edgeIndex + j;
-            (*edgeIndices)[qv][1] = edgeIndex + (j + nv - 1) % nv;
+            // edge next
+            quadIndices[1] = vertIndex + j;
+            // center
+            quadIndices[2] = vertIndex + nv;
+            // edge prev
+            quadIndices[3] = vertIndex + (j + nv - 1) % nv;
           }
-        }
+          outputIndices.EmitQuadFace(quadIndices);
+
+          // edge flag != 0 => quad face is from quadrangulation
+          // it is used to hide internal edges (edge-center) of the quad
+          // The first quad gets flag = 1, intermediate quads get flag = 3
+          // and the last quad gets flag = 2, so computations can tell
+          // how quads are grouped by looking at edge flags.
+          int edgeFlag = 0;
+          if (j == 0) {
+            edgeFlag = 1;
+          } else if (j == nv - 1) {
+            edgeFlag = 2;
+          } else {
+            edgeFlag = 3;
+          }
+          primitiveParamsPtr[qv] = EncodeCoarseFaceParam(i, edgeFlag);
 
-        ++qv;
+          if (edgeIndicesPtr) {
+            if (flip) {
+              edgeIndicesPtr[qv][0] = edgeIndex + (j + nv - 1) % nv;
+              edgeIndicesPtr[qv][1] = edgeIndex + j;
+            } else {
+              edgeIndicesPtr[qv][0] = edgeIndex + j;
+              edgeIndicesPtr[qv][1] = edgeIndex + (j + nv - 1) % nv;
+            }
+          }
+
+          ++qv;
+        }
+        vertIndex += nv + 1;
       }
-      vertIndex += nv + 1;
+      v += nv;
+      ev += nv;
     }
-    v += nv;
-    ev += nv;
-  }
+    return invalid;
+  });
   if (invalidTopology) {
     TF_WARN("numVerts and verts are incosistent [%s]", _id.GetText());
   }
@@ -32,6 +32,8 @@
 
 #include "wabi/imaging/hf/perfLog.h"
 
+#include "wabi/base/work/loops.h"
+
 WABI_NAMESPACE_BEGIN
 
 template<class PrimType> Hd_PrimTypeIndex<PrimType>::Hd_PrimTypeIndex() : _entries(), _index() {}
@@ -320,16 +322,59 @@ void Hd_PrimTypeIndex<PrimType>::DestroyFallbackPrims(HdRenderDelegate *renderDe
 }
 
 template<class PrimType>
-void Hd_PrimTypeIndex<PrimType>::SyncPrims(HdChangeTracker &tracker, HdRenderParam *renderParam)
+void Hd_PrimTypeIndex<PrimType>::SyncPrims(HdChangeTracker &tracker,
+                                           HdRenderParam *renderParam,
+                                           bool parallel)
 {
   size_t numTypes = _entries.size();
 
   _dirtyPrimDelegates.clear();
   HdSceneDelegate *prevDelegate = nullptr;
 
+  struct _DirtyPrim
+  {
+    SdfPath const *primPath;
+    _PrimInfo *primInfo;
+    HdDirtyBits dirtyBits;
+  };
+  std::vector<_DirtyPrim> dirtyPrims;
+
   for (size_t typeIdx = 0; typeIdx < numTypes; ++typeIdx) {
     _PrimTypeEntry &typeEntry = _entries[typeIdx];
 
+    if (parallel) {
+      // The change tracker isn't safe to update concurrently, so the dirty
+      // bits are read before, and written back after, the parallel sync.
+      dirtyPrims.clear();
+      for (typename _PrimMap::iterator primIt = typeEntry.primMap.begin();
+           primIt != typeEntry.primMap.end();
+           ++primIt) {
+        HdDirtyBits dirtyBits = _TrackerGetPrimDirtyBits(tracker, primIt->first);
+        if (dirtyBits != HdChangeTracker::Clean) {
+          dirtyPrims.push_back({&primIt->first, &primIt->second, dirtyBits});
+        }
+      }
+
+      WorkParallelForN(dirtyPrims.size(), [&dirtyPrims, renderParam](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          _DirtyPrim &dirtyPrim = dirtyPrims[i];
+          dirtyPrim.primInfo->prim->Sync(dirtyPrim.primInfo->sceneDelegate,
+                                         renderParam,
+                                         &dirtyPrim.dirtyBits);
+        }
+      });
+
+      for (_DirtyPrim const &dirtyPrim : dirtyPrims) {
+        _TrackerMarkPrimClean(tracker, *dirtyPrim.primPath, dirtyPrim.dirtyBits);
+
+        if (prevDelegate != dirtyPrim.primInfo->sceneDelegate) {
+          _dirtyPrimDelegates.push_back(dirtyPrim.primInfo->sceneDelegate);
+          prevDelegate = dirtyPrim.primInfo->sceneDelegate;
+        }
+      }
+      continue;
+    }
+
     for (typename _PrimMap::iterator primIt = typeEntry.primMap.begin();
          primIt != typeEntry.primMap.end();
          ++primIt) {
@@ -152,7 +152,10 @@ template<class PrimType> class Hd_PrimTypeIndex
   /// are marked dirty in the specified change tracker.
   /// Also updates an internal list of scene delegates for the dirty prims.
   ///
-  void SyncPrims(HdChangeTracker &tracker, HdRenderParam *renderParam);
+  /// If \p parallel is true, the dirty prims of each type are synced
+  /// concurrently.  Types are still synced one after another, in order.
+  ///
+  void SyncPrims(HdChangeTracker &tracker, HdRenderParam *renderParam, bool parallel = false);
 
   /// Returns a vector of unique scene delegates corresponding to the dirty
   /// prims that were sync'd in SyncPrims.
@@ -102,6 +102,16 @@ bool HdRenderDelegate::IsPrimvarFilteringNeeded() const
   return false;
 }
 
+bool HdRenderDelegate::IsParallelSprimSyncSupported() const
+{
+  return false;
+}
+
+bool HdRenderDelegate::IsParallelBprimSyncSupported() const
+{
+  return false;
+}
+
 HdAovDescriptor HdRenderDelegate::GetDefaultAovDescriptor(TfToken const &name) const
 {
   return HdAovDescriptor();
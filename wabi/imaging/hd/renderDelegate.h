@@ -423,6 +423,19 @@ class HdRenderDelegate
   HD_API
   virtual bool IsPrimvarFilteringNeeded() const;
 
+  ///
+  /// Return true to indicate that the Sync methods of this render
+  /// delegate's sprims (or bprims) may be called concurrently for different
+  /// prims of the same type.  The render index then syncs the dirty prims of
+  /// each type in parallel, still finishing all bprims before any sprim and
+  /// all sprims before any rprim.  Such Sync methods must not dirty other
+  /// prims through the change tracker.  Defaults to false.
+  ///
+  HD_API
+  virtual bool IsParallelSprimSyncSupported() const;
+  HD_API
+  virtual bool IsParallelBprimSyncSupported() const;
+
   ///
   /// Returns the ordered list of shader source types that the render delegate
   /// supports.
@@ -1216,9 +1216,13 @@ void HdRenderIndex::SyncAll(HdTaskSharedPtrVector *tasks, HdTaskContext *taskCon
 
   HdRenderParam *renderParam = _renderDelegate->GetRenderParam();
 
-  _bprimIndex.SyncPrims(_tracker, _renderDelegate->GetRenderParam());
+  _bprimIndex.SyncPrims(_tracker,
+                        _renderDelegate->GetRenderParam(),
+                        _renderDelegate->IsParallelBprimSyncSupported());
 
-  _sprimIndex.SyncPrims(_tracker, _renderDelegate->GetRenderParam());
+  _sprimIndex.SyncPrims(_tracker,
+                        _renderDelegate->GetRenderParam(),
+                        _renderDelegate->IsParallelSprimSyncSupported());
 
   ////////////////////////////////////////////////////////////////////////////
   //
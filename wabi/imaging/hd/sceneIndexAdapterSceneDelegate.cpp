@@ -33,6 +33,7 @@
 #include "wabi/imaging/hd/tokens.h"
 #include "wabi/imaging/pxOsd/tokens.h"
 #include "wabi/base/trace/trace.h"
+#include "wabi/base/work/loops.h"
 
 #include "wabi/imaging/hd/dataSourceLegacyPrim.h"
 #include "wabi/imaging/hd/dataSourceLocator.h"
@@ -285,7 +286,20 @@ void HdSceneIndexAdapterSceneDelegate::PrimsDirtied(const HdSceneIndexBase &send
 {
   TRACE_FUNCTION();
 
-  for (const DirtiedPrimEntry &entry : entries) {
+  // Large batches, such as every time varying rprim after a time change,
+  // mark rprims in parallel, which HdChangeTracker supports.  Everything
+  // else is handled serially below.
+  std::vector<char> markedInParallel;
+  if (entries.size() >= _parallelDirtyThreshold) {
+    markedInParallel.resize(entries.size(), 0);
+    _RprimsDirtiedInParallel(entries, &markedInParallel);
+  }
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (!markedInParallel.empty() && markedInParallel[i]) {
+      continue;
+    }
+    const DirtiedPrimEntry &entry = entries[i];
     const SdfPath &indexPath = entry.primPath;
     _PrimCacheTable::iterator it = _primCache.find(indexPath);
     if (it == _primCache.end()) {
@@ -345,6 +359,48 @@ void HdSceneIndexAdapterSceneDelegate::PrimsDirtied(const HdSceneIndexBase &send
   }
 }
 
+void HdSceneIndexAdapterSceneDelegate::_RprimsDirtiedInParallel(const DirtiedPrimEntries &entries,
+                                                                std::vector<char> *marked)
+{
+  TRACE_FUNCTION();
+
+  HdRenderIndex &renderIndex = GetRenderIndex();
+  HdChangeTracker &tracker = renderIndex.GetChangeTracker();
+
+  WorkParallelForN(entries.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const DirtiedPrimEntry &entry = entries[i];
+      const _PrimCacheTable::iterator it = _primCache.find(entry.primPath);
+      if (it == _primCache.end()) {
+        (*marked)[i] = 1;
+        continue;
+      }
+      const TfToken &primType = it->second.primType;
+      if (!renderIndex.IsRprimTypeSupported(primType)) {
+        continue;
+      }
+
+      const HdDirtyBits dirtyBits = HdDirtyBitsTranslator::RprimLocatorSetToDirtyBits(
+        primType,
+        entry.dirtyLocators);
+      if (dirtyBits != HdChangeTracker::Clean) {
+        tracker._MarkRprimDirty(entry.primPath, dirtyBits);
+      }
+
+      // The same prim may appear more than once in a batch, so only reset
+      // the read states here; the cached descriptors are replaced on the
+      // next read.
+      if (entry.dirtyLocators.Intersects(HdPrimvarsSchema::GetDefaultLocator())) {
+        it->second.primvarDescriptorsState.store(_PrimCacheEntry::ReadStateUnread);
+      }
+      if (entry.dirtyLocators.Intersects(HdExtComputationPrimvarsSchema::GetDefaultLocator())) {
+        it->second.extCmpPrimvarDescriptorsState.store(_PrimCacheEntry::ReadStateUnread);
+      }
+      (*marked)[i] = 1;
+    }
+  });
+}
+
 // ----------------------------------------------------------------------------
 
 HdMeshTopology HdSceneIndexAdapterSceneDelegate::GetMeshTopology(SdfPath const &id)
@@ -231,6 +231,13 @@ class HdSceneIndexAdapterSceneDelegate : public HdSceneDelegate, public HdSceneI
   using _PrimCacheTable = SdfPathTable<_PrimCacheEntry>;
   _PrimCacheTable _primCache;
 
+  // Batches of dirtied prims at least this large mark rprims in parallel.
+  static constexpr size_t _parallelDirtyThreshold = 1024;
+
+  // Marks the rprims in \p entries dirty in parallel, setting the entries
+  // of \p marked that need no further processing.
+  void _RprimsDirtiedInParallel(const DirtiedPrimEntries &entries, std::vector<char> *marked);
+
   bool _sceneDelegatesBuilt;
   std::vector<HdSceneDelegate *> _sceneDelegates;
 
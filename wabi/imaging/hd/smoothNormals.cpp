@@ -31,6 +31,9 @@
 #include "wabi/base/vt/array.h"
 #include "wabi/base/work/loops.h"
 
+#include <algorithm>
+#include <memory>
+
 WABI_NAMESPACE_BEGIN
 
 
@@ -65,7 +68,7 @@ template<typename SrcVec3Type, typename DstType> class _SmoothNormalsWorker
       if (true) {  // Could defer normalization to shader code
         normal.Normalize();
       }
-      _normals[i] = normal;
+      _normals[i] = DstType(normal);
     }
   }
 
@@ -76,15 +79,96 @@ template<typename SrcVec3Type, typename DstType> class _SmoothNormalsWorker
   DstType *_normals;
 };
 
+/// Computes the same normals as _SmoothNormalsWorker by walking the faces
+/// instead of the points.  Each face range accumulates the corner normals
+/// of its faces into its own buffer, loading every face's points once for
+/// all of its corners and reading the face-vertex indices sequentially.
+///
+/// A point touched by a single range takes that range's sum, which adds the
+/// same corner normals in the same order as the adjacency table.  The few
+/// points shared by several ranges are gathered from the adjacency table
+/// instead of adding up the ranges' partial sums, so every normal is
+/// bit-identical to the per-point gather regardless of the range
+/// boundaries.
+template<typename SrcVec3Type, typename DstType>
+static void _ScatterSmoothNormals(Hd_VertexAdjacency const *adjacency,
+                                  int numPoints,
+                                  SrcVec3Type const *pointsPtr,
+                                  DstType *normals)
+{
+  VtIntArray const &adjacencyTable = adjacency->GetAdjacencyTable();
+  std::vector<Hd_VertexAdjacency::FaceRange> const &faceRanges = adjacency->GetFaceRanges();
+  int const *numVertsPtr = adjacency->GetFaceVertexCounts().cdata();
+  int const *vertsPtr = adjacency->GetFaceVertexIndices().cdata();
+  int const *pointFaceRangesPtr = adjacency->GetPointFaceRanges().cdata();
+  bool flip = adjacency->IsLeftHanded();
+
+  std::unique_ptr<SrcVec3Type[]> accum(new SrcVec3Type[adjacency->GetFaceRangesAccumSize()]);
+
+  WorkParallelForN(faceRanges.size(), [&](size_t begin, size_t end) {
+    for (size_t r = begin; r < end; ++r) {
+      Hd_VertexAdjacency::FaceRange const &range = faceRanges[r];
+      SrcVec3Type *rangeAccum = accum.get() + range.accumOffset;
+      std::fill(rangeAccum, rangeAccum + (range.pointEnd - range.pointBegin), SrcVec3Type(0));
+
+      int v = range.vertexBegin;
+      for (int i = range.faceBegin; i < range.faceEnd; ++i) {
+        int nv = numVertsPtr[i];
+        for (int j = 0; j < nv; ++j) {
+          int prev = vertsPtr[v + (j + nv - 1) % nv];
+          int curr = vertsPtr[v + j];
+          int next = vertsPtr[v + (j + 1) % nv];
+          if (flip) {
+            std::swap(prev, next);
+          }
+          SrcVec3Type const &currPoint = pointsPtr[curr];
+          rangeAccum[curr - range.pointBegin] += GfCross(pointsPtr[next] - currPoint, pointsPtr[prev] - currPoint);
+        }
+        v += nv;
+      }
+    }
+  });
+
+  _SmoothNormalsWorker<SrcVec3Type, DstType> gatherWorker(pointsPtr, adjacencyTable, normals);
+
+  WorkParallelForN(numPoints, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      int const firstRange = pointFaceRangesPtr[i * 2];
+      int const lastRange = pointFaceRangesPtr[i * 2 + 1];
+      if (lastRange - firstRange > 1) {
+        gatherWorker.Compute(i, i + 1);
+        continue;
+      }
+      SrcVec3Type normal(0);
+      if (lastRange > firstRange) {
+        Hd_VertexAdjacency::FaceRange const &range = faceRanges[firstRange];
+        normal = accum[range.accumOffset + (static_cast<int>(i) - range.pointBegin)];
+      }
+      normal.Normalize();
+      normals[i] = DstType(normal);
+    }
+  });
+}
+
 /// Returns an array of the same size and type as the source points
 /// containing normal vectors computed by averaging the cross products
 /// of incident face edges.
 template<typename SrcVec3Type, typename DstType = SrcVec3Type>
-VtArray<DstType> _ComputeSmoothNormals(int numPoints,
-                                       SrcVec3Type const *pointsPtr,
-                                       VtIntArray const &adjacencyTable,
-                                       int numAdjPoints)
+VtArray<DstType> _ComputeSmoothNormals(Hd_VertexAdjacency const *adjacency,
+                                       int numPoints,
+                                       SrcVec3Type const *pointsPtr)
 {
+  VtIntArray const &adjacencyTable = adjacency->GetAdjacencyTable();
+  int numAdjPoints = adjacency->GetNumPoints();
+
+  // Walk the faces when the adjacency has face ranges for them, as long as
+  // all of the mesh's points were provided.
+  if (!adjacency->GetFaceRanges().empty() && numPoints >= numAdjPoints) {
+    VtArray<DstType> normals(numAdjPoints);
+    _ScatterSmoothNormals(adjacency, numAdjPoints, pointsPtr, normals.data());
+    return normals;
+  }
+
   // to be safe.
   // numPoints of input pointer could be different from the number of points
   // in adjacency table.
@@ -110,10 +194,7 @@ VtArray<GfVec3f> Hd_SmoothNormals::ComputeSmoothNormals(Hd_VertexAdjacency const
                                                         int numPoints,
                                                         GfVec3f const *pointsPtr)
 {
-  return _ComputeSmoothNormals(numPoints,
-                               pointsPtr,
-                               adjacency->GetAdjacencyTable(),
-                               adjacency->GetNumPoints());
+  return _ComputeSmoothNormals(adjacency, numPoints, pointsPtr);
 }
 
 /* static */
@@ -121,10 +202,7 @@ VtArray<GfVec3d> Hd_SmoothNormals::ComputeSmoothNormals(Hd_VertexAdjacency const
                                                         int numPoints,
                                                         GfVec3d const *pointsPtr)
 {
-  return _ComputeSmoothNormals(numPoints,
-                               pointsPtr,
-                               adjacency->GetAdjacencyTable(),
-                               adjacency->GetNumPoints());
+  return _ComputeSmoothNormals(adjacency, numPoints, pointsPtr);
 }
 
 /* static */
@@ -133,10 +211,7 @@ VtArray<HdVec4f_2_10_10_10_REV> Hd_SmoothNormals::ComputeSmoothNormalsPacked(
   int numPoints,
   GfVec3f const *pointsPtr)
 {
-  return _ComputeSmoothNormals<GfVec3f, HdVec4f_2_10_10_10_REV>(numPoints,
-                                                                pointsPtr,
-                                                                adjacency->GetAdjacencyTable(),
-                                                                adjacency->GetNumPoints());
+  return _ComputeSmoothNormals<GfVec3f, HdVec4f_2_10_10_10_REV>(adjacency, numPoints, pointsPtr);
 }
 
 /* static */
@@ -145,10 +220,23 @@ VtArray<HdVec4f_2_10_10_10_REV> Hd_SmoothNormals::ComputeSmoothNormalsPacked(
   int numPoints,
   GfVec3d const *pointsPtr)
 {
-  return _ComputeSmoothNormals<GfVec3d, HdVec4f_2_10_10_10_REV>(numPoints,
-                                                                pointsPtr,
-                                                                adjacency->GetAdjacencyTable(),
-                                                                adjacency->GetNumPoints());
+  return _ComputeSmoothNormals<GfVec3d, HdVec4f_2_10_10_10_REV>(adjacency, numPoints, pointsPtr);
+}
+
+/* static */
+VtArray<GfVec3h> Hd_SmoothNormals::ComputeSmoothNormalsHalf(Hd_VertexAdjacency const *adjacency,
+                                                            int numPoints,
+                                                            GfVec3f const *pointsPtr)
+{
+  return _ComputeSmoothNormals<GfVec3f, GfVec3h>(adjacency, numPoints, pointsPtr);
+}
+
+/* static */
+VtArray<GfVec3h> Hd_SmoothNormals::ComputeSmoothNormalsHalf(Hd_VertexAdjacency const *adjacency,
+                                                            int numPoints,
+                                                            GfVec3d const *pointsPtr)
+{
+  return _ComputeSmoothNormals<GfVec3d, GfVec3h>(adjacency, numPoints, pointsPtr);
 }
 
 Hd_SmoothNormalsComputation::Hd_SmoothNormalsComputation(
@@ -33,6 +33,7 @@
 
 #include "wabi/base/gf/vec3d.h"
 #include "wabi/base/gf/vec3f.h"
+#include "wabi/base/gf/vec3h.h"
 #include "wabi/base/tf/token.h"
 
 WABI_NAMESPACE_BEGIN
@@ -73,6 +74,17 @@ class Hd_SmoothNormals final
     int numPoints,
     GfVec3d const *pointsPtr);
 
+  /// Computes the smooth normals as half precision vectors, halving the
+  /// size of the result for float points.
+  HD_API
+  static VtArray<GfVec3h> ComputeSmoothNormalsHalf(Hd_VertexAdjacency const *adjacency,
+                                                   int numPoints,
+                                                   GfVec3f const *pointsPtr);
+  HD_API
+  static VtArray<GfVec3h> ComputeSmoothNormalsHalf(Hd_VertexAdjacency const *adjacency,
+                                                   int numPoints,
+                                                   GfVec3d const *pointsPtr);
+
  private:
 
   Hd_SmoothNormals() = delete;
@@ -0,0 +1,132 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// Times invalidating every rprim in a render index one MarkRprimDirty call
+// at a time against a single MarkRprimsDirty batch, as UsdImagingDelegate
+// does on a time change, and checks that both leave the same dirty bits.
+//
+// Usage: testHdChangeTrackerBenchmark [numRprims] [numIterations]
+//
+// Scene index emulation is on by default; set
+// HD_ENABLE_SCENE_INDEX_EMULATION=0 to time the direct path.
+
+#include "wabi/imaging/hd/changeTracker.h"
+#include "wabi/imaging/hd/renderIndex.h"
+#include "wabi/imaging/hd/unitTestDelegate.h"
+#include "wabi/imaging/hd/unitTestNullRenderDelegate.h"
+
+#include "wabi/base/gf/matrix4f.h"
+#include "wabi/base/tf/errorMark.h"
+#include "wabi/base/tf/stopwatch.h"
+#include "wabi/base/tf/stringUtils.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+WABI_NAMESPACE_USING
+
+static const HdDirtyBits _timeVaryingBits = HdChangeTracker::DirtyPoints |
+                                            HdChangeTracker::DirtyTransform |
+                                            HdChangeTracker::DirtyPrimvar;
+
+static void _CleanAll(HdChangeTracker &tracker, const SdfPathVector &ids)
+{
+  for (const SdfPath &id : ids) {
+    tracker.MarkRprimClean(id);
+  }
+}
+
+static std::vector<HdDirtyBits> _GetDirtyBits(HdChangeTracker &tracker, const SdfPathVector &ids)
+{
+  std::vector<HdDirtyBits> result;
+  result.reserve(ids.size());
+  for (const SdfPath &id : ids) {
+    result.push_back(tracker.GetRprimDirtyBits(id));
+  }
+  return result;
+}
+
+int main(int argc, char *argv[])
+{
+  TfErrorMark mark;
+
+  const size_t numRprims = argc > 1 ? TfStringToUInt64(argv[1]) : 10000;
+  const size_t numIterations = argc > 2 ? TfStringToUInt64(argv[2]) : 10;
+
+  Hd_UnitTestNullRenderDelegate renderDelegate;
+  std::unique_ptr<HdRenderIndex> index(HdRenderIndex::New(&renderDelegate, HdDriverVector()));
+  HdUnitTestDelegate delegate(index.get(), SdfPath::AbsoluteRootPath());
+
+  SdfPathVector ids;
+  ids.reserve(numRprims);
+  for (size_t i = 0; i < numRprims; ++i) {
+    ids.push_back(SdfPath(TfStringPrintf("/cube%zu", i)));
+    delegate.AddCube(ids.back(), GfMatrix4f(1));
+  }
+  const std::vector<HdDirtyBits> bits(numRprims, _timeVaryingBits);
+
+  HdChangeTracker &tracker = index->GetChangeTracker();
+
+  TfStopwatch serialTimer;
+  TfStopwatch batchTimer;
+  bool success = true;
+
+  for (size_t iteration = 0; iteration < numIterations; ++iteration) {
+    _CleanAll(tracker, ids);
+    serialTimer.Start();
+    for (size_t i = 0; i < numRprims; ++i) {
+      tracker.MarkRprimDirty(ids[i], bits[i]);
+    }
+    serialTimer.Stop();
+    const std::vector<HdDirtyBits> serialBits = _GetDirtyBits(tracker, ids);
+
+    _CleanAll(tracker, ids);
+    batchTimer.Start();
+    tracker.MarkRprimsDirty(ids, bits);
+    batchTimer.Stop();
+    const std::vector<HdDirtyBits> batchBits = _GetDirtyBits(tracker, ids);
+
+    if (serialBits != batchBits) {
+      std::cerr << "Dirty bits differ after iteration " << iteration << "\n";
+      success = false;
+      break;
+    }
+  }
+
+  std::cout << "scene index emulation: "
+            << (HdRenderIndex::IsSceneIndexEmulationEnabled() ? "on" : "off") << "\n"
+            << "rprims: " << numRprims << ", iterations: " << numIterations << "\n"
+            << "MarkRprimDirty loop: " << serialTimer.GetSeconds() / numIterations << " s\n"
+            << "MarkRprimsDirty: " << batchTimer.GetSeconds() / numIterations << " s\n";
+
+  if (success && mark.IsClean()) {
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
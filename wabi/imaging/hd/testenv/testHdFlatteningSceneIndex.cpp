@@ -0,0 +1,343 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+#include "wabi/imaging/hd/flatteningSceneIndex.h"
+#include "wabi/imaging/hd/retainedDataSource.h"
+#include "wabi/imaging/hd/retainedSceneIndex.h"
+#include "wabi/imaging/hd/sceneIndexObserver.h"
+#include "wabi/imaging/hd/visibilitySchema.h"
+#include "wabi/imaging/hd/xformSchema.h"
+
+#include "wabi/base/gf/matrix4d.h"
+#include "wabi/base/gf/vec3d.h"
+#include "wabi/base/tf/diagnosticLite.h"
+
+#include <iostream>
+#include <map>
+
+WABI_NAMESPACE_USING
+
+// A typed data source whose value can be changed after it has been handed to
+// a scene index, to stand in for an edit to the input scene.
+template<typename T> class _MutableDataSource : public HdRetainedTypedSampledDataSource<T>
+{
+ public:
+
+  HD_DECLARE_DATASOURCE(_MutableDataSource<T>);
+
+  _MutableDataSource(const T &value) : HdRetainedTypedSampledDataSource<T>(value) {}
+
+  void Set(const T &value)
+  {
+    this->_value = value;
+  }
+};
+
+using _MutableMatrixDataSource = _MutableDataSource<GfMatrix4d>;
+using _MutableBoolDataSource = _MutableDataSource<bool>;
+
+// Records the dirtied locators sent for each prim.
+class _DirtyRecorder : public HdSceneIndexObserver
+{
+ public:
+
+  void PrimsAdded(const HdSceneIndexBase &sender, const AddedPrimEntries &entries) override {}
+
+  void PrimsRemoved(const HdSceneIndexBase &sender, const RemovedPrimEntries &entries) override {}
+
+  void PrimsDirtied(const HdSceneIndexBase &sender, const DirtiedPrimEntries &entries) override
+  {
+    for (const DirtiedPrimEntry &entry : entries) {
+      for (const HdDataSourceLocator &locator : entry.dirtyLocators) {
+        dirtied[entry.primPath].insert(locator);
+      }
+    }
+  }
+
+  bool IsDirtied(const SdfPath &primPath, const HdDataSourceLocator &locator) const
+  {
+    const auto it = dirtied.find(primPath);
+    return it != dirtied.end() && it->second.Intersects(locator);
+  }
+
+  std::map<SdfPath, HdDataSourceLocatorSet> dirtied;
+};
+
+static GfMatrix4d _Translate(double x, double y, double z)
+{
+  return GfMatrix4d().SetTranslate(GfVec3d(x, y, z));
+}
+
+static HdContainerDataSourceHandle _MakePrim(const HdMatrixDataSourceHandle &matrix,
+                                             bool resetXformStack,
+                                             const HdBoolDataSourceHandle &visibility)
+{
+  TfTokenVector names;
+  std::vector<HdDataSourceBaseHandle> values;
+  if (matrix) {
+    names.push_back(HdXformSchemaTokens->xform);
+    values.push_back(
+      HdXformSchema::Builder()
+        .SetMatrix(matrix)
+        .SetResetXformStack(resetXformStack ? HdRetainedTypedSampledDataSource<bool>::New(true) :
+                                              nullptr)
+        .Build());
+  }
+  if (visibility) {
+    names.push_back(HdVisibilitySchemaTokens->visibility);
+    values.push_back(HdVisibilitySchema::Builder().SetVisibility(visibility).Build());
+  }
+  return HdRetainedContainerDataSource::New(names.size(), names.data(), values.data());
+}
+
+static GfMatrix4d _GetFlattenedMatrix(const HdSceneIndexBaseRefPtr &sceneIndex,
+                                      const SdfPath &primPath)
+{
+  HdXformSchema xform = HdXformSchema::GetFromParent(sceneIndex->GetPrim(primPath).dataSource);
+  return xform.GetMatrix()->GetTypedValue(0.0f);
+}
+
+static bool _GetFlattenedVisibility(const HdSceneIndexBaseRefPtr &sceneIndex,
+                                    const SdfPath &primPath)
+{
+  HdVisibilitySchema vis = HdVisibilitySchema::GetFromParent(
+    sceneIndex->GetPrim(primPath).dataSource);
+  return vis.GetVisibility()->GetTypedValue(0.0f);
+}
+
+#define _CHECK(cond)                                 \
+  do {                                               \
+    if (!(cond)) {                                   \
+      std::cerr << "FAILED: " << #cond << std::endl; \
+      success = false;                               \
+    }                                                \
+  } while (0)
+
+// The test scene:
+//
+//   /P          xform, visibility
+//   /P/C        xform with resetXformStack
+//   /P/C/G      xform
+//   /P/D        xform
+//   /P/D/H      xform
+//   /P/V        visibility
+//   /P/V/W
+//
+struct _Scene
+{
+  _Scene()
+    : parentMatrix(_MutableMatrixDataSource::New(_Translate(1, 0, 0))),
+      childMatrix(_MutableMatrixDataSource::New(_Translate(0, 1, 0))),
+      parentVis(_MutableBoolDataSource::New(true)),
+      input(HdRetainedSceneIndex::New()),
+      flattening(HdFlatteningSceneIndex::New(input))
+  {
+    flattening->AddObserver(HdSceneIndexObserverPtr(&recorder));
+
+    const TfToken type("test");
+    input->AddPrims({
+      {SdfPath("/P"), type, _MakePrim(parentMatrix, false, parentVis)},
+      {SdfPath("/P/C"), type, _MakePrim(childMatrix, true, nullptr)},
+      {SdfPath("/P/C/G"),
+       type,
+       _MakePrim(HdRetainedTypedSampledDataSource<GfMatrix4d>::New(_Translate(0, 0, 1)),
+                 false,
+                 nullptr)},
+      {SdfPath("/P/D"),
+       type,
+       _MakePrim(HdRetainedTypedSampledDataSource<GfMatrix4d>::New(_Translate(0, 2, 0)),
+                 false,
+                 nullptr)},
+      {SdfPath("/P/D/H"),
+       type,
+       _MakePrim(HdRetainedTypedSampledDataSource<GfMatrix4d>::New(_Translate(0, 0, 2)),
+                 false,
+                 nullptr)},
+      {SdfPath("/P/V"),
+       type,
+       _MakePrim(nullptr, false, HdRetainedTypedSampledDataSource<bool>::New(true))},
+      {SdfPath("/P/V/W"), type, _MakePrim(nullptr, false, nullptr)},
+    });
+
+    // Populate the flattened caches; only cached values are invalidated.
+    for (const SdfPath &primPath : GetPrimPaths()) {
+      _GetFlattenedMatrix(flattening, primPath);
+      _GetFlattenedVisibility(flattening, primPath);
+    }
+    recorder.dirtied.clear();
+  }
+
+  static SdfPathVector GetPrimPaths()
+  {
+    return {SdfPath("/P"),
+            SdfPath("/P/C"),
+            SdfPath("/P/C/G"),
+            SdfPath("/P/D"),
+            SdfPath("/P/D/H"),
+            SdfPath("/P/V"),
+            SdfPath("/P/V/W")};
+  }
+
+  void Dirty(const SdfPath &primPath, const HdDataSourceLocator &locator)
+  {
+    input->DirtyPrims({{primPath, HdDataSourceLocatorSet{locator}}});
+  }
+
+  _MutableMatrixDataSource::Handle parentMatrix;
+  _MutableMatrixDataSource::Handle childMatrix;
+  _MutableBoolDataSource::Handle parentVis;
+  HdRetainedSceneIndexRefPtr input;
+  HdFlatteningSceneIndexRefPtr flattening;
+  _DirtyRecorder recorder;
+};
+
+// A parent xform edit re-flattens the descendants that inherit it, but not a
+// child with resetXformStack or the prims below it.
+static bool _TestParentXformEdit()
+{
+  bool success = true;
+  _Scene scene;
+  const HdDataSourceLocator &xformLocator = HdXformSchema::GetDefaultLocator();
+
+  scene.parentMatrix->Set(_Translate(5, 0, 0));
+  scene.Dirty(SdfPath("/P"), xformLocator);
+
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P"), xformLocator));
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/D"), xformLocator));
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/D/H"), xformLocator));
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/V"), xformLocator));
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/V/W"), xformLocator));
+  _CHECK(!scene.recorder.dirtied.count(SdfPath("/P/C")));
+  _CHECK(!scene.recorder.dirtied.count(SdfPath("/P/C/G")));
+
+  const GfMatrix4d d = _Translate(0, 2, 0) * _Translate(5, 0, 0);
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P")) == _Translate(5, 0, 0));
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/D")) == d);
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/D/H")) == _Translate(0, 0, 2) * d);
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/V/W")) == _Translate(5, 0, 0));
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/C")) == _Translate(0, 1, 0));
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/C/G")) ==
+         _Translate(0, 0, 1) * _Translate(0, 1, 0));
+
+  return success;
+}
+
+// The prims below a child with resetXformStack inherit from that child, so
+// an edit to it re-flattens them.
+static bool _TestResetChildXformEdit()
+{
+  bool success = true;
+  _Scene scene;
+  const HdDataSourceLocator &xformLocator = HdXformSchema::GetDefaultLocator();
+
+  scene.childMatrix->Set(_Translate(0, 7, 0));
+  scene.Dirty(SdfPath("/P/C"), xformLocator);
+
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/C"), xformLocator));
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/C/G"), xformLocator));
+  _CHECK(!scene.recorder.dirtied.count(SdfPath("/P")));
+  _CHECK(!scene.recorder.dirtied.count(SdfPath("/P/D")));
+
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/C")) == _Translate(0, 7, 0));
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/C/G")) ==
+         _Translate(0, 0, 1) * _Translate(0, 7, 0));
+
+  return success;
+}
+
+// A visibility edit stops at a child with its own visibility opinion.
+static bool _TestVisibilityEdit()
+{
+  bool success = true;
+  _Scene scene;
+  const HdDataSourceLocator &visLocator = HdVisibilitySchema::GetDefaultLocator();
+
+  scene.parentVis->Set(false);
+  scene.Dirty(SdfPath("/P"), visLocator);
+
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P"), visLocator));
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/C"), visLocator));
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/C/G"), visLocator));
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/D"), visLocator));
+  _CHECK(scene.recorder.IsDirtied(SdfPath("/P/D/H"), visLocator));
+  _CHECK(!scene.recorder.dirtied.count(SdfPath("/P/V")));
+  _CHECK(!scene.recorder.dirtied.count(SdfPath("/P/V/W")));
+
+  _CHECK(!_GetFlattenedVisibility(scene.flattening, SdfPath("/P")));
+  _CHECK(!_GetFlattenedVisibility(scene.flattening, SdfPath("/P/C/G")));
+  _CHECK(!_GetFlattenedVisibility(scene.flattening, SdfPath("/P/D/H")));
+  _CHECK(_GetFlattenedVisibility(scene.flattening, SdfPath("/P/V")));
+  _CHECK(_GetFlattenedVisibility(scene.flattening, SdfPath("/P/V/W")));
+
+  return success;
+}
+
+// Re-adding an existing prim invalidates every cached value below it,
+// including values that weren't inherited.
+static bool _TestReAdd()
+{
+  bool success = true;
+  _Scene scene;
+  const HdDataSourceLocator &xformLocator = HdXformSchema::GetDefaultLocator();
+  const HdDataSourceLocator &visLocator = HdVisibilitySchema::GetDefaultLocator();
+
+  scene.parentMatrix->Set(_Translate(3, 0, 0));
+  scene.childMatrix->Set(_Translate(0, 3, 0));
+  scene.input->AddPrims({{SdfPath("/P"),
+                          TfToken("test"),
+                          _MakePrim(scene.parentMatrix, false, scene.parentVis)}});
+
+  for (const SdfPath &primPath : _Scene::GetPrimPaths()) {
+    if (primPath != SdfPath("/P")) {
+      _CHECK(scene.recorder.IsDirtied(primPath, xformLocator));
+      _CHECK(scene.recorder.IsDirtied(primPath, visLocator));
+    }
+  }
+
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/D/H")) ==
+         _Translate(0, 0, 2) * _Translate(0, 2, 0) * _Translate(3, 0, 0));
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/C")) == _Translate(0, 3, 0));
+  _CHECK(_GetFlattenedMatrix(scene.flattening, SdfPath("/P/C/G")) ==
+         _Translate(0, 0, 1) * _Translate(0, 3, 0));
+
+  return success;
+}
+
+int main()
+{
+  bool success = true;
+
+  success &= _TestParentXformEdit();
+  success &= _TestResetChildXformEdit();
+  success &= _TestVisibilityEdit();
+  success &= _TestReAdd();
+
+  if (success) {
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
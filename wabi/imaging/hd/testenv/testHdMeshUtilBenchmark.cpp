@@ -0,0 +1,223 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// Times triangulation and quadrangulation of large meshes with one thread
+// and with all threads, and checks that both produce the same results.
+//
+// Usage: testHdMeshUtilBenchmark [numFaces] [numIterations]
+//
+// The topologies are a quad grid, an all-triangle scan-like mesh, and a
+// left-handed mesh of mixed polygons with holes and degenerate faces.
+
+#include "wabi/imaging/hd/meshTopology.h"
+#include "wabi/imaging/hd/meshUtil.h"
+#include "wabi/imaging/hd/tokens.h"
+#include "wabi/imaging/hd/types.h"
+
+#include "wabi/imaging/pxOsd/tokens.h"
+
+#include "wabi/base/gf/vec3f.h"
+#include "wabi/base/tf/stopwatch.h"
+#include "wabi/base/tf/stringUtils.h"
+#include "wabi/base/vt/array.h"
+#include "wabi/base/vt/value.h"
+#include "wabi/base/work/threadLimits.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+
+WABI_NAMESPACE_USING
+
+static HdMeshTopology _MakeQuadGrid(size_t numFaces)
+{
+  const int n = std::max(1, int(std::sqrt(double(numFaces))));
+  VtIntArray counts(n * n, 4);
+  VtIntArray indices;
+  indices.reserve(4 * n * n);
+  for (int y = 0; y < n; ++y) {
+    for (int x = 0; x < n; ++x) {
+      const int p = y * (n + 1) + x;
+      indices.push_back(p);
+      indices.push_back(p + 1);
+      indices.push_back(p + n + 2);
+      indices.push_back(p + n + 1);
+    }
+  }
+  return HdMeshTopology(PxOsdOpenSubdivTokens->none, HdTokens->rightHanded, counts, indices);
+}
+
+static HdMeshTopology _MakeTriangleMesh(size_t numFaces)
+{
+  const int n = std::max(1, int(std::sqrt(double(numFaces / 2))));
+  VtIntArray counts(2 * n * n, 3);
+  VtIntArray indices;
+  indices.reserve(6 * n * n);
+  for (int y = 0; y < n; ++y) {
+    for (int x = 0; x < n; ++x) {
+      const int p = y * (n + 1) + x;
+      indices.push_back(p);
+      indices.push_back(p + 1);
+      indices.push_back(p + n + 2);
+      indices.push_back(p);
+      indices.push_back(p + n + 2);
+      indices.push_back(p + n + 1);
+    }
+  }
+  return HdMeshTopology(PxOsdOpenSubdivTokens->none, HdTokens->rightHanded, counts, indices);
+}
+
+static HdMeshTopology _MakeMixedMesh(size_t numFaces)
+{
+  static const int faceSizes[] = {3, 4, 5, 6, 4, 8, 1, 4, 3, 0};
+  const int numPoints = int(numFaces) + 8;
+
+  VtIntArray counts;
+  VtIntArray indices;
+  VtIntArray holes;
+  counts.reserve(numFaces);
+  for (size_t face = 0; face < numFaces; ++face) {
+    const int faceSize = faceSizes[face % (sizeof(faceSizes) / sizeof(faceSizes[0]))];
+    counts.push_back(faceSize);
+    for (int i = 0; i < faceSize; ++i) {
+      indices.push_back(int((face + i) % numPoints));
+    }
+    if (face % 97 == 5) {
+      holes.push_back(int(face));
+    }
+  }
+  return HdMeshTopology(
+    PxOsdOpenSubdivTokens->none, HdTokens->leftHanded, counts, indices, holes);
+}
+
+// Runs \p compute once with a single thread and once with all threads,
+// \p numIterations times each, and returns whether the results match.
+template<typename Result>
+static bool _Time(const std::string &name,
+                  size_t numIterations,
+                  const std::function<void(Result *)> &compute)
+{
+  Result serial, parallel;
+  TfStopwatch serialTimer, parallelTimer;
+
+  for (size_t iteration = 0; iteration < numIterations; ++iteration) {
+    WorkSetConcurrencyLimit(1);
+    serialTimer.Start();
+    compute(&serial);
+    serialTimer.Stop();
+
+    WorkSetMaximumConcurrencyLimit();
+    parallelTimer.Start();
+    compute(&parallel);
+    parallelTimer.Stop();
+  }
+
+  const double serialSeconds = serialTimer.GetSeconds() / numIterations;
+  const double parallelSeconds = parallelTimer.GetSeconds() / numIterations;
+  std::cout << "  " << name << ": 1 thread " << serialSeconds << " s, "
+            << WorkGetConcurrencyLimit() << " threads " << parallelSeconds << " s";
+  if (parallelSeconds > 0.0) {
+    std::cout << " (" << serialSeconds / parallelSeconds << "x)";
+  }
+  std::cout << "\n";
+
+  if (!(serial == parallel)) {
+    std::cerr << name << ": results differ\n";
+    return false;
+  }
+  return true;
+}
+
+struct _Indices
+{
+  VtVec3iArray triangles;
+  VtIntArray quads;
+  VtIntArray primitiveParams;
+  VtIntArray edgeIndices;
+  VtVec2iArray quadEdgeIndices;
+
+  bool operator==(const _Indices &other) const
+  {
+    return triangles == other.triangles && quads == other.quads &&
+           primitiveParams == other.primitiveParams && edgeIndices == other.edgeIndices &&
+           quadEdgeIndices == other.quadEdgeIndices;
+  }
+};
+
+static bool _TestTopology(const std::string &name,
+                          const HdMeshTopology &topology,
+                          size_t numIterations)
+{
+  std::cout << name << ": " << topology.GetFaceVertexCounts().size() << " faces\n";
+
+  const HdMeshUtil meshUtil(&topology, SdfPath("/Mesh"));
+  bool success = true;
+
+  success &= _Time<_Indices>("ComputeTriangleIndices", numIterations, [&](_Indices *result) {
+    meshUtil.ComputeTriangleIndices(
+      &result->triangles, &result->primitiveParams, &result->edgeIndices);
+  });
+  success &= _Time<_Indices>("ComputeQuadIndices", numIterations, [&](_Indices *result) {
+    meshUtil.ComputeQuadIndices(&result->quads, &result->primitiveParams, &result->quadEdgeIndices);
+  });
+  success &= _Time<_Indices>("ComputeTriQuadIndices", numIterations, [&](_Indices *result) {
+    meshUtil.ComputeTriQuadIndices(
+      &result->quads, &result->primitiveParams, &result->quadEdgeIndices);
+  });
+
+  const VtIntArray &faceVertexIndices = topology.GetFaceVertexIndices();
+  VtVec3fArray faceVarying(faceVertexIndices.size());
+  for (size_t i = 0; i < faceVarying.size(); ++i) {
+    faceVarying[i] = GfVec3f(float(i), float(faceVertexIndices[i]), 1.0f);
+  }
+  success &= _Time<VtValue>(
+    "ComputeTriangulatedFaceVaryingPrimvar", numIterations, [&](VtValue *result) {
+      meshUtil.ComputeTriangulatedFaceVaryingPrimvar(
+        faceVarying.cdata(), int(faceVarying.size()), HdTypeFloatVec3, result);
+    });
+
+  return success;
+}
+
+int main(int argc, char *argv[])
+{
+  const size_t numFaces = argc > 1 ? TfStringToUInt64(argv[1]) : 4000000;
+  const size_t numIterations = argc > 2 ? TfStringToUInt64(argv[2]) : 5;
+
+  bool success = true;
+  success &= _TestTopology("quad grid", _MakeQuadGrid(numFaces), numIterations);
+  success &= _TestTopology("triangle mesh", _MakeTriangleMesh(numFaces), numIterations);
+  success &= _TestTopology("mixed polygons with holes", _MakeMixedMesh(numFaces), numIterations);
+
+  if (success) {
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,203 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+#include "wabi/imaging/hd/meshTopology.h"
+#include "wabi/imaging/hd/smoothNormals.h"
+#include "wabi/imaging/hd/tokens.h"
+#include "wabi/imaging/hd/vertexAdjacency.h"
+
+#include "wabi/imaging/pxOsd/tokens.h"
+
+#include "wabi/base/gf/vec3d.h"
+#include "wabi/base/gf/vec3f.h"
+#include "wabi/base/gf/vec3h.h"
+#include "wabi/base/tf/diagnosticLite.h"
+#include "wabi/base/vt/array.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+WABI_NAMESPACE_USING
+
+// Build a gridSize x gridSize grid of quads.  If shuffle is true, the point
+// indices are randomly permuted so the faces touch points all over the
+// points array.
+static HdMeshTopology _MakeGrid(int gridSize, TfToken const &orientation, bool shuffle)
+{
+  const int numPointsPerRow = gridSize + 1;
+  std::vector<int> pointIds(numPointsPerRow * numPointsPerRow);
+  for (size_t i = 0; i < pointIds.size(); ++i) {
+    pointIds[i] = static_cast<int>(i);
+  }
+  if (shuffle) {
+    std::mt19937 gen(1234);
+    std::shuffle(pointIds.begin(), pointIds.end(), gen);
+  }
+
+  VtIntArray faceVertexCounts(gridSize * gridSize, 4);
+  VtIntArray faceVertexIndices;
+  faceVertexIndices.reserve(4 * gridSize * gridSize);
+  for (int y = 0; y < gridSize; ++y) {
+    for (int x = 0; x < gridSize; ++x) {
+      const int p = y * numPointsPerRow + x;
+      faceVertexIndices.push_back(pointIds[p]);
+      faceVertexIndices.push_back(pointIds[p + 1]);
+      faceVertexIndices.push_back(pointIds[p + 1 + numPointsPerRow]);
+      faceVertexIndices.push_back(pointIds[p + numPointsPerRow]);
+    }
+  }
+  return HdMeshTopology(PxOsdOpenSubdivTokens->catmullClark,
+                        orientation,
+                        faceVertexCounts,
+                        faceVertexIndices);
+}
+
+// A bumpy surface, so the corner normals are not exactly representable and
+// the order in which they are added matters.
+template<typename Vec3Type> static VtArray<Vec3Type> _MakePoints(int numPoints)
+{
+  VtArray<Vec3Type> points(numPoints);
+  for (int i = 0; i < numPoints; ++i) {
+    const double x = 0.37 * i;
+    points[i] = Vec3Type(std::sin(x) * 10.0, std::cos(1.3 * x) * 10.0, std::sin(0.7 * x) * 3.0);
+  }
+  return points;
+}
+
+// The per-point gather over the adjacency table, which the face-parallel
+// computation must match bit for bit.
+template<typename Vec3Type>
+static VtArray<Vec3Type> _GatherNormals(Hd_VertexAdjacency const &adjacency,
+                                        Vec3Type const *points)
+{
+  VtIntArray const &table = adjacency.GetAdjacencyTable();
+  VtArray<Vec3Type> normals(adjacency.GetNumPoints());
+  for (int i = 0; i < adjacency.GetNumPoints(); ++i) {
+    int const offset = table[i * 2];
+    int const valence = table[i * 2 + 1];
+    int const *e = &table[offset];
+    Vec3Type normal(0);
+    Vec3Type const &curr = points[i];
+    for (int j = 0; j < valence; ++j) {
+      Vec3Type const &prev = points[*e++];
+      Vec3Type const &next = points[*e++];
+      normal += GfCross(next - curr, prev - curr);
+    }
+    normal.Normalize();
+    normals[i] = normal;
+  }
+  return normals;
+}
+
+template<typename Vec3Type>
+static bool _BitwiseEqual(VtArray<Vec3Type> const &a, VtArray<Vec3Type> const &b)
+{
+  return a.size() == b.size() && memcmp(a.cdata(), b.cdata(), a.size() * sizeof(Vec3Type)) == 0;
+}
+
+static bool _TestGrid(int gridSize, TfToken const &orientation, bool shuffle)
+{
+  std::cout << "Grid " << gridSize << "x" << gridSize << ", " << orientation
+            << (shuffle ? ", shuffled" : "") << "\n";
+
+  HdMeshTopology topology = _MakeGrid(gridSize, orientation, shuffle);
+  Hd_VertexAdjacency adjacency;
+  if (!adjacency.BuildAdjacencyTable(&topology)) {
+    std::cout << "  failed to build the adjacency table\n";
+    return false;
+  }
+
+  // Small meshes and scattered indices have no face ranges and are
+  // gathered per point.
+  const bool expectFaceRanges = !shuffle && gridSize * gridSize >= 8192;
+  if (adjacency.GetFaceRanges().empty() == expectFaceRanges) {
+    std::cout << "  expected " << (expectFaceRanges ? "" : "no ") << "face ranges\n";
+    return false;
+  }
+
+  const int numPoints = adjacency.GetNumPoints();
+  const VtArray<GfVec3f> pointsF = _MakePoints<GfVec3f>(numPoints);
+  const VtArray<GfVec3d> pointsD = _MakePoints<GfVec3d>(numPoints);
+
+  const VtArray<GfVec3f> expectedF = _GatherNormals(adjacency, pointsF.cdata());
+  const VtArray<GfVec3d> expectedD = _GatherNormals(adjacency, pointsD.cdata());
+
+  const VtArray<GfVec3f> normalsF = Hd_SmoothNormals::ComputeSmoothNormals(&adjacency,
+                                                                           numPoints,
+                                                                           pointsF.cdata());
+  if (!_BitwiseEqual(normalsF, expectedF)) {
+    std::cout << "  float normals differ from the per-point gather\n";
+    return false;
+  }
+
+  const VtArray<GfVec3d> normalsD = Hd_SmoothNormals::ComputeSmoothNormals(&adjacency,
+                                                                           numPoints,
+                                                                           pointsD.cdata());
+  if (!_BitwiseEqual(normalsD, expectedD)) {
+    std::cout << "  double normals differ from the per-point gather\n";
+    return false;
+  }
+
+  // Half normals are the float normals rounded to half precision.
+  const VtArray<GfVec3h> normalsH = Hd_SmoothNormals::ComputeSmoothNormalsHalf(&adjacency,
+                                                                               numPoints,
+                                                                               pointsF.cdata());
+  VtArray<GfVec3h> expectedH(numPoints);
+  for (int i = 0; i < numPoints; ++i) {
+    expectedH[i] = GfVec3h(expectedF[i]);
+  }
+  if (!_BitwiseEqual(normalsH, expectedH)) {
+    std::cout << "  half normals differ from the rounded float normals\n";
+    return false;
+  }
+
+  return true;
+}
+
+int main()
+{
+  bool success = true;
+
+  // Below the face range threshold.
+  success &= _TestGrid(16, HdTokens->rightHanded, false);
+
+  // Large enough for face ranges, with points shared between ranges along
+  // every range boundary.
+  success &= _TestGrid(160, HdTokens->rightHanded, false);
+  success &= _TestGrid(160, HdTokens->leftHanded, false);
+
+  // Scattered indices fall back to the per-point gather.
+  success &= _TestGrid(160, HdTokens->rightHanded, true);
+
+  if (success) {
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,205 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// Times smooth normals of a deforming mesh, recomputed every frame as for
+// an animated character, against the per-point gather over the adjacency
+// table, and checks that the results match.
+//
+// Usage: testHdSmoothNormalsBenchmark [numFaces] [numFrames]
+//
+// The mesh is a closed tube of quads, like a limb or torso, that bends and
+// twists from frame to frame.  The adjacency table is built once.
+
+#include "wabi/imaging/hd/meshTopology.h"
+#include "wabi/imaging/hd/smoothNormals.h"
+#include "wabi/imaging/hd/tokens.h"
+#include "wabi/imaging/hd/vertexAdjacency.h"
+
+#include "wabi/imaging/pxOsd/tokens.h"
+
+#include "wabi/base/gf/vec3f.h"
+#include "wabi/base/gf/vec3h.h"
+#include "wabi/base/tf/stopwatch.h"
+#include "wabi/base/tf/stringUtils.h"
+#include "wabi/base/vt/array.h"
+#include "wabi/base/work/loops.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+WABI_NAMESPACE_USING
+
+static const int _numSegments = 256;
+
+// Build a tube of numRings rings of _numSegments quads each, closed around
+// its circumference.
+static HdMeshTopology _MakeTube(int numRings)
+{
+  VtIntArray faceVertexCounts(numRings * _numSegments, 4);
+  VtIntArray faceVertexIndices;
+  faceVertexIndices.reserve(4 * numRings * _numSegments);
+  for (int ring = 0; ring < numRings; ++ring) {
+    for (int segment = 0; segment < _numSegments; ++segment) {
+      const int next = (segment + 1) % _numSegments;
+      faceVertexIndices.push_back(ring * _numSegments + segment);
+      faceVertexIndices.push_back(ring * _numSegments + next);
+      faceVertexIndices.push_back((ring + 1) * _numSegments + next);
+      faceVertexIndices.push_back((ring + 1) * _numSegments + segment);
+    }
+  }
+  return HdMeshTopology(PxOsdOpenSubdivTokens->catmullClark,
+                        HdTokens->rightHanded,
+                        faceVertexCounts,
+                        faceVertexIndices);
+}
+
+// Pose the tube for \p frame: it bends along its length and twists, with
+// some surface detail so the normals vary from point to point.
+static void _Deform(int frame, VtArray<GfVec3f> *points)
+{
+  const int numPoints = int(points->size());
+  const float t = 0.1f * frame;
+  GfVec3f *p = points->data();
+  WorkParallelForN(numPoints, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const int ring = int(i) / _numSegments;
+      const int segment = int(i) % _numSegments;
+      const float v = 0.01f * ring;
+      const float angle = 6.2831853f * segment / _numSegments + std::sin(t + v) * v;
+      const float radius = 1.0f + 0.05f * std::sin(7.0f * angle + 3.0f * v + t);
+      const float bend = 0.5f * std::sin(t) * v * v;
+      p[i].Set(radius * std::cos(angle) + bend, radius * std::sin(angle), v);
+    }
+  });
+}
+
+// The per-point gather over the adjacency table.
+static VtArray<GfVec3f> _GatherNormals(Hd_VertexAdjacency const &adjacency,
+                                       GfVec3f const *points)
+{
+  VtIntArray const &table = adjacency.GetAdjacencyTable();
+  VtArray<GfVec3f> normals(adjacency.GetNumPoints());
+  GfVec3f *normalsPtr = normals.data();
+  WorkParallelForN(adjacency.GetNumPoints(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      int const offset = table[i * 2];
+      int const valence = table[i * 2 + 1];
+      int const *e = &table[offset];
+      GfVec3f normal(0);
+      GfVec3f const &curr = points[i];
+      for (int j = 0; j < valence; ++j) {
+        GfVec3f const &prev = points[*e++];
+        GfVec3f const &next = points[*e++];
+        normal += GfCross(next - curr, prev - curr);
+      }
+      normal.Normalize();
+      normalsPtr[i] = normal;
+    }
+  });
+  return normals;
+}
+
+int main(int argc, char *argv[])
+{
+  const size_t numFaces = argc > 1 ? TfStringToUInt64(argv[1]) : 500000;
+  const int numFrames = argc > 2 ? TfStringToInt64(argv[2]) : 48;
+
+  const int numRings = std::max(1, int(numFaces / _numSegments));
+  const HdMeshTopology topology = _MakeTube(numRings);
+
+  TfStopwatch adjacencyTimer;
+  adjacencyTimer.Start();
+  Hd_VertexAdjacency adjacency;
+  const bool built = adjacency.BuildAdjacencyTable(&topology);
+  adjacencyTimer.Stop();
+  if (!built) {
+    std::cerr << "Failed to build the adjacency table\n";
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const int numPoints = adjacency.GetNumPoints();
+  VtArray<GfVec3f> points(numPoints);
+
+  TfStopwatch gatherTimer, floatTimer, packedTimer, halfTimer;
+  bool success = true;
+
+  for (int frame = 0; frame < numFrames; ++frame) {
+    _Deform(frame, &points);
+
+    gatherTimer.Start();
+    const VtArray<GfVec3f> expected = _GatherNormals(adjacency, points.cdata());
+    gatherTimer.Stop();
+
+    floatTimer.Start();
+    const VtArray<GfVec3f> normals = Hd_SmoothNormals::ComputeSmoothNormals(&adjacency,
+                                                                          numPoints,
+                                                                          points.cdata());
+    floatTimer.Stop();
+
+    packedTimer.Start();
+    Hd_SmoothNormals::ComputeSmoothNormalsPacked(&adjacency, numPoints, points.cdata());
+    packedTimer.Stop();
+
+    halfTimer.Start();
+    const VtArray<GfVec3h> normalsH = Hd_SmoothNormals::ComputeSmoothNormalsHalf(&adjacency,
+                                                                                 numPoints,
+                                                                                 points.cdata());
+    halfTimer.Stop();
+
+    // Normals are bit-identical to the gather, and half normals are the
+    // float normals rounded to half precision.
+    for (int i = 0; i < numPoints && success; ++i) {
+      if (std::memcmp(&normals[i], &expected[i], sizeof(GfVec3f)) != 0 ||
+          normalsH[i] != GfVec3h(normals[i])) {
+        std::cerr << "Normal " << i << " differs on frame " << frame << "\n";
+        success = false;
+      }
+    }
+    if (!success) {
+      break;
+    }
+  }
+
+  std::cout << "faces: " << numRings * _numSegments << ", points: " << numPoints
+            << ", frames: " << numFrames << ", face ranges: " << adjacency.GetFaceRanges().size()
+            << "\n"
+            << "adjacency (once): " << adjacencyTimer.GetSeconds() << " s\n"
+            << "per-point gather: " << gatherTimer.GetSeconds() / numFrames << " s/frame\n"
+            << "ComputeSmoothNormals: " << floatTimer.GetSeconds() / numFrames << " s/frame\n"
+            << "ComputeSmoothNormalsPacked: " << packedTimer.GetSeconds() / numFrames
+            << " s/frame\n"
+            << "ComputeSmoothNormalsHalf: " << halfTimer.GetSeconds() / numFrames << " s/frame\n";
+
+  if (success) {
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -47,7 +47,7 @@ WABI_NAMESPACE_BEGIN
 
 #define HD_PERF_TOKENS                     \
   (adjacencyBufSize)(basisCurvesTopology)( \
-    bufferSourcesResolved)(bufferArrayRangeMigrated)(bufferArrayRangeContainerResized)(computationsCommited)(drawBatches)(drawCalls)(dirtyLists)(dirtyListsRebuilt)(garbageCollected)(garbageCollectedSsbo)(garbageCollectedUbo)(garbageCollectedVbo)(gpuMemoryUsed)(instBasisCurvesTopology)(instBasisCurvesTopologyRange)(instExtComputationDataRange)(instMeshTopology)(instMeshTopologyRange)(instPrimvarRange)(instVertexAdjacency)(meshTopology)(nonUniformSize)(numCompletedSamples)(quadrangulateCPU)(quadrangulateGPU)(quadrangulateFaceVarying)(quadrangulatedVerts)(rebuildBatches)(singleBufferSize)(ssboSize)(skipInvisibleRprimSync)(subdivisionRefineCPU)(subdivisionRefineGPU)(textureMemory)(triangulateFaceVarying)(uboSize)(vboRelocated)
+    bufferSourcesResolved)(bufferArrayRangeMigrated)(bufferArrayRangeContainerResized)(computationsCommited)(drawBatches)(drawCalls)(dirtyLists)(dirtyListsRebuilt)(flatteningSceneIndex)(flatteningSceneIndexInvalidations)(garbageCollected)(garbageCollectedSsbo)(garbageCollectedUbo)(garbageCollectedVbo)(gpuMemoryUsed)(instBasisCurvesTopology)(instBasisCurvesTopologyRange)(instExtComputationDataRange)(instMeshTopology)(instMeshTopologyRange)(instPrimvarRange)(instVertexAdjacency)(meshTopology)(nonUniformSize)(numCompletedSamples)(quadrangulateCPU)(quadrangulateGPU)(quadrangulateFaceVarying)(quadrangulatedVerts)(rebuildBatches)(singleBufferSize)(ssboSize)(skipInvisibleRprimSync)(subdivisionRefineCPU)(subdivisionRefineGPU)(textureMemory)(triangulateFaceVarying)(uboSize)(vboRelocated)
 
 #define HD_SHADER_TOKENS        \
   (alphaThreshold)(clipPlanes)( \
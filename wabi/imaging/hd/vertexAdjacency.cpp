@@ -29,12 +29,20 @@
 
 #include "wabi/imaging/hf/perfLog.h"
 
+#include <algorithm>
+#include <limits>
+
 WABI_NAMESPACE_BEGIN
 
+// Meshes with fewer faces than twice this have no face ranges.
+static const int _NumFacesPerRange = 4096;
+
 
 Hd_VertexAdjacency::Hd_VertexAdjacency()
   : _numPoints(0),
     _adjacencyTable(),
+    _faceRangesAccumSize(0),
+    _leftHanded(false),
     _adjacencyRange(),
     _sharedAdjacencyBuilder()
 {}
@@ -78,6 +86,7 @@ bool Hd_VertexAdjacency::BuildAdjacencyTable(HdMeshTopology const *topology)
           _numPoints);
         _numPoints = 0;
         _adjacencyTable.clear();
+        _ClearFaceRanges();
         return false;
       }
       ++vertexValence[index];
@@ -130,9 +139,99 @@ bool Hd_VertexAdjacency::BuildAdjacencyTable(HdMeshTopology const *topology)
     vertIndex += nv;
   }
 
+  _BuildFaceRanges(topology);
+
   return true;
 }
 
+void Hd_VertexAdjacency::_BuildFaceRanges(HdMeshTopology const *topology)
+{
+  _ClearFaceRanges();
+
+  int const *numVertsPtr = topology->GetFaceVertexCounts().cdata();
+  int const *vertsPtr = topology->GetFaceVertexIndices().cdata();
+  int numFaces = topology->GetFaceVertexCounts().size();
+  if (numFaces < 2 * _NumFacesPerRange) {
+    return;
+  }
+
+  // Split the faces into ranges and find the points each range touches.
+  // Indices were range checked while building the adjacency table.
+  std::vector<FaceRange> faceRanges;
+  faceRanges.reserve((numFaces + _NumFacesPerRange - 1) / _NumFacesPerRange);
+  size_t accumSize = 0;
+  int vertIndex = 0;
+  for (int faceBegin = 0; faceBegin < numFaces; faceBegin += _NumFacesPerRange) {
+    FaceRange range;
+    range.faceBegin = faceBegin;
+    range.faceEnd = std::min(numFaces, faceBegin + _NumFacesPerRange);
+    range.vertexBegin = vertIndex;
+    range.pointBegin = std::numeric_limits<int>::max();
+    range.pointEnd = 0;
+    for (int i = range.faceBegin; i < range.faceEnd; ++i) {
+      for (int j = 0; j < numVertsPtr[i]; ++j) {
+        int index = vertsPtr[vertIndex++];
+        range.pointBegin = std::min(range.pointBegin, index);
+        range.pointEnd = std::max(range.pointEnd, index + 1);
+      }
+    }
+    if (range.pointBegin > range.pointEnd) {
+      range.pointBegin = range.pointEnd = 0;
+    }
+    range.accumOffset = accumSize;
+    accumSize += range.pointEnd - range.pointBegin;
+    faceRanges.push_back(range);
+  }
+
+  // If the face-vertex indices are scattered, the ranges cover most points
+  // each and accumulating them would cost far more than gathering.
+  if (accumSize > 2 * size_t(_numPoints)) {
+    return;
+  }
+
+  // Record which ranges may touch each point.  A range only touches points
+  // in its span, so the ranges between the first and last one that do are
+  // cheap to skip.
+  VtIntArray pointFaceRanges(2 * _numPoints, 0);
+  int *pointFaceRangesPtr = pointFaceRanges.data();
+  vertIndex = 0;
+  for (size_t r = 0; r < faceRanges.size(); ++r) {
+    for (int i = faceRanges[r].faceBegin; i < faceRanges[r].faceEnd; ++i) {
+      for (int j = 0; j < numVertsPtr[i]; ++j) {
+        int index = vertsPtr[vertIndex++];
+        if (pointFaceRangesPtr[index * 2 + 1] == 0) {
+          pointFaceRangesPtr[index * 2] = r;
+        }
+        pointFaceRangesPtr[index * 2 + 1] = r + 1;
+      }
+    }
+  }
+  size_t numVisits = 0;
+  for (int i = 0; i < _numPoints; ++i) {
+    numVisits += pointFaceRangesPtr[i * 2 + 1] - pointFaceRangesPtr[i * 2];
+  }
+  if (numVisits > 2 * size_t(_numPoints)) {
+    return;
+  }
+
+  _faceRanges = std::move(faceRanges);
+  _pointFaceRanges = std::move(pointFaceRanges);
+  _faceRangesAccumSize = accumSize;
+  _faceVertexCounts = topology->GetFaceVertexCounts();
+  _faceVertexIndices = topology->GetFaceVertexIndices();
+  _leftHanded = (topology->GetOrientation() != HdTokens->rightHanded);
+}
+
+void Hd_VertexAdjacency::_ClearFaceRanges()
+{
+  _faceRanges.clear();
+  _pointFaceRanges = VtIntArray();
+  _faceRangesAccumSize = 0;
+  _faceVertexCounts = VtIntArray();
+  _faceVertexIndices = VtIntArray();
+  _leftHanded = false;
+}
+
 HdBufferSourceSharedPtr Hd_VertexAdjacency::GetSharedAdjacencyBuilderComputation(
   HdMeshTopology const *topology)
 {
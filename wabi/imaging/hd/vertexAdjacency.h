@@ -34,6 +34,7 @@
 #include "wabi/base/vt/array.h"
 
 #include <memory>
+#include <vector>
 
 WABI_NAMESPACE_BEGIN
 
@@ -125,11 +126,73 @@ class Hd_VertexAdjacency final
     return _adjacencyTable;
   }
 
+  /// A contiguous range of faces whose vertices all lie in
+  /// [pointBegin, pointEnd).  Smooth normals of large meshes are computed by
+  /// accumulating the corner normals of each range in parallel into its own
+  /// buffer, which starts at accumOffset in a buffer shared by all ranges.
+  struct FaceRange
+  {
+    int faceBegin;
+    int faceEnd;
+    int vertexBegin;
+    int pointBegin;
+    int pointEnd;
+    size_t accumOffset;
+  };
+
+  /// Returns the face ranges built along with the adjacency table.  This is
+  /// empty if the mesh is small, or if its face-vertex indices are too
+  /// scattered for the ranges to cover few points each, in which case smooth
+  /// normals are gathered per point from the adjacency table instead.
+  std::vector<FaceRange> const &GetFaceRanges() const
+  {
+    return _faceRanges;
+  }
+
+  /// Returns, for each point, the index of the first face range that
+  /// touches it and one past the index of the last one.
+  VtIntArray const &GetPointFaceRanges() const
+  {
+    return _pointFaceRanges;
+  }
+
+  /// Returns the size of the buffer needed to accumulate all face ranges.
+  size_t GetFaceRangesAccumSize() const
+  {
+    return _faceRangesAccumSize;
+  }
+
+  /// Returns the face vertex counts and indices the face ranges refer to,
+  /// and whether their winding is left handed.
+  VtIntArray const &GetFaceVertexCounts() const
+  {
+    return _faceVertexCounts;
+  }
+  VtIntArray const &GetFaceVertexIndices() const
+  {
+    return _faceVertexIndices;
+  }
+  bool IsLeftHanded() const
+  {
+    return _leftHanded;
+  }
+
  private:
 
+  void _BuildFaceRanges(HdMeshTopology const *topology);
+  void _ClearFaceRanges();
+
   int _numPoints;
   VtIntArray _adjacencyTable;
 
+  // face ranges for computing smooth normals face by face
+  std::vector<FaceRange> _faceRanges;
+  VtIntArray _pointFaceRanges;
+  size_t _faceRangesAccumSize;
+  VtIntArray _faceVertexCounts;
+  VtIntArray _faceVertexIndices;
+  bool _leftHanded;
+
   // adjacency buffer range
   HdBufferArrayRangeSharedPtr _adjacencyRange;
 
@@ -66,6 +66,14 @@ TF_DEFINE_ENV_SETTING(HDEMBREE_CAMERA_LIGHT_INTENSITY,
                       300,
                       "Intensity of the camera light, specified as a percentage of <1,1,1>.");
 
+TF_DEFINE_ENV_SETTING(HDEMBREE_USE_RAY_STREAMS,
+                      0,
+                      "Should HdEmbree trace rays in per-tile streams? (values > 0 are true)");
+
+TF_DEFINE_ENV_SETTING(HDEMBREE_RENDER_STATS_FILE,
+                      "",
+                      "File to append per-render statistics to, as JSON lines (empty disables)");
+
 TF_DEFINE_ENV_SETTING(HDEMBREE_PRINT_CONFIGURATION,
                       0,
                       "Should HdEmbree print configuration on startup? (values > 0 are true)");
@@ -80,6 +88,8 @@ HdEmbreeConfig::HdEmbreeConfig()
   useFaceColors = (TfGetEnvSetting(HDEMBREE_USE_FACE_COLORS) > 0);
   cameraLightIntensity = (std::max(100, TfGetEnvSetting(HDEMBREE_CAMERA_LIGHT_INTENSITY)) /
                           100.0f);
+  useRayStreams = (TfGetEnvSetting(HDEMBREE_USE_RAY_STREAMS) > 0);
+  renderStatsFile = TfGetEnvSetting(HDEMBREE_RENDER_STATS_FILE);
 
   if (TfGetEnvSetting(HDEMBREE_PRINT_CONFIGURATION) > 0) {
     std::cout << "HdEmbree Configuration: \n"
@@ -88,7 +98,9 @@ HdEmbreeConfig::HdEmbreeConfig()
               << "  ambientOcclusionSamples    = " << ambientOcclusionSamples << "\n"
               << "  jitterCamera               = " << jitterCamera << "\n"
               << "  useFaceColors              = " << useFaceColors << "\n"
-              << "  cameraLightIntensity      = " << cameraLightIntensity << "\n";
+              << "  cameraLightIntensity      = " << cameraLightIntensity << "\n"
+              << "  useRayStreams              = " << useRayStreams << "\n"
+              << "  renderStatsFile            = " << renderStatsFile << "\n";
   }
 }
 
@@ -34,6 +34,8 @@
 #include "wabi/base/tf/singleton.h"
 #include "wabi/wabi.h"
 
+#include <string>
+
 WABI_NAMESPACE_BEGIN
 
 /// \class HdEmbreeConfig
@@ -93,6 +95,22 @@ class HdEmbreeConfig
   /// Override with *HDEMBREE_CAMERA_LIGHT_INTENSITY*.
   float cameraLightIntensity;
 
+  /// Should the renderpass trace camera and ambient occlusion rays as
+  /// coherent ray streams (one embree stream query per tile, and per
+  /// shading point for occlusion rays) instead of one ray at a time?
+  ///
+  /// Override with *HDEMBREE_USE_RAY_STREAMS*. Integer values greater than
+  /// zero are considered "true".
+  bool useRayStreams;
+
+  /// If set, the path of a file to which statistics about each completed
+  /// render (rays traced, rays per second, time to first pixel and time per
+  /// sample pass, along with the tile size and thread count used) are
+  /// appended, one JSON object per line.
+  ///
+  /// Override with *HDEMBREE_RENDER_STATS_FILE*.
+  std::string renderStatsFile;
+
  private:
 
   // The constructor initializes the config variables with their
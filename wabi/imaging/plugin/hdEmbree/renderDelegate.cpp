@@ -116,7 +116,7 @@ HdEmbreeRenderDelegate::HdEmbreeRenderDelegate(HdRenderSettingsMap const &settin
 void HdEmbreeRenderDelegate::_Initialize()
 {
   // Initialize the settings and settings descriptors.
-  _settingDescriptors.resize(4);
+  _settingDescriptors.resize(5);
   _settingDescriptors[0] = {"Enable Scene Colors",
                             HdEmbreeRenderSettingsTokens->enableSceneColors,
                             VtValue(HdEmbreeConfig::GetInstance().useFaceColors)};
@@ -129,6 +129,9 @@ void HdEmbreeRenderDelegate::_Initialize()
   _settingDescriptors[3] = {"Samples To Convergence",
                             HdRenderSettingsTokens->convergedSamplesPerPixel,
                             VtValue(int(HdEmbreeConfig::GetInstance().samplesToConvergence))};
+  _settingDescriptors[4] = {"Tile Size",
+                            HdEmbreeRenderSettingsTokens->tileSize,
+                            VtValue(int(HdEmbreeConfig::GetInstance().tileSize))};
   _PopulateDefaultSettings(_settingDescriptors);
 
   // Initialize the embree library handle (_rtcDevice).
@@ -257,7 +260,7 @@ HdAovDescriptor HdEmbreeRenderDelegate::GetDefaultAovDescriptor(TfToken const &n
 
 VtDictionary HdEmbreeRenderDelegate::GetRenderStats() const
 {
-  VtDictionary stats;
+  VtDictionary stats = _renderer.GetRenderStats();
   stats[HdPerfTokens->numCompletedSamples.GetString()] = _renderer.GetCompletedSamples();
   return stats;
 }
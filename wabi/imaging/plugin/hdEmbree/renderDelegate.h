@@ -45,7 +45,7 @@ WABI_NAMESPACE_BEGIN
 class HdEmbreeRenderParam;
 
 #define HDEMBREE_RENDER_SETTINGS_TOKENS \
-  (enableAmbientOcclusion)(enableSceneColors)(ambientOcclusionSamples)
+  (enableAmbientOcclusion)(enableSceneColors)(ambientOcclusionSamples)(tileSize)
 
 // Also: HdRenderSettingsTokens->convergedSamplesPerPixel
 
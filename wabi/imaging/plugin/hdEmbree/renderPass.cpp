@@ -30,6 +30,7 @@
  */
 #include "wabi/imaging/plugin/hdEmbree/renderPass.h"
 #include "wabi/imaging/hd/renderPassState.h"
+#include "wabi/imaging/plugin/hdEmbree/config.h"
 #include "wabi/imaging/plugin/hdEmbree/renderDelegate.h"
 
 WABI_NAMESPACE_BEGIN
@@ -132,6 +133,10 @@ void HdEmbreeRenderPass::_Execute(HdRenderPassStateSharedPtr const &renderPassSt
       renderDelegate->GetRenderSetting<bool>(HdEmbreeRenderSettingsTokens->enableSceneColors,
                                              true));
 
+    _renderer->SetTileSize(
+      renderDelegate->GetRenderSetting<int>(HdEmbreeRenderSettingsTokens->tileSize,
+                                            HdEmbreeConfig::GetInstance().tileSize));
+
     needStartRender = true;
   }
 
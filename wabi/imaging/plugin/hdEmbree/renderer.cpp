@@ -39,9 +39,13 @@
 
 #include "wabi/base/gf/matrix3f.h"
 #include "wabi/base/gf/vec2f.h"
+#include "wabi/base/js/json.h"
+#include "wabi/base/vt/array.h"
 #include "wabi/base/work/loops.h"
+#include "wabi/base/work/threadLimits.h"
 
 #include <chrono>
+#include <fstream>
 #include <thread>
 
 WABI_NAMESPACE_BEGIN
@@ -65,7 +69,12 @@ HdEmbreeRenderer::HdEmbreeRenderer()
     _samplesToConvergence(0),
     _ambientOcclusionSamples(0),
     _enableSceneColors(false),
-    _completedSamples(0)
+    _completedSamples(0),
+    _tileSize(HdEmbreeConfig::GetInstance().tileSize),
+    _numRays(0),
+    _firstTileCompleted(false),
+    _timeToFirstPixel(0.0),
+    _renderTime(0.0)
 {}
 
 HdEmbreeRenderer::~HdEmbreeRenderer() = default;
@@ -90,6 +99,11 @@ void HdEmbreeRenderer::SetEnableSceneColors(bool enableSceneColors)
   _enableSceneColors = enableSceneColors;
 }
 
+void HdEmbreeRenderer::SetTileSize(int tileSize)
+{
+  _tileSize = std::max(1, tileSize);
+}
+
 void HdEmbreeRenderer::SetDataWindow(const GfRect2i &dataWindow)
 {
   _dataWindow = dataWindow;
@@ -328,6 +342,77 @@ int HdEmbreeRenderer::GetCompletedSamples() const
   return _completedSamples.load();
 }
 
+VtDictionary HdEmbreeRenderer::GetRenderStats() const
+{
+  const uint64_t numRays = _numRays.load();
+
+  std::lock_guard<std::mutex> lock(_statsMutex);
+  const double renderTime = _renderTime > 0.0 ? _renderTime : _GetElapsedSeconds();
+
+  VtDictionary stats;
+  stats["numRays"] = numRays;
+  stats["raysPerSecond"] = renderTime > 0.0 ? numRays / renderTime : 0.0;
+  stats["timeToFirstPixel"] = _timeToFirstPixel;
+  stats["renderTime"] = renderTime;
+  stats["sampleTimes"] = VtDoubleArray(_sampleTimes.begin(), _sampleTimes.end());
+  stats["tileSize"] = int(_tileSize);
+  stats["numThreads"] = int(WorkGetConcurrencyLimit());
+  return stats;
+}
+
+void HdEmbreeRenderer::_ResetRenderStats()
+{
+  std::lock_guard<std::mutex> lock(_statsMutex);
+  _numRays.store(0);
+  _firstTileCompleted.store(false);
+  _renderStartTime = std::chrono::steady_clock::now();
+  _timeToFirstPixel = 0.0;
+  _renderTime = 0.0;
+  _sampleTimes.clear();
+}
+
+double HdEmbreeRenderer::_GetElapsedSeconds() const
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - _renderStartTime)
+    .count();
+}
+
+void HdEmbreeRenderer::_WriteRenderStats() const
+{
+  const std::string &fileName = HdEmbreeConfig::GetInstance().renderStatsFile;
+  if (fileName.empty()) {
+    return;
+  }
+
+  std::ofstream out(fileName, std::ios::app);
+  if (!out) {
+    TF_WARN("Could not open render stats file '%s'", fileName.c_str());
+    return;
+  }
+
+  const uint64_t numRays = _numRays.load();
+  std::lock_guard<std::mutex> lock(_statsMutex);
+
+  JsWriter js(out);
+  js.BeginObject();
+  js.WriteKeyValue("width", int(_dataWindow.GetWidth()));
+  js.WriteKeyValue("height", int(_dataWindow.GetHeight()));
+  js.WriteKeyValue("samplesToConvergence", _samplesToConvergence);
+  js.WriteKeyValue("completedSamples", GetCompletedSamples());
+  js.WriteKeyValue("ambientOcclusionSamples", _ambientOcclusionSamples);
+  js.WriteKeyValue("useRayStreams", HdEmbreeConfig::GetInstance().useRayStreams);
+  js.WriteKeyValue("tileSize", _tileSize);
+  js.WriteKeyValue("numThreads", WorkGetConcurrencyLimit());
+  js.WriteKeyValue("numRays", numRays);
+  js.WriteKeyValue("raysPerSecond", _renderTime > 0.0 ? numRays / _renderTime : 0.0);
+  js.WriteKeyValue("timeToFirstPixel", _timeToFirstPixel);
+  js.WriteKeyValue("renderTime", _renderTime);
+  js.WriteKey("sampleTimes");
+  js.WriteArray(_sampleTimes);
+  js.EndObject();
+  out << "\n";
+}
+
 static bool _IsContained(const GfRect2i &rect, int width, int height)
 {
   return rect.GetMinX() >= 0 && rect.GetMaxX() < width && rect.GetMinY() >= 0 &&
@@ -337,6 +422,7 @@ static bool _IsContained(const GfRect2i &rect, int width, int height)
 void HdEmbreeRenderer::Render(HdRenderThread *renderThread)
 {
   _completedSamples.store(0);
+  _ResetRenderStats();
 
   // Commit any pending changes to the scene.
   rtcCommitScene(_scene);
@@ -403,7 +489,7 @@ void HdEmbreeRenderer::Render(HdRenderThread *renderThread)
       break;
     }
 
-    const unsigned int tileSize = HdEmbreeConfig::GetInstance().tileSize;
+    const unsigned int tileSize = _tileSize;
     const unsigned int numTilesX = (_dataWindow.GetWidth() + tileSize - 1) / tileSize;
     const unsigned int numTilesY = (_dataWindow.GetHeight() + tileSize - 1) / tileSize;
 
@@ -416,6 +502,11 @@ void HdEmbreeRenderer::Render(HdRenderThread *renderThread)
                                std::placeholders::_1,
                                std::placeholders::_2));
 
+    {
+      std::lock_guard<std::mutex> lock(_statsMutex);
+      _sampleTimes.push_back(_GetElapsedSeconds());
+    }
+
     // After the first pass, mark the single-sampled attachments as
     // converged and unmap them. If there are no multisampled attachments,
     // we are done.
@@ -443,12 +534,56 @@ void HdEmbreeRenderer::Render(HdRenderThread *renderThread)
     }
   }
 
+  // Record the render time before marking the buffers converged, so that
+  // clients polling for convergence see the final stats.
+  {
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _renderTime = _GetElapsedSeconds();
+  }
+
   // Mark the multisampled attachments as converged and unmap all buffers.
   for (size_t i = 0; i < _aovBindings.size(); ++i) {
     HdEmbreeRenderBuffer *rb = static_cast<HdEmbreeRenderBuffer *>(_aovBindings[i].renderBuffer);
     rb->Unmap();
     rb->SetConverged(true);
   }
+
+  // Only report renders that ran to completion.
+  if (!renderThread->IsStopRequested()) {
+    _WriteRenderStats();
+  }
+}
+
+/// Fill in an RTCRay structure from the given parameters.
+static void _PopulateRay(RTCRay *ray, GfVec3f const &origin, GfVec3f const &dir, float nearest)
+{
+  ray->org_x = origin[0];
+  ray->org_y = origin[1];
+  ray->org_z = origin[2];
+  ray->tnear = nearest;
+
+  ray->dir_x = dir[0];
+  ray->dir_y = dir[1];
+  ray->dir_z = dir[2];
+  ray->time = 0.0f;
+
+  ray->tfar = std::numeric_limits<float>::infinity();
+  ray->mask = -1;
+}
+
+/// Fill in an RTCRayHit structure from the given parameters.
+// note this containts a Ray and a RayHit
+static void _PopulateRayHit(RTCRayHit *rayHit,
+                            GfVec3f const &origin,
+                            GfVec3f const &dir,
+                            float nearest)
+{
+  // Fill in defaults for the ray
+  _PopulateRay(&rayHit->ray, origin, dir, nearest);
+
+  // Fill in defaults for the hit
+  rayHit->hit.primID = RTC_INVALID_GEOMETRY_ID;
+  rayHit->hit.geomID = RTC_INVALID_GEOMETRY_ID;
 }
 
 void HdEmbreeRenderer::_RenderTiles(HdRenderThread *renderThread, size_t tileStart, size_t tileEnd)
@@ -468,7 +603,7 @@ void HdEmbreeRenderer::_RenderTiles(HdRenderThread *renderThread, size_t tileSta
     maxY = _height - maxY;
   }
 
-  const unsigned int tileSize = HdEmbreeConfig::GetInstance().tileSize;
+  const unsigned int tileSize = _tileSize;
   const unsigned int numTilesX = (_dataWindow.GetWidth() + tileSize - 1) / tileSize;
 
   // Initialize the RNG for this tile (each tile creates one as
@@ -481,6 +616,20 @@ void HdEmbreeRenderer::_RenderTiles(HdRenderThread *renderThread, size_t tileSta
   std::uniform_real_distribution<float> uniform_dist(0.0f, 1.0f);
   std::function<float()> uniform_float = std::bind(uniform_dist, random);
 
+  // Rays traced for the current tile, added to _numRays once per tile to
+  // keep render threads from contending on the shared counter.
+  uint64_t numRays = 0;
+
+  // In ray stream mode, camera rays for a whole tile are gathered here and
+  // traced together once the tile has been generated.
+  const bool useRayStreams = HdEmbreeConfig::GetInstance().useRayStreams;
+  std::vector<GfVec2i> streamPixels;
+  std::vector<RTCRayHit> streamRayHits;
+  if (useRayStreams) {
+    streamPixels.reserve(tileSize * tileSize);
+    streamRayHits.reserve(tileSize * tileSize);
+  }
+
   // _RenderTiles gets a range of tiles; iterate through them.
   for (unsigned int tile = tileStart; tile < tileEnd; ++tile) {
 
@@ -541,43 +690,33 @@ void HdEmbreeRenderer::_RenderTiles(HdRenderThread *renderThread, size_t tileSta
         origin = _inverseViewMatrix.Transform(origin);
         dir = _inverseViewMatrix.TransformDir(dir).GetNormalized();
 
-        // Trace the ray.
-        _TraceRay(x, y, origin, dir, random);
+        // Trace the ray, or queue it up for this tile's ray stream.
+        if (useRayStreams) {
+          streamPixels.push_back(GfVec2i(x, y));
+          streamRayHits.emplace_back();
+          streamRayHits.back().ray.flags = 0;
+          _PopulateRayHit(&streamRayHits.back(), origin, dir, 0.0f);
+        } else {
+          _TraceRay(x, y, origin, dir, random, &numRays);
+        }
       }
     }
-  }
-}
-
-/// Fill in an RTCRay structure from the given parameters.
-static void _PopulateRay(RTCRay *ray, GfVec3f const &origin, GfVec3f const &dir, float nearest)
-{
-  ray->org_x = origin[0];
-  ray->org_y = origin[1];
-  ray->org_z = origin[2];
-  ray->tnear = nearest;
-
-  ray->dir_x = dir[0];
-  ray->dir_y = dir[1];
-  ray->dir_z = dir[2];
-  ray->time = 0.0f;
-
-  ray->tfar = std::numeric_limits<float>::infinity();
-  ray->mask = -1;
-}
 
-/// Fill in an RTCRayHit structure from the given parameters.
-// note this containts a Ray and a RayHit
-static void _PopulateRayHit(RTCRayHit *rayHit,
-                            GfVec3f const &origin,
-                            GfVec3f const &dir,
-                            float nearest)
-{
-  // Fill in defaults for the ray
-  _PopulateRay(&rayHit->ray, origin, dir, nearest);
+    if (useRayStreams && !streamRayHits.empty()) {
+      _TraceRayStream(streamPixels, &streamRayHits, random, &numRays);
+      streamPixels.clear();
+      streamRayHits.clear();
+    }
 
-  // Fill in defaults for the hit
-  rayHit->hit.primID = RTC_INVALID_GEOMETRY_ID;
-  rayHit->hit.geomID = RTC_INVALID_GEOMETRY_ID;
+    // Count the camera rays, and note when the first tile is done.
+    numRays += uint64_t(x1 - x0) * (y1 - y0);
+    _numRays.fetch_add(numRays, std::memory_order_relaxed);
+    numRays = 0;
+    if (!_firstTileCompleted.load(std::memory_order_relaxed) && !_firstTileCompleted.exchange(true)) {
+      std::lock_guard<std::mutex> lock(_statsMutex);
+      _timeToFirstPixel = _GetElapsedSeconds();
+    }
+  }
 }
 
 /// Generate a random cosine-weighted direction ray (in the hemisphere
@@ -602,7 +741,8 @@ void HdEmbreeRenderer::_TraceRay(unsigned int x,
                                  unsigned int y,
                                  GfVec3f const &origin,
                                  GfVec3f const &dir,
-                                 std::default_random_engine &random)
+                                 std::default_random_engine &random,
+                                 uint64_t *numRays)
 {
   // Intersect the camera ray.
   RTCRayHit rayHit;  // EMBREE_FIXME: use RTCRay for occlusion rays
@@ -628,6 +768,46 @@ void HdEmbreeRenderer::_TraceRay(unsigned int x,
     rayHit.hit.Ng_z = -rayHit.hit.Ng_z;
   }
 
+  _WriteAovs(x, y, rayHit, random, numRays);
+}
+
+void HdEmbreeRenderer::_TraceRayStream(std::vector<GfVec2i> const &pixels,
+                                       std::vector<RTCRayHit> *rayHits,
+                                       std::default_random_engine &random,
+                                       uint64_t *numRays)
+{
+  // Intersect all camera rays of the stream at once. Camera rays from a
+  // single tile are spatially coherent, which lets embree trace them as
+  // packets internally.
+  {
+    RTCIntersectContext context;
+    rtcInitIntersectContext(&context);
+    context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+    rtcIntersect1M(_scene,
+                   &context,
+                   rayHits->data(),
+                   static_cast<unsigned int>(rayHits->size()),
+                   sizeof(RTCRayHit));
+  }
+
+  for (size_t i = 0; i < rayHits->size(); ++i) {
+    RTCRayHit &rayHit = (*rayHits)[i];
+
+    // See _TraceRay for the geometric normal reversal.
+    rayHit.hit.Ng_x = -rayHit.hit.Ng_x;
+    rayHit.hit.Ng_y = -rayHit.hit.Ng_y;
+    rayHit.hit.Ng_z = -rayHit.hit.Ng_z;
+
+    _WriteAovs(pixels[i][0], pixels[i][1], rayHit, random, numRays);
+  }
+}
+
+void HdEmbreeRenderer::_WriteAovs(unsigned int x,
+                                  unsigned int y,
+                                  RTCRayHit const &rayHit,
+                                  std::default_random_engine &random,
+                                  uint64_t *numRays)
+{
   // Write AOVs to attachments that aren't converged.
   for (size_t i = 0; i < _aovBindings.size(); ++i) {
     HdEmbreeRenderBuffer *renderBuffer = static_cast<HdEmbreeRenderBuffer *>(
@@ -639,7 +819,7 @@ void HdEmbreeRenderer::_TraceRay(unsigned int x,
 
     if (_aovNames[i].name == HdAovTokens->color) {
       GfVec4f clearColor = _GetClearColor(_aovBindings[i].clearValue);
-      GfVec4f sample = _ComputeColor(rayHit, random, clearColor);
+      GfVec4f sample = _ComputeColor(rayHit, random, clearColor, numRays);
       renderBuffer->Write(GfVec3i(x, y, 1), 4, sample.data());
     } else if ((_aovNames[i].name == HdAovTokens->cameraDepth ||
                 _aovNames[i].name == HdAovTokens->depth) &&
@@ -799,7 +979,8 @@ bool HdEmbreeRenderer::_ComputePrimvar(RTCRayHit const &rayHit,
 
 GfVec4f HdEmbreeRenderer::_ComputeColor(RTCRayHit const &rayHit,
                                         std::default_random_engine &random,
-                                        GfVec4f const &clearColor)
+                                        GfVec4f const &clearColor,
+                                        uint64_t *numRays)
 {
   if (rayHit.hit.geomID == RTC_INVALID_GEOMETRY_ID) {
     return clearColor;
@@ -850,7 +1031,7 @@ GfVec4f HdEmbreeRenderer::_ComputeColor(RTCRayHit const &rayHit,
                        HdEmbreeConfig::GetInstance().cameraLightIntensity;
 
   // Lighting gets modulated by an ambient occlusion term.
-  float aoLightIntensity = _ComputeAmbientOcclusion(hitPos, normal, random);
+  float aoLightIntensity = _ComputeAmbientOcclusion(hitPos, normal, random, numRays);
 
   // XXX: We should support opacity here...
 
@@ -868,7 +1049,8 @@ GfVec4f HdEmbreeRenderer::_ComputeColor(RTCRayHit const &rayHit,
 
 float HdEmbreeRenderer::_ComputeAmbientOcclusion(GfVec3f const &position,
                                                  GfVec3f const &normal,
-                                                 std::default_random_engine &random)
+                                                 std::default_random_engine &random,
+                                                 uint64_t *numRays)
 {
   // Create a uniform random distribution for AO calculations.
   std::uniform_real_distribution<float> uniform_dist(0.0f, 1.0f);
@@ -881,6 +1063,8 @@ float HdEmbreeRenderer::_ComputeAmbientOcclusion(GfVec3f const &position,
 
   float occlusionFactor = 0.0f;
 
+  *numRays += _ambientOcclusionSamples;
+
   // For hemisphere sampling we need to choose a coordinate frame at this
   // point. For the purposes of _CosineWeightedDirection, the normal needs
   // to map to (0,0,1), but since the distribution is radially symmetric
@@ -915,6 +1099,38 @@ float HdEmbreeRenderer::_ComputeAmbientOcclusion(GfVec3f const &position,
   // Trace ambient occlusion rays. The occlusion factor is the fraction of
   // the hemisphere that's occluded when rays are traced to infinity,
   // computed by random sampling over the hemisphere.
+  if (HdEmbreeConfig::GetInstance().useRayStreams) {
+    // Build all of the shadow rays for this shading point and trace them
+    // with a single (incoherent) stream query. The ray buffers are reused
+    // per thread rather than allocated at every shading point.
+    static thread_local std::vector<GfVec3f> shadowDirs;
+    static thread_local std::vector<RTCRay> shadows;
+    shadowDirs.resize(_ambientOcclusionSamples);
+    shadows.resize(_ambientOcclusionSamples);
+    for (int i = 0; i < _ambientOcclusionSamples; i++) {
+      shadowDirs[i] = basis * _CosineWeightedDirection(samples[i]);
+      shadows[i].flags = 0;
+      _PopulateRay(&shadows[i], position, shadowDirs[i], 0.001f);
+    }
+    {
+      RTCIntersectContext context;
+      rtcInitIntersectContext(&context);
+      context.flags = RTC_INTERSECT_CONTEXT_FLAG_INCOHERENT;
+      rtcOccluded1M(_scene,
+                    &context,
+                    shadows.data(),
+                    static_cast<unsigned int>(shadows.size()),
+                    sizeof(RTCRay));
+    }
+    for (int i = 0; i < _ambientOcclusionSamples; i++) {
+      if (shadows[i].tfar > 0.0f)
+        occlusionFactor += GfDot(shadowDirs[i], normal);
+    }
+    occlusionFactor /= _ambientOcclusionSamples;
+
+    return occlusionFactor;
+  }
+
   for (int i = 0; i < _ambientOcclusionSamples; i++) {
     // Sample in the hemisphere centered on the face normal. Use
     // cosine-weighted hemisphere sampling to bias towards samples which
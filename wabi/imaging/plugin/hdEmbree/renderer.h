@@ -38,12 +38,17 @@
 
 #include "wabi/base/gf/matrix4d.h"
 #include "wabi/base/gf/rect2i.h"
+#include "wabi/base/gf/vec2i.h"
+#include "wabi/base/vt/dictionary.h"
 
 #include <embree3/rtcore.h>
 #include <embree3/rtcore_ray.h>
 
 #include <atomic>
+#include <chrono>
+#include <mutex>
 #include <random>
+#include <vector>
 
 WABI_NAMESPACE_BEGIN
 
@@ -107,6 +112,10 @@ class HdEmbreeRenderer final
   ///                            everything as white.
   void SetEnableSceneColors(bool enableSceneColors);
 
+  /// Set the size of the square tiles the image is rendered in.
+  ///   \param tileSize The size (per axis) of a threading work unit.
+  void SetTileSize(int tileSize);
+
   /// Rendering entrypoint: add one sample per pixel to the whole sample
   /// buffer, and then loop until the image is converged.  After each pass,
   /// the image will be resolved into a color buffer.
@@ -123,6 +132,12 @@ class HdEmbreeRenderer final
   /// Get the number of samples completed so far.
   int GetCompletedSamples() const;
 
+  /// Get statistics about the current or most recent render: the number of
+  /// rays traced, rays per second, time to first pixel, the time at which
+  /// each sample pass completed, and the tile size and thread count used.
+  /// Times are in seconds from the start of the render.
+  VtDictionary GetRenderStats() const;
+
  private:
 
   // Validate the internal consistency of aov bindings provided to
@@ -145,17 +160,36 @@ class HdEmbreeRenderer final
   void _RenderTiles(HdRenderThread *renderThread, size_t tileStart, size_t tileEnd);
 
   // Cast a ray into the scene and if it hits an object, write to the bound
-  // aov buffers.
+  // aov buffers. Secondary rays traced while shading are added to numRays.
   void _TraceRay(unsigned int x,
                  unsigned int y,
                  GfVec3f const &origin,
                  GfVec3f const &dir,
-                 std::default_random_engine &random);
+                 std::default_random_engine &random,
+                 uint64_t *numRays);
+
+  // Cast a stream of camera rays (typically one tile's worth) into the
+  // scene with a single coherent embree query, and then write each hit to
+  // the bound aov buffers. pixels[i] holds the image coordinates that
+  // rayHits[i] was generated for.
+  void _TraceRayStream(std::vector<GfVec2i> const &pixels,
+                       std::vector<RTCRayHit> *rayHits,
+                       std::default_random_engine &random,
+                       uint64_t *numRays);
+
+  // Write the shading results for a single intersected camera ray to
+  // the bound aov buffers that aren't yet converged.
+  void _WriteAovs(unsigned int x,
+                  unsigned int y,
+                  RTCRayHit const &rayHit,
+                  std::default_random_engine &random,
+                  uint64_t *numRays);
 
   // Compute the color at the given ray hit.
   GfVec4f _ComputeColor(RTCRayHit const &rayHit,
                         std::default_random_engine &random,
-                        GfVec4f const &clearColor);
+                        GfVec4f const &clearColor,
+                        uint64_t *numRays);
   // Compute the depth at the given ray hit.
   bool _ComputeDepth(RTCRayHit const &rayHit, float *depth, bool clip);
   // Compute the given ID at the given ray hit.
@@ -173,7 +207,8 @@ class HdEmbreeRenderer final
   // the light contribution of an infinitely far, pure white dome light.
   float _ComputeAmbientOcclusion(GfVec3f const &position,
                                  GfVec3f const &normal,
-                                 std::default_random_engine &random);
+                                 std::default_random_engine &random,
+                                 uint64_t *numRays);
 
   // The bound aovs for this renderer.
   HdRenderPassAovBindingVector _aovBindings;
@@ -214,6 +249,23 @@ class HdEmbreeRenderer final
 
   // How many samples have been completed.
   std::atomic<int> _completedSamples;
+
+  // The size (per axis) of the tiles rendered as threading work units.
+  unsigned int _tileSize;
+
+  // Render statistics, see GetRenderStats().  The ray count is updated by
+  // worker threads, the rest only by the render thread, under _statsMutex.
+  void _ResetRenderStats();
+  void _WriteRenderStats() const;
+  double _GetElapsedSeconds() const;
+
+  alignas(64) std::atomic<uint64_t> _numRays;
+  std::atomic<bool> _firstTileCompleted;
+  std::chrono::steady_clock::time_point _renderStartTime;
+  mutable std::mutex _statsMutex;
+  double _timeToFirstPixel;
+  double _renderTime;
+  std::vector<double> _sampleTimes;
 };
 
 WABI_NAMESPACE_END
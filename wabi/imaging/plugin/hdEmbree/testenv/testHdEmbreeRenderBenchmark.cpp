@@ -0,0 +1,403 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// Headless hdEmbree benchmark.  Loads a stage (or builds a grid of cubes)
+// through UsdImagingDelegate, renders a number of frames to convergence with
+// an orbiting camera for each combination of tile size and thread count, and
+// writes the render stats reported by the render delegate as JSON:
+//
+//   testHdEmbreeRenderBenchmark [--stage file.usd] [--cubes 10]
+//                               [--frames 4] [--width 256] [--height 256]
+//                               [--samples 16] [--tileSizes 8,16,32]
+//                               [--threads 1,4,0] [--out stats.json]
+//
+// A thread count of 0 means the default concurrency limit.
+
+#include "wabi/usdImaging/usdImaging/delegate.h"
+
+#include "wabi/usd/usd/stage.h"
+#include "wabi/usd/usdGeom/bboxCache.h"
+#include "wabi/usd/usdGeom/mesh.h"
+#include "wabi/usd/usdGeom/tokens.h"
+#include "wabi/usd/usdGeom/xformCommonAPI.h"
+
+#include "wabi/imaging/hd/engine.h"
+#include "wabi/imaging/hd/pluginRenderDelegateUniqueHandle.h"
+#include "wabi/imaging/hd/renderDelegate.h"
+#include "wabi/imaging/hd/renderIndex.h"
+#include "wabi/imaging/hd/rendererPluginRegistry.h"
+#include "wabi/imaging/hd/tokens.h"
+#include "wabi/imaging/hdx/renderSetupTask.h"
+#include "wabi/imaging/hdx/renderTask.h"
+#include "wabi/imaging/hdx/taskController.h"
+
+#include "wabi/base/gf/bbox3d.h"
+#include "wabi/base/gf/frustum.h"
+#include "wabi/base/gf/matrix4d.h"
+#include "wabi/base/gf/rotation.h"
+#include "wabi/base/js/json.h"
+#include "wabi/base/tf/errorMark.h"
+#include "wabi/base/tf/stringUtils.h"
+#include "wabi/base/vt/dictionary.h"
+#include "wabi/base/work/threadLimits.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+WABI_NAMESPACE_USING
+
+namespace
+{
+
+  struct _Options
+  {
+    std::string stagePath;
+    int numCubes = 10;
+    int numFrames = 4;
+    int width = 256;
+    int height = 256;
+    int samples = 16;
+    std::vector<int> tileSizes = {8, 16, 32};
+    std::vector<int> threads = {1, 0};
+    std::string outPath;
+  };
+
+  struct _FrameStats
+  {
+    double raysPerSecond = 0.0;
+    double timeToFirstPixel = 0.0;
+    double renderTime = 0.0;
+    std::vector<double> sampleTimes;
+  };
+
+}  // namespace
+
+static std::vector<int> _ParseIntList(const std::string &s)
+{
+  std::vector<int> result;
+  for (const std::string &item : TfStringSplit(s, ",")) {
+    result.push_back(std::atoi(item.c_str()));
+  }
+  return result;
+}
+
+static bool _ParseArgs(int argc, char *argv[], _Options *options)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 == argc) {
+      std::cerr << "Missing value for " << arg << "\n";
+      return false;
+    }
+    const std::string value = argv[++i];
+    if (arg == "--stage") {
+      options->stagePath = value;
+    } else if (arg == "--cubes") {
+      options->numCubes = std::atoi(value.c_str());
+    } else if (arg == "--frames") {
+      options->numFrames = std::atoi(value.c_str());
+    } else if (arg == "--width") {
+      options->width = std::atoi(value.c_str());
+    } else if (arg == "--height") {
+      options->height = std::atoi(value.c_str());
+    } else if (arg == "--samples") {
+      options->samples = std::atoi(value.c_str());
+    } else if (arg == "--tileSizes") {
+      options->tileSizes = _ParseIntList(value);
+    } else if (arg == "--threads") {
+      options->threads = _ParseIntList(value);
+    } else if (arg == "--out") {
+      options->outPath = value;
+    } else {
+      std::cerr << "Unknown option " << arg << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Build a numCubes x numCubes grid of cube meshes.
+static UsdStageRefPtr _CreateCubeGrid(int numCubes)
+{
+  UsdStageRefPtr stage = UsdStage::CreateInMemory();
+
+  const VtVec3fArray points = {GfVec3f(-0.4f, -0.4f, 0.4f),
+                               GfVec3f(0.4f, -0.4f, 0.4f),
+                               GfVec3f(-0.4f, 0.4f, 0.4f),
+                               GfVec3f(0.4f, 0.4f, 0.4f),
+                               GfVec3f(-0.4f, 0.4f, -0.4f),
+                               GfVec3f(0.4f, 0.4f, -0.4f),
+                               GfVec3f(-0.4f, -0.4f, -0.4f),
+                               GfVec3f(0.4f, -0.4f, -0.4f)};
+  const VtIntArray faceVertexCounts = {4, 4, 4, 4, 4, 4};
+  const VtIntArray faceVertexIndices = {0, 1, 3, 2, 2, 3, 5, 4, 4, 5, 7, 6,
+                                        6, 7, 1, 0, 1, 7, 5, 3, 6, 0, 2, 4};
+  const VtVec3fArray extent = {GfVec3f(-0.4f), GfVec3f(0.4f)};
+
+  for (int y = 0; y < numCubes; ++y) {
+    for (int x = 0; x < numCubes; ++x) {
+      UsdGeomMesh mesh = UsdGeomMesh::Define(
+        stage, SdfPath(TfStringPrintf("/Grid/Cube_%d_%d", x, y)));
+      mesh.CreatePointsAttr(VtValue(points));
+      mesh.CreateFaceVertexCountsAttr(VtValue(faceVertexCounts));
+      mesh.CreateFaceVertexIndicesAttr(VtValue(faceVertexIndices));
+      mesh.CreateExtentAttr(VtValue(extent));
+      UsdGeomXformCommonAPI(mesh).SetTranslate(
+        GfVec3d(x - 0.5 * (numCubes - 1), y - 0.5 * (numCubes - 1), 0.0));
+    }
+  }
+  return stage;
+}
+
+// Return the view matrix for \p frame of a camera orbiting the stage bounds.
+static GfMatrix4d _GetViewMatrix(const GfRange3d &bounds, int frame, int numFrames)
+{
+  const GfVec3d center = bounds.GetMidpoint();
+  const double radius = bounds.IsEmpty() ? 1.0 : 0.5 * bounds.GetSize().GetLength();
+  const double angle = 360.0 * frame / std::max(numFrames, 1);
+  const GfVec3d offset = GfRotation(GfVec3d::YAxis(), angle).TransformDir(
+    GfVec3d(0.0, 0.5 * radius, 2.5 * radius));
+  return GfMatrix4d().SetLookAt(center + offset, center, GfVec3d::YAxis());
+}
+
+static GfMatrix4d _GetProjectionMatrix(const GfRange3d &bounds, const _Options &options)
+{
+  const double radius = bounds.IsEmpty() ? 1.0 : 0.5 * bounds.GetSize().GetLength();
+  GfFrustum frustum;
+  frustum.SetPerspective(45.0, double(options.width) / options.height, 0.01 * radius, 10 * radius);
+  return frustum.ComputeProjectionMatrix();
+}
+
+static double _GetDouble(const VtDictionary &stats, const std::string &key)
+{
+  const auto it = stats.find(key);
+  return it != stats.end() && it->second.IsHolding<double>() ? it->second.UncheckedGet<double>() :
+                                                               0.0;
+}
+
+static _FrameStats _GetFrameStats(const HdRenderDelegate *renderDelegate)
+{
+  const VtDictionary stats = renderDelegate->GetRenderStats();
+
+  _FrameStats frameStats;
+  frameStats.raysPerSecond = _GetDouble(stats, "raysPerSecond");
+  frameStats.timeToFirstPixel = _GetDouble(stats, "timeToFirstPixel");
+  frameStats.renderTime = _GetDouble(stats, "renderTime");
+  const auto it = stats.find("sampleTimes");
+  if (it != stats.end() && it->second.IsHolding<VtDoubleArray>()) {
+    const VtDoubleArray &sampleTimes = it->second.UncheckedGet<VtDoubleArray>();
+    frameStats.sampleTimes.assign(sampleTimes.begin(), sampleTimes.end());
+  }
+  return frameStats;
+}
+
+static double _Mean(const std::vector<_FrameStats> &frames, double _FrameStats::*member)
+{
+  double sum = 0.0;
+  for (const _FrameStats &frame : frames) {
+    sum += frame.*member;
+  }
+  return frames.empty() ? 0.0 : sum / frames.size();
+}
+
+// The mean time at which each sample pass completed.
+static std::vector<double> _MeanSampleTimes(const std::vector<_FrameStats> &frames)
+{
+  std::vector<double> result;
+  std::vector<int> counts;
+  for (const _FrameStats &frame : frames) {
+    if (frame.sampleTimes.size() > result.size()) {
+      result.resize(frame.sampleTimes.size(), 0.0);
+      counts.resize(frame.sampleTimes.size(), 0);
+    }
+    for (size_t i = 0; i < frame.sampleTimes.size(); ++i) {
+      result[i] += frame.sampleTimes[i];
+      ++counts[i];
+    }
+  }
+  for (size_t i = 0; i < result.size(); ++i) {
+    result[i] /= counts[i];
+  }
+  return result;
+}
+
+// Render the frames for one tile size and thread count, returning false if
+// the renderer stopped making progress.
+static bool _RenderFrames(const _Options &options,
+                          const GfRange3d &bounds,
+                          HdRenderIndex *renderIndex,
+                          HdxTaskController *taskController,
+                          HdEngine *engine,
+                          std::vector<_FrameStats> *frames)
+{
+  // Only run the tasks that drive the render delegate; the remaining tasks
+  // composite and present the result, which needs a GPU.
+  HdTaskSharedPtrVector tasks;
+  for (const HdTaskSharedPtr &task : taskController->GetRenderingTasks()) {
+    if (std::dynamic_pointer_cast<HdxRenderTask>(task) ||
+        std::dynamic_pointer_cast<HdxRenderSetupTask>(task)) {
+      tasks.push_back(task);
+    }
+  }
+
+  const GfMatrix4d projMatrix = _GetProjectionMatrix(bounds, options);
+
+  for (int frame = 0; frame < options.numFrames; ++frame) {
+    taskController->SetFreeCameraMatrices(_GetViewMatrix(bounds, frame, options.numFrames),
+                                          projMatrix);
+
+    const auto start = std::chrono::steady_clock::now();
+    do {
+      engine->Execute(renderIndex, &tasks);
+      if (std::chrono::steady_clock::now() - start > std::chrono::minutes(10)) {
+        std::cerr << "Timed out waiting for frame " << frame << " to converge\n";
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } while (!taskController->IsConverged());
+
+    frames->push_back(_GetFrameStats(renderIndex->GetRenderDelegate()));
+  }
+  return true;
+}
+
+static void _WriteFrameStats(JsWriter &js, const _FrameStats &frame)
+{
+  js.BeginObject();
+  js.WriteKeyValue("raysPerSecond", frame.raysPerSecond);
+  js.WriteKeyValue("timeToFirstPixel", frame.timeToFirstPixel);
+  js.WriteKeyValue("renderTime", frame.renderTime);
+  js.WriteKey("sampleTimes");
+  js.WriteArray(frame.sampleTimes);
+  js.EndObject();
+}
+
+int main(int argc, char *argv[])
+{
+  TfErrorMark mark;
+
+  _Options options;
+  if (!_ParseArgs(argc, argv, &options)) {
+    return EXIT_FAILURE;
+  }
+
+  UsdStageRefPtr stage = options.stagePath.empty() ? _CreateCubeGrid(options.numCubes) :
+                                                     UsdStage::Open(options.stagePath);
+  if (!stage) {
+    std::cerr << "Could not open stage " << options.stagePath << "\n";
+    return EXIT_FAILURE;
+  }
+
+  UsdGeomBBoxCache bboxCache(UsdTimeCode::Default(), {UsdGeomTokens->default_});
+  const GfRange3d bounds =
+    bboxCache.ComputeWorldBound(stage->GetPseudoRoot()).ComputeAlignedRange();
+
+  HdPluginRenderDelegateUniqueHandle renderDelegate =
+    HdRendererPluginRegistry::GetInstance().CreateRenderDelegate(
+      TfToken("HdEmbreeRendererPlugin"));
+  if (!renderDelegate) {
+    std::cerr << "Could not create the hdEmbree render delegate\n";
+    return EXIT_FAILURE;
+  }
+  renderDelegate->SetRenderSetting(HdRenderSettingsTokens->convergedSamplesPerPixel,
+                                   VtValue(options.samples));
+
+  std::unique_ptr<HdRenderIndex> renderIndex(HdRenderIndex::New(renderDelegate.Get(), {}));
+  std::unique_ptr<UsdImagingDelegate> sceneDelegate(
+    new UsdImagingDelegate(renderIndex.get(), SdfPath::AbsoluteRootPath()));
+  sceneDelegate->Populate(stage->GetPseudoRoot());
+  sceneDelegate->SetTime(UsdTimeCode::Default());
+
+  std::unique_ptr<HdxTaskController> taskController(
+    new HdxTaskController(renderIndex.get(), SdfPath("/HdEmbreeBenchmark")));
+  taskController->SetEnablePresentation(false);
+  taskController->SetRenderOutputs({HdAovTokens->color});
+  taskController->SetRenderBufferSize(GfVec2i(options.width, options.height));
+  taskController->SetRenderViewport(GfVec4d(0, 0, options.width, options.height));
+
+  HdEngine engine;
+
+  const int defaultThreads = int(WorkGetConcurrencyLimit());
+
+  std::ostream *out = &std::cout;
+  std::ofstream outFile;
+  if (!options.outPath.empty()) {
+    outFile.open(options.outPath);
+    out = &outFile;
+  }
+
+  bool success = true;
+
+  JsWriter js(*out, JsWriter::Style::Pretty);
+  js.BeginObject();
+  js.WriteKeyValue("stage", options.stagePath.empty() ? std::string("cubeGrid") :
+                                                        options.stagePath);
+  js.WriteKeyValue("width", options.width);
+  js.WriteKeyValue("height", options.height);
+  js.WriteKeyValue("samples", options.samples);
+  js.WriteKeyValue("frames", options.numFrames);
+  js.WriteKey("runs");
+  js.BeginArray();
+  for (const int threads : options.threads) {
+    const int numThreads = threads > 0 ? threads : defaultThreads;
+    WorkSetConcurrencyLimit(numThreads);
+
+    for (const int tileSize : options.tileSizes) {
+      renderDelegate->SetRenderSetting(TfToken("tileSize"), VtValue(tileSize));
+
+      std::vector<_FrameStats> frames;
+      success &= _RenderFrames(
+        options, bounds, renderIndex.get(), taskController.get(), &engine, &frames);
+
+      js.BeginObject();
+      js.WriteKeyValue("tileSize", tileSize);
+      js.WriteKeyValue("numThreads", numThreads);
+      js.WriteKeyValue("raysPerSecond", _Mean(frames, &_FrameStats::raysPerSecond));
+      js.WriteKeyValue("timeToFirstPixel", _Mean(frames, &_FrameStats::timeToFirstPixel));
+      js.WriteKeyValue("renderTime", _Mean(frames, &_FrameStats::renderTime));
+      js.WriteKey("convergence");
+      js.WriteArray(_MeanSampleTimes(frames));
+      js.WriteKey("frameStats");
+      js.WriteArray(frames, _WriteFrameStats);
+      js.EndObject();
+    }
+  }
+  js.EndArray();
+  js.EndObject();
+  *out << std::endl;
+
+  // Tear down in dependency order.
+  taskController.reset();
+  sceneDelegate.reset();
+  renderIndex.reset();
+
+  return success && mark.IsClean() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -65,7 +65,14 @@ def _CheckCompliance(rootLayer, arkit=False):
             _Err(msg)
     return len(errors) == 0 and len(failedChecks) == 0
 
-def _CreateUsdzPackage(usdzFile, filesToAdd, recurse, checkCompliance, verbose):
+def _CompressionMethod(f, compressExtensions):
+    ext = os.path.splitext(f)[1].lstrip('.').lower()
+    if ext in compressExtensions:
+        return Usd.ZipFile.CompressionMethodDeflate
+    return Usd.ZipFile.CompressionMethodNone
+
+def _CreateUsdzPackage(usdzFile, filesToAdd, recurse, checkCompliance, verbose,
+                       compressExtensions):
     with Usd.ZipFileWriter.CreateNew(usdzFile) as usdzWriter:
         fileList = []
         while filesToAdd:
@@ -98,7 +105,8 @@ def _CreateUsdzPackage(usdzFile, filesToAdd, recurse, checkCompliance, verbose):
 
         for f in fileList:
             try:
-                usdzWriter.AddFile(f)
+                usdzWriter.AddFile(f, compressionMethod=
+                                   _CompressionMethod(f, compressExtensions))
             except Tf.ErrorException as e:
                 _Err('Failed to add file \'%s\' to package. Discarding '
                     'package.' % f)
@@ -161,6 +169,16 @@ def main():
                         'layer fails any of the compliance checks, the package '
                         'is not created and the program fails.')
 
+    parser.add_argument('--compress', dest='compress', type=str,
+                        default='', metavar='EXT[,EXT...]',
+                        help='Comma-separated list of file extensions (e.g. '
+                        '\'usda,usdc\') of input files to store with deflate '
+                        'compression. Files that do not get smaller are '
+                        'stored uncompressed. Note that compressed packages '
+                        'do not conform to the usdz specification and can '
+                        'only be read by readers that support '
+                        'decompression.')
+
     parser.add_argument('-l', '--list', dest='listTarget', type=str, 
                         nargs='?', default=None, const='-',
                         help='List contents of the specified usdz file. If '
@@ -192,6 +210,14 @@ def main():
         parser.error("Specify either inputFiles or an asset (via --asset or "
                      "--arkitAsset, not both.")
 
+    elif (args.arkitAsset or args.asset) and args.compress:
+        parser.error("--compress is only supported when creating a package "
+                     "from inputFiles.")
+
+    compressExtensions = set(
+        ext.strip().lstrip('.').lower() for ext in args.compress.split(',')
+        if ext.strip())
+
     # If usdzFile is not specified directly as an argument, check if it has been
     # specified as an argument to the --list or --dump options. In these cases,
     # output the list or the contents to stdout.
@@ -240,7 +266,8 @@ def main():
     success = True
     if len(inputFiles) > 0:
         success = _CreateUsdzPackage(usdzFile, inputFiles, args.recurse, 
-                args.checkCompliance, args.verbose) and success
+                args.checkCompliance, args.verbose,
+                compressExtensions) and success
 
     elif args.asset:
         r = Ar.GetResolver()
@@ -35,6 +35,7 @@
 #include "wabi/usd/pcp/node_Iterator.h"
 #include "wabi/usd/pcp/pathTranslation.h"
 #include "wabi/usd/pcp/primIndex.h"
+#include "wabi/usd/pcp/primIndexDiskCache.h"
 #include "wabi/usd/pcp/propertyIndex.h"
 #include "wabi/usd/pcp/statistics.h"
 #include "wabi/usd/pcp/targetIndex.h"
@@ -47,6 +48,7 @@
 #include "wabi/base/trace/trace.h"
 #include "wabi/base/work/dispatcher.h"
 #include "wabi/base/work/loops.h"
+#include "wabi/base/work/threadLimits.h"
 #include "wabi/base/work/utils.h"
 #include "wabi/base/work/withScopedParallelism.h"
 #include "wabi/base/tf/enum.h"
@@ -72,6 +74,21 @@ TF_DEFINE_ENV_SETTING(
     PCP_CULLING, true,
     "Controls whether culling is enabled in Pcp caches.");
 
+TF_DEFINE_ENV_SETTING(
+    PCP_ENABLE_DEPENDENCY_PREFETCH, false,
+    "Enables speculative, parallel opening of the layers a stage depends "
+    "on while the stage is being composed.");
+
+TF_DEFINE_ENV_SETTING(
+    PCP_DEPENDENCY_PREFETCH_MAX_IN_FLIGHT, 16,
+    "Maximum number of layers opened concurrently by dependency prefetch.");
+
+TF_DEFINE_ENV_SETTING(
+    PCP_PRIM_INDEX_DISK_CACHE_DIR, "",
+    "Directory in which to persist composed prim indexes so they can be "
+    "restored rather than recomposed the next time the same layers are "
+    "opened.  Disabled if empty.");
+
 // Helper for applying changes immediately if the client hasn't asked that
 // they only be collected instead.
 class Pcp_CacheChangesHelper
@@ -132,6 +149,10 @@ PcpCache::~PcpCache()
   // we'll deadlock.  Dropping the GIL here prevents this.
   TF_PY_ALLOW_THREADS_IN_SCOPE();
 
+  // Stop any layer prefetching before tearing anything else down.
+  _layerPrefetcher.reset();
+  _primIndexDiskCache.reset();
+
   // Clear the layer stack before destroying the registry, so
   // that it can safely unregister itself.
   TfReset(_layerStack);
@@ -384,11 +405,87 @@ PcpPrimIndexInputs PcpCache::GetPrimIndexInputs()
     .FileFormatTarget(_fileFormatTarget);
 }
 
+void PcpCache::PrefetchLayerDependencies(bool includePayloads)
+{
+  if (_layerPrefetcher || !TfGetEnvSetting(PCP_ENABLE_DEPENDENCY_PREFETCH) ||
+      !WorkHasConcurrency()) {
+    return;
+  }
+
+  TRACE_FUNCTION();
+
+  const int maxInFlight = TfGetEnvSetting(PCP_DEPENDENCY_PREFETCH_MAX_IN_FLIGHT);
+  _layerPrefetcher.reset(new PcpLayerDependencyPrefetcher(_fileFormatTarget,
+                                                          _layerStackIdentifier.pathResolverContext,
+                                                          _rootLayer,
+                                                          GetMutedLayers(),
+                                                          includePayloads,
+                                                          std::max(maxInFlight, 1)));
+  if (_sessionLayer) {
+    _layerPrefetcher->Prefetch(_sessionLayer);
+  }
+  _layerPrefetcher->Prefetch(_rootLayer);
+}
+
+PcpLayerDependencyPrefetchStats PcpCache::ReleasePrefetchedLayers()
+{
+  if (!_layerPrefetcher) {
+    return PcpLayerDependencyPrefetchStats();
+  }
+
+  // The prefetcher itself is kept alive, since it retains value clip
+  // manifests for later use.
+  const PcpLayerDependencyPrefetchStats stats = _layerPrefetcher->Release();
+
+  TF_DEBUG(PCP_LAYER_PREFETCH)
+    .Msg(
+      "PcpCache: prefetched dependencies of @%s@: %zu requested, %zu opened, "
+      "%zu failed, %zu cancelled, %zu used by composition (%.1f%% hit rate), "
+      "%.3f s spent opening layers\n",
+      _rootLayer->GetIdentifier().c_str(),
+      stats.requested,
+      stats.opened,
+      stats.failed,
+      stats.cancelled,
+      stats.hits,
+      stats.opened ? 100.0 * stats.hits / stats.opened : 0.0,
+      stats.openSeconds);
+
+  return stats;
+}
+
+void PcpCache::OpenPrimIndexDiskCache()
+{
+  if (_primIndexDiskCache) {
+    return;
+  }
+
+  const std::string filePath = Pcp_PrimIndexDiskCache::GetCacheFilePath(
+    *this, TfGetEnvSetting(PCP_PRIM_INDEX_DISK_CACHE_DIR));
+  if (!filePath.empty()) {
+    _primIndexDiskCache.reset(new Pcp_PrimIndexDiskCache(this, filePath));
+  }
+}
+
+void PcpCache::ClosePrimIndexDiskCache()
+{
+  if (_primIndexDiskCache) {
+    _primIndexDiskCache->Write();
+    _primIndexDiskCache.reset();
+  }
+}
+
 PcpLayerStackRefPtr PcpCache::ComputeLayerStack(const PcpLayerStackIdentifier &id,
                                                 PcpErrorVector *allErrors)
 {
   PcpLayerStackRefPtr result = _layerStackCache->FindOrCreate(id, allErrors);
 
+  // Record the layer stack as a dependency of the prim index being
+  // restored from or persisted to disk, if any.
+  if (_primIndexDiskCache) {
+    Pcp_PrimIndexDiskCache::NoteLayerStackComputed(result);
+  }
+
   // Retain the cache's root layer stack.
   if (!_layerStack && id == GetLayerStackIdentifier()) {
     _layerStack = result;
@@ -849,6 +946,10 @@ void PcpCache::Apply(const PcpCacheChanges &changes, PcpLifeboat *lifeboat)
 {
   TRACE_FUNCTION();
 
+  // Prim indexes recomposed after changes no longer reflect the layers on
+  // disk, so stop persisting them.
+  _primIndexDiskCache.reset();
+
   // Check for special case of blowing everything.
   if (changes.didChangeSignificantly.count(SdfPath::AbsoluteRootPath())) {
     // Clear everything for scene graph objects.
@@ -1279,8 +1380,15 @@ struct PcpCache::_ParallelIndexer
 
       TF_VERIFY(parentIndex || path == SdfPath::AbsoluteRootPath());
 
-      // Run indexing.
-      PcpComputePrimIndex(path, _layerStack, inputs, &outputs, &_resolver);
+      // Restore the index from disk if possible, otherwise run indexing.
+      Pcp_PrimIndexDiskCache *diskCache = _cache->_primIndexDiskCache.get();
+      if (!diskCache || !diskCache->Restore(path, inputs, &outputs)) {
+        Pcp_PrimIndexDiskCache::DependencyRecorder recorder(diskCache);
+        PcpComputePrimIndex(path, _layerStack, inputs, &outputs, &_resolver);
+        if (diskCache) {
+          diskCache->Record(path, outputs, recorder);
+        }
+      }
 
       // Append any errors.
       if (!outputs.allErrors.empty()) {
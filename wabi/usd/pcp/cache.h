@@ -28,6 +28,7 @@
 #include "wabi/usd/pcp/api.h"
 #include "wabi/usd/pcp/dependency.h"
 #include "wabi/usd/pcp/errors.h"
+#include "wabi/usd/pcp/layerPrefetchRequest.h"
 #include "wabi/usd/pcp/mapFunction.h"
 #include "wabi/usd/pcp/primIndex.h"
 #include "wabi/usd/pcp/propertyIndex.h"
@@ -56,6 +57,7 @@ class PcpLayerStackIdentifier;
 class PcpLifeboat;
 class PcpNodeRef;
 class PcpMapFunction;
+class Pcp_PrimIndexDiskCache;
 
 TF_DECLARE_WEAK_AND_REF_PTRS(PcpLayerStack);
 TF_DECLARE_WEAK_AND_REF_PTRS(Pcp_LayerStackRegistry);
@@ -253,6 +255,54 @@ class PcpCache
 
   /// @}
 
+  /// \name Layer prefetching
+  /// @{
+
+  /// Begin speculatively opening, in the background, the layers that this
+  /// cache's root and session layers depend on: sublayers, references,
+  /// value clip manifests and, if \p includePayloads is true, payloads.
+  /// This lets high-latency layer opens overlap rather than happen one at a
+  /// time as composition discovers them.  Prefetched layers are retained until
+  /// ReleasePrefetchedLayers() is called.
+  ///
+  /// Does nothing unless the PCP_ENABLE_DEPENDENCY_PREFETCH environment
+  /// setting is enabled, if there is no concurrency available, or if
+  /// prefetching has already been started.
+  PCP_API
+  void PrefetchLayerDependencies(bool includePayloads);
+
+  /// Stop prefetching layers and release prefetched layers that are not
+  /// otherwise in use.  Returns statistics about the prefetch, including
+  /// how many prefetched layers were used.
+  PCP_API
+  PcpLayerDependencyPrefetchStats ReleasePrefetchedLayers();
+
+  /// @}
+
+  /// \name Persistent prim index cache
+  /// @{
+
+  /// Begin restoring prim indexes computed by ComputePrimIndexesInParallel()
+  /// from the on-disk cache written for this cache's layer stack, resolver
+  /// context, muted layers and variant fallbacks.  A cached prim index is
+  /// only restored if none of the layers it was composed from have changed
+  /// since it was written, and if its parent's prim index was restored;
+  /// other prim indexes are composed as usual.
+  ///
+  /// Does nothing unless the PCP_PRIM_INDEX_DISK_CACHE_DIR environment
+  /// setting names a directory, and unless this is a USD mode cache with a
+  /// root layer that is not anonymous.
+  PCP_API
+  void OpenPrimIndexDiskCache();
+
+  /// Stop using the on-disk prim index cache, first writing the prim
+  /// indexes computed since OpenPrimIndexDiskCache() back to it if any of
+  /// them could not be restored.
+  PCP_API
+  void ClosePrimIndexDiskCache();
+
+  /// @}
+
   /// \name Computations
   /// @{
 
@@ -766,6 +816,12 @@ class PcpCache
 
   // Parallel indexer state.
   std::unique_ptr<_ParallelIndexer> _parallelIndexer;
+
+  // Speculative layer dependency prefetch state.
+  std::unique_ptr<PcpLayerDependencyPrefetcher> _layerPrefetcher;
+
+  // On-disk prim index cache state.
+  std::unique_ptr<Pcp_PrimIndexDiskCache> _primIndexDiskCache;
 };
 
 WABI_NAMESPACE_END
@@ -35,6 +35,8 @@ TF_REGISTRY_FUNCTION(TfDebug)
 {
   TF_DEBUG_ENVIRONMENT_SYMBOL(PCP_CHANGES, "Pcp change processing");
   TF_DEBUG_ENVIRONMENT_SYMBOL(PCP_DEPENDENCIES, "Pcp dependencies");
+  TF_DEBUG_ENVIRONMENT_SYMBOL(PCP_LAYER_PREFETCH, "Pcp layer dependency prefetch");
+  TF_DEBUG_ENVIRONMENT_SYMBOL(PCP_PRIM_INDEX_DISK_CACHE, "Pcp persistent prim index cache");
 
   TF_DEBUG_ENVIRONMENT_SYMBOL(PCP_PRIM_INDEX,
                               "Print debug output to terminal during prim indexing");
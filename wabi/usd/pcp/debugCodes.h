@@ -33,7 +33,9 @@ TF_DEBUG_CODES(
 
   PCP_CHANGES,
   PCP_DEPENDENCIES,
+  PCP_LAYER_PREFETCH,
   PCP_PRIM_INDEX,
+  PCP_PRIM_INDEX_DISK_CACHE,
   PCP_PRIM_INDEX_GRAPHS,
   PCP_NAMESPACE_EDIT
 
@@ -25,12 +25,30 @@
 #include "wabi/wabi.h"
 #include "wabi/usd/pcp/layerPrefetchRequest.h"
 #include "wabi/usd/pcp/layerStackRegistry.h"
+#include "wabi/usd/pcp/utils.h"
+#include "wabi/usd/ar/resolverContext.h"
+#include "wabi/usd/ar/resolverContextBinder.h"
+#include "wabi/usd/sdf/assetPath.h"
+#include "wabi/usd/sdf/layerUtils.h"
+#include "wabi/usd/sdf/listOp.h"
+#include "wabi/usd/sdf/payload.h"
+#include "wabi/usd/sdf/reference.h"
+#include "wabi/usd/sdf/schema.h"
+#include "wabi/base/tf/errorMark.h"
+#include "wabi/base/tf/staticTokens.h"
+#include "wabi/base/tf/stopwatch.h"
+#include "wabi/base/trace/trace.h"
+#include "wabi/base/vt/array.h"
+#include "wabi/base/vt/dictionary.h"
 #include "wabi/base/work/dispatcher.h"
 #include "wabi/base/work/threadLimits.h"
 #include "wabi/base/work/withScopedParallelism.h"
 
 #include <tbb/spin_mutex.h>
 
+#include <deque>
+#include <unordered_set>
+
 WABI_NAMESPACE_BEGIN
 
 namespace
@@ -122,4 +140,291 @@ void PcpLayerPrefetchRequest::Run(const Pcp_MutedLayers &mutedLayers)
   });
 }
 
+////////////////////////////////////////////////////////////////////////
+// PcpLayerDependencyPrefetcher
+
+// Value clip metadata is defined by usd, which pcp cannot depend on, so the
+// field and dictionary keys are spelled out here.
+TF_DEFINE_PRIVATE_TOKENS(_tokens, (clips)(manifestAssetPath));
+
+namespace
+{
+
+  struct _PrefetchItem
+  {
+    std::string path;
+    SdfLayer::FileFormatArguments args;
+    bool isClipManifest;
+  };
+
+  template<class T> void _ForEachListOpItem(const SdfListOp<T> &listOp, const std::function<void(const T &)> &fn)
+  {
+    if (listOp.IsExplicit()) {
+      for (const T &item : listOp.GetExplicitItems()) {
+        fn(item);
+      }
+      return;
+    }
+    for (const T &item : listOp.GetAddedItems()) {
+      fn(item);
+    }
+    for (const T &item : listOp.GetPrependedItems()) {
+      fn(item);
+    }
+    for (const T &item : listOp.GetAppendedItems()) {
+      fn(item);
+    }
+  }
+
+}  // namespace
+
+struct PcpLayerDependencyPrefetcher::_Data
+{
+  _Data(const std::string &fileFormatTarget_,
+        const ArResolverContext &pathResolverContext_,
+        bool includePayloads_,
+        size_t maxInFlight_)
+    : fileFormatTarget(fileFormatTarget_),
+      pathResolverContext(pathResolverContext_),
+      includePayloads(includePayloads_),
+      maxInFlight(std::max<size_t>(maxInFlight_, 1))
+  {}
+
+  // Scan \p layer for asset paths and schedule them to be opened.
+  void Scan(const SdfLayerRefPtr &layer)
+  {
+    TRACE_FUNCTION();
+
+    std::vector<_PrefetchItem> items;
+    auto addItem = [this, &layer, &items](const std::string &assetPath, bool isClipManifest) {
+      if (assetPath.empty() || mutedLayers.IsLayerMuted(layer, assetPath)) {
+        return;
+      }
+      _PrefetchItem item;
+      item.path = SdfComputeAssetPathRelativeToLayer(layer, assetPath);
+      item.isClipManifest = isClipManifest;
+      if (!isClipManifest) {
+        item.args = Pcp_GetArgumentsForFileFormatTarget(item.path, fileFormatTarget);
+      }
+      items.push_back(std::move(item));
+    };
+
+    for (const std::string &sublayer : layer->GetSubLayerPaths()) {
+      addItem(sublayer, /* isClipManifest = */ false);
+    }
+
+    layer->Traverse(SdfPath::AbsoluteRootPath(), [&](const SdfPath &path) {
+      if (!path.IsPrimOrPrimVariantSelectionPath()) {
+        return;
+      }
+
+      SdfReferenceListOp references;
+      if (layer->HasField(path, SdfFieldKeys->References, &references)) {
+        _ForEachListOpItem<SdfReference>(references, [&](const SdfReference &ref) {
+          addItem(ref.GetAssetPath(), /* isClipManifest = */ false);
+        });
+      }
+
+      SdfPayloadListOp payloads;
+      if (includePayloads && layer->HasField(path, SdfFieldKeys->Payload, &payloads)) {
+        _ForEachListOpItem<SdfPayload>(payloads, [&](const SdfPayload &payload) {
+          addItem(payload.GetAssetPath(), /* isClipManifest = */ false);
+        });
+      }
+
+      // Only the manifests of value clips are prefetched.  The clip layers
+      // themselves are opened lazily, one per time sample range, and with
+      // per-frame clips there can be thousands of them.
+      VtDictionary clips;
+      if (layer->HasField(path, _tokens->clips, &clips)) {
+        for (const auto &clipSet : clips) {
+          if (!clipSet.second.IsHolding<VtDictionary>()) {
+            continue;
+          }
+          const VtDictionary &clipInfo = clipSet.second.UncheckedGet<VtDictionary>();
+          auto it = clipInfo.find(_tokens->manifestAssetPath);
+          if (it != clipInfo.end() && it->second.IsHolding<SdfAssetPath>()) {
+            addItem(it->second.UncheckedGet<SdfAssetPath>().GetAssetPath(),
+                    /* isClipManifest = */ true);
+          }
+        }
+      }
+    });
+
+    tbb::spin_mutex::scoped_lock lock(mutex);
+    for (_PrefetchItem &item : items) {
+      if (seen.insert(SdfLayer::CreateIdentifier(item.path, item.args)).second) {
+        ++stats.requested;
+        pending.push_back(std::move(item));
+      }
+    }
+    _ScheduleLocked();
+  }
+
+  // Start opening pending items until the in-flight limit is reached.  The
+  // caller must hold the mutex.
+  void _ScheduleLocked()
+  {
+    while (!stopped && inFlight < maxInFlight && !pending.empty()) {
+      ++inFlight;
+      dispatcher.Run([this, item = std::move(pending.front())]() {
+        _Open(item);
+      });
+      pending.pop_front();
+    }
+  }
+
+  void _Open(const _PrefetchItem &item)
+  {
+    // Bind the same resolver context composition will use so that the
+    // layers we open are the ones composition would find.
+    ArResolverContextBinder binder(pathResolverContext);
+
+    TfStopwatch stopwatch;
+    stopwatch.Start();
+
+    SdfLayerRefPtr layer;
+    {
+      // Errors are reported by composition when it opens the same layer.
+      TfErrorMark m;
+      layer = SdfLayer::FindOrOpen(item.path, item.args);
+      m.Clear();
+    }
+
+    stopwatch.Stop();
+
+    {
+      tbb::spin_mutex::scoped_lock lock(mutex);
+      --inFlight;
+      stats.openSeconds += stopwatch.GetSeconds();
+      if (layer) {
+        ++stats.opened;
+        (item.isClipManifest ? retainedClipManifests : retained).push_back(layer);
+      } else {
+        ++stats.failed;
+      }
+      if (!layer || stopped) {
+        _ScheduleLocked();
+        return;
+      }
+    }
+
+    // Clip manifests are scanned too, since they may sublayer or reference
+    // other layers of their own.
+    Scan(layer);
+  }
+
+  const std::string fileFormatTarget;
+  const ArResolverContext pathResolverContext;
+  Pcp_MutedLayers mutedLayers;
+  const bool includePayloads;
+  const size_t maxInFlight;
+
+  tbb::spin_mutex mutex;
+  std::unordered_set<std::string> seen;
+  std::deque<_PrefetchItem> pending;
+  size_t inFlight = 0;
+  bool stopped = false;
+  std::vector<SdfLayerRefPtr> retained;
+  std::vector<SdfLayerRefPtr> retainedClipManifests;
+  PcpLayerDependencyPrefetchStats stats;
+
+  // Declared last so that it is destroyed, and waited on, first.
+  WorkDispatcher dispatcher;
+};
+
+PcpLayerDependencyPrefetcher::PcpLayerDependencyPrefetcher(
+  const std::string &fileFormatTarget,
+  const ArResolverContext &pathResolverContext,
+  const SdfLayerHandle &anchorLayer,
+  std::vector<std::string> mutedLayers,
+  bool includePayloads,
+  size_t maxInFlight)
+  : _data(new _Data(fileFormatTarget, pathResolverContext, includePayloads, maxInFlight))
+{
+  std::vector<std::string> unmuted;
+  _data->mutedLayers.MuteAndUnmuteLayers(anchorLayer, &mutedLayers, &unmuted);
+}
+
+PcpLayerDependencyPrefetcher::~PcpLayerDependencyPrefetcher()
+{
+  // Dropping the layer RefPtrs may expire layers; see PcpCache::~PcpCache.
+  TF_PY_ALLOW_THREADS_IN_SCOPE();
+
+  {
+    tbb::spin_mutex::scoped_lock lock(_data->mutex);
+    _data->stopped = true;
+  }
+  _data->dispatcher.Wait();
+  _data.reset();
+}
+
+void PcpLayerDependencyPrefetcher::Prefetch(const SdfLayerHandle &layer)
+{
+  if (!layer) {
+    return;
+  }
+
+  SdfLayerRefPtr layerRef(layer);
+  _data->dispatcher.Run([this, layerRef]() {
+    _data->Scan(layerRef);
+  });
+}
+
+PcpLayerDependencyPrefetchStats PcpLayerDependencyPrefetcher::Release()
+{
+  TRACE_FUNCTION();
+
+  TF_PY_ALLOW_THREADS_IN_SCOPE();
+
+  {
+    tbb::spin_mutex::scoped_lock lock(_data->mutex);
+    _data->stopped = true;
+  }
+  _data->dispatcher.Wait();
+
+  std::vector<SdfLayerRefPtr> retained;
+  PcpLayerDependencyPrefetchStats stats;
+  {
+    tbb::spin_mutex::scoped_lock lock(_data->mutex);
+    retained.swap(_data->retained);
+    _data->stats.cancelled += _data->pending.size();
+    _data->pending.clear();
+
+    // A layer is a hit if something other than this prefetcher holds a
+    // reference to it, which for layers composition has used will be the
+    // layer stack.
+    for (const SdfLayerRefPtr &layer : retained) {
+      if (layer->GetCurrentCount() > 1) {
+        ++_data->stats.hits;
+      }
+    }
+    for (const SdfLayerRefPtr &layer : _data->retainedClipManifests) {
+      if (layer->GetCurrentCount() > 1) {
+        ++_data->stats.hits;
+      }
+    }
+    stats = _data->stats;
+  }
+
+  // Let unused layers expire in parallel, since closing many layers can
+  // take a while.
+  WorkWithScopedParallelism([&retained]() {
+    WorkDispatcher wd;
+    for (SdfLayerRefPtr &layer : retained) {
+      wd.Run([&layer]() {
+        layer.Reset();
+      });
+    }
+  });
+
+  return stats;
+}
+
+PcpLayerDependencyPrefetchStats PcpLayerDependencyPrefetcher::GetStats() const
+{
+  tbb::spin_mutex::scoped_lock lock(_data->mutex);
+  return _data->stats;
+}
+
 WABI_NAMESPACE_END
@@ -28,11 +28,15 @@
 #include "wabi/usd/pcp/api.h"
 #include "wabi/usd/sdf/layer.h"
 
+#include <memory>
 #include <set>
+#include <string>
 #include <utility>
+#include <vector>
 
 WABI_NAMESPACE_BEGIN
 
+class ArResolverContext;
 class Pcp_MutedLayers;
 
 /// \class PcpLayerPrefetchRequest
@@ -68,6 +72,91 @@ class PcpLayerPrefetchRequest
   std::set<SdfLayerRefPtr> _retainedLayers;
 };
 
+/// \struct PcpLayerDependencyPrefetchStats
+///
+/// Statistics describing the work done by a PcpLayerDependencyPrefetcher.
+///
+struct PcpLayerDependencyPrefetchStats
+{
+  /// Number of distinct layers scheduled to be opened.
+  size_t requested = 0;
+  /// Number of scheduled layers that were opened successfully.
+  size_t opened = 0;
+  /// Number of scheduled layers that failed to open.
+  size_t failed = 0;
+  /// Number of scheduled layers that were never opened because the
+  /// prefetcher was stopped first.
+  size_t cancelled = 0;
+  /// Number of opened layers that were also in use elsewhere, typically by
+  /// composition, when the prefetcher released them.
+  size_t hits = 0;
+  /// Total time in seconds spent opening layers across all threads.
+  double openSeconds = 0.0;
+};
+
+/// \class PcpLayerDependencyPrefetcher
+///
+/// PcpLayerDependencyPrefetcher speculatively opens the layers that a set
+/// of layers depend on -- sublayers, references, payloads and value clip
+/// manifests -- in the background, so that high-latency layer opens overlap
+/// each other and composition rather than happening one after another as
+/// composition discovers them.  Each opened layer is scanned in turn, so the prefetcher
+/// follows the whole dependency graph.
+///
+/// At most a bounded number of layers are opened concurrently.  Opened
+/// layers are retained by the prefetcher until Release() is called.  Errors
+/// encountered while opening layers are discarded; composition reports them
+/// when it opens the same layers.
+///
+class PcpLayerDependencyPrefetcher
+{
+ public:
+
+  /// Create a prefetcher that opens layers with \p pathResolverContext
+  /// bound, using file format arguments for \p fileFormatTarget.  Layers
+  /// listed in \p mutedLayers (canonical identifiers, anchored to
+  /// \p anchorLayer) are skipped, as are payloads unless
+  /// \p includePayloads is true.  At most \p maxInFlight layers are opened
+  /// at once.
+  PCP_API
+  PcpLayerDependencyPrefetcher(const std::string &fileFormatTarget,
+                               const ArResolverContext &pathResolverContext,
+                               const SdfLayerHandle &anchorLayer,
+                               std::vector<std::string> mutedLayers,
+                               bool includePayloads,
+                               size_t maxInFlight);
+
+  /// Stops prefetching, waits for in-flight opens to finish and releases
+  /// all retained layers.
+  PCP_API
+  ~PcpLayerDependencyPrefetcher();
+
+  PcpLayerDependencyPrefetcher(const PcpLayerDependencyPrefetcher &) = delete;
+  PcpLayerDependencyPrefetcher &operator=(const PcpLayerDependencyPrefetcher &) = delete;
+
+  /// Begin prefetching the dependencies of \p layer in the background.
+  /// Returns immediately.
+  PCP_API
+  void Prefetch(const SdfLayerHandle &layer);
+
+  /// Stop scheduling new layer opens, wait for in-flight opens to finish
+  /// and release the retained layers, except for value clip manifests, which
+  /// are opened lazily by clients after composition and so are retained
+  /// until the prefetcher is destroyed.  Returns the final statistics.
+  PCP_API
+  PcpLayerDependencyPrefetchStats Release();
+
+  /// Returns a snapshot of the current statistics.  Hits are only counted
+  /// by Release().
+  PCP_API
+  PcpLayerDependencyPrefetchStats GetStats() const;
+
+ private:
+
+  struct _Data;
+  std::unique_ptr<_Data> _data;
+};
+
 WABI_NAMESPACE_END
 
 #endif  // WABI_USD_PCP_LAYER_PREFETCH_REQUEST_H
@@ -0,0 +1,992 @@
+//
+// Copyright 2016 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "wabi/wabi.h"
+#include "wabi/usd/pcp/primIndexDiskCache.h"
+#include "wabi/usd/pcp/arc.h"
+#include "wabi/usd/pcp/cache.h"
+#include "wabi/usd/pcp/debugCodes.h"
+#include "wabi/usd/pcp/layerStack.h"
+#include "wabi/usd/pcp/layerStackIdentifier.h"
+#include "wabi/usd/pcp/mapExpression.h"
+#include "wabi/usd/pcp/mapFunction.h"
+#include "wabi/usd/pcp/node.h"
+#include "wabi/usd/pcp/primIndex.h"
+#include "wabi/usd/pcp/primIndex_Graph.h"
+#include "wabi/usd/ar/resolverContext.h"
+#include "wabi/usd/ar/resolverContextBinder.h"
+#include "wabi/usd/ar/timestamp.h"
+#include "wabi/usd/sdf/layer.h"
+#include "wabi/base/arch/fileSystem.h"
+#include "wabi/base/tf/atomicOfstreamWrapper.h"
+#include "wabi/base/tf/errorMark.h"
+#include "wabi/base/tf/pathUtils.h"
+#include "wabi/base/tf/stringUtils.h"
+#include "wabi/base/trace/trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+WABI_NAMESPACE_BEGIN
+
+namespace
+{
+
+  // Bump this whenever the file layout below changes.
+  constexpr char _fileMagic[] = "PCPIDXC";
+  constexpr uint32_t _fileVersion = 1;
+
+  constexpr uint32_t _invalidIndex = uint32_t(-1);
+
+  // Node flag bits.  The low two bits hold the node's SdfPermission.
+  enum _NodeFlags : uint8_t
+  {
+    _PermissionMask = 0x3,
+    _HasSymmetry = 1 << 2,
+    _Inert = 1 << 3,
+    _Culled = 1 << 4,
+    _Restricted = 1 << 5,
+    _HasSpecs = 1 << 6
+  };
+
+  thread_local Pcp_PrimIndexDiskCache::DependencyRecorder *_currentRecorder = nullptr;
+
+  // Serializes plain values into a byte buffer.  Paths are written as
+  // indexes into a path table that is written ahead of the data using them.
+  class _Writer
+  {
+   public:
+
+    void WriteU8(uint8_t v)
+    {
+      _buffer.push_back(char(v));
+    }
+
+    void WriteU32(uint32_t v)
+    {
+      _Append(&v, sizeof(v));
+    }
+
+    void WriteI32(int32_t v)
+    {
+      _Append(&v, sizeof(v));
+    }
+
+    void WriteDouble(double v)
+    {
+      _Append(&v, sizeof(v));
+    }
+
+    void WriteString(const std::string &s)
+    {
+      WriteU32(uint32_t(s.size()));
+      _Append(s.data(), s.size());
+    }
+
+    void WritePath(const SdfPath &path, TfHashMap<SdfPath, uint32_t, SdfPath::Hash> *pathTable)
+    {
+      const auto result = pathTable->emplace(path, uint32_t(pathTable->size()));
+      WriteU32(result.first->second);
+    }
+
+    const std::string &GetBuffer() const
+    {
+      return _buffer;
+    }
+
+   private:
+
+    void _Append(const void *data, size_t size)
+    {
+      _buffer.append(static_cast<const char *>(data), size);
+    }
+
+    std::string _buffer;
+  };
+
+  // Reads values written by _Writer.  Reads past the end of the data set
+  // the reader's failure state and return zeroed values.
+  class _Reader
+  {
+   public:
+
+    _Reader(const char *data, size_t size) : _cur(data), _end(data + size), _ok(true) {}
+
+    bool IsOk() const
+    {
+      return _ok;
+    }
+
+    bool AtEnd() const
+    {
+      return _cur == _end;
+    }
+
+    uint8_t ReadU8()
+    {
+      uint8_t v = 0;
+      _Read(&v, sizeof(v));
+      return v;
+    }
+
+    uint32_t ReadU32()
+    {
+      uint32_t v = 0;
+      _Read(&v, sizeof(v));
+      return v;
+    }
+
+    int32_t ReadI32()
+    {
+      int32_t v = 0;
+      _Read(&v, sizeof(v));
+      return v;
+    }
+
+    double ReadDouble()
+    {
+      double v = 0.0;
+      _Read(&v, sizeof(v));
+      return v;
+    }
+
+    std::string ReadString()
+    {
+      const uint32_t size = ReadU32();
+      if (!_ok || size_t(_end - _cur) < size) {
+        _ok = false;
+        return std::string();
+      }
+      std::string s(_cur, size);
+      _cur += size;
+      return s;
+    }
+
+    // Reads a count of elements that each occupy at least \p minElementSize
+    // bytes, failing if the remaining data cannot hold that many.
+    uint32_t ReadCount(size_t minElementSize)
+    {
+      const uint32_t count = ReadU32();
+      if (_ok && size_t(_end - _cur) / minElementSize < count) {
+        _ok = false;
+        return 0;
+      }
+      return count;
+    }
+
+    SdfPath ReadPath(const SdfPathVector &pathTable)
+    {
+      const uint32_t index = ReadU32();
+      if (index >= pathTable.size()) {
+        _ok = false;
+        return SdfPath();
+      }
+      return pathTable[index];
+    }
+
+   private:
+
+    void _Read(void *dst, size_t size)
+    {
+      if (!_ok || size_t(_end - _cur) < size) {
+        _ok = false;
+        return;
+      }
+      memcpy(dst, _cur, size);
+      _cur += size;
+    }
+
+    const char *_cur;
+    const char *_end;
+    bool _ok;
+  };
+
+  bool _GetAssetTimestamp(const SdfLayerHandle &layer, double *time)
+  {
+    const VtValue &timestamp = layer->GetAssetModificationTimestamp();
+    if (timestamp.IsHolding<ArTimestamp>() && timestamp.UncheckedGet<ArTimestamp>().IsValid()) {
+      *time = timestamp.UncheckedGet<ArTimestamp>().GetTime();
+      return true;
+    }
+    return false;
+  }
+
+  uint8_t _GetNodeFlags(const PcpNodeRef &node)
+  {
+    uint8_t flags = uint8_t(node.GetPermission()) & _PermissionMask;
+    if (node.HasSymmetry()) {
+      flags |= _HasSymmetry;
+    }
+    if (node.IsInert()) {
+      flags |= _Inert;
+    }
+    if (node.IsCulled()) {
+      flags |= _Culled;
+    }
+    if (node.IsRestricted()) {
+      flags |= _Restricted;
+    }
+    if (node.HasSpecs()) {
+      flags |= _HasSpecs;
+    }
+    return flags;
+  }
+
+  void _SetNodeFlags(PcpNodeRef node, uint8_t flags)
+  {
+    node.SetPermission(SdfPermission(flags & _PermissionMask));
+    node.SetHasSymmetry(flags & _HasSymmetry);
+    node.SetInert(flags & _Inert);
+    node.SetCulled(flags & _Culled);
+    node.SetRestricted(flags & _Restricted);
+    node.SetHasSpecs(flags & _HasSpecs);
+  }
+
+  bool _IsIncludedPayloadState(uint8_t payloadState)
+  {
+    return payloadState == PcpPrimIndexOutputs::IncludedByIncludeSet ||
+           payloadState == PcpPrimIndexOutputs::IncludedByPredicate;
+  }
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////
+
+Pcp_PrimIndexDiskCache::DependencyRecorder::DependencyRecorder(Pcp_PrimIndexDiskCache *diskCache)
+  : _previous(_currentRecorder),
+    _active(diskCache != nullptr)
+{
+  if (_active) {
+    _currentRecorder = this;
+  }
+}
+
+Pcp_PrimIndexDiskCache::DependencyRecorder::~DependencyRecorder()
+{
+  if (_active) {
+    _currentRecorder = _previous;
+  }
+}
+
+void Pcp_PrimIndexDiskCache::NoteLayerStackComputed(const PcpLayerStackRefPtr &layerStack)
+{
+  if (_currentRecorder && layerStack) {
+    _currentRecorder->_layerStacks.push_back(layerStack);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+std::string Pcp_PrimIndexDiskCache::_ComputeKey(const PcpCache &cache)
+{
+  // Everything other than layer contents that affects the prim indexes a
+  // cache computes.
+  const PcpLayerStackIdentifier &id = cache.GetLayerStackIdentifier();
+
+  _Writer w;
+  w.WriteU8(cache.IsUsd());
+  w.WriteString(cache.GetFileFormatTarget());
+  w.WriteString(id.rootLayer ? id.rootLayer->GetIdentifier() : std::string());
+  w.WriteU8(bool(id.sessionLayer));
+  w.WriteU8(id.sessionLayer && id.sessionLayer->IsAnonymous());
+  w.WriteString((id.sessionLayer && !id.sessionLayer->IsAnonymous()) ?
+                  id.sessionLayer->GetIdentifier() :
+                  std::string());
+  w.WriteString(id.pathResolverContext.GetDebugString());
+
+  const std::vector<std::string> &mutedLayers = cache.GetMutedLayers();
+  w.WriteU32(uint32_t(mutedLayers.size()));
+  for (const std::string &mutedLayer : mutedLayers) {
+    w.WriteString(mutedLayer);
+  }
+
+  const PcpVariantFallbackMap fallbacks = cache.GetVariantFallbacks();
+  w.WriteU32(uint32_t(fallbacks.size()));
+  for (const auto &fallback : fallbacks) {
+    w.WriteString(fallback.first);
+    w.WriteU32(uint32_t(fallback.second.size()));
+    for (const std::string &selection : fallback.second) {
+      w.WriteString(selection);
+    }
+  }
+
+  w.WriteU8(PcpIsTimeScalingForLayerTimeCodesPerSecondDisabled());
+  return w.GetBuffer();
+}
+
+std::string Pcp_PrimIndexDiskCache::GetCacheFilePath(const PcpCache &cache,
+                                                     const std::string &directory)
+{
+  const SdfLayerHandle &rootLayer = cache.GetLayerStackIdentifier().rootLayer;
+  if (directory.empty() || !cache.IsUsd() || !rootLayer || rootLayer->IsAnonymous()) {
+    return std::string();
+  }
+
+  const std::string fileName = TfStringPrintf("%016llx.pcpcache",
+                                              (unsigned long long)TfHash()(_ComputeKey(cache)));
+  return TfStringCatPaths(directory, fileName);
+}
+
+Pcp_PrimIndexDiskCache::Pcp_PrimIndexDiskCache(PcpCache *cache, const std::string &filePath)
+  : _cache(cache),
+    _filePath(filePath),
+    _numComputed(0)
+{
+  if (!_Read()) {
+    _persisted = _Tables();
+    _persistedEntries.clear();
+  }
+  _restoredLayerStacks.reset(new _RestoredLayerStack[_persisted.layerStacks.size()]);
+}
+
+Pcp_PrimIndexDiskCache::~Pcp_PrimIndexDiskCache() = default;
+
+bool Pcp_PrimIndexDiskCache::_Read()
+{
+  TRACE_FUNCTION();
+
+  std::string errMsg;
+  ArchConstFileMapping mapping = ArchMapFileReadOnly(_filePath, &errMsg);
+  if (!mapping) {
+    TF_DEBUG(PCP_PRIM_INDEX_DISK_CACHE)
+      .Msg("Pcp: no prim index cache at '%s': %s\n", _filePath.c_str(), errMsg.c_str());
+    return false;
+  }
+
+  _Reader r(mapping.get(), ArchGetFileMappingLength(mapping));
+
+  char magic[sizeof(_fileMagic)] = {};
+  for (char &c : magic) {
+    c = char(r.ReadU8());
+  }
+  if (!r.IsOk() || memcmp(magic, _fileMagic, sizeof(_fileMagic)) != 0 ||
+      r.ReadU32() != _fileVersion) {
+    TF_DEBUG(PCP_PRIM_INDEX_DISK_CACHE)
+      .Msg("Pcp: ignoring prim index cache '%s' with unknown format\n", _filePath.c_str());
+    return false;
+  }
+  if (r.ReadString() != _ComputeKey(*_cache)) {
+    TF_DEBUG(PCP_PRIM_INDEX_DISK_CACHE)
+      .Msg("Pcp: ignoring prim index cache '%s' written for different "
+           "composition inputs\n",
+           _filePath.c_str());
+    return false;
+  }
+
+  SdfPathVector pathTable(r.ReadCount(sizeof(uint32_t)));
+  for (SdfPath &path : pathTable) {
+    path = SdfPath(r.ReadString());
+  }
+
+  _persisted.layers.resize(r.ReadCount(2 * sizeof(uint32_t) + sizeof(double) + 1));
+  for (_Layer &layer : _persisted.layers) {
+    layer.identifier = r.ReadString();
+    layer.resolvedPath = r.ReadString();
+    layer.timestamp = r.ReadDouble();
+    layer.anonymous = r.ReadU8();
+  }
+
+  _persisted.layerStacks.resize(r.ReadCount(1 + 2 * sizeof(uint32_t)));
+  for (_LayerStack &layerStack : _persisted.layerStacks) {
+    layerStack.isCacheLayerStack = r.ReadU8();
+    layerStack.rootLayer = r.ReadString();
+    layerStack.layers.resize(r.ReadCount(sizeof(uint32_t)));
+    for (uint32_t &layer : layerStack.layers) {
+      layer = r.ReadU32();
+      if (layer >= _persisted.layers.size()) {
+        return false;
+      }
+    }
+  }
+
+  const size_t numLayerStacks = _persisted.layerStacks.size();
+  _persisted.entries.resize(r.ReadCount(3 + 3 * sizeof(uint32_t)));
+  for (_Entry &entry : _persisted.entries) {
+    entry.path = r.ReadPath(pathTable);
+    entry.hasPayloads = r.ReadU8();
+    entry.instanceable = r.ReadU8();
+    entry.payloadState = r.ReadU8();
+    entry.layerStacks.resize(r.ReadCount(sizeof(uint32_t)));
+    for (uint32_t &layerStack : entry.layerStacks) {
+      layerStack = r.ReadU32();
+      if (layerStack >= numLayerStacks) {
+        return false;
+      }
+    }
+
+    entry.nodes.resize(r.ReadCount(2 + 7 * sizeof(uint32_t) + 2 * sizeof(double)));
+    for (size_t i = 0; i != entry.nodes.size(); ++i) {
+      _Node &node = entry.nodes[i];
+      node.layerStack = r.ReadU32();
+      node.path = r.ReadPath(pathTable);
+      node.arcType = r.ReadU8();
+      node.flags = r.ReadU8();
+      node.parent = r.ReadI32();
+      node.origin = r.ReadI32();
+      node.siblingNumAtOrigin = r.ReadI32();
+      node.namespaceDepth = r.ReadI32();
+      node.mapToParent.resize(r.ReadCount(2 * sizeof(uint32_t)));
+      for (auto &pathPair : node.mapToParent) {
+        pathPair.first = r.ReadPath(pathTable);
+        pathPair.second = r.ReadPath(pathTable);
+      }
+      node.offset = r.ReadDouble();
+      node.scale = r.ReadDouble();
+
+      // Only the root node may be parentless, and parents and origins
+      // must refer to other nodes in the same entry.
+      const int32_t numNodes = int32_t(entry.nodes.size());
+      const bool isRoot = (i == 0);
+      if (node.layerStack >= numLayerStacks || node.arcType >= PcpNumArcTypes ||
+          (isRoot != (node.parent < 0)) || node.parent >= numNodes || node.origin >= numNodes ||
+          (!isRoot && node.parent == int32_t(i))) {
+        return false;
+      }
+    }
+    if (entry.nodes.empty() || !r.IsOk()) {
+      return false;
+    }
+  }
+
+  if (!r.IsOk() || !r.AtEnd()) {
+    TF_DEBUG(PCP_PRIM_INDEX_DISK_CACHE)
+      .Msg("Pcp: ignoring corrupt prim index cache '%s'\n", _filePath.c_str());
+    return false;
+  }
+
+  for (size_t i = 0; i != _persisted.entries.size(); ++i) {
+    _persistedEntries[_persisted.entries[i].path] = i;
+  }
+
+  TF_DEBUG(PCP_PRIM_INDEX_DISK_CACHE)
+    .Msg("Pcp: read %zu prim indexes from '%s'\n", _persisted.entries.size(), _filePath.c_str());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const PcpLayerStackRefPtr &Pcp_PrimIndexDiskCache::_GetRestoredLayerStack(uint32_t index)
+{
+  _RestoredLayerStack &restored = _restoredLayerStacks[index];
+  if (restored.restored) {
+    return restored.layerStack;
+  }
+
+  // Restoring a layer stack opens layers, which may wait on work that lets
+  // this thread pick up another task restoring the same layer stack, so no
+  // lock is held while restoring.  Threads that race here compute the same
+  // layer stack from the PcpCache; the first result is kept.
+  PcpLayerStackRefPtr layerStack = _RestoreLayerStack(_persisted.layerStacks[index]);
+
+  tbb::spin_mutex::scoped_lock lock(restored.mutex);
+  if (!restored.restored) {
+    restored.layerStack = std::move(layerStack);
+    restored.restored = true;
+  }
+  return restored.layerStack;
+}
+
+PcpLayerStackRefPtr Pcp_PrimIndexDiskCache::_RestoreLayerStack(
+  const _LayerStack &persistedLayerStack) const
+{
+  const PcpLayerStackIdentifier &cacheId = _cache->GetLayerStackIdentifier();
+
+  SdfLayerRefPtr rootLayer;
+  if (!persistedLayerStack.isCacheLayerStack) {
+    // Composition would have opened this layer with the cache's resolver
+    // context bound; errors opening it will be reported if the prim index
+    // is composed live instead.
+    ArResolverContextBinder binder(cacheId.pathResolverContext);
+    TfErrorMark m;
+    rootLayer = SdfLayer::FindOrOpen(persistedLayerStack.rootLayer);
+    m.Clear();
+    if (!rootLayer) {
+      return TfNullPtr;
+    }
+  }
+
+  PcpErrorVector errors;
+  PcpLayerStackRefPtr layerStack =
+    persistedLayerStack.isCacheLayerStack ?
+      _cache->ComputeLayerStack(cacheId, &errors) :
+      _cache->ComputeLayerStack(
+        PcpLayerStackIdentifier(rootLayer, SdfLayerHandle(), cacheId.pathResolverContext),
+        &errors);
+  if (!layerStack || !errors.empty() || !layerStack->GetLocalErrors().empty()) {
+    return TfNullPtr;
+  }
+
+  // Make sure the layer stack still consists of the same, unmodified
+  // layers.
+  const SdfLayerRefPtrVector &layers = layerStack->GetLayers();
+  if (layers.size() != persistedLayerStack.layers.size()) {
+    return TfNullPtr;
+  }
+  for (size_t i = 0; i != layers.size(); ++i) {
+    const SdfLayerRefPtr &layer = layers[i];
+    const _Layer &persistedLayer = _persisted.layers[persistedLayerStack.layers[i]];
+    double timestamp = 0.0;
+    const bool matches = persistedLayer.anonymous ?
+                           (layer->IsAnonymous() && layer->IsEmpty()) :
+                           (!layer->IsAnonymous() && !layer->IsDirty() &&
+                            layer->GetIdentifier() == persistedLayer.identifier &&
+                            layer->GetResolvedPath().GetPathString() ==
+                              persistedLayer.resolvedPath &&
+                            _GetAssetTimestamp(layer, &timestamp) &&
+                            timestamp == persistedLayer.timestamp);
+    if (!matches) {
+      TF_DEBUG(PCP_PRIM_INDEX_DISK_CACHE)
+        .Msg("Pcp: layer @%s@ changed since prim indexes were cached\n",
+             layer->GetIdentifier().c_str());
+      return TfNullPtr;
+    }
+  }
+  return layerStack;
+}
+
+bool Pcp_PrimIndexDiskCache::Restore(const SdfPath &path,
+                                     const PcpPrimIndexInputs &inputs,
+                                     PcpPrimIndexOutputs *outputs)
+{
+  const auto entryIt = _persistedEntries.find(path);
+  if (entryIt == _persistedEntries.end()) {
+    return false;
+  }
+
+  // A prim index depends on its parent's index, including on arcs that
+  // were culled from it, so it can only be reused if its parent was.
+  if (!path.IsAbsoluteRootPath()) {
+    tbb::spin_mutex::scoped_lock lock(_recordMutex);
+    if (!_restoredPaths.count(path.GetParentPath())) {
+      return false;
+    }
+  }
+
+  TRACE_FUNCTION();
+
+  const _Entry &entry = _persisted.entries[entryIt->second];
+  std::vector<PcpLayerStackRefPtr> layerStacks;
+  layerStacks.reserve(entry.layerStacks.size());
+  for (const uint32_t layerStack : entry.layerStacks) {
+    layerStacks.push_back(_GetRestoredLayerStack(layerStack));
+    if (!layerStacks.back()) {
+      return false;
+    }
+  }
+
+  // Make the same payload inclusion decision composition would, and make
+  // sure it matches the one the persisted index was composed with.
+  PcpPrimIndexOutputs::PayloadState payloadState = PcpPrimIndexOutputs::NoPayload;
+  if (entry.payloadState != PcpPrimIndexOutputs::NoPayload) {
+    if (!inputs.includedPayloads) {
+      return false;
+    }
+    bool included = false;
+    if (auto const &pred = inputs.includePayloadPredicate) {
+      included = pred(path);
+      payloadState = included ? PcpPrimIndexOutputs::IncludedByPredicate :
+                                PcpPrimIndexOutputs::ExcludedByPredicate;
+    } else {
+      tbb::spin_rw_mutex::scoped_lock lock;
+      if (inputs.includedPayloadsMutex) {
+        lock.acquire(*inputs.includedPayloadsMutex, /*write=*/false);
+      }
+      included = inputs.includedPayloads->count(path);
+      payloadState = included ? PcpPrimIndexOutputs::IncludedByIncludeSet :
+                                PcpPrimIndexOutputs::ExcludedByIncludeSet;
+    }
+    if (included != _IsIncludedPayloadState(entry.payloadState)) {
+      return false;
+    }
+  }
+
+  PcpPrimIndexOutputs restored;
+  if (!_RestoreGraph(entry, &restored)) {
+    TF_DEBUG(PCP_PRIM_INDEX_DISK_CACHE)
+      .Msg("Pcp: failed to restore cached prim index for <%s>\n", path.GetText());
+    return false;
+  }
+  restored.payloadState = payloadState;
+
+  _Record(path, restored, layerStacks, /* computed = */ false);
+
+  outputs->primIndex.Swap(restored.primIndex);
+  outputs->payloadState = payloadState;
+  return true;
+}
+
+bool Pcp_PrimIndexDiskCache::_RestoreGraph(const _Entry &entry, PcpPrimIndexOutputs *outputs)
+{
+  const size_t numNodes = entry.nodes.size();
+
+  const _Node &persistedRoot = entry.nodes.front();
+  const PcpLayerStackSite rootSite(_GetRestoredLayerStack(persistedRoot.layerStack),
+                                   persistedRoot.path);
+  if (!rootSite.layerStack) {
+    return false;
+  }
+  PcpPrimIndex_GraphRefPtr graph = PcpPrimIndex_Graph::New(rootSite, /* usd = */ true);
+
+  std::vector<PcpNodeRef> nodes(numNodes);
+  nodes[0] = graph->GetRootNode();
+  _SetNodeFlags(nodes[0], persistedRoot.flags);
+
+  // Nodes are persisted in strength order, but a node's origin may be
+  // weaker than the node itself, so insert each node once its parent and
+  // origin are in the graph.  Children are inserted in strength order, so
+  // the finalized graph has the same node order as the persisted one.
+  size_t numInserted = 1;
+  while (numInserted != numNodes) {
+    const size_t numInsertedBefore = numInserted;
+    for (size_t i = 1; i != numNodes; ++i) {
+      const _Node &persistedNode = entry.nodes[i];
+      if (nodes[i] || !nodes[persistedNode.parent] ||
+          (persistedNode.origin >= 0 && !nodes[persistedNode.origin])) {
+        continue;
+      }
+
+      const PcpLayerStackSite site(_GetRestoredLayerStack(persistedNode.layerStack),
+                                   persistedNode.path);
+      if (!site.layerStack) {
+        return false;
+      }
+
+      PcpMapFunction::PathMap pathMap(persistedNode.mapToParent.begin(),
+                                      persistedNode.mapToParent.end());
+
+      PcpArc arc;
+      arc.type = PcpArcType(persistedNode.arcType);
+      arc.parent = nodes[persistedNode.parent];
+      if (persistedNode.origin >= 0) {
+        arc.origin = nodes[persistedNode.origin];
+      }
+      arc.mapToParent = PcpMapExpression::Constant(
+        PcpMapFunction::Create(pathMap, SdfLayerOffset(persistedNode.offset, persistedNode.scale)));
+      arc.siblingNumAtOrigin = persistedNode.siblingNumAtOrigin;
+      arc.namespaceDepth = persistedNode.namespaceDepth;
+
+      PcpErrorBasePtr error;
+      nodes[i] = graph->InsertChildNode(arc.parent, site, arc, &error);
+      if (!nodes[i]) {
+        return false;
+      }
+      _SetNodeFlags(nodes[i], persistedNode.flags);
+      ++numInserted;
+    }
+    if (numInserted == numInsertedBefore) {
+      // The persisted parent and origin indexes form a cycle.
+      return false;
+    }
+  }
+
+  graph->SetHasPayloads(entry.hasPayloads);
+  graph->SetIsInstanceable(entry.instanceable);
+  graph->Finalize();
+
+  outputs->primIndex.SetGraph(graph);
+
+  // Verify that the graph came out in the persisted strength order.
+  size_t i = 0;
+  for (const PcpNodeRef &node : outputs->primIndex.GetNodeRange()) {
+    if (i == numNodes || node.GetPath() != entry.nodes[i].path ||
+        node.GetArcType() != PcpArcType(entry.nodes[i].arcType) ||
+        node.GetLayerStack() != _GetRestoredLayerStack(entry.nodes[i].layerStack)) {
+      return false;
+    }
+    ++i;
+  }
+  return i == numNodes;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void Pcp_PrimIndexDiskCache::Record(const SdfPath &path,
+                                    const PcpPrimIndexOutputs &outputs,
+                                    const DependencyRecorder &recorder)
+{
+  if (!outputs.allErrors.empty() || !outputs.dynamicFileFormatDependency.IsEmpty() ||
+      !outputs.primIndex.IsValid() || !outputs.primIndex.GetLocalErrors().empty()) {
+    return;
+  }
+  _Record(path, outputs, recorder.GetLayerStacks(), /* computed = */ true);
+}
+
+void Pcp_PrimIndexDiskCache::_Record(const SdfPath &path,
+                                     const PcpPrimIndexOutputs &outputs,
+                                     const std::vector<PcpLayerStackRefPtr> &dependencies,
+                                     bool computed)
+{
+  const PcpPrimIndex &index = outputs.primIndex;
+
+  _Entry entry;
+  entry.path = path;
+  entry.hasPayloads = index.HasAnyPayloads();
+  entry.instanceable = index.IsInstanceable();
+  entry.payloadState = uint8_t(outputs.payloadState);
+
+  // Build the entry's nodes, recording their layer stacks as indexes into
+  // a local table that is interned below.
+  std::vector<PcpLayerStackRefPtr> layerStacks;
+  auto getLocalLayerStackIndex = [&layerStacks](const PcpLayerStackRefPtr &layerStack) {
+    const auto it = std::find(layerStacks.begin(), layerStacks.end(), layerStack);
+    if (it != layerStacks.end()) {
+      return uint32_t(it - layerStacks.begin());
+    }
+    layerStacks.push_back(layerStack);
+    return uint32_t(layerStacks.size() - 1);
+  };
+
+  TfHashMap<PcpNodeRef, int32_t, TfHash> nodeIndexes;
+  for (const PcpNodeRef &node : index.GetNodeRange()) {
+    nodeIndexes[node] = int32_t(nodeIndexes.size());
+  }
+  auto getNodeIndex = [&nodeIndexes](const PcpNodeRef &node) {
+    const auto it = node ? nodeIndexes.find(node) : nodeIndexes.end();
+    return it != nodeIndexes.end() ? it->second : -1;
+  };
+
+  entry.nodes.reserve(nodeIndexes.size());
+  for (const PcpNodeRef &node : index.GetNodeRange()) {
+    _Node n;
+    n.layerStack = getLocalLayerStackIndex(node.GetLayerStack());
+    n.path = node.GetPath();
+    n.arcType = uint8_t(node.GetArcType());
+    n.flags = _GetNodeFlags(node);
+    n.parent = getNodeIndex(node.GetParentNode());
+    n.origin = getNodeIndex(node.GetOriginNode());
+    n.siblingNumAtOrigin = node.GetSiblingNumAtOrigin();
+    n.namespaceDepth = node.GetNamespaceDepth();
+
+    const PcpMapFunction &mapToParent = node.GetMapToParent().Evaluate();
+    const PcpMapFunction::PathMap pathMap = mapToParent.GetSourceToTargetMap();
+    n.mapToParent.assign(pathMap.begin(), pathMap.end());
+    n.offset = mapToParent.GetTimeOffset().GetOffset();
+    n.scale = mapToParent.GetTimeOffset().GetScale();
+
+    // Nodes whose origin was culled from the graph can't be restored.
+    if (node.GetOriginNode() && n.origin < 0) {
+      return;
+    }
+    entry.nodes.push_back(std::move(n));
+  }
+  for (const PcpLayerStackRefPtr &layerStack : dependencies) {
+    getLocalLayerStackIndex(layerStack);
+  }
+
+  tbb::spin_mutex::scoped_lock lock(_recordMutex);
+
+  if (!path.IsAbsoluteRootPath() && !_recordedPaths.count(path.GetParentPath())) {
+    return;
+  }
+
+  entry.layerStacks.resize(layerStacks.size());
+  for (size_t i = 0; i != layerStacks.size(); ++i) {
+    if (!_InternLayerStack(layerStacks[i], &entry.layerStacks[i])) {
+      return;
+    }
+  }
+  for (_Node &node : entry.nodes) {
+    node.layerStack = entry.layerStacks[node.layerStack];
+  }
+
+  _recordedPaths.insert(path);
+  if (computed) {
+    ++_numComputed;
+  } else {
+    _restoredPaths.insert(path);
+  }
+  _recorded.entries.push_back(std::move(entry));
+}
+
+bool Pcp_PrimIndexDiskCache::_InternLayerStack(const PcpLayerStackRefPtr &layerStack,
+                                               uint32_t *index)
+{
+  // Layer stacks are restored either as the cache's own layer stack or
+  // from their root layer alone, as for references and payloads, so they
+  // are keyed by their root layer's identifier or the empty string.
+  const PcpLayerStackIdentifier &id = layerStack->GetIdentifier();
+  const PcpLayerStackIdentifier &cacheId = _cache->GetLayerStackIdentifier();
+  _LayerStack info;
+  info.isCacheLayerStack = (id == cacheId);
+  if (!info.isCacheLayerStack) {
+    if (!id.rootLayer || id.rootLayer->IsAnonymous() || id.sessionLayer ||
+        !(id.pathResolverContext == cacheId.pathResolverContext)) {
+      return false;
+    }
+    info.rootLayer = id.rootLayer->GetIdentifier();
+  }
+
+  const auto it = _recordedLayerStacks.find(info.rootLayer);
+  if (it != _recordedLayerStacks.end()) {
+    *index = it->second;
+    return *index != _invalidIndex;
+  }
+
+  // Layer stacks with relocations are not persisted, since composition
+  // maps across relocations using expressions that track changes to them.
+  bool ok = layerStack->GetLocalErrors().empty() &&
+            layerStack->GetRelocatesSourceToTarget().empty();
+
+  const SdfLayerRefPtrVector &layers = layerStack->GetLayers();
+  info.layers.reserve(layers.size());
+  for (size_t i = 0; ok && i != layers.size(); ++i) {
+    const bool isSessionLayer = info.isCacheLayerStack && layers[i] == cacheId.sessionLayer;
+    info.layers.push_back(_InternLayer(layers[i], isSessionLayer, &ok));
+  }
+
+  *index = ok ? uint32_t(_recorded.layerStacks.size()) : _invalidIndex;
+  _recordedLayerStacks[info.rootLayer] = *index;
+  if (ok) {
+    _recorded.layerStacks.push_back(std::move(info));
+  }
+  return ok;
+}
+
+uint32_t Pcp_PrimIndexDiskCache::_InternLayer(const SdfLayerRefPtr &layer,
+                                              bool isSessionLayer,
+                                              bool *ok)
+{
+  _Layer info;
+  if (layer->IsAnonymous()) {
+    // The only anonymous layer that can be restored is an empty session
+    // layer, which is recreated on every open.
+    info.anonymous = true;
+    *ok = isSessionLayer && layer->IsEmpty();
+  } else {
+    info.identifier = layer->GetIdentifier();
+    info.resolvedPath = layer->GetResolvedPath().GetPathString();
+    *ok = !layer->IsDirty() && _GetAssetTimestamp(layer, &info.timestamp);
+  }
+  if (!*ok) {
+    return _invalidIndex;
+  }
+
+  const auto result = _recordedLayers.emplace(info.identifier,
+                                              uint32_t(_recorded.layers.size()));
+  if (result.second) {
+    _recorded.layers.push_back(std::move(info));
+  }
+  return result.first->second;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void Pcp_PrimIndexDiskCache::Write()
+{
+  if (_numComputed == 0) {
+    return;
+  }
+
+  TRACE_FUNCTION();
+
+  TfHashMap<SdfPath, uint32_t, SdfPath::Hash> pathTable;
+
+  _Writer body;
+  body.WriteU32(uint32_t(_recorded.layers.size()));
+  for (const _Layer &layer : _recorded.layers) {
+    body.WriteString(layer.identifier);
+    body.WriteString(layer.resolvedPath);
+    body.WriteDouble(layer.timestamp);
+    body.WriteU8(layer.anonymous);
+  }
+
+  body.WriteU32(uint32_t(_recorded.layerStacks.size()));
+  for (const _LayerStack &layerStack : _recorded.layerStacks) {
+    body.WriteU8(layerStack.isCacheLayerStack);
+    body.WriteString(layerStack.rootLayer);
+    body.WriteU32(uint32_t(layerStack.layers.size()));
+    for (const uint32_t layer : layerStack.layers) {
+      body.WriteU32(layer);
+    }
+  }
+
+  body.WriteU32(uint32_t(_recorded.entries.size()));
+  for (const _Entry &entry : _recorded.entries) {
+    body.WritePath(entry.path, &pathTable);
+    body.WriteU8(entry.hasPayloads);
+    body.WriteU8(entry.instanceable);
+    body.WriteU8(entry.payloadState);
+    body.WriteU32(uint32_t(entry.layerStacks.size()));
+    for (const uint32_t layerStack : entry.layerStacks) {
+      body.WriteU32(layerStack);
+    }
+    body.WriteU32(uint32_t(entry.nodes.size()));
+    for (const _Node &node : entry.nodes) {
+      body.WriteU32(node.layerStack);
+      body.WritePath(node.path, &pathTable);
+      body.WriteU8(node.arcType);
+      body.WriteU8(node.flags);
+      body.WriteI32(node.parent);
+      body.WriteI32(node.origin);
+      body.WriteI32(node.siblingNumAtOrigin);
+      body.WriteI32(node.namespaceDepth);
+      body.WriteU32(uint32_t(node.mapToParent.size()));
+      for (const auto &pathPair : node.mapToParent) {
+        body.WritePath(pathPair.first, &pathTable);
+        body.WritePath(pathPair.second, &pathTable);
+      }
+      body.WriteDouble(node.offset);
+      body.WriteDouble(node.scale);
+    }
+  }
+
+  _Writer header;
+  for (const char c : _fileMagic) {
+    header.WriteU8(uint8_t(c));
+  }
+  header.WriteU32(_fileVersion);
+  header.WriteString(_ComputeKey(*_cache));
+
+  std::vector<const SdfPath *> paths(pathTable.size());
+  for (const auto &entry : pathTable) {
+    paths[entry.second] = &entry.first;
+  }
+  header.WriteU32(uint32_t(paths.size()));
+  for (const SdfPath *path : paths) {
+    header.WriteString(path->GetString());
+  }
+
+  std::string reason;
+  TfAtomicOfstreamWrapper wrapper(_filePath);
+  if (!wrapper.Open(&reason)) {
+    TF_WARN("Could not write prim index cache '%s': %s", _filePath.c_str(), reason.c_str());
+    return;
+  }
+  std::ofstream &stream = wrapper.GetStream();
+  stream.write(header.GetBuffer().data(), header.GetBuffer().size());
+  stream.write(body.GetBuffer().data(), body.GetBuffer().size());
+  if (!stream || !wrapper.Commit(&reason)) {
+    TF_WARN("Could not write prim index cache '%s': %s", _filePath.c_str(), reason.c_str());
+    return;
+  }
+
+  TF_DEBUG(PCP_PRIM_INDEX_DISK_CACHE)
+    .Msg("Pcp: wrote %zu prim indexes (%zu composed, %zu restored) to '%s'\n",
+         _recorded.entries.size(),
+         _numComputed,
+         _restoredPaths.size(),
+         _filePath.c_str());
+}
+
+WABI_NAMESPACE_END
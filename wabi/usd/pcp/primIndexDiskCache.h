@@ -0,0 +1,233 @@
+//
+// Copyright 2016 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef WABI_USD_PCP_PRIM_INDEX_DISK_CACHE_H
+#define WABI_USD_PCP_PRIM_INDEX_DISK_CACHE_H
+
+/// \file pcp/primIndexDiskCache.h
+
+#include "wabi/wabi.h"
+#include "wabi/usd/sdf/declareHandles.h"
+#include "wabi/usd/sdf/path.h"
+#include "wabi/base/tf/declarePtrs.h"
+#include "wabi/base/tf/hashmap.h"
+#include "wabi/base/tf/hashset.h"
+
+#include <tbb/spin_mutex.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+WABI_NAMESPACE_BEGIN
+
+TF_DECLARE_WEAK_AND_REF_PTRS(PcpLayerStack);
+SDF_DECLARE_HANDLES(SdfLayer);
+
+class PcpCache;
+class PcpPrimIndexInputs;
+class PcpPrimIndexOutputs;
+
+/// \class Pcp_PrimIndexDiskCache
+///
+/// Persists the prim indexes computed by a PcpCache to a file so that a
+/// later PcpCache opened on the same layers can restore them instead of
+/// recomposing them.
+///
+/// Each cached prim index records the layer stacks it was composed from,
+/// including the layer stacks of arcs that were culled from the final
+/// graph, along with the identifier, resolved path and modification
+/// timestamp of every layer in them.  A prim index is only restored if all
+/// of those layers are unchanged and its parent was restored as well, so a
+/// change to any layer falls back to composing the affected namespace
+/// subtrees live.
+///
+/// Only prim indexes computed in USD mode without errors, relocations or
+/// dynamic file format dependencies are cached.
+///
+class Pcp_PrimIndexDiskCache
+{
+ public:
+
+  /// Records every layer stack computed by the calling thread while it is
+  /// in scope, as dependencies of the prim index being computed.
+  class DependencyRecorder
+  {
+   public:
+
+    explicit DependencyRecorder(Pcp_PrimIndexDiskCache *diskCache);
+    ~DependencyRecorder();
+
+    DependencyRecorder(const DependencyRecorder &) = delete;
+    DependencyRecorder &operator=(const DependencyRecorder &) = delete;
+
+    const std::vector<PcpLayerStackRefPtr> &GetLayerStacks() const
+    {
+      return _layerStacks;
+    }
+
+   private:
+
+    friend class Pcp_PrimIndexDiskCache;
+
+    std::vector<PcpLayerStackRefPtr> _layerStacks;
+    DependencyRecorder *_previous;
+    bool _active;
+  };
+
+  /// Returns the file \p cache's prim indexes are persisted to within
+  /// \p directory, or the empty string if \p cache cannot be persisted.
+  static std::string GetCacheFilePath(const PcpCache &cache, const std::string &directory);
+
+  /// Creates a disk cache for \p cache, reading previously persisted prim
+  /// indexes from \p filePath if it exists and was written for the same
+  /// composition inputs.
+  Pcp_PrimIndexDiskCache(PcpCache *cache, const std::string &filePath);
+  ~Pcp_PrimIndexDiskCache();
+
+  Pcp_PrimIndexDiskCache(const Pcp_PrimIndexDiskCache &) = delete;
+  Pcp_PrimIndexDiskCache &operator=(const Pcp_PrimIndexDiskCache &) = delete;
+
+  /// Notes that \p layerStack was computed on the calling thread, adding it
+  /// to the innermost active DependencyRecorder if there is one.
+  static void NoteLayerStackComputed(const PcpLayerStackRefPtr &layerStack);
+
+  /// Attempt to restore the prim index at \p path from the persisted
+  /// cache.  Returns true and fills in \p outputs if the persisted index is
+  /// still valid for \p inputs, otherwise returns false and leaves
+  /// \p outputs untouched.  A restored index is recorded for the next call
+  /// to Write().
+  ///
+  /// This may be called concurrently for different paths, but must be
+  /// called for a prim's parent before the prim itself.
+  bool Restore(const SdfPath &path,
+               const PcpPrimIndexInputs &inputs,
+               PcpPrimIndexOutputs *outputs);
+
+  /// Record the prim index at \p path in \p outputs, computed live with
+  /// the layer stack dependencies in \p recorder, for the next call to
+  /// Write().  Prim indexes that cannot be persisted are ignored.
+  void Record(const SdfPath &path,
+              const PcpPrimIndexOutputs &outputs,
+              const DependencyRecorder &recorder);
+
+  /// Writes the recorded prim indexes to the cache file if any of them had
+  /// to be computed live.
+  void Write();
+
+ private:
+
+  struct _Layer
+  {
+    std::string identifier;
+    std::string resolvedPath;
+    double timestamp = 0.0;
+    bool anonymous = false;
+  };
+
+  struct _LayerStack
+  {
+    bool isCacheLayerStack = false;
+    std::string rootLayer;
+    std::vector<uint32_t> layers;
+  };
+
+  struct _Node
+  {
+    uint32_t layerStack = 0;
+    SdfPath path;
+    uint8_t arcType = 0;
+    uint8_t flags = 0;
+    int32_t parent = -1;
+    int32_t origin = -1;
+    int32_t siblingNumAtOrigin = 0;
+    int32_t namespaceDepth = 0;
+    std::vector<std::pair<SdfPath, SdfPath>> mapToParent;
+    double offset = 0.0;
+    double scale = 1.0;
+  };
+
+  struct _Entry
+  {
+    SdfPath path;
+    bool hasPayloads = false;
+    bool instanceable = false;
+    uint8_t payloadState = 0;
+    std::vector<_Node> nodes;
+    std::vector<uint32_t> layerStacks;
+  };
+
+  struct _Tables
+  {
+    std::vector<_Layer> layers;
+    std::vector<_LayerStack> layerStacks;
+    std::vector<_Entry> entries;
+  };
+
+  // Lazily computed, validated layer stack for a persisted layer stack.
+  // layerStack is only written under mutex, and never again once restored
+  // is set.
+  struct _RestoredLayerStack
+  {
+    tbb::spin_mutex mutex;
+    std::atomic<bool> restored{false};
+    PcpLayerStackRefPtr layerStack;
+  };
+
+  static std::string _ComputeKey(const PcpCache &cache);
+  bool _Read();
+  const PcpLayerStackRefPtr &_GetRestoredLayerStack(uint32_t index);
+  PcpLayerStackRefPtr _RestoreLayerStack(const _LayerStack &layerStack) const;
+  bool _RestoreGraph(const _Entry &entry, PcpPrimIndexOutputs *outputs);
+  void _Record(const SdfPath &path,
+               const PcpPrimIndexOutputs &outputs,
+               const std::vector<PcpLayerStackRefPtr> &dependencies,
+               bool computed);
+  bool _InternLayerStack(const PcpLayerStackRefPtr &layerStack, uint32_t *index);
+  uint32_t _InternLayer(const SdfLayerRefPtr &layer, bool isSessionLayer, bool *ok);
+
+  PcpCache *const _cache;
+  const std::string _filePath;
+
+  // Prim indexes read from the cache file.
+  _Tables _persisted;
+  TfHashMap<SdfPath, size_t, SdfPath::Hash> _persistedEntries;
+  std::unique_ptr<_RestoredLayerStack[]> _restoredLayerStacks;
+
+  // Prim indexes to write out.  _recordedPaths holds the paths of all
+  // recorded prim indexes; a prim index is only recorded if its parent
+  // was.  _restoredPaths holds the subset that were restored.
+  tbb::spin_mutex _recordMutex;
+  _Tables _recorded;
+  TfHashMap<std::string, uint32_t, TfHash> _recordedLayerStacks;
+  TfHashMap<std::string, uint32_t, TfHash> _recordedLayers;
+  TfHashSet<SdfPath, SdfPath::Hash> _recordedPaths;
+  TfHashSet<SdfPath, SdfPath::Hash> _restoredPaths;
+  size_t _numComputed;
+};
+
+WABI_NAMESPACE_END
+
+#endif  // WABI_USD_PCP_PRIM_INDEX_DISK_CACHE_H
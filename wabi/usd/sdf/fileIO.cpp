@@ -45,6 +45,8 @@ WABI_NAMESPACE_BEGIN
 
 Sdf_StreamWritableAsset::~Sdf_StreamWritableAsset() = default;
 
+Sdf_StringWritableAsset::~Sdf_StringWritableAsset() = default;
+
 #endif
 
 bool Sdf_WriteToStream(const SdfSpec &baseSpec, std::ostream &o, size_t indent)
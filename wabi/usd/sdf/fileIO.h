@@ -167,6 +167,12 @@ class Sdf_TextOutput
     return _Write(str, strlen(str));
   }
 
+  // Write \p length characters starting at \p str to output.
+  bool Write(const char *str, size_t length)
+  {
+    return _Write(str, length);
+  }
+
  private:
 
   bool _Write(const char *str, size_t strLength)
@@ -174,6 +180,20 @@ class Sdf_TextOutput
     // Much of the text format writing code writes small number of
     // characters at a time. Buffer writes to batch writes into larger
     // chunks.
+    // Large writes, such as prims formatted separately, bypass the buffer.
+    if (strLength >= BUFFER_SIZE) {
+      if (!_FlushBuffer()) {
+        return false;
+      }
+      const size_t nWritten = _asset->Write(str, strLength, _offset);
+      if (nWritten != strLength) {
+        TF_RUNTIME_ERROR("Failed to write bytes");
+        return false;
+      }
+      _offset += nWritten;
+      return true;
+    }
+
     while (strLength != 0) {
       const size_t numAvail = BUFFER_SIZE - _bufferPos;
       const size_t numToCopy = std::min(numAvail, strLength);
@@ -213,13 +233,15 @@ class Sdf_TextOutput
   std::shared_ptr<ArWritableAsset> _asset;
   size_t _offset;
 
-  const size_t BUFFER_SIZE = 4096;
+  const size_t BUFFER_SIZE = 64 * 1024;
   std::unique_ptr<char[]> _buffer;
   size_t _bufferPos;
 };
 
 #endif
 
+#if AR_VERSION == 1
+
 // Helper class for writing out strings for the text file format
 // into a single string.
 class Sdf_StringOutput : public Sdf_TextOutput
@@ -240,6 +262,63 @@ class Sdf_StringOutput : public Sdf_TextOutput
   std::stringstream _str;
 };
 
+#else
+
+// ArWritableAsset implementation that appends to a std::string.
+class Sdf_StringWritableAsset : public ArWritableAsset
+{
+ public:
+
+  explicit Sdf_StringWritableAsset(std::string &str) : _str(str) {}
+
+  virtual ~Sdf_StringWritableAsset();
+
+  bool Close() override
+  {
+    return true;
+  }
+
+  size_t Write(const void *buffer, size_t count, size_t offset) override
+  {
+    // As with Sdf_StreamWritableAsset, only sequential writes are supported.
+    _str.append(static_cast<const char *>(buffer), count);
+    return count;
+  }
+
+ private:
+
+  std::string &_str;
+};
+
+// Helper class for writing out strings for the text file format
+// into a single string.
+class Sdf_StringOutput : public Sdf_TextOutput
+{
+ public:
+
+  explicit Sdf_StringOutput() : Sdf_TextOutput(std::make_shared<Sdf_StringWritableAsset>(_str)) {}
+
+  // Flush any buffered output while _str is still alive.
+  ~Sdf_StringOutput()
+  {
+    Close();
+  }
+
+  // Closes the output and returns the text output as a string.  The output
+  // is moved into the result, so this may only be called once.
+  std::string GetString()
+  {
+    Close();
+    return std::move(_str);
+  }
+
+ private:
+
+  std::string _str;
+};
+
+#endif
+
 // Write the provided \a spec to \a out indented \a indent levels.
 bool Sdf_WriteToStream(const SdfSpec &spec, std::ostream &out, size_t indent);
 
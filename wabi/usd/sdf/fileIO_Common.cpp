@@ -28,9 +28,21 @@
 #include "wabi/usd/sdf/fileIO.h"
 #include "wabi/usd/sdf/fileIO_Common.h"
 
+#include "wabi/base/gf/matrix4d.h"
+#include "wabi/base/gf/vec2d.h"
+#include "wabi/base/gf/vec2f.h"
+#include "wabi/base/gf/vec2i.h"
+#include "wabi/base/gf/vec3d.h"
+#include "wabi/base/gf/vec3f.h"
+#include "wabi/base/gf/vec3i.h"
+#include "wabi/base/gf/vec4d.h"
+#include "wabi/base/gf/vec4f.h"
+#include "wabi/base/gf/vec4i.h"
 #include "wabi/base/tf/stringUtils.h"
+#include "wabi/base/vt/array.h"
 
 #include <cctype>
+#include <charconv>
 
 using std::map;
 using std::ostream;
@@ -179,6 +191,124 @@ template<class T> static bool _StringFromVtValueHelper(string *valueStr, const V
   return false;
 }
 
+// Helpers for formatting the numeric scalar, vector and matrix types (and
+// arrays of them) that make up the bulk of large layers.  These append
+// directly to the output string rather than going through TfStringify and
+// std::ostream, but produce exactly the same text.
+static void _AppendNumber(string *valueStr, int value)
+{
+  char buffer[16];
+  const std::to_chars_result r = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  valueStr->append(buffer, r.ptr);
+}
+
+static void _AppendNumber(string *valueStr, float value)
+{
+  char buffer[32];
+  TfFloatToString(value, buffer, sizeof(buffer), /* emitTrailingZero = */ false);
+  valueStr->append(buffer);
+}
+
+static void _AppendNumber(string *valueStr, double value)
+{
+  char buffer[32];
+  TfDoubleToString(value, buffer, sizeof(buffer), /* emitTrailingZero = */ false);
+  valueStr->append(buffer);
+}
+
+template<class T> static void _AppendNumeric(string *valueStr, const T &value)
+{
+  _AppendNumber(valueStr, value);
+}
+
+template<class Vec> static void _AppendVec(string *valueStr, const Vec &vec)
+{
+  valueStr->push_back('(');
+  for (size_t i = 0; i != Vec::dimension; ++i) {
+    if (i) {
+      valueStr->append(", ");
+    }
+    _AppendNumber(valueStr, vec[i]);
+  }
+  valueStr->push_back(')');
+}
+
+#define _SDF_APPEND_VEC(Vec) \
+  static void _AppendNumeric(string *valueStr, const Vec &vec) \
+  { \
+    _AppendVec(valueStr, vec); \
+  }
+
+_SDF_APPEND_VEC(GfVec2d)
+_SDF_APPEND_VEC(GfVec2f)
+_SDF_APPEND_VEC(GfVec2i)
+_SDF_APPEND_VEC(GfVec3d)
+_SDF_APPEND_VEC(GfVec3f)
+_SDF_APPEND_VEC(GfVec3i)
+_SDF_APPEND_VEC(GfVec4d)
+_SDF_APPEND_VEC(GfVec4f)
+_SDF_APPEND_VEC(GfVec4i)
+
+#undef _SDF_APPEND_VEC
+
+static void _AppendNumeric(string *valueStr, const GfMatrix4d &m)
+{
+  valueStr->append("( ");
+  for (int i = 0; i != 4; ++i) {
+    if (i) {
+      valueStr->append(", ");
+    }
+    _AppendVec(valueStr, m.GetRow(i));
+  }
+  valueStr->append(" )");
+}
+
+template<class T> static bool _NumericStringFromVtValueHelper(string *valueStr, const VtValue &value)
+{
+  if (value.IsHolding<T>()) {
+    _AppendNumeric(valueStr, value.UncheckedGet<T>());
+    return true;
+  } else if (value.IsHolding<VtArray<T>>()) {
+    const VtArray<T> &valArray = value.UncheckedGet<VtArray<T>>();
+    // Leave multidimensional arrays to VtStreamOutArray.
+    if (valArray._GetShapeData()->GetRank() != 1) {
+      return false;
+    }
+    valueStr->push_back('[');
+    if (typename VtArray<T>::const_pointer d = valArray.cdata()) {
+      const size_t n = valArray.size();
+      // Most values need fewer than 8 characters per component.
+      valueStr->reserve(valueStr->size() + n * 8 * sizeof(T) / sizeof(float));
+      for (size_t i = 0; i != n; ++i) {
+        if (i) {
+          valueStr->append(", ");
+        }
+        _AppendNumeric(valueStr, d[i]);
+      }
+    }
+    valueStr->push_back(']');
+    return true;
+  }
+  return false;
+}
+
+static bool _NumericStringFromVtValue(string *valueStr, const VtValue &value)
+{
+  return _NumericStringFromVtValueHelper<float>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<double>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<int>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfVec3f>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfVec2f>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfVec4f>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfVec3d>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfVec2d>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfVec4d>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfVec2i>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfVec3i>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfVec4i>(valueStr, value) ||
+         _NumericStringFromVtValueHelper<GfMatrix4d>(valueStr, value);
+}
+
 // ------------------------------------------------------------
 // Helpers functions for writing SdfListOp<T>. Consumers can
 // specialize the _ListOpWriter struct for custom behavior based
@@ -444,8 +574,10 @@ void Sdf_FileIOUtility::WriteDefaultValue(Sdf_TextOutput &out, size_t indent, Vt
   // ---
   // General case value to string conversion and write-out.
   // ---
-  std::string valueString = Sdf_FileIOUtility::StringFromVtValue(value);
-  Sdf_FileIOUtility::Write(out, 0, " = %s", valueString.c_str());
+  // Large array values are written with Puts rather than Write to avoid
+  // formatting them a second time through printf.
+  Sdf_FileIOUtility::Puts(out, 0, " = ");
+  Sdf_FileIOUtility::Puts(out, 0, Sdf_FileIOUtility::StringFromVtValue(value));
 }
 
 void Sdf_FileIOUtility::WriteSdfPath(Sdf_TextOutput &out, size_t indent, const SdfPath &path)
@@ -814,7 +946,8 @@ string Sdf_FileIOUtility::StringFromVtValue(const VtValue &value)
   string s;
   if (_StringFromVtValueHelper<string>(&s, value) ||
       _StringFromVtValueHelper<TfToken>(&s, value) ||
-      _StringFromVtValueHelper<SdfAssetPath>(&s, value)) {
+      _StringFromVtValueHelper<SdfAssetPath>(&s, value) ||
+      _NumericStringFromVtValue(&s, value)) {
     return s;
   }
 
@@ -2433,6 +2433,11 @@ const VtValue &SdfLayer::GetAssetInfo() const
   return _assetInfo->assetInfo.resolverInfo;
 }
 
+const VtValue &SdfLayer::GetAssetModificationTimestamp() const
+{
+  return _assetModificationTime;
+}
+
 const string &SdfLayer::GetAssetName() const
 {
   return _assetInfo->assetInfo.assetName;
@@ -528,6 +528,13 @@ class SdfLayer : public TfRefBase, public TfWeakBase
   SDF_API
   const VtValue &GetAssetInfo() const;
 
+  /// Returns the modification timestamp of this layer's asset as of the
+  /// last time the layer was read or saved.  The returned value holds
+  /// whatever the resolver returned from GetModificationTimestamp(), and is
+  /// empty for anonymous layers.
+  SDF_API
+  const VtValue &GetAssetModificationTimestamp() const;
+
   /// Returns the path to the asset specified by \p assetPath using this layer
   /// to anchor the path if necessary. Returns \p assetPath if it's empty or
   /// an anonymous layer identifier.
@@ -276,6 +276,54 @@ namespace
     return typename Table::NodeHandle(iresult.first->second, /* add_ref = */ false);
   }
 
+  // A small direct-mapped cache of recently found or created child nodes,
+  // keyed by (parent, name).  Each thread owns one of these per node table,
+  // so looking up a hit takes neither the shard mutex nor a probe of the
+  // shared map.  Entries hold counted handles, which keeps both the cached
+  // node and (through it) the parent alive, so the raw parent pointer in the
+  // key can never be reused for a different node while the entry exists.
+  // Colliding entries are simply overwritten, which bounds how many nodes a
+  // thread can keep alive this way.
+  template<class NodeHandle, unsigned Size> struct _ThreadNodeCache
+  {
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+    struct _Entry
+    {
+      Sdf_PathNode const *parent = nullptr;
+      TfToken name;
+      NodeHandle node;
+    };
+
+    _Entry &GetEntryFor(Sdf_PathNode const *parent, const TfToken &name)
+    {
+      return _entries[TfHash::Combine(parent, name) & (Size - 1)];
+    }
+
+    _Entry _entries[Size];
+  };
+
+  template<class PathNode, class Cache, class Table>
+  inline typename Table::NodeHandle _FindOrCreateCached(Cache &cache,
+                                                        Table &table,
+                                                        const TfFunctionRef<bool()> &isValid,
+                                                        const Sdf_PathNode *parent,
+                                                        const TfToken &name)
+  {
+    auto &entry = cache.GetEntryFor(parent, name);
+    if (entry.node && entry.parent == parent && entry.name == name) {
+      // The node exists, so it was already found to be valid.
+      return entry.node;
+    }
+    typename Table::NodeHandle node = _FindOrCreate<PathNode>(table, isValid, parent, name);
+    if (node) {
+      entry.parent = parent;
+      entry.name = name;
+      entry.node = node;
+    }
+    return node;
+  }
+
   template<class Table, class... Args>
   inline void _Remove(const Sdf_PathNode *pathNode,
                       Table &table,
@@ -355,7 +403,8 @@ Sdf_PathPrimNodeHandle Sdf_PathNode::FindOrCreatePrim(Sdf_PathNode const *parent
                                                       const TfToken &name,
                                                       TfFunctionRef<bool()> isValid)
 {
-  return _FindOrCreate<Sdf_PrimPathNode>(*_primNodes, isValid, parent, name);
+  static thread_local _ThreadNodeCache<Sdf_PathPrimNodeHandle, 256> primCache;
+  return _FindOrCreateCached<Sdf_PrimPathNode>(primCache, *_primNodes, isValid, parent, name);
 }
 
 Sdf_PathPropNodeHandle Sdf_PathNode::FindOrCreatePrimProperty(Sdf_PathNode const *parent,
@@ -365,7 +414,9 @@ Sdf_PathPropNodeHandle Sdf_PathNode::FindOrCreatePrimProperty(Sdf_PathNode const
   // NOTE!  We explicitly set the parent to null here in order to create a
   // separate prefix tree for property-like paths.
 
-  return _FindOrCreate<Sdf_PrimPropertyPathNode>(*_primPropertyNodes, isValid, nullptr, name);
+  static thread_local _ThreadNodeCache<Sdf_PathPropNodeHandle, 256> primPropertyCache;
+  return _FindOrCreateCached<Sdf_PrimPropertyPathNode>(
+    primPropertyCache, *_primPropertyNodes, isValid, nullptr, name);
 }
 
 Sdf_PathPrimNodeHandle Sdf_PathNode::FindOrCreatePrimVariantSelection(
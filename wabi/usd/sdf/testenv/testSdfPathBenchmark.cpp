@@ -0,0 +1,143 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// Builds the paths of a large namespace in parallel, the way a parallel
+// stage traversal does, and times creating the paths and then creating
+// them again while the first set is still alive.
+//
+// Usage: testSdfPathBenchmark [numPrims] [numThreads]
+//
+// The namespace has numPrims prims, 10M by default, in groups of 1000
+// under /World, and each prim has one property.  numThreads is passed to
+// WorkSetConcurrencyLimitArgument(), so 0, the default, uses all cores.
+
+#include "wabi/usd/sdf/path.h"
+
+#include "wabi/base/tf/stopwatch.h"
+#include "wabi/base/tf/stringUtils.h"
+#include "wabi/base/tf/token.h"
+#include "wabi/base/work/loops.h"
+#include "wabi/base/work/threadLimits.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+WABI_NAMESPACE_USING
+
+static const size_t _groupSize = 1000;
+
+// Creates the paths of the prims and properties in each group into
+// \p paths, or if \p paths is already populated checks that the new paths
+// are equal to the existing ones.  Returns false on a mismatch.
+static bool _CreatePaths(const SdfPath &root,
+                         const std::vector<TfToken> &groupNames,
+                         const std::vector<TfToken> &primNames,
+                         const TfToken &propertyName,
+                         size_t numPrims,
+                         std::vector<SdfPathVector> *paths)
+{
+  const bool verify = !paths->empty();
+  paths->resize(groupNames.size());
+
+  std::atomic<bool> mismatch(false);
+  WorkParallelForN(groupNames.size(), [&](size_t begin, size_t end) {
+    for (size_t g = begin; g < end; ++g) {
+      const size_t groupBegin = g * _groupSize;
+      const size_t groupEnd = std::min(groupBegin + _groupSize, numPrims);
+
+      SdfPathVector result;
+      result.reserve(2 * (groupEnd - groupBegin));
+      const SdfPath group = root.AppendChild(groupNames[g]);
+      for (size_t i = groupBegin; i < groupEnd; ++i) {
+        const SdfPath prim = group.AppendChild(primNames[i - groupBegin]);
+        result.push_back(prim);
+        result.push_back(prim.AppendProperty(propertyName));
+      }
+
+      if (!verify) {
+        (*paths)[g] = std::move(result);
+      } else if (result != (*paths)[g]) {
+        mismatch = true;
+      }
+    }
+  });
+  return !mismatch;
+}
+
+int main(int argc, char *argv[])
+{
+  const size_t numPrims = argc > 1 ? TfStringToUInt64(argv[1]) : 10000000;
+  const int numThreads = argc > 2 ? TfStringToInt64(argv[2]) : 0;
+
+  WorkSetConcurrencyLimitArgument(numThreads);
+
+  // Create the name tokens up front so that only path creation is timed.
+  const size_t numGroups = (numPrims + _groupSize - 1) / _groupSize;
+  std::vector<TfToken> groupNames, primNames;
+  groupNames.reserve(numGroups);
+  for (size_t g = 0; g < numGroups; ++g) {
+    groupNames.emplace_back(TfStringPrintf("Group_%zu", g));
+  }
+  primNames.reserve(_groupSize);
+  for (size_t i = 0; i < _groupSize; ++i) {
+    primNames.emplace_back(TfStringPrintf("Prim_%zu", i));
+  }
+  const TfToken propertyName("points");
+  const SdfPath root("/World");
+
+  std::vector<SdfPathVector> paths;
+
+  TfStopwatch createTimer;
+  createTimer.Start();
+  bool success = _CreatePaths(root, groupNames, primNames, propertyName, numPrims, &paths);
+  createTimer.Stop();
+
+  TfStopwatch recreateTimer;
+  recreateTimer.Start();
+  success &= _CreatePaths(root, groupNames, primNames, propertyName, numPrims, &paths);
+  recreateTimer.Stop();
+
+  const SdfPath last = paths.empty() ? SdfPath() : paths.back().back();
+  const size_t lastPrim = numPrims - 1;
+  success &= numPrims == 0 ||
+             last.GetString() == TfStringPrintf("/World/Group_%zu/Prim_%zu.points",
+                                                lastPrim / _groupSize,
+                                                lastPrim % _groupSize);
+
+  std::cout << "prims: " << numPrims << ", threads: " << WorkGetConcurrencyLimit() << "\n"
+            << "create: " << createTimer.GetSeconds() << " s\n"
+            << "create existing: " << recreateTimer.GetSeconds() << " s\n";
+
+  if (success) {
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    std::cerr << "Created paths differ from the expected ones\n";
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
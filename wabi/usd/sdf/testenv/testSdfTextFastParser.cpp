@@ -0,0 +1,228 @@
+//
+// Copyright 2021 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// Parses each layer given on the command line (or the layers in this test's
+// testenv) with both the hand-written parser and the generated parser, and
+// checks that they produce the same SdfData, spec by spec.
+
+#include "wabi/usd/sdf/abstractData.h"
+#include "wabi/usd/sdf/data.h"
+#include "wabi/usd/sdf/layerHints.h"
+#include "wabi/usd/sdf/textFastParser.h"
+
+#include "wabi/usd/ar/asset.h"
+#include "wabi/usd/ar/resolvedPath.h"
+#include "wabi/usd/ar/resolver.h"
+
+#include "wabi/base/tf/errorMark.h"
+#include "wabi/base/tf/pathUtils.h"
+#include "wabi/base/tf/stringUtils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+// The generated parser's entry point, as declared by textFileFormat.cpp.
+extern bool Sdf_ParseLayer(const std::string &context,
+                           const std::shared_ptr<WABI_NS::ArAsset> &asset,
+                           const std::string &token,
+                           const std::string &version,
+                           bool metadataOnly,
+                           WABI_NS::SdfDataRefPtr data,
+                           WABI_NS::SdfLayerHints *hints);
+
+WABI_NAMESPACE_USING
+
+static const char *_layers[] = {
+  "syntax.usda",
+  "clip.usda",
+  "complexSet.usda",
+  "creases.usda",
+  "looks.usda",
+  "payload.usda",
+  "shading.usda",
+  "timeSamples.usda",
+};
+
+class _SpecCollector : public SdfAbstractDataSpecVisitor
+{
+ public:
+
+  bool VisitSpec(const SdfAbstractData &data, const SdfPath &path) override
+  {
+    paths.insert(path);
+    return true;
+  }
+
+  void Done(const SdfAbstractData &data) override {}
+
+  std::set<SdfPath> paths;
+};
+
+static std::set<SdfPath> _GetSpecPaths(const SdfDataRefPtr &data)
+{
+  _SpecCollector collector;
+  data->VisitSpecs(&collector);
+  return collector.paths;
+}
+
+// NaNs don't compare equal, so values of the same type whose text
+// representations match are treated as equal too.
+static bool _ValuesMatch(const VtValue &a, const VtValue &b)
+{
+  return a == b || (a.GetType() == b.GetType() && TfStringify(a) == TfStringify(b));
+}
+
+static bool _CompareSpec(const std::string &layer,
+                         const SdfPath &path,
+                         const SdfDataRefPtr &fast,
+                         const SdfDataRefPtr &expected)
+{
+  bool success = true;
+
+  if (fast->GetSpecType(path) != expected->GetSpecType(path)) {
+    std::cerr << layer << ": spec type differs at <" << path << ">\n";
+    success = false;
+  }
+
+  std::vector<TfToken> fastFields = fast->List(path);
+  std::vector<TfToken> expectedFields = expected->List(path);
+  std::sort(fastFields.begin(), fastFields.end());
+  std::sort(expectedFields.begin(), expectedFields.end());
+  if (fastFields != expectedFields) {
+    std::cerr << layer << ": fields differ at <" << path << ">: ["
+              << TfStringJoin(fastFields.begin(), fastFields.end(), ", ") << "] vs ["
+              << TfStringJoin(expectedFields.begin(), expectedFields.end(), ", ") << "]\n";
+    return false;
+  }
+
+  for (const TfToken &field : expectedFields) {
+    // Time samples are compared sample by sample below.
+    if (field == SdfDataTokens->TimeSamples) {
+      continue;
+    }
+    const VtValue fastValue = fast->Get(path, field);
+    const VtValue expectedValue = expected->Get(path, field);
+    if (!_ValuesMatch(fastValue, expectedValue)) {
+      std::cerr << layer << ": field '" << field << "' differs at <" << path << ">: "
+                << TfStringify(fastValue) << " vs " << TfStringify(expectedValue) << "\n";
+      success = false;
+    }
+  }
+
+  const std::set<double> fastTimes = fast->ListTimeSamplesForPath(path);
+  const std::set<double> expectedTimes = expected->ListTimeSamplesForPath(path);
+  if (fastTimes != expectedTimes) {
+    std::cerr << layer << ": time samples differ at <" << path << ">\n";
+    return false;
+  }
+  for (const double time : expectedTimes) {
+    VtValue fastValue, expectedValue;
+    fast->QueryTimeSample(path, time, &fastValue);
+    expected->QueryTimeSample(path, time, &expectedValue);
+    if (!_ValuesMatch(fastValue, expectedValue)) {
+      std::cerr << layer << ": time sample " << time << " differs at <" << path << ">: "
+                << TfStringify(fastValue) << " vs " << TfStringify(expectedValue) << "\n";
+      success = false;
+    }
+  }
+
+  return success;
+}
+
+static bool _TestLayer(const std::string &layer)
+{
+  std::cout << "Testing " << layer << std::endl;
+
+  std::shared_ptr<ArAsset> asset = ArGetResolver().OpenAsset(ArResolvedPath(TfAbsPath(layer)));
+  if (!asset) {
+    std::cerr << layer << ": could not open\n";
+    return false;
+  }
+
+  SdfDataRefPtr expected = TfCreateRefPtr(new SdfData);
+  SdfLayerHints expectedHints;
+  if (!Sdf_ParseLayer(layer, asset, "usda", "1.0", false, expected, &expectedHints)) {
+    std::cerr << layer << ": generated parser failed\n";
+    return false;
+  }
+
+  SdfDataRefPtr fast = TfCreateRefPtr(new SdfData);
+  SdfLayerHints fastHints;
+  if (!Sdf_ParseLayerFast(layer, asset, "usda", "1.0", fast, &fastHints)) {
+    std::cerr << layer << ": hand-written parser failed\n";
+    return false;
+  }
+
+  bool success = true;
+
+  if (fastHints.mightHaveRelocates != expectedHints.mightHaveRelocates) {
+    std::cerr << layer << ": mightHaveRelocates hint differs\n";
+    success = false;
+  }
+
+  const std::set<SdfPath> fastPaths = _GetSpecPaths(fast);
+  const std::set<SdfPath> expectedPaths = _GetSpecPaths(expected);
+  for (const SdfPath &path : expectedPaths) {
+    if (!fastPaths.count(path)) {
+      std::cerr << layer << ": missing spec <" << path << ">\n";
+      success = false;
+    } else {
+      success &= _CompareSpec(layer, path, fast, expected);
+    }
+  }
+  for (const SdfPath &path : fastPaths) {
+    if (!expectedPaths.count(path)) {
+      std::cerr << layer << ": unexpected spec <" << path << ">\n";
+      success = false;
+    }
+  }
+
+  return success;
+}
+
+int main(int argc, char *argv[])
+{
+  TfErrorMark mark;
+
+  std::vector<std::string> layers(argv + 1, argv + argc);
+  if (layers.empty()) {
+    layers.assign(std::begin(_layers), std::end(_layers));
+  }
+
+  bool success = true;
+  for (const std::string &layer : layers) {
+    success &= _TestLayer(layer);
+  }
+
+  if (success && mark.IsClean()) {
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    std::cout << "FAILED" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
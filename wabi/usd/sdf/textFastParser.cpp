@@ -0,0 +1,2079 @@
+//
+// Copyright 2016 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "wabi/wabi.h"
+#include "wabi/usd/sdf/textFastParser.h"
+#include "wabi/usd/sdf/debugCodes.h"
+#include "wabi/usd/sdf/layerOffset.h"
+#include "wabi/usd/sdf/listOp.h"
+#include "wabi/usd/sdf/parserHelpers.h"
+#include "wabi/usd/sdf/parserValueContext.h"
+#include "wabi/usd/sdf/payload.h"
+#include "wabi/usd/sdf/reference.h"
+#include "wabi/usd/sdf/schema.h"
+#include "wabi/usd/sdf/types.h"
+#include "wabi/usd/ar/asset.h"
+
+#include "wabi/base/trace/trace.h"
+#include "wabi/base/tf/diagnostic.h"
+#include "wabi/base/tf/errorMark.h"
+#include "wabi/base/tf/hashset.h"
+#include "wabi/base/tf/mallocTag.h"
+#include "wabi/base/tf/stringUtils.h"
+#include "wabi/base/vt/dictionary.h"
+#include "wabi/base/work/loops.h"
+
+#include <boost/optional.hpp>
+#include <boost/variant.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Our interface to the YACC layer parser, used for the layer header and for
+// any prims the hand-written parser does not handle.
+extern bool Sdf_ParseLayerFromString(const std::string &layerString,
+                                     const std::string &token,
+                                     const std::string &version,
+                                     WABI_NS::SdfDataRefPtr data,
+                                     WABI_NS::SdfLayerHints *hints);
+
+WABI_NAMESPACE_BEGIN
+
+using Sdf_ParserHelpers::Value;
+
+namespace
+{
+
+  ////////////////////////////////////////////////////////////////////////
+  // Lexing
+
+  // Keywords recognized by textFileFormat.ll.  Identifiers that exactly
+  // match one of these are keywords rather than plain identifiers.
+  enum _Keyword
+  {
+    _KwNone = 0,
+    _KwAdd,
+    _KwAppend,
+    _KwClass,
+    _KwConfig,
+    _KwConnect,
+    _KwCustom,
+    _KwCustomData,
+    _KwDefault,
+    _KwDef,
+    _KwDelete,
+    _KwDictionary,
+    _KwDisplayUnit,
+    _KwDoc,
+    _KwInherits,
+    _KwKind,
+    _KwNameChildren,
+    _KwNoneValue,
+    _KwOffset,
+    _KwOver,
+    _KwPayload,
+    _KwPermission,
+    _KwPrefixSubstitutions,
+    _KwPrepend,
+    _KwProperties,
+    _KwReferences,
+    _KwRelocates,
+    _KwRel,
+    _KwReorder,
+    _KwRootPrims,
+    _KwScale,
+    _KwSubLayers,
+    _KwSuffixSubstitutions,
+    _KwSpecializes,
+    _KwSymmetryArguments,
+    _KwSymmetryFunction,
+    _KwTimeSamples,
+    _KwUniform,
+    _KwVariantSet,
+    _KwVariantSets,
+    _KwVariants,
+    _KwVarying
+  };
+
+  struct _KeywordEntry
+  {
+    const char *text;
+    size_t length;
+    _Keyword keyword;
+  };
+
+#define _SDF_KW(str, kw) \
+  { \
+    str, sizeof(str) - 1, kw \
+  }
+
+  const _KeywordEntry _keywords[] = {
+    _SDF_KW("add", _KwAdd),
+    _SDF_KW("append", _KwAppend),
+    _SDF_KW("class", _KwClass),
+    _SDF_KW("config", _KwConfig),
+    _SDF_KW("connect", _KwConnect),
+    _SDF_KW("custom", _KwCustom),
+    _SDF_KW("customData", _KwCustomData),
+    _SDF_KW("default", _KwDefault),
+    _SDF_KW("def", _KwDef),
+    _SDF_KW("delete", _KwDelete),
+    _SDF_KW("dictionary", _KwDictionary),
+    _SDF_KW("displayUnit", _KwDisplayUnit),
+    _SDF_KW("doc", _KwDoc),
+    _SDF_KW("inherits", _KwInherits),
+    _SDF_KW("kind", _KwKind),
+    _SDF_KW("nameChildren", _KwNameChildren),
+    _SDF_KW("None", _KwNoneValue),
+    _SDF_KW("offset", _KwOffset),
+    _SDF_KW("over", _KwOver),
+    _SDF_KW("payload", _KwPayload),
+    _SDF_KW("permission", _KwPermission),
+    _SDF_KW("prefixSubstitutions", _KwPrefixSubstitutions),
+    _SDF_KW("prepend", _KwPrepend),
+    _SDF_KW("properties", _KwProperties),
+    _SDF_KW("references", _KwReferences),
+    _SDF_KW("relocates", _KwRelocates),
+    _SDF_KW("rel", _KwRel),
+    _SDF_KW("reorder", _KwReorder),
+    _SDF_KW("rootPrims", _KwRootPrims),
+    _SDF_KW("scale", _KwScale),
+    _SDF_KW("subLayers", _KwSubLayers),
+    _SDF_KW("suffixSubstitutions", _KwSuffixSubstitutions),
+    _SDF_KW("specializes", _KwSpecializes),
+    _SDF_KW("symmetryArguments", _KwSymmetryArguments),
+    _SDF_KW("symmetryFunction", _KwSymmetryFunction),
+    _SDF_KW("timeSamples", _KwTimeSamples),
+    _SDF_KW("uniform", _KwUniform),
+    _SDF_KW("variantSet", _KwVariantSet),
+    _SDF_KW("variantSets", _KwVariantSets),
+    _SDF_KW("variants", _KwVariants),
+    _SDF_KW("varying", _KwVarying),
+  };
+
+#undef _SDF_KW
+
+  _Keyword _FindKeyword(const char *text, size_t length)
+  {
+    for (const _KeywordEntry &entry : _keywords) {
+      if (entry.length == length && memcmp(entry.text, text, length) == 0) {
+        return entry.keyword;
+      }
+    }
+    return _KwNone;
+  }
+
+  inline bool _IsIdentStart(char c)
+  {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+  }
+
+  inline bool _IsIdentChar(char c)
+  {
+    return _IsIdentStart(c) || (c >= '0' && c <= '9');
+  }
+
+  inline bool _IsDigit(char c)
+  {
+    return c >= '0' && c <= '9';
+  }
+
+  inline const char *_SkipIdent(const char *p, const char *end)
+  {
+    while (p != end && _IsIdentChar(*p)) {
+      ++p;
+    }
+    return p;
+  }
+
+  enum _TokenType
+  {
+    _TokEnd,
+    _TokError,
+    _TokNewline,
+    _TokIdentifier,            // C/Python identifier, possibly a keyword
+    _TokCxxNamespacedIdentifier,  // a::b
+    _TokNamespacedIdentifier,  // a:b
+    _TokNumber,
+    _TokString,
+    _TokAssetRef,
+    _TokPathRef,
+    _TokPunct
+  };
+
+  // A lexed token.  Identifiers refer directly into the layer buffer; only
+  // strings, asset paths and scene paths are copied out since they need
+  // unescaping anyway.
+  struct _Token
+  {
+    _TokenType type = _TokEnd;
+    _Keyword keyword = _KwNone;
+    char punct = 0;
+    const char *text = nullptr;
+    size_t length = 0;
+    Value number;
+    std::string str;
+
+    std::string GetText() const
+    {
+      return std::string(text, length);
+    }
+  };
+
+  // Tokenizer mirroring the rules in textFileFormat.ll.  Anything the rules
+  // there would reject, or that we choose not to handle here (out-of-range
+  // integer literals, triple-delimited asset paths), produces _TokError.
+  class _Lexer
+  {
+   public:
+
+    _Lexer(const char *begin, const char *end) : _cur(begin), _end(end) {}
+
+    void Lex(_Token *tok)
+    {
+      tok->keyword = _KwNone;
+      tok->punct = 0;
+
+      for (;;) {
+        if (_cur == _end) {
+          tok->type = _TokEnd;
+          return;
+        }
+
+        const char c = *_cur;
+        if (c == ' ' || c == '\t') {
+          ++_cur;
+        } else if (c == '#' ||
+                   (c == '/' && _cur + 1 != _end && _cur[1] == '/')) {
+          while (_cur != _end && *_cur != '\r' && *_cur != '\n') {
+            ++_cur;
+          }
+        } else if (c == '/' && _cur + 1 != _end && _cur[1] == '*') {
+          const char *close = _Find(_cur + 2, "*/");
+          if (!close) {
+            tok->type = _TokError;
+            return;
+          }
+          _cur = close + 2;
+        } else {
+          break;
+        }
+      }
+
+      const char c = *_cur;
+      tok->text = _cur;
+
+      if (c == '\r' || c == '\n') {
+        _cur += (c == '\r' && _cur + 1 != _end && _cur[1] == '\n') ? 2 : 1;
+        tok->type = _TokNewline;
+      } else if (_IsIdentStart(c)) {
+        _LexIdentifier(tok);
+      } else if (c == '"' || c == '\'') {
+        _LexString(tok);
+      } else if (c == '<') {
+        _LexPathRef(tok);
+      } else if (c == '@') {
+        _LexAssetRef(tok);
+      } else if (_IsDigit(c) || (c == '.' && _Next(1) && _IsDigit(_cur[1])) ||
+                 (c == '-' && _Next(1) &&
+                  (_IsDigit(_cur[1]) || _cur[1] == 'i' ||
+                   (_cur[1] == '.' && _Next(2) && _IsDigit(_cur[2]))))) {
+        _LexNumber(tok);
+      } else if (strchr("=,:;$.[](){}&-", c)) {
+        tok->type = _TokPunct;
+        tok->punct = c;
+        ++_cur;
+      } else {
+        tok->type = _TokError;
+      }
+      tok->length = _cur - tok->text;
+    }
+
+   private:
+
+    bool _Next(size_t n) const
+    {
+      return static_cast<size_t>(_end - _cur) > n;
+    }
+
+    const char *_Find(const char *p, const char *needle) const
+    {
+      const size_t n = strlen(needle);
+      for (; static_cast<size_t>(_end - p) >= n; ++p) {
+        if (memcmp(p, needle, n) == 0) {
+          return p;
+        }
+      }
+      return nullptr;
+    }
+
+    void _LexIdentifier(_Token *tok)
+    {
+      const char *identEnd = _SkipIdent(_cur, _end);
+
+      // C++ namespaced identifiers, a::b::c
+      const char *cxxEnd = identEnd;
+      while (_end - cxxEnd > 2 && cxxEnd[0] == ':' && cxxEnd[1] == ':' &&
+             _IsIdentStart(cxxEnd[2])) {
+        cxxEnd = _SkipIdent(cxxEnd + 2, _end);
+      }
+
+      // Namespaced identifiers, a:b:c
+      const char *nsEnd = identEnd;
+      while (_end - nsEnd > 1 && nsEnd[0] == ':' && _IsIdentStart(nsEnd[1])) {
+        nsEnd = _SkipIdent(nsEnd + 1, _end);
+      }
+
+      if (cxxEnd > identEnd && cxxEnd >= nsEnd) {
+        tok->type = _TokCxxNamespacedIdentifier;
+        _cur = cxxEnd;
+      } else if (nsEnd > identEnd) {
+        tok->type = _TokNamespacedIdentifier;
+        _cur = nsEnd;
+      } else {
+        tok->type = _TokIdentifier;
+        tok->keyword = _FindKeyword(_cur, identEnd - _cur);
+        _cur = identEnd;
+      }
+    }
+
+    void _LexString(_Token *tok)
+    {
+      const char q = *_cur;
+      const char *p = _cur + 1;
+
+      if (_Next(2) && _cur[1] == q && _cur[2] == q) {
+        // Triply quoted, multi-line string.
+        p = _cur + 3;
+        for (;;) {
+          if (p >= _end) {
+            tok->type = _TokError;
+            return;
+          }
+          if (*p == '\\') {
+            p += 2;
+          } else if (*p == q && _end - p > 2 && p[1] == q && p[2] == q) {
+            p += 3;
+            break;
+          } else {
+            ++p;
+          }
+        }
+        tok->str = Sdf_EvalQuotedString(_cur, p - _cur, 3);
+      } else if (_Next(1) && _cur[1] == q) {
+        // Empty singly quoted string.
+        p = _cur + 2;
+        tok->str.clear();
+      } else {
+        // Singly quoted, single line string.
+        for (;;) {
+          if (p == _end || *p == '\r' || *p == '\n') {
+            tok->type = _TokError;
+            return;
+          }
+          if (*p == '\\') {
+            if (p + 1 == _end || p[1] == '\n') {
+              tok->type = _TokError;
+              return;
+            }
+            p += 2;
+          } else if (*p == q) {
+            ++p;
+            break;
+          } else {
+            ++p;
+          }
+        }
+        tok->str = Sdf_EvalQuotedString(_cur, p - _cur, 1);
+      }
+
+      tok->type = _TokString;
+      _cur = p;
+    }
+
+    void _LexPathRef(_Token *tok)
+    {
+      const char *p = _cur + 1;
+      while (p != _end && *p != '<' && *p != '>' && *p != '\r' && *p != '\n') {
+        ++p;
+      }
+      if (p == _end || *p != '>') {
+        tok->type = _TokError;
+        return;
+      }
+      ++p;
+      tok->str = Sdf_EvalQuotedString(_cur, p - _cur, 1);
+      tok->type = _TokPathRef;
+      _cur = p;
+    }
+
+    void _LexAssetRef(_Token *tok)
+    {
+      // Triple-delimited asset paths are rare; leave them to the generated
+      // parser.
+      if (_Next(2) && _cur[1] == '@' && _cur[2] == '@') {
+        tok->type = _TokError;
+        return;
+      }
+
+      const char *p = _cur + 1;
+      while (p != _end && *p != '@' && *p != '\n') {
+        ++p;
+      }
+      if (p == _end || *p != '@') {
+        tok->type = _TokError;
+        return;
+      }
+      ++p;
+
+      TfErrorMark m;
+      tok->str = Sdf_EvalAssetPath(_cur, p - _cur, /* tripleDelimited = */ false);
+      if (!m.IsClean()) {
+        m.Clear();
+        tok->type = _TokError;
+        return;
+      }
+      tok->type = _TokAssetRef;
+      _cur = p;
+    }
+
+    void _LexNumber(_Token *tok)
+    {
+      const char *start = _cur;
+      const char *p = _cur;
+      const bool negative = (*p == '-');
+      if (negative) {
+        ++p;
+        if (*p == 'i') {
+          if (_end - p >= 3 && memcmp(p, "inf", 3) == 0 &&
+              (p + 3 == _end || !_IsIdentChar(p[3]))) {
+            tok->number = -std::numeric_limits<double>::infinity();
+            tok->type = _TokNumber;
+            _cur = p + 3;
+          } else {
+            // A bare '-' followed by an identifier.
+            tok->type = _TokPunct;
+            tok->punct = '-';
+            _cur = start + 1;
+          }
+          return;
+        }
+      }
+
+      bool isFloat = false;
+      while (p != _end && _IsDigit(*p)) {
+        ++p;
+      }
+      if (p != _end && *p == '.') {
+        isFloat = true;
+        ++p;
+        while (p != _end && _IsDigit(*p)) {
+          ++p;
+        }
+      }
+      if (p != _end && (*p == 'e' || *p == 'E')) {
+        const char *e = p + 1;
+        if (e != _end && (*e == '+' || *e == '-')) {
+          ++e;
+        }
+        if (e != _end && _IsDigit(*e)) {
+          isFloat = true;
+          p = e;
+          while (p != _end && _IsDigit(*p)) {
+            ++p;
+          }
+        }
+      }
+
+      tok->type = _TokNumber;
+      if (isFloat) {
+        tok->number = TfStringToDouble(start, static_cast<int>(p - start));
+      } else if (negative) {
+        if (p - start == 2 && start[1] == '0') {
+          // Negative zero must be stored as a double to preserve the sign.
+          tok->number = double(-0.0);
+        } else {
+          bool outOfRange = false;
+          tok->number = TfStringToInt64(start, &outOfRange);
+          if (outOfRange) {
+            tok->type = _TokError;
+          }
+        }
+      } else {
+        bool outOfRange = false;
+        tok->number = TfStringToUInt64(start, &outOfRange);
+        if (outOfRange) {
+          tok->type = _TokError;
+        }
+      }
+      _cur = p;
+    }
+
+    const char *_cur;
+    const char *_end;
+  };
+
+  ////////////////////////////////////////////////////////////////////////
+  // Helpers shared with the generated parser's semantic actions.
+
+  template<class T> bool _HasDuplicates(const std::vector<T> &v)
+  {
+    if (v.size() <= 1) {
+      return false;
+    }
+    if (v.size() <= 10) {
+      for (auto i = v.begin(), iend = std::prev(v.end()); i != iend; ++i) {
+        for (auto j = std::next(i); j != v.end(); ++j) {
+          if (*i == *j) {
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+    std::vector<T> copy(v);
+    std::sort(copy.begin(), copy.end());
+    return std::adjacent_find(copy.begin(), copy.end()) != copy.end();
+  }
+
+  template<class T> std::vector<T> _ToItemVector(const VtArray<T> &v)
+  {
+    return std::vector<T>(v.begin(), v.end());
+  }
+
+  template<class ListOpType> std::pair<TfType, TfType> _GetListOpAndArrayTfTypes()
+  {
+    return {TfType::Find<ListOpType>(),
+            TfType::Find<VtArray<typename ListOpType::value_type>>()};
+  }
+
+  bool _IsGenericMetadataListOpType(const TfType &type, TfType *itemArrayType)
+  {
+    static std::pair<TfType, TfType> listOpAndArrayTypes[] = {
+      _GetListOpAndArrayTfTypes<SdfIntListOp>(),
+      _GetListOpAndArrayTfTypes<SdfInt64ListOp>(),
+      _GetListOpAndArrayTfTypes<SdfUIntListOp>(),
+      _GetListOpAndArrayTfTypes<SdfUInt64ListOp>(),
+      _GetListOpAndArrayTfTypes<SdfStringListOp>(),
+      _GetListOpAndArrayTfTypes<SdfTokenListOp>(),
+    };
+
+    for (const auto &p : listOpAndArrayTypes) {
+      if (p.first == type) {
+        *itemArrayType = p.second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  // Parsing
+
+  // Recursive-descent parser for a single top-level prim statement.
+  //
+  // This handles the constructs that make up the bulk of large layers --
+  // prims, attributes (defaults, time samples, connections), relationships,
+  // references, payloads, inherits, specializes, variant selections and
+  // registered metadata -- and writes exactly what the generated parser
+  // would.  Every parse function returns false on anything else, including
+  // input the generated parser would report as an error, so the caller can
+  // hand the prim to the generated parser instead.
+  class _Parser
+  {
+   public:
+
+    _Parser(const char *begin, const char *end, const SdfDataRefPtr &data)
+      : _lexer(begin, end),
+        _data(data),
+        _valueError(false)
+    {
+      _values.errorReporter = [this](const std::string &) { _valueError = true; };
+      _Lex();
+    }
+
+    // Parse the prim statement making up the whole input and return the
+    // prim's name in \p name.
+    bool ParseRootPrim(TfToken *name)
+    {
+      std::vector<TfToken> rootChildren;
+      bool ok = false;
+      try {
+        ok = _ParsePrim(SdfPath::AbsoluteRootPath(), &rootChildren);
+      }
+      catch (boost::bad_get const &) {
+        ok = false;
+      }
+      if (!ok) {
+        return false;
+      }
+      _SkipNewlines();
+      if (_tok.type != _TokEnd || rootChildren.size() != 1) {
+        return false;
+      }
+      *name = rootChildren.front();
+      return true;
+    }
+
+   private:
+
+    // Token helpers
+
+    void _Lex()
+    {
+      _lexer.Lex(&_tok);
+    }
+
+    bool _IsPunct(char c) const
+    {
+      return _tok.type == _TokPunct && _tok.punct == c;
+    }
+
+    bool _IsKeyword(_Keyword kw) const
+    {
+      return _tok.type == _TokIdentifier && _tok.keyword == kw;
+    }
+
+    // identifier: TOK_IDENTIFIER | TOK_CXX_NAMESPACED_IDENTIFIER
+    bool _IsIdentifier() const
+    {
+      return (_tok.type == _TokIdentifier && _tok.keyword == _KwNone) ||
+             _tok.type == _TokCxxNamespacedIdentifier;
+    }
+
+    // namespaced_name: TOK_IDENTIFIER | TOK_NAMESPACED_IDENTIFIER | keyword
+    bool _IsNamespacedName() const
+    {
+      return _tok.type == _TokIdentifier || _tok.type == _TokNamespacedIdentifier;
+    }
+
+    // name: identifier | keyword
+    bool _IsName() const
+    {
+      return _tok.type == _TokIdentifier || _tok.type == _TokCxxNamespacedIdentifier;
+    }
+
+    bool _Accept(char c)
+    {
+      if (_IsPunct(c)) {
+        _Lex();
+        return true;
+      }
+      return false;
+    }
+
+    void _SkipNewlines()
+    {
+      while (_tok.type == _TokNewline) {
+        _Lex();
+      }
+    }
+
+    // stmtsep: ';' newlines_opt | newlines
+    bool _AcceptStmtSep()
+    {
+      if (_Accept(';')) {
+        _SkipNewlines();
+        return true;
+      }
+      if (_tok.type == _TokNewline) {
+        _SkipNewlines();
+        return true;
+      }
+      return false;
+    }
+
+    // After a list item: listsep (',' newlines_opt) or newlines_opt followed
+    // by \p close.  Sets \p done when the closing character was consumed.
+    bool _AcceptListSep(char close, bool *done)
+    {
+      if (_Accept(',')) {
+        _SkipNewlines();
+      } else {
+        _SkipNewlines();
+        if (!_IsPunct(close)) {
+          return false;
+        }
+      }
+      *done = _Accept(close);
+      return true;
+    }
+
+    // Parses a bracketed, comma separated list of items, or a single
+    // unbracketed item, or None.  This is the shape shared by connections,
+    // relationship targets, references, payloads, inherits and specializes.
+    template<class Fn> bool _ParseItemList(Fn &&parseItem, bool *isNone)
+    {
+      *isNone = false;
+      if (_IsKeyword(_KwNoneValue)) {
+        _Lex();
+        *isNone = true;
+        return true;
+      }
+      if (!_Accept('[')) {
+        return parseItem();
+      }
+      _SkipNewlines();
+      if (_Accept(']')) {
+        return true;
+      }
+      for (bool done = false; !done;) {
+        if (!parseItem() || !_AcceptListSep(']', &done)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Data helpers
+
+    template<class T> void _SetField(const SdfPath &path, const TfToken &key, const T &item)
+    {
+      _data->Set(path, key, VtValue(item));
+    }
+
+    template<class T>
+    bool _SetListOpItems(const SdfPath &path,
+                         const TfToken &key,
+                         SdfListOpType type,
+                         const std::vector<T> &items)
+    {
+      if (_HasDuplicates(items)) {
+        return false;
+      }
+
+      SdfListOp<T> op = _data->GetAs<SdfListOp<T>>(path, key);
+      op.SetItems(items, type);
+      _data->Set(path, key, VtValue::Take(op));
+      return true;
+    }
+
+    template<class ListOpType>
+    bool _SetItemsIfListOp(const TfType &type,
+                           const SdfPath &path,
+                           const TfToken &key,
+                           SdfListOpType opType,
+                           const VtValue &value,
+                           bool *ok)
+    {
+      if (!type.IsA<ListOpType>()) {
+        return false;
+      }
+
+      typedef VtArray<typename ListOpType::value_type> ArrayType;
+      if (!value.IsHolding<ArrayType>() && !value.IsEmpty()) {
+        *ok = false;
+        return true;
+      }
+
+      ArrayType vtArray;
+      if (value.IsHolding<ArrayType>()) {
+        vtArray = value.UncheckedGet<ArrayType>();
+      }
+      *ok = _SetListOpItems(path, key, opType, _ToItemVector(vtArray));
+      return true;
+    }
+
+    // Values
+
+    bool _ProduceValue(VtValue *value)
+    {
+      std::string errStr;
+      *value = _values.ProduceValue(&errStr);
+      return !_valueError && !value->IsEmpty();
+    }
+
+    // typed_value_atomic
+    bool _AppendAtomic()
+    {
+      switch (_tok.type) {
+        case _TokNumber:
+          _values.AppendValue(_tok.number);
+          break;
+        case _TokString:
+          _values.AppendValue(Value(_tok.str));
+          break;
+        case _TokAssetRef:
+          _values.AppendValue(Value(SdfAssetPath(_tok.str)));
+          break;
+        case _TokIdentifier:
+        case _TokCxxNamespacedIdentifier:
+          if (!_IsIdentifier()) {
+            return false;
+          }
+          _values.AppendValue(Value(TfToken(_tok.GetText())));
+          break;
+        default:
+          return false;
+      }
+      _Lex();
+      return !_valueError;
+    }
+
+    // typed_value_tuple, with the '(' current.
+    bool _ParseTuple()
+    {
+      _values.BeginTuple();
+      _Lex();
+      _SkipNewlines();
+      for (bool done = false; !done;) {
+        if (_IsPunct('(')) {
+          if (!_ParseTuple()) {
+            return false;
+          }
+        } else if (!_AppendAtomic()) {
+          return false;
+        }
+        if (!_AcceptListSep(')', &done)) {
+          return false;
+        }
+      }
+      _values.EndTuple();
+      return !_valueError;
+    }
+
+    // typed_value_list, with the '[' already consumed.
+    bool _ParseListBody()
+    {
+      _values.BeginList();
+      _SkipNewlines();
+      for (bool done = false; !done;) {
+        if (_IsPunct('(')) {
+          if (!_ParseTuple()) {
+            return false;
+          }
+        } else if (_Accept('[')) {
+          if (!_ParseListBody()) {
+            return false;
+          }
+        } else if (!_AppendAtomic()) {
+          return false;
+        }
+        if (!_AcceptListSep(']', &done)) {
+          return false;
+        }
+      }
+      _values.EndList();
+      return !_valueError;
+    }
+
+    // typed_value, using the value factory currently set up in _values.
+    bool _ParseTypedValue(VtValue *value)
+    {
+      if (_tok.type == _TokPathRef) {
+        *value = _tok.str.empty() ? SdfPath() : SdfPath(_tok.str);
+        _Lex();
+        return true;
+      }
+      if (_IsPunct('(')) {
+        return _ParseTuple() && !_values.valueIsShaped && _ProduceValue(value);
+      }
+      if (_Accept('[')) {
+        if (_Accept(']')) {
+          return _values.valueIsShaped && _ProduceValue(value);
+        }
+        return _ParseListBody() && _values.valueIsShaped && _ProduceValue(value);
+      }
+      return _AppendAtomic() && !_values.valueIsShaped && _ProduceValue(value);
+    }
+
+    // dictionary_key: TOK_STRING | name
+    bool _ParseDictionaryKey(std::string *key)
+    {
+      if (_tok.type == _TokString) {
+        *key = _tok.str;
+      } else if (_IsName()) {
+        *key = _tok.GetText();
+      } else {
+        return false;
+      }
+      _Lex();
+      return true;
+    }
+
+    // typed_dictionary, with the '{' current.
+    bool _ParseTypedDictionary(VtDictionary *dict)
+    {
+      _Lex();
+      _SkipNewlines();
+      while (!_Accept('}')) {
+        std::string key;
+        if (_IsKeyword(_KwDictionary)) {
+          _Lex();
+          VtDictionary nested;
+          if (!_ParseDictionaryKey(&key) || !_Accept('=') || !_IsPunct('{') ||
+              !_ParseTypedDictionary(&nested)) {
+            return false;
+          }
+          (*dict)[key].Swap(nested);
+        } else {
+          if (!_IsIdentifier()) {
+            return false;
+          }
+          std::string typeName = _tok.GetText();
+          _Lex();
+          if (_Accept('[')) {
+            if (!_Accept(']')) {
+              return false;
+            }
+            typeName += "[]";
+          }
+          if (!_values.SetupFactory(typeName)) {
+            return false;
+          }
+          VtValue value;
+          if (!_ParseDictionaryKey(&key) || !_Accept('=') || !_ParseTypedValue(&value)) {
+            return false;
+          }
+          (*dict)[key] = value;
+        }
+        if (!_AcceptStmtSep() && !_IsPunct('}')) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Metadata
+
+    // Generic metadata for fields registered in the schema.  Unregistered
+    // fields are preserved as strings by the generated parser, which we
+    // leave to it.
+    bool _ParseGenericMetadata(const SdfPath &path,
+                               SdfSpecType specType,
+                               const TfToken &key,
+                               SdfListOpType opType)
+    {
+      const SdfSchema &schema = SdfSchema::GetInstance();
+      const SdfSchema::SpecDefinition &specDef = *schema.GetSpecDefinition(specType);
+      if (!specDef.IsMetadataField(key)) {
+        return false;
+      }
+
+      const SdfSchema::FieldDefinition &fieldDef = *schema.GetFieldDefinition(key);
+      const TfType fieldType = fieldDef.GetFallbackValue().GetType();
+
+      TfType itemArrayType;
+      const bool isListOp = _IsGenericMetadataListOpType(fieldType, &itemArrayType);
+      if (!isListOp && opType != SdfListOpTypeExplicit) {
+        return false;
+      }
+
+      if (isListOp) {
+        _values.SetupFactory(schema.FindType(itemArrayType).GetAsToken().GetString());
+      } else {
+        _values.SetupFactory(
+          schema.FindType(fieldDef.GetFallbackValue()).GetAsToken().GetString());
+      }
+
+      if (!_Accept('=')) {
+        return false;
+      }
+
+      VtValue value;
+      if (_IsKeyword(_KwNoneValue)) {
+        _Lex();
+      } else if (opType != SdfListOpTypeExplicit) {
+        // metadata_listop_list
+        if (!_Accept('[') || _IsPunct(']') || !_ParseListBody() ||
+            !_values.valueIsShaped || !_ProduceValue(&value)) {
+          return false;
+        }
+      } else if (_IsPunct('{')) {
+        VtDictionary dict;
+        if (!_ParseTypedDictionary(&dict)) {
+          return false;
+        }
+        value.Swap(dict);
+      } else if (!_ParseTypedValue(&value)) {
+        return false;
+      }
+
+      bool ok = true;
+      if (isListOp) {
+        if (!fieldDef.IsValidListValue(value)) {
+          return false;
+        }
+        _SetItemsIfListOp<SdfIntListOp>(fieldType, path, key, opType, value, &ok) ||
+          _SetItemsIfListOp<SdfInt64ListOp>(fieldType, path, key, opType, value, &ok) ||
+          _SetItemsIfListOp<SdfUIntListOp>(fieldType, path, key, opType, value, &ok) ||
+          _SetItemsIfListOp<SdfUInt64ListOp>(fieldType, path, key, opType, value, &ok) ||
+          _SetItemsIfListOp<SdfStringListOp>(fieldType, path, key, opType, value, &ok) ||
+          _SetItemsIfListOp<SdfTokenListOp>(fieldType, path, key, opType, value, &ok);
+      } else {
+        if (!fieldDef.IsValidValue(value) || value.IsEmpty()) {
+          return false;
+        }
+        _data->Set(path, key, value);
+      }
+
+      _values.Clear();
+      return ok;
+    }
+
+    // prim_path, with the path ref current.
+    bool _ParsePrimPath(SdfPath *path)
+    {
+      if (_tok.type != _TokPathRef) {
+        return false;
+      }
+      *path = SdfPath(_tok.str);
+      _Lex();
+      return path->IsPrimPath();
+    }
+
+    // ( offset = ...; scale = ... ) for references and payloads.
+    bool _ParseLayerOffsetParams(SdfLayerOffset *offset)
+    {
+      if (!_Accept('(')) {
+        return true;
+      }
+      _SkipNewlines();
+      while (!_Accept(')')) {
+        const bool isOffset = _IsKeyword(_KwOffset);
+        if (!isOffset && !_IsKeyword(_KwScale)) {
+          return false;
+        }
+        _Lex();
+        if (!_Accept('=') || _tok.type != _TokNumber) {
+          return false;
+        }
+        const double value = _tok.number.Get<double>();
+        if (isOffset) {
+          offset->SetOffset(value);
+        } else {
+          offset->SetScale(value);
+        }
+        _Lex();
+        if (!_AcceptStmtSep() && !_IsPunct(')')) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // reference_list and payload_list
+    template<class RefType>
+    bool _ParseReferenceList(const SdfPath &path,
+                             const TfToken &key,
+                             SdfListOpType opType,
+                             SdfAllowed (*isValid)(const RefType &))
+    {
+      std::vector<RefType> refs;
+      auto parseItem = [&]() {
+        std::string assetPath;
+        SdfPath primPath;
+        SdfLayerOffset offset;
+        if (_tok.type == _TokAssetRef) {
+          assetPath = _tok.str;
+          _Lex();
+          if (assetPath.empty()) {
+            return false;
+          }
+          if (_tok.type == _TokPathRef && !_ParsePrimPath(&primPath)) {
+            return false;
+          }
+        } else if (_tok.type == _TokPathRef) {
+          const bool isEmpty = _tok.str.empty();
+          if (isEmpty) {
+            _Lex();
+            primPath = SdfPath::EmptyPath();
+          } else if (!_ParsePrimPath(&primPath)) {
+            return false;
+          }
+        } else {
+          return false;
+        }
+        if (!_ParseLayerOffsetParams(&offset)) {
+          return false;
+        }
+        refs.emplace_back(assetPath, primPath, offset);
+        return true;
+      };
+
+      bool isNone;
+      if (!_ParseItemList(parseItem, &isNone)) {
+        return false;
+      }
+      if (refs.empty() && opType != SdfListOpTypeExplicit) {
+        return false;
+      }
+      for (const RefType &ref : refs) {
+        if (!isValid(ref)) {
+          return false;
+        }
+      }
+      return _SetListOpItems(path, key, opType, refs);
+    }
+
+    // inherit_list and specializes_list
+    bool _ParsePathList(const SdfPath &path,
+                        const TfToken &key,
+                        SdfListOpType opType,
+                        SdfAllowed (*isValid)(const SdfPath &))
+    {
+      SdfPathVector paths;
+      auto parseItem = [&]() {
+        SdfPath target;
+        if (!_ParsePrimPath(&target)) {
+          return false;
+        }
+        paths.push_back(target.MakeAbsolutePath(path.GetPrimPath()));
+        return true;
+      };
+
+      bool isNone;
+      if (!_ParseItemList(parseItem, &isNone)) {
+        return false;
+      }
+      if (paths.empty() && opType != SdfListOpTypeExplicit) {
+        return false;
+      }
+      for (const SdfPath &p : paths) {
+        if (!isValid(p)) {
+          return false;
+        }
+      }
+      return _SetListOpItems(path, key, opType, paths);
+    }
+
+    // variants = { string set = "selection" ... }
+    bool _ParseVariantSelection(const SdfPath &path)
+    {
+      VtDictionary dict;
+      if (!_Accept('=') || !_IsPunct('{') || !_ParseTypedDictionary(&dict)) {
+        return false;
+      }
+
+      SdfVariantSelectionMap refVars;
+      VtValue oldVars;
+      if (_data->Has(path, SdfFieldKeys->VariantSelection, &oldVars)) {
+        refVars = oldVars.Get<SdfVariantSelectionMap>();
+      }
+      for (const auto &entry : dict) {
+        if (!entry.second.IsHolding<std::string>()) {
+          return false;
+        }
+        const std::string &variantName = entry.second.UncheckedGet<std::string>();
+        if (!SdfSchema::IsValidVariantIdentifier(variantName)) {
+          return false;
+        }
+        refVars[entry.first] = variantName;
+      }
+      _SetField(path, SdfFieldKeys->VariantSelection, refVars);
+      return true;
+    }
+
+    // A single entry of a prim_metadata, attribute_metadata or
+    // relationship_metadata list.
+    bool _ParseMetadata(const SdfPath &path, SdfSpecType specType)
+    {
+      const bool isPrim = (specType == SdfSpecTypePrim);
+
+      if (_tok.type == _TokString) {
+        _SetField(path, SdfFieldKeys->Comment, _tok.str);
+        _Lex();
+        return true;
+      }
+
+      if (_IsKeyword(_KwDoc) || (isPrim && _IsKeyword(_KwKind))) {
+        const bool isDoc = _IsKeyword(_KwDoc);
+        _Lex();
+        if (!_Accept('=') || _tok.type != _TokString) {
+          return false;
+        }
+        if (isDoc) {
+          _SetField(path, SdfFieldKeys->Documentation, _tok.str);
+        } else {
+          _SetField(path, SdfFieldKeys->Kind, TfToken(_tok.str));
+        }
+        _Lex();
+        return true;
+      }
+
+      if (isPrim && _IsKeyword(_KwVariants)) {
+        _Lex();
+        return _ParseVariantSelection(path);
+      }
+
+      SdfListOpType opType = SdfListOpTypeExplicit;
+      if (_tok.type == _TokIdentifier) {
+        switch (_tok.keyword) {
+          case _KwDelete:
+            opType = SdfListOpTypeDeleted;
+            break;
+          case _KwAdd:
+            opType = SdfListOpTypeAdded;
+            break;
+          case _KwPrepend:
+            opType = SdfListOpTypePrepended;
+            break;
+          case _KwAppend:
+            opType = SdfListOpTypeAppended;
+            break;
+          case _KwReorder:
+            opType = SdfListOpTypeOrdered;
+            break;
+          default:
+            break;
+        }
+      }
+      const bool isListEdit = (opType != SdfListOpTypeExplicit);
+      if (isListEdit) {
+        _Lex();
+      }
+
+      if (isPrim && _tok.type == _TokIdentifier) {
+        switch (_tok.keyword) {
+          case _KwReferences:
+            _Lex();
+            return _Accept('=') &&
+                   _ParseReferenceList<SdfReference>(
+                     path, SdfFieldKeys->References, opType, &SdfSchema::IsValidReference);
+          case _KwPayload:
+            _Lex();
+            return _Accept('=') &&
+                   _ParseReferenceList<SdfPayload>(
+                     path, SdfFieldKeys->Payload, opType, &SdfSchema::IsValidPayload);
+          case _KwInherits:
+            _Lex();
+            return _Accept('=') &&
+                   _ParsePathList(
+                     path, SdfFieldKeys->InheritPaths, opType, &SdfSchema::IsValidInheritPath);
+          case _KwSpecializes:
+            _Lex();
+            return _Accept('=') &&
+                   _ParsePathList(
+                     path, SdfFieldKeys->Specializes, opType, &SdfSchema::IsValidSpecializesPath);
+          default:
+            break;
+        }
+      }
+
+      // Generic metadata keys are identifiers; the explicit form also allows
+      // the customData and symmetryArguments keywords.
+      if (!_IsIdentifier() &&
+          (isListEdit || !(_IsKeyword(_KwCustomData) || _IsKeyword(_KwSymmetryArguments)))) {
+        return false;
+      }
+      const TfToken key(_tok.GetText());
+      _Lex();
+      return _ParseGenericMetadata(path, specType, key, opType);
+    }
+
+    // A parenthesized metadata list, with the '(' current.
+    bool _ParseMetadataList(const SdfPath &path, SdfSpecType specType)
+    {
+      _Lex();
+      _SkipNewlines();
+      while (!_Accept(')')) {
+        if (!_ParseMetadata(path, specType)) {
+          return false;
+        }
+        if (!_AcceptStmtSep() && !_IsPunct(')')) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Properties
+
+    bool _InitAttribute(const SdfPath &primPath,
+                        const TfToken &name,
+                        bool custom,
+                        const VtValue &variabilityValue,
+                        std::vector<TfToken> *properties,
+                        SdfPath *attrPath)
+    {
+      if (!SdfPath::IsValidNamespacedIdentifier(name)) {
+        return false;
+      }
+
+      *attrPath = primPath.AppendProperty(name);
+      if (!_data->HasSpec(*attrPath)) {
+        properties->push_back(name);
+        _data->CreateSpec(*attrPath, SdfSpecTypeAttribute);
+        _SetField(*attrPath, SdfFieldKeys->Custom, false);
+      }
+
+      if (custom) {
+        _SetField(*attrPath, SdfFieldKeys->Custom, true);
+      }
+
+      const TfToken newType(_values.valueTypeName);
+      VtValue oldTypeValue;
+      if (_data->Has(*attrPath, SdfFieldKeys->TypeName, &oldTypeValue)) {
+        if (oldTypeValue.Get<TfToken>() != newType) {
+          return false;
+        }
+      } else {
+        _SetField(*attrPath, SdfFieldKeys->TypeName, newType);
+      }
+
+      const SdfVariability variability = variabilityValue.IsEmpty() ?
+                                           SdfVariabilityVarying :
+                                           variabilityValue.Get<SdfVariability>();
+      VtValue oldVariability;
+      if (_data->Has(*attrPath, SdfFieldKeys->Variability, &oldVariability)) {
+        if (variability != oldVariability.Get<SdfVariability>()) {
+          return false;
+        }
+      } else {
+        _SetField(*attrPath, SdfFieldKeys->Variability, variability);
+      }
+      return true;
+    }
+
+    // time_samples_rhs, with the '{' current.  The value factory for the
+    // attribute or relationship must already be set up.
+    bool _ParseTimeSamples(SdfTimeSampleMap *samples)
+    {
+      _Lex();
+      _SkipNewlines();
+      if (_Accept('}')) {
+        return true;
+      }
+      for (bool done = false; !done;) {
+        double time;
+        if (_tok.type == _TokNumber) {
+          time = _tok.number.Get<double>();
+        } else if (_tok.type == _TokIdentifier) {
+          time = Value(_tok.GetText()).Get<double>();
+        } else {
+          return false;
+        }
+        _Lex();
+        if (!_Accept(':')) {
+          return false;
+        }
+        if (_IsKeyword(_KwNoneValue)) {
+          _Lex();
+          (*samples)[time] = VtValue(SdfValueBlock());
+        } else {
+          VtValue value;
+          if (!_ParseTypedValue(&value)) {
+            return false;
+          }
+          (*samples)[time] = value;
+        }
+        if (!_AcceptListSep('}', &done)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // prim_attribute, with the attribute's type name current.
+    bool _ParseAttribute(const SdfPath &primPath,
+                         bool custom,
+                         const VtValue &variability,
+                         std::vector<TfToken> *properties)
+    {
+      if (!_IsIdentifier()) {
+        return false;
+      }
+      std::string typeName = _tok.GetText();
+      _Lex();
+      if (_Accept('[')) {
+        if (!_Accept(']')) {
+          return false;
+        }
+        typeName += "[]";
+      }
+      // Unknown type names are recorded as strings by the generated parser.
+      if (!_values.SetupFactory(typeName)) {
+        return false;
+      }
+
+      if (!_IsNamespacedName()) {
+        return false;
+      }
+      const TfToken name(_tok.GetText());
+      _Lex();
+
+      SdfPath attrPath;
+      if (_Accept('.')) {
+        // Connections and time samples cannot be declared custom.
+        if (custom) {
+          return false;
+        }
+        const bool isConnect = _IsKeyword(_KwConnect);
+        if (!isConnect && !_IsKeyword(_KwTimeSamples)) {
+          return false;
+        }
+        _Lex();
+        if (!_Accept('=') ||
+            !_InitAttribute(primPath, name, custom, variability, properties, &attrPath)) {
+          return false;
+        }
+        if (isConnect) {
+          return _ParseConnections(attrPath);
+        }
+
+        SdfTimeSampleMap samples;
+        if (!_IsPunct('{') || !_ParseTimeSamples(&samples)) {
+          return false;
+        }
+        _SetField(attrPath, SdfFieldKeys->TimeSamples, samples);
+        return true;
+      }
+
+      if (!_InitAttribute(primPath, name, custom, variability, properties, &attrPath)) {
+        return false;
+      }
+
+      if (_Accept('=')) {
+        if (_IsKeyword(_KwNoneValue)) {
+          _Lex();
+          _SetField(attrPath, SdfFieldKeys->Default, SdfValueBlock());
+        } else {
+          VtValue value;
+          if (!_ParseTypedValue(&value)) {
+            return false;
+          }
+          _data->Set(attrPath, SdfFieldKeys->Default, value);
+        }
+      }
+
+      if (_IsPunct('(')) {
+        return _ParseMetadataList(attrPath, SdfSpecTypeAttribute);
+      }
+      return true;
+    }
+
+    // connect_rhs for an explicit connection list.
+    bool _ParseConnections(const SdfPath &attrPath)
+    {
+      const SdfPath primPath = attrPath.GetPrimPath();
+      SdfPathVector targets;
+      auto parseItem = [&]() {
+        if (_tok.type != _TokPathRef) {
+          return false;
+        }
+        const SdfPath path(_tok.str);
+        _Lex();
+        if (!(path.IsPrimPath() || path.IsPropertyPath()) ||
+            path.ContainsPrimVariantSelection()) {
+          return false;
+        }
+        SdfPath absPath = path.MakeAbsolutePath(primPath);
+        // The generated parser warns about and strips variant selections
+        // here.
+        if (absPath.ContainsPrimVariantSelection()) {
+          return false;
+        }
+        targets.push_back(absPath);
+        return true;
+      };
+
+      bool isNone;
+      if (!_ParseItemList(parseItem, &isNone)) {
+        return false;
+      }
+
+      for (const SdfPath &path : targets) {
+        if (!SdfSchema::IsValidAttributeConnectionPath(path)) {
+          return false;
+        }
+      }
+      for (const SdfPath &target : targets) {
+        const SdfPath path = attrPath.AppendTarget(target);
+        if (!_data->HasSpec(path)) {
+          _data->CreateSpec(path, SdfSpecTypeConnection);
+        }
+      }
+      _SetField(attrPath, SdfChildrenKeys->ConnectionChildren, targets);
+      return _SetListOpItems(
+        attrPath, SdfFieldKeys->ConnectionPaths, SdfListOpTypeExplicit, targets);
+    }
+
+    // prim_relationship with explicit targets, with the relationship's name
+    // current.
+    bool _ParseRelationship(const SdfPath &primPath,
+                            bool custom,
+                            SdfVariability variability,
+                            std::vector<TfToken> *properties)
+    {
+      if (!_IsNamespacedName()) {
+        return false;
+      }
+      const TfToken name(_tok.GetText());
+      _Lex();
+
+      // Time samples, defaults and the single target form are rare; leave
+      // them to the generated parser.
+      if (_IsPunct('.') || _IsPunct('[')) {
+        return false;
+      }
+
+      if (!SdfPath::IsValidNamespacedIdentifier(name)) {
+        return false;
+      }
+      const SdfPath relPath = primPath.AppendProperty(name);
+      if (!_data->HasSpec(relPath)) {
+        properties->push_back(name);
+        _data->CreateSpec(relPath, SdfSpecTypeRelationship);
+      }
+      _SetField(relPath, SdfFieldKeys->Variability, variability);
+      if (custom) {
+        _SetField(relPath, SdfFieldKeys->Custom, custom);
+      }
+
+      boost::optional<SdfPathVector> targets;
+      if (_Accept('=')) {
+        targets = SdfPathVector();
+        auto parseItem = [&]() {
+          if (_tok.type != _TokPathRef) {
+            return false;
+          }
+          SdfPath path(_tok.str);
+          _Lex();
+          if (!path.IsAbsolutePath()) {
+            // Expand paths relative to the containing prim.
+            path = path.MakeAbsolutePath(relPath.GetPrimPath());
+          }
+          targets->push_back(path);
+          return true;
+        };
+        bool isNone;
+        if (!_ParseItemList(parseItem, &isNone)) {
+          return false;
+        }
+      }
+
+      if (_IsPunct('(') && !_ParseMetadataList(relPath, SdfSpecTypeRelationship)) {
+        return false;
+      }
+
+      if (!targets) {
+        return true;
+      }
+
+      for (const SdfPath &path : *targets) {
+        if (!SdfSchema::IsValidRelationshipTargetPath(path)) {
+          return false;
+        }
+      }
+
+      SdfPathVector newTargetChildren;
+      for (const SdfPath &target : *targets) {
+        const SdfPath path = relPath.AppendTarget(target);
+        if (!_data->HasSpec(path)) {
+          _data->CreateSpec(path, SdfSpecTypeRelationshipTarget);
+          newTargetChildren.push_back(target);
+        }
+      }
+
+      if (!_SetListOpItems(relPath, SdfFieldKeys->TargetPaths, SdfListOpTypeExplicit, *targets)) {
+        return false;
+      }
+
+      if (!newTargetChildren.empty()) {
+        std::vector<SdfPath> children = _data->GetAs<std::vector<SdfPath>>(
+          relPath, SdfChildrenKeys->RelationshipTargetChildren);
+        children.insert(children.end(), newTargetChildren.begin(), newTargetChildren.end());
+        _SetField(relPath, SdfChildrenKeys->RelationshipTargetChildren, children);
+      }
+      return true;
+    }
+
+    // prim_property
+    bool _ParseProperty(const SdfPath &primPath, std::vector<TfToken> *properties)
+    {
+      bool custom = false;
+      if (_IsKeyword(_KwCustom)) {
+        custom = true;
+        _Lex();
+      }
+
+      if (_IsKeyword(_KwVarying) || _IsKeyword(_KwRel)) {
+        SdfVariability variability = SdfVariabilityUniform;
+        if (_IsKeyword(_KwVarying)) {
+          variability = SdfVariabilityVarying;
+          _Lex();
+          if (!_IsKeyword(_KwRel)) {
+            return false;
+          }
+        }
+        _Lex();
+        return _ParseRelationship(primPath, custom, variability, properties);
+      }
+
+      VtValue variability;
+      if (_IsKeyword(_KwUniform) || _IsKeyword(_KwConfig)) {
+        // Legacy "config" variability is read as uniform.
+        variability = VtValue(SdfVariabilityUniform);
+        _Lex();
+      }
+      return _ParseAttribute(primPath, custom, variability, properties);
+    }
+
+    // Prims
+
+    // prim_stmt, with the specifier keyword current.
+    bool _ParsePrim(const SdfPath &parentPath, std::vector<TfToken> *parentChildren)
+    {
+      SdfSpecifier specifier;
+      switch (_IsIdentifier() ? _KwNone : _tok.keyword) {
+        case _KwDef:
+          specifier = SdfSpecifierDef;
+          break;
+        case _KwOver:
+          specifier = SdfSpecifierOver;
+          break;
+        case _KwClass:
+          specifier = SdfSpecifierClass;
+          break;
+        default:
+          return false;
+      }
+      _Lex();
+
+      // prim_type_name: identifier ('.' identifier)*
+      std::string typeName;
+      if (_IsIdentifier()) {
+        typeName = _tok.GetText();
+        _Lex();
+        while (_Accept('.')) {
+          if (!_IsIdentifier()) {
+            return false;
+          }
+          typeName += '.';
+          typeName.append(_tok.text, _tok.length);
+          _Lex();
+        }
+      }
+
+      if (_tok.type != _TokString) {
+        return false;
+      }
+      const TfToken name(_tok.str);
+      _Lex();
+      if (!SdfPath::IsValidIdentifier(name)) {
+        return false;
+      }
+
+      const SdfPath path = parentPath.AppendChild(name);
+      if (_data->HasSpec(path)) {
+        return false;
+      }
+      _data->CreateSpec(path, SdfSpecTypePrim);
+      parentChildren->push_back(name);
+
+      _SetField(path, SdfFieldKeys->Specifier, specifier);
+      if (!typeName.empty()) {
+        _SetField(path, SdfFieldKeys->TypeName, TfToken(typeName));
+      }
+
+      _SkipNewlines();
+      if (_IsPunct('(')) {
+        if (!_ParseMetadataList(path, SdfSpecTypePrim)) {
+          return false;
+        }
+        _SkipNewlines();
+      }
+
+      if (!_Accept('{')) {
+        return false;
+      }
+      _SkipNewlines();
+
+      std::vector<TfToken> children;
+      std::vector<TfToken> properties;
+      while (!_Accept('}')) {
+        if (_IsKeyword(_KwDef) || _IsKeyword(_KwOver) || _IsKeyword(_KwClass)) {
+          if (!_ParsePrim(path, &children)) {
+            return false;
+          }
+          if (_tok.type != _TokNewline) {
+            return false;
+          }
+          _SkipNewlines();
+        } else {
+          if (!_ParseProperty(path, &properties) || !_AcceptStmtSep()) {
+            return false;
+          }
+        }
+      }
+
+      if (!children.empty()) {
+        _SetField(path, SdfChildrenKeys->PrimChildren, children);
+      }
+      if (!properties.empty()) {
+        _SetField(path, SdfChildrenKeys->PropertyChildren, properties);
+      }
+      return true;
+    }
+
+    _Lexer _lexer;
+    _Token _tok;
+    SdfDataRefPtr _data;
+    Sdf_ParserValueContext _values;
+    bool _valueError;
+  };
+
+  ////////////////////////////////////////////////////////////////////////
+  // Pre-scan
+
+  // Skip past a string, asset path, scene path or comment starting at \p p,
+  // following the same delimiter rules as the lexer.  Returns \p p unchanged
+  // if there is no such token there, and nullptr if it is unterminated.
+  const char *_SkipOpaque(const char *p, const char *end)
+  {
+    const char c = *p;
+    if (c == '"' || c == '\'') {
+      if (end - p > 2 && p[1] == c && p[2] == c) {
+        for (p += 3; p < end; ++p) {
+          if (*p == '\\') {
+            ++p;
+          } else if (*p == c && end - p > 2 && p[1] == c && p[2] == c) {
+            return p + 3;
+          }
+        }
+        return nullptr;
+      }
+      for (++p; p < end; ++p) {
+        if (*p == '\\') {
+          ++p;
+        } else if (*p == c) {
+          return p + 1;
+        } else if (*p == '\r' || *p == '\n') {
+          return nullptr;
+        }
+      }
+      return nullptr;
+    }
+    if (c == '@') {
+      if (end - p > 2 && p[1] == '@' && p[2] == '@') {
+        for (p += 3; p < end; ++p) {
+          if (*p == '\\') {
+            ++p;
+          } else if (*p == '@' && end - p > 2 && p[1] == '@' && p[2] == '@') {
+            return p + 3;
+          }
+        }
+        return nullptr;
+      }
+      const char *q = p + 1;
+      while (q != end && *q != '@' && *q != '\n') {
+        ++q;
+      }
+      return (q != end && *q == '@') ? q + 1 : p + 1;
+    }
+    if (c == '<') {
+      const char *q = p + 1;
+      while (q != end && *q != '<' && *q != '>' && *q != '\r' && *q != '\n') {
+        ++q;
+      }
+      return (q != end && *q == '>') ? q + 1 : p + 1;
+    }
+    if (c == '#' || (c == '/' && end - p > 1 && p[1] == '/')) {
+      while (p != end && *p != '\r' && *p != '\n') {
+        ++p;
+      }
+      return p;
+    }
+    if (c == '/' && end - p > 1 && p[1] == '*') {
+      for (p += 2; end - p > 1; ++p) {
+        if (p[0] == '*' && p[1] == '/') {
+          return p + 2;
+        }
+      }
+      return nullptr;
+    }
+    return p;
+  }
+
+  // Return the end of the bracketed group or statement starting at \p p:
+  // either just past the ')' matching an opening '(' or just past the '}'
+  // that closes the outermost brace of a prim statement.  Returns nullptr if
+  // the brackets are unbalanced.
+  const char *_FindGroupEnd(const char *p, const char *end, char closer)
+  {
+    int depth = 0;
+    while (p < end) {
+      const char *q = _SkipOpaque(p, end);
+      if (!q) {
+        return nullptr;
+      }
+      if (q != p) {
+        p = q;
+        continue;
+      }
+      const char c = *p++;
+      if (c == '(' || c == '[' || c == '{') {
+        ++depth;
+      } else if (c == ')' || c == ']' || c == '}') {
+        if (--depth < 0) {
+          return nullptr;
+        }
+        if (depth == 0 && c == closer) {
+          return p;
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  // Skip blanks, comments and newlines, recording whether a newline token
+  // was seen.
+  const char *_SkipSpace(const char *p, const char *end, bool *sawNewline)
+  {
+    while (p != end) {
+      if (*p == ' ' || *p == '\t') {
+        ++p;
+      } else if (*p == '\r' || *p == '\n') {
+        *sawNewline = true;
+        ++p;
+      } else if (*p == '#' || *p == '/') {
+        const char *q = _SkipOpaque(p, end);
+        if (!q || q == p) {
+          return p;
+        }
+        p = q;
+      } else {
+        break;
+      }
+    }
+    return p;
+  }
+
+  typedef std::pair<const char *, const char *> _Range;
+
+  // Split the layer into the header (magic cookie and layer metadata) and
+  // one range per top-level prim statement.  Returns false if the layer
+  // contains anything else at the top level.
+  bool _SplitLayer(const char *begin,
+                   const char *end,
+                   const char **headerEnd,
+                   std::vector<_Range> *prims)
+  {
+    // The first line holds the magic cookie.
+    const char *p = begin;
+    while (p != end && *p != '\r' && *p != '\n') {
+      ++p;
+    }
+
+    bool sawNewline = false;
+    p = _SkipSpace(p, end, &sawNewline);
+    if (p != end && *p == '(') {
+      p = _FindGroupEnd(p, end, ')');
+      if (!p) {
+        return false;
+      }
+      sawNewline = true;
+      p = _SkipSpace(p, end, &sawNewline);
+    }
+
+    *headerEnd = p;
+    while (p != end) {
+      // Top-level prims must be separated by newlines.
+      if (!sawNewline) {
+        return false;
+      }
+      const char *wordEnd = _SkipIdent(p, end);
+      const _Keyword kw = _FindKeyword(p, wordEnd - p);
+      if (wordEnd == end || (kw != _KwDef && kw != _KwOver && kw != _KwClass)) {
+        return false;
+      }
+      const char *primEnd = _FindGroupEnd(wordEnd, end, '}');
+      if (!primEnd) {
+        return false;
+      }
+      prims->emplace_back(p, primEnd);
+
+      sawNewline = false;
+      p = _SkipSpace(primEnd, end, &sawNewline);
+    }
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  // Merging
+
+  class _SpecCopier : public SdfAbstractDataSpecVisitor
+  {
+   public:
+
+    explicit _SpecCopier(SdfAbstractData *dst) : _dst(dst) {}
+
+    bool VisitSpec(const SdfAbstractData &src, const SdfPath &path) override
+    {
+      if (path == SdfPath::AbsoluteRootPath()) {
+        return true;
+      }
+      _dst->CreateSpec(path, src.GetSpecType(path));
+      for (const TfToken &field : src.List(path)) {
+        _dst->Set(path, field, src.Get(path, field));
+      }
+      return true;
+    }
+
+    void Done(const SdfAbstractData &) override {}
+
+   private:
+
+    SdfAbstractData *_dst;
+  };
+
+  struct _PrimResult
+  {
+    SdfDataRefPtr data;
+    TfToken name;
+    SdfLayerHints hints{/*.mightHaveRelocates =*/false};
+    bool ok = false;
+  };
+
+  void _ParsePrimRange(const _Range &range, const std::string &cookie,
+                       const std::string &magicId,
+                       const std::string &versionString,
+                       _PrimResult *result)
+  {
+    TfErrorMark mark;
+
+    result->data = TfCreateRefPtr(new SdfData);
+    if (_Parser(range.first, range.second, result->data).ParseRootPrim(&result->name) &&
+        mark.IsClean()) {
+      result->ok = true;
+      return;
+    }
+    mark.Clear();
+
+    // Hand prims using syntax we don't handle to the generated parser.
+    TF_DEBUG(SDF_FILE_FORMAT)
+      .Msg("Sdf_ParseLayerFast: using generated parser for prim at '%s'\n",
+           TfStringTrim(std::string(range.first, std::find(range.first, range.second, '\n')))
+             .c_str());
+
+    result->data = TfCreateRefPtr(new SdfData);
+    std::string text = cookie;
+    text.append(range.first, range.second);
+    if (!Sdf_ParseLayerFromString(text, magicId, versionString, result->data, &result->hints) ||
+        !mark.IsClean()) {
+      mark.Clear();
+      return;
+    }
+
+    const TfTokenVector names = result->data->GetAs<TfTokenVector>(
+      SdfPath::AbsoluteRootPath(), SdfChildrenKeys->PrimChildren);
+    if (names.size() == 1) {
+      result->name = names.front();
+      result->ok = true;
+    }
+  }
+
+}  // end anonymous namespace
+
+bool Sdf_ParseLayerFast(const std::string &fileContext,
+                        const std::shared_ptr<ArAsset> &asset,
+                        const std::string &magicId,
+                        const std::string &versionString,
+                        SdfDataRefPtr data,
+                        SdfLayerHints *hints)
+{
+  TfAutoMallocTag2 tag("Sdf", "Sdf_ParseLayerFast");
+
+  TRACE_FUNCTION();
+
+  const size_t size = asset->GetSize();
+  std::shared_ptr<const char> buffer = asset->GetBuffer();
+  if (!buffer || size == 0) {
+    return false;
+  }
+  const char *begin = buffer.get();
+  const char *end = begin + size;
+
+  const char *headerEnd = nullptr;
+  std::vector<_Range> primRanges;
+  {
+    TRACE_SCOPE("Sdf_ParseLayerFast: pre-scan");
+    if (!_SplitLayer(begin, end, &headerEnd, &primRanges) || primRanges.empty()) {
+      TF_DEBUG(SDF_FILE_FORMAT)
+        .Msg("Sdf_ParseLayerFast: could not split @%s@ into top-level prims\n",
+             fileContext.c_str());
+      return false;
+    }
+  }
+
+  // Parse each top-level prim into its own SdfData.
+  const std::string cookie = "#" + magicId + " " + versionString + "\n";
+  std::vector<_PrimResult> results(primRanges.size());
+  {
+    TRACE_SCOPE("Sdf_ParseLayerFast: parse prims");
+    WorkParallelForN(primRanges.size(), [&](size_t b, size_t e) {
+      for (size_t i = b; i != e; ++i) {
+        _ParsePrimRange(primRanges[i], cookie, magicId, versionString, &results[i]);
+      }
+    });
+  }
+
+  TfTokenVector rootPrims;
+  rootPrims.reserve(results.size());
+  TfToken::HashSet seenRootPrims;
+  for (const _PrimResult &result : results) {
+    if (!result.ok || !seenRootPrims.insert(result.name).second) {
+      return false;
+    }
+    rootPrims.push_back(result.name);
+  }
+
+  // The layer header is small; parse it with the generated parser so that
+  // the magic cookie and layer metadata are handled identically.
+  SdfDataRefPtr headerData = TfCreateRefPtr(new SdfData);
+  SdfLayerHints headerHints;
+  {
+    TfErrorMark mark;
+    if (!Sdf_ParseLayerFromString(
+          std::string(begin, headerEnd), magicId, versionString, headerData, &headerHints) ||
+        !mark.IsClean()) {
+      mark.Clear();
+      return false;
+    }
+  }
+
+  // Merge everything into the destination data.
+  TRACE_SCOPE("Sdf_ParseLayerFast: merge");
+
+  const SdfPath &rootPath = SdfPath::AbsoluteRootPath();
+  data->CreateSpec(rootPath, SdfSpecTypePseudoRoot);
+  for (const TfToken &field : headerData->List(rootPath)) {
+    data->Set(rootPath, field, headerData->Get(rootPath, field));
+  }
+
+  bool mightHaveRelocates = headerHints.mightHaveRelocates;
+  _SpecCopier copier(get_pointer(data));
+  for (const _PrimResult &result : results) {
+    result.data->VisitSpecs(&copier);
+    mightHaveRelocates |= result.hints.mightHaveRelocates;
+  }
+  data->Set(rootPath, SdfChildrenKeys->PrimChildren, VtValue(rootPrims));
+
+  *hints = SdfLayerHints(mightHaveRelocates);
+  return true;
+}
+
+WABI_NAMESPACE_END
@@ -0,0 +1,62 @@
+//
+// Copyright 2016 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef WABI_USD_SDF_TEXT_FAST_PARSER_H
+#define WABI_USD_SDF_TEXT_FAST_PARSER_H
+
+#include "wabi/wabi.h"
+#include "wabi/usd/sdf/api.h"
+#include "wabi/usd/sdf/data.h"
+#include "wabi/usd/sdf/layerHints.h"
+
+#include <memory>
+#include <string>
+
+WABI_NAMESPACE_BEGIN
+
+class ArAsset;
+
+// Parse a text layer into an SdfData using a hand-written recursive-descent
+// parser that reads the asset's (memory-mapped) buffer directly.
+//
+// The layer is pre-scanned to split it into its header and top-level prim
+// statements, and the prims are parsed in parallel into separate SdfData
+// objects that are merged into \p data afterwards.  Prims using syntax the
+// hand-written parser does not handle are re-parsed with the generated
+// parser.
+//
+// Returns false without emitting errors and without modifying \p data if the
+// layer could not be parsed this way (including when the layer contains
+// errors), in which case the caller should fall back to Sdf_ParseLayer so
+// that diagnostics are reported with the correct file context.
+SDF_API
+bool Sdf_ParseLayerFast(const std::string &fileContext,
+                        const std::shared_ptr<ArAsset> &asset,
+                        const std::string &magicId,
+                        const std::string &versionString,
+                        SdfDataRefPtr data,
+                        SdfLayerHints *hints);
+
+WABI_NAMESPACE_END
+
+#endif  // WABI_USD_SDF_TEXT_FAST_PARSER_H
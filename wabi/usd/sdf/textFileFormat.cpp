@@ -29,6 +29,7 @@
 #include "wabi/usd/sdf/fileIO.h"
 #include "wabi/usd/sdf/fileIO_Common.h"
 #include "wabi/usd/sdf/layer.h"
+#include "wabi/usd/sdf/textFastParser.h"
 #include "wabi/usd/ar/asset.h"
 #include "wabi/usd/ar/resolvedPath.h"
 #include "wabi/usd/ar/resolver.h"
@@ -40,9 +41,13 @@
 #include "wabi/base/tf/registryManager.h"
 #include "wabi/base/tf/staticData.h"
 #include "wabi/base/arch/fileSystem.h"
+#include "wabi/base/work/loops.h"
+#include "wabi/base/work/threadLimits.h"
 
 #include <boost/assign.hpp>
+#include <algorithm>
 #include <ostream>
+#include <vector>
 
 using std::string;
 
@@ -55,6 +60,11 @@ TF_DEFINE_ENV_SETTING(
     "Warn when reading a text file larger than this number of MB "
     "(no warnings if set to 0)");
 
+TF_DEFINE_ENV_SETTING(
+    SDF_TEXTFILE_USE_FAST_PARSER, false,
+    "Read text layers with the hand-written parallel parser, falling back "
+    "to the generated parser for anything it does not handle");
+
 WABI_NAMESPACE_END
 
 // Our interface to the YACC layer parser for parsing to SdfData.
@@ -178,6 +188,17 @@ bool SdfTextFileFormat::_ReadFromAsset(SdfLayer *layer,
 
   SdfLayerHints hints;
   SdfAbstractDataRefPtr data = InitData(layer->GetFileFormatArguments());
+  if (!metadataOnly && TfGetEnvSetting(SDF_TEXTFILE_USE_FAST_PARSER) &&
+      Sdf_ParseLayerFast(resolvedPath,
+                         asset,
+                         GetFormatId(),
+                         GetVersionString(),
+                         TfDynamic_cast<SdfDataRefPtr>(data),
+                         &hints)) {
+    _SetLayerData(layer, data, hints);
+    return true;
+  }
+
   if (!Sdf_ParseLayer(resolvedPath,
                       asset,
                       GetFormatId(),
@@ -212,6 +233,103 @@ struct Sdf_IsLayerMetadataField : public Sdf_IsMetadataField
 #define _WriteNameVector Sdf_FileIOUtility::WriteNameVector
 #define _WriteLayerOffset Sdf_FileIOUtility::WriteLayerOffset
 
+// Approximate upper bound on the formatted root prim text that
+// _WriteRootPrimsConcurrently keeps in memory at once.
+static const size_t _maxBufferedRootPrimBytes = 64 * 1024 * 1024;
+
+// Returns a rough measure of how much text the subtree rooted at \p prim
+// formats to: one unit per spec, plus one per time sample and per element of
+// array-valued defaults.
+static size_t _EstimateSubtreeTextSize(const SdfPrimSpecHandle &prim)
+{
+  const SdfLayerHandle layer = prim->GetLayer();
+
+  size_t size = 1;
+  for (const SdfPropertySpecHandle &prop : prim->GetProperties()) {
+    const SdfPath &path = prop->GetPath();
+    size += 1 + layer->GetNumTimeSamplesForPath(path);
+    const VtValue value = layer->GetField(path, SdfFieldKeys->Default);
+    if (value.IsArrayValued()) {
+      size += value.GetArraySize();
+    }
+  }
+  const SdfVariantSetSpecHandleVector variantSets = prim->GetVariantSets();
+  for (const SdfVariantSetSpecHandle &variantSet : variantSets) {
+    for (const SdfVariantSpecHandle &variant : variantSet->GetVariantList()) {
+      size += _EstimateSubtreeTextSize(variant->GetPrimSpec());
+    }
+  }
+  for (const SdfPrimSpecHandle &child : prim->GetNameChildren()) {
+    size += _EstimateSubtreeTextSize(child);
+  }
+  return size;
+}
+
+// Root prim subtrees are independent, so format windows of consecutive root
+// prims concurrently into separate buffers and write those out in order.
+// Windows are sized so that their estimated text stays within
+// _maxBufferedRootPrimBytes, using the bytes per estimated unit observed so
+// far.  Prims that are expected to be large are streamed straight to the
+// output instead.
+static void _WriteRootPrimsConcurrently(const std::vector<SdfPrimSpecHandle> &rootPrims,
+                                        size_t numWorkers,
+                                        Sdf_TextOutput &out)
+{
+  std::vector<size_t> estimates(rootPrims.size());
+  WorkParallelForN(rootPrims.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i != end; ++i) {
+      estimates[i] = _EstimateSubtreeTextSize(rootPrims[i]);
+    }
+  });
+
+  const size_t maxWindowSize = 4 * numWorkers;
+  const double maxPrimBytes = double(_maxBufferedRootPrimBytes) / numWorkers;
+  double bytesPerUnit = 64.0;
+  size_t formattedBytes = 0;
+  size_t formattedUnits = 0;
+
+  std::vector<std::string> formattedPrims;
+  size_t i = 0;
+  while (i < rootPrims.size()) {
+    if (estimates[i] * bytesPerUnit > maxPrimBytes) {
+      _Write(out, 0, "\n");
+      Sdf_WritePrim(rootPrims[i].GetSpec(), out, 0);
+      ++i;
+      continue;
+    }
+
+    const size_t windowBegin = i;
+    double windowBytes = 0.0;
+    while (i < rootPrims.size() && i - windowBegin < maxWindowSize) {
+      const double primBytes = estimates[i] * bytesPerUnit;
+      if (primBytes > maxPrimBytes || windowBytes + primBytes > _maxBufferedRootPrimBytes) {
+        break;
+      }
+      windowBytes += primBytes;
+      ++i;
+    }
+    const size_t windowEnd = i;
+
+    formattedPrims.resize(windowEnd - windowBegin);
+    WorkParallelForN(windowEnd - windowBegin, [&](size_t begin, size_t end) {
+      for (size_t j = begin; j != end; ++j) {
+        Sdf_StringOutput primOut;
+        Sdf_WritePrim(rootPrims[windowBegin + j].GetSpec(), primOut, 0);
+        formattedPrims[j] = primOut.GetString();
+      }
+    });
+
+    for (size_t j = 0; j != formattedPrims.size(); ++j) {
+      _Write(out, 0, "\n");
+      out.Write(formattedPrims[j]);
+      formattedBytes += formattedPrims[j].size();
+      formattedUnits += estimates[windowBegin + j];
+      std::string().swap(formattedPrims[j]);
+    }
+    bytesPerUnit = std::max(1.0, double(formattedBytes) / formattedUnits);
+  }
+}
+
 static bool _WriteLayer(const SdfLayer *l,
                         Sdf_TextOutput &out,
                         const string &cookie,
@@ -287,7 +405,7 @@ static bool _WriteLayer(const SdfLayer *l,
   string headerStr = header.GetString();
   if (!headerStr.empty()) {
     _Write(out, 0, "(\n");
-    _Write(out, 0, "%s", headerStr.c_str());
+    out.Write(headerStr);
     _Write(out, 0, ")\n");
   }
 
@@ -301,10 +419,19 @@ static bool _WriteLayer(const SdfLayer *l,
     _Write(out, 0, "\n");
   }
 
-  // Root prims
-  for (const SdfPrimSpecHandle &rootPrim : l->GetRootPrims()) {
-    _Write(out, 0, "\n");
-    Sdf_WritePrim(rootPrim.GetSpec(), out, 0);
+  // Root prims.  With fewer root prims than workers, e.g. a layer with a
+  // single /World prim, there is little to gain from formatting them
+  // concurrently, so they are streamed straight to the output.
+  const SdfLayer::RootPrimsView rootPrimsView = l->GetRootPrims();
+  const std::vector<SdfPrimSpecHandle> rootPrims(rootPrimsView.begin(), rootPrimsView.end());
+  const size_t numWorkers = WorkGetConcurrencyLimit();
+  if (numWorkers < 2 || rootPrims.size() < numWorkers) {
+    for (const SdfPrimSpecHandle &rootPrim : rootPrims) {
+      _Write(out, 0, "\n");
+      Sdf_WritePrim(rootPrim.GetSpec(), out, 0);
+    }
+  } else {
+    _WriteRootPrimsConcurrently(rootPrims, numWorkers, out);
   }
 
   _Write(out, 0, "\n");
@@ -164,10 +164,13 @@ class Usd_CrateDataImpl
 
     // Now pack all the specs.
     if (CrateFile::Packer packer = _crateFile->StartPacking(fileName)) {
+      vector<CrateFile::SpecToPack> specs;
+      specs.reserve(sortedPaths.size());
       for (auto const &p : sortedPaths) {
         auto iter = _data.find(p);
-        packer.PackSpec(p, iter->second.specType, iter->second.fields.Get());
+        specs.emplace_back(p, iter->second.specType, &iter->second.fields.Get());
       }
+      packer.PackSpecs(specs);
       if (packer.Close()) {
         return _PopulateFromCrateFile();
       }
@@ -54,6 +54,7 @@
 #include "wabi/base/tf/envSetting.h"
 #include "wabi/base/tf/errorMark.h"
 #include "wabi/base/tf/fastCompression.h"
+#include "wabi/base/tf/fileUtils.h"
 #include "wabi/base/tf/getenv.h"
 #include "wabi/base/tf/hash.h"
 #include "wabi/base/tf/mallocTag.h"
@@ -68,6 +69,7 @@
 #include "wabi/base/vt/dictionary.h"
 #include "wabi/base/vt/value.h"
 #include "wabi/base/work/dispatcher.h"
+#include "wabi/base/work/loops.h"
 #include "wabi/base/work/singularTask.h"
 #include "wabi/base/work/utils.h"
 #include "wabi/base/work/withScopedParallelism.h"
@@ -85,9 +87,13 @@
 #include "wabi/usd/sdf/types.h"
 
 #include <tbb/concurrent_queue.h>
+#include <tbb/concurrent_unordered_map.h>
 
+#include <atomic>
 #include <iostream>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <tuple>
 #include <type_traits>
 
@@ -142,6 +148,36 @@ TF_DEFINE_ENV_SETTING(
     "files on disk, but these functions may be used indirectly by ArAsset "
     "implementations.");
 
+TF_DEFINE_ENV_SETTING(
+    USDC_PARALLEL_READ_STRUCTURAL_SECTIONS, true,
+    "If set, decode the independent structural sections of Crate files "
+    "(strings, fields, field sets and specs) concurrently with the tokens "
+    "and paths sections when opening a file.");
+
+TF_DEFINE_ENV_SETTING(
+    USDC_DECOMPRESSED_ARRAY_CACHE_MB, 0,
+    "If set to a nonzero value, each Crate file keeps up to this many "
+    "megabytes of decompressed array values (for example compressed "
+    "faceVertexIndices) so that repeated reads of the same value share a "
+    "single VtArray instead of decompressing it again.  Least recently used "
+    "arrays are evicted first.");
+
+TF_DEFINE_ENV_SETTING(
+    USDC_PARALLEL_ARRAY_PACKING, false,
+    "If set, hash and compress large array values on worker threads ahead of "
+    "the thread writing a Crate file.  Values are still written in the same "
+    "order, so the resulting file is byte-identical.");
+
+TF_DEFINE_ENV_SETTING(
+    USDC_DECOMPRESSION_CACHE_DIR, "",
+    "If set to a directory, the decompressed structural sections (tokens, "
+    "strings, fields, field sets, paths and specs) of Crate files read from "
+    "disk are saved there uncompressed, and later opens of an unmodified file "
+    "read that cache instead of decompressing the sections again.  This only "
+    "saves decompression time: every process still builds its own tokens, "
+    "paths and tables from the cache.  Caches are keyed by asset path and "
+    "validated against the file's size, modification time and header.");
+
 static int _GetMMapPrefetchKB()
 {
   auto getKB = []() {
@@ -357,6 +393,8 @@ namespace Usd_CrateFile
   using std::vector;
 
   // Version history:
+  // 0.10.0: Compressed floating point arrays (scalar and vector valued) that
+  //         are written byte-shuffled and LZ4 compressed.
   // 0.9.0: Added support for the timecode and timecode[] value types.
   // 0.8.0: Added support for SdfPayloadListOp values and SdfPayload values with
   //        layer offsets.
@@ -371,7 +409,7 @@ namespace Usd_CrateFile
   //        See _PathItemHeader_0_0_1.
   // 0.0.1: Initial release.
   constexpr uint8_t USDC_MAJOR = 0;
-  constexpr uint8_t USDC_MINOR = 9;
+  constexpr uint8_t USDC_MINOR = 10;
   constexpr uint8_t USDC_PATCH = 0;
 
   CrateFile::Version CrateFile::Version::FromString(char const *str)
@@ -683,6 +721,10 @@ namespace Usd_CrateFile
     {
       return _cur - _mapping->GetMapStart();
     }
+    inline int64_t GetSize() const
+    {
+      return _mapping->GetLength();
+    }
     inline void Seek(int64_t offset)
     {
       _cur = _mapping->GetMapStart() + offset;
@@ -740,6 +782,7 @@ namespace Usd_CrateFile
     template<class FileRange>
     explicit _PreadStream(FileRange const &fr) : _start(fr.startOffset),
                                                  _cur(0),
+                                                 _size(fr.GetLength()),
                                                  _file(fr.file)
     {}
     inline void Read(void *dest, size_t nBytes)
@@ -750,6 +793,10 @@ namespace Usd_CrateFile
     {
       return _cur;
     }
+    inline int64_t GetSize() const
+    {
+      return _size;
+    }
     inline void Seek(int64_t offset)
     {
       _cur = offset;
@@ -763,6 +810,7 @@ namespace Usd_CrateFile
 
     int64_t _start;
     int64_t _cur;
+    int64_t _size;
     FILE *_file;
   };
 
@@ -780,6 +828,10 @@ namespace Usd_CrateFile
     {
       return _cur;
     }
+    inline int64_t GetSize() const
+    {
+      return _asset->GetSize();
+    }
     inline void Seek(int64_t offset)
     {
       _cur = offset;
@@ -992,6 +1044,51 @@ namespace Usd_CrateFile
     WorkSingularTask _writeTask;
   };
 
+  ////////////////////////////////////////////////////////////////////////
+  // _ArrayEncodings
+
+  // An array value that was hashed, and possibly encoded, ahead of being
+  // packed.
+  struct _ArrayEncoding
+  {
+    // The array's hash, as computed by _Hasher.
+    size_t hash = 0;
+    // The version the array was encoded for.
+    CrateFile::Version version;
+    // True if the array was encoded.  If the array is written compressed,
+    // bytes holds its encoding and rep its value rep, with a zero payload.
+    // Otherwise the array is written uncompressed.
+    bool isEncoded = false;
+    ValueRep rep;
+    vector<char> bytes;
+  };
+
+  struct CrateFile::_ArrayEncodings
+  {
+    using _Key = std::pair<void const *, size_t>;
+
+    template<class T> _ArrayEncoding const *Find(VtArray<T> const &array) const
+    {
+      auto iter = _map.find(_Key(array.cdata(), array.size()));
+      return iter == _map.end() ? nullptr : &iter->second;
+    }
+
+    template<class T> void Insert(VtArray<T> const &array, _ArrayEncoding &&encoding)
+    {
+      _map.insert(std::make_pair(_Key(array.cdata(), array.size()), std::move(encoding)));
+    }
+
+    // Not thread-safe.
+    void Clear()
+    {
+      _map.clear();
+    }
+
+   private:
+
+    tbb::concurrent_unordered_map<_Key, _ArrayEncoding, boost::hash<_Key>> _map;
+  };
+
   ////////////////////////////////////////////////////////////////////////
   // _PackingContext
   struct CrateFile::_PackingContext
@@ -1109,6 +1206,12 @@ namespace Usd_CrateFile
       return true;
     }
 
+    // Return the encoding for \p array computed ahead of packing, or null.
+    template<class T> _ArrayEncoding const *FindArrayEncoding(VtArray<T> const &array) const
+    {
+      return arrayEncodings ? arrayEncodings->Find(array) : nullptr;
+    }
+
     // Read the bytes of some unknown section into memory so we can rewrite them
     // out later (to preserve it).
     RawDataPtr _ReadSectionBytes(_Section const &sec, CrateFile *crate) const
@@ -1138,6 +1241,8 @@ namespace Usd_CrateFile
     _BufferedOutput bufferedOutput;
     // Output destination.
     OutputType outputAsset;
+    // Array values encoded ahead of packing, if any.  See _PackPipelined.
+    _ArrayEncodings const *arrayEncodings = nullptr;
   };
 
   /////////////////////////////////////////////////////////////////////////
@@ -1235,6 +1340,13 @@ namespace Usd_CrateFile
       src.Seek(offset);
     }
 
+    // Return the number of bytes between the current position and the end
+    // of the crate data.
+    int64_t GetRemainingSize() const
+    {
+      return std::max<int64_t>(src.GetSize() - src.Tell(), 0);
+    }
+
     // Map helper.
     template<class Map> Map ReadMap()
     {
@@ -1831,6 +1943,8 @@ namespace Usd_CrateFile
   template<class T, class Enable>
   struct CrateFile::_ArrayValueHandlerBase : _ScalarValueHandlerBase<T>
   {
+    static void EncodeVtValue(VtValue const &, Version, _ArrayEncodings *) {}
+
     ValueRep PackVtValue(_Writer w, VtValue const &v)
     {
       return this->Pack(w, v.UncheckedGet<T>());
@@ -1886,6 +2000,113 @@ namespace Usd_CrateFile
     w.WriteContiguous(compBuffer.get(), compSize);
   }
 
+  // Transpose \p numScalars scalars of \p scalarSize bytes each so that the
+  // i'th byte of every scalar is stored contiguously.  Neighboring floating
+  // point values tend to share sign and exponent bytes, so the shuffled bytes
+  // compress far better than the interleaved ones.
+  static inline void _ShuffleBytes(char const *in,
+                                   char *out,
+                                   size_t numScalars,
+                                   size_t scalarSize)
+  {
+    for (size_t b = 0; b != scalarSize; ++b) {
+      char *plane = out + b * numScalars;
+      for (size_t i = 0; i != numScalars; ++i) {
+        plane[i] = in[i * scalarSize + b];
+      }
+    }
+  }
+
+  // Inverse of _ShuffleBytes.
+  static inline void _UnshuffleBytes(char const *in,
+                                     char *out,
+                                     size_t numScalars,
+                                     size_t scalarSize)
+  {
+    for (size_t b = 0; b != scalarSize; ++b) {
+      char const *plane = in + b * numScalars;
+      for (size_t i = 0; i != numScalars; ++i) {
+        out[i * scalarSize + b] = plane[i];
+      }
+    }
+  }
+
+  // Byte-shuffle and LZ4 compress \p numScalars floating point scalars of
+  // \p scalarSize bytes into \p compBuffer and return the compressed size.
+  // Return 0 if compressing doesn't save space.
+  static inline uint64_t _CompressShuffledFloats(char const *data,
+                                                 size_t numScalars,
+                                                 size_t scalarSize,
+                                                 std::unique_ptr<char[]> *compBuffer)
+  {
+    const size_t numBytes = numScalars * scalarSize;
+    if (numBytes > TfFastCompression::GetMaxInputSize()) {
+      return 0;
+    }
+    std::unique_ptr<char[]> shuffled(new char[numBytes]);
+    _ShuffleBytes(data, shuffled.get(), numScalars, scalarSize);
+    compBuffer->reset(new char[TfFastCompression::GetCompressedBufferSize(numBytes)]);
+    uint64_t compSize = TfFastCompression::CompressToBuffer(shuffled.get(),
+                                                            compBuffer->get(),
+                                                            numBytes);
+    // Account for the code byte and the compressed size we write.
+    if (compSize + sizeof(int8_t) + sizeof(uint64_t) >= numBytes) {
+      return 0;
+    }
+    return compSize;
+  }
+
+  // Write data compressed by _CompressShuffledFloats.
+  template<class Writer>
+  static inline void _WriteShuffledFloats(Writer w, char const *compressed, uint64_t compSize)
+  {
+    // Lowercase 's' code indicates byte-shuffled, LZ4 compressed floats.
+    w.template WriteAs<int8_t>('s');
+    w.template WriteAs<uint64_t>(compSize);
+    w.WriteContiguous(compressed, compSize);
+  }
+
+  // Read data written by _WriteShuffledFloats, after its 's' code.
+  template<class Reader>
+  static inline void _ReadShuffledFloats(Reader &reader,
+                                         char *out,
+                                         size_t numScalars,
+                                         size_t scalarSize)
+  {
+    const size_t numBytes = numScalars * scalarSize;
+    auto compSize = reader.template Read<uint64_t>();
+    // The compressed size comes from the file, so make sure it is plausible
+    // before allocating and reading that many bytes.
+    if (numBytes > TfFastCompression::GetMaxInputSize() ||
+        compSize > TfFastCompression::GetCompressedBufferSize(numBytes) ||
+        compSize > static_cast<uint64_t>(reader.GetRemainingSize())) {
+      TF_RUNTIME_ERROR(
+        "Corrupt data stream detected reading shuffled floating point "
+        "array in <%s>: compressed size %" PRIu64 " is invalid for %zu "
+        "bytes of data",
+        reader.crate->GetAssetPath().c_str(),
+        compSize,
+        numBytes);
+      memset(out, 0, numBytes);
+      return;
+    }
+    std::unique_ptr<char[]> compBuffer(new char[compSize]);
+    reader.ReadContiguous(compBuffer.get(), compSize);
+    std::unique_ptr<char[]> shuffled(new char[numBytes]);
+    if (TfFastCompression::DecompressFromBuffer(compBuffer.get(),
+                                                shuffled.get(),
+                                                compSize,
+                                                numBytes) != numBytes) {
+      TF_RUNTIME_ERROR(
+        "Corrupt data stream detected reading shuffled floating point "
+        "array in <%s>",
+        reader.crate->GetAssetPath().c_str());
+      memset(out, 0, numBytes);
+      return;
+    }
+    _UnshuffleBytes(shuffled.get(), out, numScalars, scalarSize);
+  }
+
   template<class Writer, class T>
   static inline
     typename std::enable_if<std::is_same<T, int>::value || std::is_same<T, unsigned int>::value ||
@@ -1976,6 +2197,19 @@ namespace Usd_CrateFile
       return result;
     }
 
+    // Version 0.10.0 can write byte-shuffled, LZ4 compressed floats.
+    if (ver >= CrateFile::Version(0, 10, 0)) {
+      std::unique_ptr<char[]> compBuffer;
+      if (uint64_t compSize = _CompressShuffledFloats(
+            reinterpret_cast<char const *>(array.cdata()), array.size(), sizeof(T), &compBuffer)) {
+        auto result = ValueRepForArray<T>(w.Tell());
+        w.template WriteAs<uint64_t>(array.size());
+        result.SetIsCompressed();
+        _WriteShuffledFloats(w, compBuffer.get(), compSize);
+        return result;
+      }
+    }
+
     // Otherwise, just write uncompressed floats.  We don't need to write a code
     // byte here like the 'i' and 't' above since the resulting ValueRep is not
     // marked compressed -- the reader code will thus just read the uncompressed
@@ -1983,6 +2217,164 @@ namespace Usd_CrateFile
     return _WriteUncompressedArray(w, array, ver);
   }
 
+  template<class Writer, class T>
+  static inline
+    typename std::enable_if<GfIsGfVec<T>::value && GfIsFloatingPoint<typename T::ScalarType>::value,
+                            ValueRep>::type
+    _WritePossiblyCompressedArray(Writer w, VtArray<T> const &array, CrateFile::Version ver, int)
+  {
+    // Version 0.10.0 introduced compressed floating point vector arrays.
+    if (ver < CrateFile::Version(0, 10, 0) || array.size() < MinCompressedArraySize) {
+      return _WriteUncompressedArray(w, array, ver);
+    }
+
+    // Shuffle per scalar component rather than per vector, so that like
+    // bytes of all components end up next to each other.
+    std::unique_ptr<char[]> compBuffer;
+    if (uint64_t compSize = _CompressShuffledFloats(reinterpret_cast<char const *>(array.cdata()),
+                                                    array.size() * T::dimension,
+                                                    sizeof(typename T::ScalarType),
+                                                    &compBuffer)) {
+      auto result = ValueRepForArray<T>(w.Tell());
+      w.template WriteAs<uint64_t>(array.size());
+      result.SetIsCompressed();
+      _WriteShuffledFloats(w, compBuffer.get(), compSize);
+      return result;
+    }
+    return _WriteUncompressedArray(w, array, ver);
+  }
+
+  // Don't encode arrays smaller than this ahead of packing.
+  constexpr size_t MinPipelinedArraySize = 1024;
+
+  // A writer that captures the encoding of a compressed array in memory, so
+  // that it can be computed ahead of packing.  The array writing functions
+  // only Align() when writing uncompressed data, which is cheap to redo when
+  // packing, so any writes after that are dropped.  Copies share state.
+  class _ArrayEncodingWriter
+  {
+   public:
+
+    explicit _ArrayEncodingWriter(vector<char> *bytes) : _bytes(bytes), _discard(new bool(false))
+    {}
+
+    int64_t Tell() const
+    {
+      return _bytes->size();
+    }
+    int64_t Align(int)
+    {
+      *_discard = true;
+      return Tell();
+    }
+    bool IsDiscarding() const
+    {
+      return *_discard;
+    }
+
+    template<class U, class T> void WriteAs(T const &obj)
+    {
+      U const u = static_cast<U>(obj);
+      WriteContiguous(&u, 1);
+    }
+
+    template<class T> void WriteContiguous(T const *values, size_t sz)
+    {
+      static_assert(_IsBitwiseReadWrite<T>::value, "");
+      if (!*_discard) {
+        char const *bytes = reinterpret_cast<char const *>(values);
+        _bytes->insert(_bytes->end(), bytes, bytes + sz * sizeof(T));
+      }
+    }
+
+   private:
+
+    vector<char> *_bytes;
+    std::shared_ptr<bool> _discard;
+  };
+
+  // Element types whose arrays may be written compressed.
+  template<class T> struct _IsCompressibleArrayElement
+  {
+    static constexpr bool value = std::is_same<T, int>::value ||
+                                  std::is_same<T, unsigned int>::value ||
+                                  std::is_same<T, int64_t>::value ||
+                                  std::is_same<T, uint64_t>::value ||
+                                  GfIsFloatingPoint<T>::value;
+  };
+  template<class T> struct _IsCompressibleArrayElement<VtArray<T>> : std::false_type
+  {};
+
+  template<class T, class = void> struct _IsCompressibleArrayType
+    : _IsCompressibleArrayElement<T>
+  {};
+  template<class T>
+  struct _IsCompressibleArrayType<T, typename std::enable_if<GfIsGfVec<T>::value>::type>
+    : GfIsFloatingPoint<typename T::ScalarType>
+  {};
+
+  // Encode \p array as _WritePossiblyCompressedArray would write it for
+  // \p ver into \p encoding.
+  template<class T>
+  static inline typename std::enable_if<_IsCompressibleArrayType<T>::value>::type
+  _EncodeArray(VtArray<T> const &array, CrateFile::Version ver, _ArrayEncoding *encoding)
+  {
+    // Older versions write arrays differently, see PackArray.
+    if (ver < CrateFile::Version(0, 5, 0) || array.size() < MinCompressedArraySize) {
+      return;
+    }
+    _ArrayEncodingWriter w(&encoding->bytes);
+    encoding->rep = _WritePossiblyCompressedArray(w, array, ver, 0);
+    encoding->isEncoded = true;
+    if (!encoding->rep.IsCompressed()) {
+      TF_VERIFY(w.IsDiscarding());
+      TfReset(encoding->bytes);
+    }
+  }
+
+  template<class T>
+  static inline typename std::enable_if<!_IsCompressibleArrayType<T>::value>::type
+  _EncodeArray(VtArray<T> const &, CrateFile::Version, _ArrayEncoding *)
+  {
+    // Only hash arrays that are always written uncompressed.
+  }
+
+  // Write \p array using an \p encoding made by _EncodeArray.
+  template<class Writer, class T>
+  static inline ValueRep _WriteArrayEncoding(Writer w,
+                                             VtArray<T> const &array,
+                                             _ArrayEncoding const &encoding)
+  {
+    if (!encoding.rep.IsCompressed()) {
+      return _WriteUncompressedArray(w, array, encoding.version);
+    }
+    ValueRep result = encoding.rep;
+    result.SetPayload(w.Tell());
+    w.WriteContiguous(encoding.bytes.data(), encoding.bytes.size());
+    return result;
+  }
+
+  // Key for array deduplication that carries the array's hash, so it can be
+  // computed ahead of packing.
+  template<class T> struct _ArrayDedupKey
+  {
+    VtArray<T> array;
+    size_t hash;
+
+    bool operator==(_ArrayDedupKey const &other) const
+    {
+      return array == other.array;
+    }
+  };
+
+  struct _ArrayDedupKeyHash
+  {
+    template<class T> size_t operator()(_ArrayDedupKey<T> const &key) const
+    {
+      return key.hash;
+    }
+  };
+
   template<class Reader, class T>
   static inline typename std::enable_if<!Reader::StreamSupportsZeroCopy ||
                                         !_IsBitwiseReadWrite<T>::value>::type
@@ -2172,6 +2564,9 @@ namespace Usd_CrateFile
       for (auto index : indexes) {
         *o++ = lut[index];
       }
+    } else if (code == 's' && ver >= CrateFile::Version(0, 10, 0)) {
+      // Byte-shuffled, LZ4 compressed floats.
+      _ReadShuffledFloats(reader, reinterpret_cast<char *>(odata), osize, sizeof(T));
     } else {
       // This is a corrupt data stream.
       TF_RUNTIME_ERROR(
@@ -2181,6 +2576,128 @@ namespace Usd_CrateFile
     }
   }
 
+  template<class Reader, class T>
+  static inline typename std::enable_if<GfIsGfVec<T>::value &&
+                                        GfIsFloatingPoint<typename T::ScalarType>::value>::type
+  _ReadPossiblyCompressedArray(Reader reader,
+                               ValueRep rep,
+                               VtArray<T> *out,
+                               CrateFile::Version ver,
+                               int)
+  {
+    // Version 0.10.0 introduced compressed floating point vector arrays.
+    if (ver < CrateFile::Version(0, 10, 0) || !rep.IsCompressed()) {
+      _ReadUncompressedArray(reader, rep, out, ver);
+      return;
+    }
+
+    out->resize(reader.template Read<uint64_t>());
+    char code = reader.template Read<int8_t>();
+    if (code == 's') {
+      _ReadShuffledFloats(reader,
+                          reinterpret_cast<char *>(out->data()),
+                          out->size() * T::dimension,
+                          sizeof(typename T::ScalarType));
+    } else {
+      // This is a corrupt data stream.
+      TF_RUNTIME_ERROR(
+        "Corrupt data stream detected reading compressed "
+        "array in <%s>",
+        reader.crate->GetAssetPath().c_str());
+    }
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  // _DecompressedArrayCache
+  class CrateFile::_DecompressedArrayCache
+  {
+   public:
+
+    explicit _DecompressedArrayCache(size_t maxBytes) : _maxBytes(maxBytes) {}
+
+    // Return a new cache sized according to USDC_DECOMPRESSED_ARRAY_CACHE_MB,
+    // or null if caching is disabled.
+    static std::unique_ptr<_DecompressedArrayCache> New()
+    {
+      const int cacheMB = TfGetEnvSetting(USDC_DECOMPRESSED_ARRAY_CACHE_MB);
+      if (cacheMB <= 0) {
+        return nullptr;
+      }
+      return std::unique_ptr<_DecompressedArrayCache>(
+        new _DecompressedArrayCache(static_cast<size_t>(cacheMB) * 1024 * 1024));
+    }
+
+    // If an array for \p rep is cached, mark it most recently used, store it
+    // in \p out and return true.  Otherwise return false.
+    bool Find(ValueRep rep, VtValue *out)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto iter = _entries.find(rep);
+      if (iter == _entries.end()) {
+        ++_stats.misses;
+        return false;
+      }
+      ++_stats.hits;
+      _lru.splice(_lru.begin(), _lru, iter->second);
+      *out = iter->second->value;
+      return true;
+    }
+
+    // Add \p value, which occupies \p numBytes, to the cache for \p rep,
+    // evicting least recently used entries to stay within budget.
+    void Insert(ValueRep rep, VtValue const &value, size_t numBytes)
+    {
+      if (numBytes > _maxBytes) {
+        return;
+      }
+
+      // Evicted values are destroyed outside the lock.
+      vector<VtValue> evicted;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_entries.count(rep)) {
+          // Another thread populated this entry concurrently.
+          return;
+        }
+        _lru.push_front(_Entry{rep, value, numBytes});
+        _entries.emplace(rep, _lru.begin());
+        _stats.numBytes += numBytes;
+        ++_stats.numEntries;
+
+        while (_stats.numBytes > _maxBytes) {
+          _Entry &victim = _lru.back();
+          _stats.numBytes -= victim.numBytes;
+          --_stats.numEntries;
+          ++_stats.evictions;
+          _entries.erase(victim.rep);
+          evicted.push_back(std::move(victim.value));
+          _lru.pop_back();
+        }
+      }
+    }
+
+    DecompressedArrayCacheStats GetStats() const
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _stats;
+    }
+
+   private:
+
+    struct _Entry
+    {
+      ValueRep rep;
+      VtValue value;
+      size_t numBytes;
+    };
+
+    const size_t _maxBytes;
+    std::list<_Entry> _lru;
+    std::unordered_map<ValueRep, std::list<_Entry>::iterator, _Hasher> _entries;
+    DecompressedArrayCacheStats _stats;
+    mutable std::mutex _mutex;
+  };
+
   // Array handler for types that support arrays -- does deduplication.
   template<class T>
   struct CrateFile::
@@ -2199,7 +2716,11 @@ namespace Usd_CrateFile
         _arrayDedup.reset(new typename decltype(_arrayDedup)::element_type);
       }
 
-      auto iresult = _arrayDedup->emplace(array, result);
+      // Use the hash and encoding computed ahead of time, if any.
+      _ArrayEncoding const *encoding = w.crate->_packCtx->FindArrayEncoding(array);
+
+      auto iresult = _arrayDedup->emplace(
+        _ArrayDedupKey<T>{array, encoding ? encoding->hash : _Hasher()(array)}, result);
       ValueRep &target = iresult.first->second;
       if (iresult.second) {
         // Not yet present.
@@ -2208,6 +2729,9 @@ namespace Usd_CrateFile
           w.WriteAs<uint32_t>(1);
           w.WriteAs<uint32_t>(array.size());
           w.WriteContiguous(array.cdata(), array.size());
+        } else if (encoding && encoding->isEncoded &&
+                   encoding->version == w.crate->_packCtx->writeVersion) {
+          target = _WriteArrayEncoding(w, array, *encoding);
         } else {
           // If we're writing 0.5.0 or greater, see if we can possibly
           // compress this array.
@@ -2224,6 +2748,20 @@ namespace Usd_CrateFile
         *out = VtArray<T>();
         return;
       }
+
+      // Compressed arrays are decompressed into fresh buffers on every read,
+      // so share them through the crate's cache if it's enabled.
+      CrateFile::_DecompressedArrayCache *cache = rep.IsCompressed() ?
+                                                    reader.crate->_decompressedArrayCache.get() :
+                                                    nullptr;
+      if (cache) {
+        VtValue cached;
+        if (cache->Find(rep, &cached)) {
+          *out = cached.UncheckedGet<VtArray<T>>();
+          return;
+        }
+      }
+
       reader.Seek(rep.GetPayload());
 
       // Check version
@@ -2232,7 +2770,27 @@ namespace Usd_CrateFile
         // Read and discard shape size.
         reader.template Read<uint32_t>();
       }
+
+      if (!cache) {
+        _ReadPossiblyCompressedArray(reader, rep, out, fileVer, 0);
+        return;
+      }
+
+      // Only share arrays that decoded cleanly to the element count recorded
+      // in the file, so a corrupt array isn't silently handed out again.
+      uint64_t const numElements = fileVer < Version(0, 7, 0) ?
+                                     reader.template Read<uint32_t>() :
+                                     reader.template Read<uint64_t>();
+      reader.Seek(rep.GetPayload());
+      if (fileVer < Version(0, 5, 0)) {
+        reader.template Read<uint32_t>();
+      }
+
+      TfErrorMark m;
       _ReadPossiblyCompressedArray(reader, rep, out, fileVer, 0);
+      if (m.IsClean() && out->size() == numElements) {
+        cache->Insert(rep, VtValue(*out), out->size() * sizeof(T));
+      }
     }
 
     ValueRep PackVtValue(_Writer w, VtValue const &v)
@@ -2261,7 +2819,19 @@ namespace Usd_CrateFile
       _arrayDedup.reset();
     }
 
-    std::unique_ptr<std::unordered_map<VtArray<T>, ValueRep, _Hasher>> _arrayDedup;
+    // Hash and encode \p val ahead of packing, see _PackPipelined.
+    static void EncodeVtValue(VtValue const &val, Version ver, _ArrayEncodings *encodings)
+    {
+      VtArray<T> const &array = val.UncheckedGet<VtArray<T>>();
+      _ArrayEncoding encoding;
+      encoding.hash = _Hasher()(array);
+      encoding.version = ver;
+      _EncodeArray(array, ver, &encoding);
+      encodings->Insert(array, std::move(encoding));
+    }
+
+    std::unique_ptr<std::unordered_map<_ArrayDedupKey<T>, ValueRep, _ArrayDedupKeyHash>>
+      _arrayDedup;
   };
 
   // _ValueHandler derives _ArrayValueHandlerBase, which in turn derives
@@ -2430,7 +3000,9 @@ namespace Usd_CrateFile
     return TfToken(Version(_boot).AsString());
   }
 
-  CrateFile::CrateFile(bool useMmap) : _useMmap(useMmap)
+  CrateFile::CrateFile(bool useMmap)
+    : _decompressedArrayCache(_DecompressedArrayCache::New()),
+      _useMmap(useMmap)
   {
     _DoAllTypeRegistrations();
   }
@@ -2439,7 +3011,8 @@ namespace Usd_CrateFile
                        string const &fileName,
                        _FileMappingIPtr mapping,
                        ArAssetSharedPtr const &asset)
-    : _mmapSrc(std::move(mapping)),
+    : _decompressedArrayCache(_DecompressedArrayCache::New()),
+      _mmapSrc(std::move(mapping)),
       _assetPath(assetPath),
       _fileReadFrom(fileName),
       _useMmap(true)
@@ -2496,7 +3069,8 @@ namespace Usd_CrateFile
                        string const &fileName,
                        _FileRange &&inputFile,
                        ArAssetSharedPtr const &asset)
-    : _preadSrc(std::move(inputFile)),
+    : _decompressedArrayCache(_DecompressedArrayCache::New()),
+      _preadSrc(std::move(inputFile)),
       _assetSrc(asset),
       _assetPath(assetPath),
       _fileReadFrom(fileName),
@@ -2526,7 +3100,8 @@ namespace Usd_CrateFile
   }
 
   CrateFile::CrateFile(string const &assetPath, ArAssetSharedPtr const &asset)
-    : _assetSrc(asset),
+    : _decompressedArrayCache(_DecompressedArrayCache::New()),
+      _assetSrc(asset),
       _assetPath(assetPath),
       _useMmap(false)
   {
@@ -2627,6 +3202,12 @@ namespace Usd_CrateFile
     _DeleteValueHandlers();
   }
 
+  CrateFile::DecompressedArrayCacheStats CrateFile::GetDecompressedArrayCacheStats() const
+  {
+    return _decompressedArrayCache ? _decompressedArrayCache->GetStats() :
+                                     DecompressedArrayCacheStats();
+  }
+
   bool CrateFile::CanPackTo(string const &fileName) const
   {
     if (_assetPath.empty()) {
@@ -2867,9 +3448,25 @@ namespace Usd_CrateFile
     // swapping them out with the resulting reps.  This ensures that when we
     // pack the specs, which will re-pack the values, they'll be noops since
     // they are just holding value reps that point into the file.
-    for (auto const &p : allValuesAtAllTimes) {
-      for (VtValue *val : p.second)
-        *val = _PackValue(*val);
+    static const bool parallelPacking = TfGetEnvSetting(USDC_PARALLEL_ARRAY_PACKING);
+    if (parallelPacking) {
+      vector<VtValue *> orderedValues;
+      for (auto const &p : allValuesAtAllTimes) {
+        orderedValues.insert(orderedValues.end(), p.second.begin(), p.second.end());
+      }
+      _PackPipelined(
+        orderedValues.size(),
+        [this, &orderedValues](size_t i, Version ver, _ArrayEncodings *encodings) {
+          _EncodeArrayValue(*orderedValues[i], ver, encodings);
+        },
+        [this, &orderedValues](size_t i) {
+          *orderedValues[i] = _PackValue(*orderedValues[i]);
+        });
+    } else {
+      for (auto const &p : allValuesAtAllTimes) {
+        for (VtValue *val : p.second)
+          *val = _PackValue(*val);
+      }
     }
 
     // Now we've transformed all the VtValues in all the timeSampleFields to
@@ -2951,6 +3548,102 @@ namespace Usd_CrateFile
     return true;
   }
 
+  void CrateFile::Packer::PackSpecs(vector<SpecToPack> const &specs)
+  {
+    _crate->_AddSpecs(specs);
+  }
+
+  void CrateFile::_AddSpecs(vector<SpecToPack> const &specs)
+  {
+    using std::get;
+
+    static const bool parallelPacking = TfGetEnvSetting(USDC_PARALLEL_ARRAY_PACKING);
+    if (!parallelPacking) {
+      for (auto const &spec : specs) {
+        _AddSpec(get<0>(spec), get<1>(spec), *get<2>(spec));
+      }
+      return;
+    }
+
+    _PackPipelined(
+      specs.size(),
+      [this, &specs](size_t i, Version ver, _ArrayEncodings *encodings) {
+        for (auto const &fv : *get<2>(specs[i])) {
+          _EncodeArrayValue(fv.second, ver, encodings);
+        }
+      },
+      [this, &specs](size_t i) {
+        _AddSpec(get<0>(specs[i]), get<1>(specs[i]), *get<2>(specs[i]));
+      });
+  }
+
+  template<class EncodeFn, class PackFn>
+  void CrateFile::_PackPipelined(size_t numItems,
+                                 EncodeFn const &encodeItem,
+                                 PackFn const &packItem)
+  {
+    TRACE_FUNCTION();
+
+    // Items are packed in windows.  While the items in one window are packed
+    // in order on this thread, the array values of the items in the next
+    // window are hashed and encoded in parallel.  Packing uses those results
+    // instead of computing them itself, and otherwise proceeds exactly as it
+    // would serially, so the output is unchanged.
+    constexpr size_t WindowSize = 64;
+    const size_t numWindows = (numItems + WindowSize - 1) / WindowSize;
+
+    _ArrayEncodings encodings[2];
+    auto encodeWindow = [&encodeItem, &encodings, numItems](size_t window, Version ver) {
+      TfAutoMallocTag2 tag("Usd", "Usd_CrateDataImpl::Save");
+      const size_t begin = window * WindowSize;
+      const size_t end = std::min(begin + WindowSize, numItems);
+      _ArrayEncodings *windowEncodings = &encodings[window % 2];
+      WorkParallelForN(end - begin, [&](size_t b, size_t e) {
+        for (size_t i = begin + b; i != begin + e; ++i) {
+          encodeItem(i, ver, windowEncodings);
+        }
+      });
+    };
+
+    if (numWindows) {
+      encodeWindow(0, _packCtx->writeVersion);
+    }
+    for (size_t window = 0; window != numWindows; ++window) {
+      WorkDispatcher wd;
+      if (window + 1 != numWindows) {
+        // Snapshot the version, packing may upgrade it concurrently.
+        const Version ver = _packCtx->writeVersion;
+        wd.Run([&encodeWindow, window, ver]() {
+          encodeWindow(window + 1, ver);
+        });
+      }
+
+      _packCtx->arrayEncodings = &encodings[window % 2];
+      const size_t begin = window * WindowSize;
+      const size_t end = std::min(begin + WindowSize, numItems);
+      for (size_t i = begin; i != end; ++i) {
+        packItem(i);
+      }
+      _packCtx->arrayEncodings = nullptr;
+
+      wd.Wait();
+      encodings[window % 2].Clear();
+    }
+  }
+
+  void CrateFile::_EncodeArrayValue(VtValue const &val,
+                                    Version writeVersion,
+                                    _ArrayEncodings *encodings) const
+  {
+    if (!val.IsArrayValued() || val.GetArraySize() < MinPipelinedArraySize) {
+      return;
+    }
+    auto iter = _encodeArrayValueFunctions.find(std::type_index(val.GetElementTypeid()));
+    if (iter != _encodeArrayValueFunctions.end()) {
+      iter->second(val, writeVersion, encodings);
+    }
+  }
+
   void CrateFile::_AddSpec(const SdfPath &path,
                            SdfSpecType type,
                            const std::vector<FieldValuePair> &fields)
@@ -3443,24 +4136,389 @@ namespace Usd_CrateFile
 
   template<class Reader> void CrateFile::_ReadStructuralSections(Reader reader, int64_t fileSize)
   {
+    TRACE_FUNCTION();
+
     TfErrorMark m;
     _boot = _ReadBootStrap(reader.src, fileSize);
     if (m.IsClean())
       _toc = _ReadTOC(reader, _boot);
+
+    // If there's an up-to-date decompression cache for this file, read the
+    // sections from it instead of decompressing them.
+    string cachePath;
+    if (m.IsClean()) {
+      cachePath = _GetDecompressionCachePath();
+      if (!cachePath.empty() && _ReadDecompressionCache(cachePath, fileSize))
+        return;
+    }
+
     if (m.IsClean())
       _PrefetchStructuralSections(reader);
-    if (m.IsClean())
-      _ReadTokens(reader);
-    if (m.IsClean())
-      _ReadStrings(reader);
-    if (m.IsClean())
-      _ReadFields(reader);
-    if (m.IsClean())
-      _ReadFieldSets(reader);
-    if (m.IsClean())
+
+    static const bool parallelRead = TfGetEnvSetting(USDC_PARALLEL_READ_STRUCTURAL_SECTIONS);
+    if (parallelRead) {
+      if (m.IsClean())
+        _ReadStructuralSectionsParallel(reader);
+    } else {
+      if (m.IsClean())
+        _ReadTokens(reader);
+      if (m.IsClean())
+        _ReadStrings(reader);
+      if (m.IsClean())
+        _ReadFields(reader);
+      if (m.IsClean())
+        _ReadFieldSets(reader);
+      if (m.IsClean())
+        _ReadPaths(reader);
+      if (m.IsClean())
+        _ReadSpecs(reader);
+    }
+
+    if (m.IsClean() && !cachePath.empty())
+      _WriteDecompressionCache(reader, cachePath, fileSize);
+  }
+
+  // The decompression cache file starts with this header, followed by each
+  // section's uncompressed data at the recorded offsets.  Every section is
+  // stored exactly as it appears in memory, so a cache is only usable by
+  // software with the same layout for these types, which the cache version
+  // and header size guard.
+  struct CrateFile::_DecompressionCacheHeader
+  {
+    static constexpr uint32_t CurrentVersion = 1;
+
+    struct Section
+    {
+      uint64_t offset;
+      uint64_t count;
+    };
+
+    char ident[8];  // "USDC-SDC"
+    uint32_t cacheVersion;
+    uint32_t headerSize;
+
+    // Identity of the crate file this cache was made from.
+    _BootStrap boot;
+    int64_t sourceSize;
+    double sourceModTime;
+
+    uint64_t numTokens;
+    uint64_t numPaths;
+    Section tokenChars;
+    Section strings;
+    Section fields;
+    Section fieldSets;
+    Section pathIndexes;
+    Section elementTokenIndexes;
+    Section jumps;
+    Section specs;
+
+    template<class T> T const *Get(Section const &sec, char const *base, size_t mapSize) const
+    {
+      if (sec.offset % alignof(T) || sec.offset > mapSize ||
+          sec.count > (mapSize - sec.offset) / sizeof(T)) {
+        return nullptr;
+      }
+      return reinterpret_cast<T const *>(base + sec.offset);
+    }
+  };
+
+  static_assert(std::is_trivially_copyable<CrateFile::Field>::value &&
+                  std::is_trivially_copyable<CrateFile::Spec>::value &&
+                  std::is_trivially_copyable<FieldIndex>::value &&
+                  std::is_trivially_copyable<TokenIndex>::value,
+                "Structural cache sections must be trivially copyable");
+
+  static const char _DecompressionCacheIdent[8] = {'U', 'S', 'D', 'C', '-', 'S', 'D', 'C'};
+
+  string CrateFile::_GetDecompressionCachePath() const
+  {
+    static const string cacheDir = TfGetEnvSetting(USDC_DECOMPRESSION_CACHE_DIR);
+
+    // Only files read directly from disk can be validated against their
+    // modification time, and only 0.4.0 and later files have the compressed
+    // path encoding that the cache stores.
+    if (cacheDir.empty() || _fileReadFrom.empty() || _assetPath.empty() ||
+        Version(_boot) < Version(0, 4, 0)) {
+      return string();
+    }
+    return TfStringCatPaths(
+      cacheDir,
+      TfStringPrintf("%s.%016zx.usdcdc", TfGetBaseName(_assetPath).c_str(), TfHash()(_assetPath)));
+  }
+
+  bool CrateFile::_ReadDecompressionCache(string const &cachePath, int64_t fileSize)
+  {
+    TRACE_FUNCTION();
+
+    TfAutoMallocTag tag("_ReadDecompressionCache");
+
+    double modTime = 0;
+    if (!TfIsFile(cachePath) || !ArchGetModificationTime(_fileReadFrom.c_str(), &modTime)) {
+      return false;
+    }
+
+    // The cache is only mapped to copy the sections out of it.  The tables
+    // built from them are private to this CrateFile, as when they are read
+    // from the crate file itself.
+    ArchConstFileMapping mapping = ArchMapFileReadOnly(cachePath);
+    if (!mapping) {
+      return false;
+    }
+    char const *base = mapping.get();
+    size_t const mapSize = ArchGetFileMappingLength(mapping);
+
+    // Validate everything before touching any of our members, so that we can
+    // fall back to reading the crate file itself if the cache is unusable.
+    using Header = _DecompressionCacheHeader;
+    if (mapSize < sizeof(Header)) {
+      return false;
+    }
+    Header const &h = *reinterpret_cast<Header const *>(base);
+    if (memcmp(h.ident, _DecompressionCacheIdent, sizeof(h.ident)) ||
+        h.cacheVersion != Header::CurrentVersion || h.headerSize != sizeof(Header) ||
+        memcmp(&h.boot, &_boot, sizeof(_boot)) || h.sourceSize != fileSize ||
+        h.sourceModTime != modTime) {
+      return false;
+    }
+
+    char const *tokenChars = h.Get<char>(h.tokenChars, base, mapSize);
+    TokenIndex const *strings = h.Get<TokenIndex>(h.strings, base, mapSize);
+    Field const *fields = h.Get<Field>(h.fields, base, mapSize);
+    FieldIndex const *fieldSets = h.Get<FieldIndex>(h.fieldSets, base, mapSize);
+    uint32_t const *pathIndexes = h.Get<uint32_t>(h.pathIndexes, base, mapSize);
+    int32_t const *elementTokenIndexes = h.Get<int32_t>(h.elementTokenIndexes, base, mapSize);
+    int32_t const *jumps = h.Get<int32_t>(h.jumps, base, mapSize);
+    Spec const *specs = h.Get<Spec>(h.specs, base, mapSize);
+    if (!tokenChars || !strings || !fields || !fieldSets || !pathIndexes ||
+        !elementTokenIndexes || !jumps || !specs) {
+      return false;
+    }
+
+    size_t const numEncodedPaths = h.pathIndexes.count;
+    if (h.elementTokenIndexes.count != numEncodedPaths || h.jumps.count != numEncodedPaths ||
+        h.numPaths != numEncodedPaths ||
+        (h.tokenChars.count && tokenChars[h.tokenChars.count - 1] != '\0') ||
+        (h.fieldSets.count && fieldSets[h.fieldSets.count - 1] != FieldIndex())) {
+      return false;
+    }
+    // The cache directory may be shared, so range check the path tree before
+    // building it regardless of WABI_PREFER_SAFETY_OVER_SPEED.
+    for (size_t i = 0; i != numEncodedPaths; ++i) {
+      int32_t const jump = jumps[i];
+      bool const hasChild = (jump > 0) || (jump == -1);
+      if (pathIndexes[i] >= h.numPaths ||
+          static_cast<uint64_t>(std::abs(elementTokenIndexes[i])) >= h.numTokens ||
+          ((hasChild || jump == 0) && i + 1 >= numEncodedPaths) ||
+          (jump > 0 && i + jump >= numEncodedPaths) || jump < -2) {
+        return false;
+      }
+    }
+
+    // Likewise range check every index into the other sections, since the
+    // rest of CrateFile trusts them.
+    if (std::count(tokenChars, tokenChars + h.tokenChars.count, '\0') <
+        static_cast<std::ptrdiff_t>(h.numTokens)) {
+      return false;
+    }
+    for (size_t i = 0; i != h.strings.count; ++i) {
+      if (strings[i].value >= h.numTokens) {
+        return false;
+      }
+    }
+    for (size_t i = 0; i != h.fields.count; ++i) {
+      if (fields[i].tokenIndex.value >= h.numTokens) {
+        return false;
+      }
+    }
+    for (size_t i = 0; i != h.fieldSets.count; ++i) {
+      if (fieldSets[i] != FieldIndex() && fieldSets[i].value >= h.fields.count) {
+        return false;
+      }
+    }
+    for (size_t i = 0; i != h.specs.count; ++i) {
+      if (specs[i].pathIndex.value >= h.numPaths ||
+          specs[i].fieldSetIndex.value >= h.fieldSets.count ||
+          static_cast<unsigned>(specs[i].specType) >= SdfNumSpecTypes) {
+        return false;
+      }
+    }
+
+    // Build the tables in locals and swap them in only once nothing can fail.
+    vector<TfToken> tokens;
+    if (_MakeTokens(tokenChars, tokenChars + h.tokenChars.count, h.numTokens, &tokens) !=
+        h.numTokens) {
+      return false;
+    }
+    vector<TokenIndex> newStrings(strings, strings + h.strings.count);
+    vector<Field> newFields(fields, fields + h.fields.count);
+    vector<FieldIndex> newFieldSets(fieldSets, fieldSets + h.fieldSets.count);
+    vector<Spec> newSpecs(specs, specs + h.specs.count);
+
+    _tokens.swap(tokens);
+    _strings.swap(newStrings);
+    _fields.swap(newFields);
+    _fieldSets.swap(newFieldSets);
+    _specs.swap(newSpecs);
+    WorkSwapDestroyAsync(tokens);
+
+    _paths.clear();
+    _paths.resize(h.numPaths);
+    if (numEncodedPaths) {
+      WorkDispatcher dispatcher;
+      _BuildDecompressedPathsImpl(pathIndexes,
+                                  elementTokenIndexes,
+                                  jumps,
+                                  numEncodedPaths,
+                                  0,
+                                  SdfPath(),
+                                  dispatcher);
+      dispatcher.Wait();
+    }
+    return true;
+  }
+
+  template<class Reader>
+  void CrateFile::_WriteDecompressionCache(Reader reader,
+                                           string const &cachePath,
+                                           int64_t fileSize) const
+  {
+    TRACE_FUNCTION();
+
+    TfAutoMallocTag tag("_WriteDecompressionCache");
+
+    // Failing to write the cache must not fail the open, so swallow any
+    // errors issued along the way.
+    TfErrorMark m;
+
+    double modTime = 0;
+    if (!ArchGetModificationTime(_fileReadFrom.c_str(), &modTime)) {
+      return;
+    }
+
+    // The path tree is not retained in its encoded form, so decode it again.
+    vector<uint32_t> pathIndexes;
+    vector<int32_t> elementTokenIndexes;
+    vector<int32_t> jumps;
+    if (auto pathsSection = _toc.GetSection(_PathsSectionName)) {
+      reader.Seek(pathsSection->start);
+      reader.template Read<uint64_t>();
+      if (!_ReadCompressedPathArrays(reader, &pathIndexes, &elementTokenIndexes, &jumps)) {
+        m.Clear();
+        return;
+      }
+    }
+
+    string tokenChars;
+    for (TfToken const &token : _tokens) {
+      tokenChars.append(token.GetString());
+      tokenChars.push_back('\0');
+    }
+
+    using Header = _DecompressionCacheHeader;
+    Header h;
+    memset(static_cast<void *>(&h), 0, sizeof(h));
+    memcpy(h.ident, _DecompressionCacheIdent, sizeof(h.ident));
+    h.cacheVersion = Header::CurrentVersion;
+    h.headerSize = sizeof(Header);
+    h.boot = _boot;
+    h.sourceSize = fileSize;
+    h.sourceModTime = modTime;
+    h.numTokens = _tokens.size();
+    h.numPaths = _paths.size();
+
+    struct Chunk
+    {
+      void const *data;
+      size_t size;
+    };
+    vector<Chunk> chunks;
+    uint64_t offset = sizeof(Header);
+    auto addSection = [&chunks, &offset](Header::Section *sec, void const *data, size_t count,
+                                         size_t elemSize) {
+      offset = (offset + 7) & ~uint64_t(7);
+      sec->offset = offset;
+      sec->count = count;
+      chunks.push_back({data, count * elemSize});
+      offset += count * elemSize;
+    };
+    addSection(&h.tokenChars, tokenChars.data(), tokenChars.size(), 1);
+    addSection(&h.strings, _strings.data(), _strings.size(), sizeof(TokenIndex));
+    addSection(&h.fields, _fields.data(), _fields.size(), sizeof(Field));
+    addSection(&h.fieldSets, _fieldSets.data(), _fieldSets.size(), sizeof(FieldIndex));
+    addSection(&h.pathIndexes, pathIndexes.data(), pathIndexes.size(), sizeof(uint32_t));
+    addSection(&h.elementTokenIndexes,
+               elementTokenIndexes.data(),
+               elementTokenIndexes.size(),
+               sizeof(int32_t));
+    addSection(&h.jumps, jumps.data(), jumps.size(), sizeof(int32_t));
+    addSection(&h.specs, _specs.data(), _specs.size(), sizeof(Spec));
+
+    TfMakeDirs(TfGetPathName(cachePath), -1, /*existOk=*/true);
+
+    // Write to a temporary file that is renamed into place, so concurrent
+    // readers and writers in other processes only ever see complete caches.
+    TfSafeOutputFile out = TfSafeOutputFile::Replace(cachePath);
+    FILE *file = out.Get();
+    bool ok = file && fwrite(&h, sizeof(h), 1, file) == 1;
+    uint64_t written = sizeof(Header);
+    static const char zeros[8] = {0};
+    for (size_t i = 0; ok && i != chunks.size(); ++i) {
+      size_t padding = ((written + 7) & ~uint64_t(7)) - written;
+      ok = fwrite(zeros, 1, padding, file) == padding &&
+           fwrite(chunks[i].data, 1, chunks[i].size, file) == chunks[i].size;
+      written += padding + chunks[i].size;
+    }
+    if (ok) {
+      out.Close();
+    } else {
+      out.Discard();
+    }
+    m.Clear();
+  }
+
+  template<class Reader> void CrateFile::_ReadStructuralSectionsParallel(Reader reader)
+  {
+    // Paths are built from tokens, so those two sections are read in order
+    // on this thread.  Every other section only refers to the others by
+    // index, so they're decoded concurrently on their own copies of the
+    // reader, which each have an independent read position.
+    //
+    // As in the serial read, the first section that fails stops the rest:
+    // sections that haven't started yet are skipped and the dispatcher is
+    // cancelled.
+    WorkDispatcher wd;
+    std::atomic<bool> failed(false);
+    auto readSection = [this, &wd, &reader, &failed](void (CrateFile::*readFn)(Reader)) {
+      wd.Run([this, reader, readFn, &wd, &failed]() {
+        if (failed)
+          return;
+        TfAutoMallocTag2 tag("Usd", "Usd_CrateDataImpl::Open");
+        TfAutoMallocTag2 tag2("Usd_CrateFile::CrateFile::Open", "_ReadStructuralSections");
+        TfErrorMark m;
+        (this->*readFn)(reader);
+        if (!m.IsClean()) {
+          failed = true;
+          wd.Cancel();
+        }
+      });
+    };
+    readSection(&CrateFile::_ReadStrings<Reader>);
+    readSection(&CrateFile::_ReadFields<Reader>);
+    readSection(&CrateFile::_ReadFieldSets<Reader>);
+    readSection(&CrateFile::_ReadSpecs<Reader>);
+
+    TfErrorMark m;
+    _ReadTokens(reader);
+    if (m.IsClean() && !failed)
       _ReadPaths(reader);
-    if (m.IsClean())
-      _ReadSpecs(reader);
+    if (!m.IsClean()) {
+      failed = true;
+      wd.Cancel();
+    }
+
+    // Errors issued by the section tasks are transported to this thread.
+    wd.Wait();
   }
 
   template<class ByteStream>
@@ -3523,6 +4581,8 @@ namespace Usd_CrateFile
 
   template<class Reader> void CrateFile::_ReadFieldSets(Reader reader)
   {
+    TRACE_FUNCTION();
+
     TfAutoMallocTag tag("_ReadFieldSets");
     if (auto fieldSetsSection = _toc.GetSection(_FieldSetsSectionName)) {
       reader.Seek(fieldSetsSection->start);
@@ -3550,6 +4610,8 @@ namespace Usd_CrateFile
 
   template<class Reader> void CrateFile::_ReadFields(Reader reader)
   {
+    TRACE_FUNCTION();
+
     TfAutoMallocTag tag("_ReadFields");
     if (auto fieldsSection = _toc.GetSection(_FieldsSectionName)) {
       reader.Seek(fieldsSection->start);
@@ -3585,6 +4647,8 @@ namespace Usd_CrateFile
 
   template<class Reader> void CrateFile::_ReadSpecs(Reader reader)
   {
+    TRACE_FUNCTION();
+
     TfAutoMallocTag tag("_ReadSpecs");
     if (auto specsSection = _toc.GetSection(_SpecsSectionName)) {
       reader.Seek(specsSection->start);
@@ -3627,6 +4691,8 @@ namespace Usd_CrateFile
 
   template<class Reader> void CrateFile::_ReadStrings(Reader reader)
   {
+    TRACE_FUNCTION();
+
     TfAutoMallocTag tag("_ReadStrings");
     if (auto stringsSection = _toc.GetSection(_StringsSectionName)) {
       reader.Seek(stringsSection->start);
@@ -3636,6 +4702,8 @@ namespace Usd_CrateFile
 
   template<class Reader> void CrateFile::_ReadTokens(Reader reader)
   {
+    TRACE_FUNCTION();
+
     TfAutoMallocTag tag("_ReadTokens");
 
     auto tokensSection = _toc.GetSection(_TokensSectionName);
@@ -3679,10 +4747,24 @@ namespace Usd_CrateFile
       const_cast<char *>(charsEnd)[-1] = '\0';
     }
 
-    // Now we read that many null-terminated strings into _tokens.
-    char const *p = chars.get();
-    _tokens.clear();
-    _tokens.resize(numTokens);
+    size_t const numFound = _MakeTokens(chars.get(), charsEnd, numTokens, &_tokens);
+    if (numFound != numTokens) {
+      TF_RUNTIME_ERROR("Crate file claims %zu tokens, found %zu", numTokens, numFound);
+    }
+
+    WorkSwapDestroyAsync(chars);
+  }
+
+  size_t CrateFile::_MakeTokens(char const *chars,
+                                char const *charsEnd,
+                                size_t numTokens,
+                                vector<TfToken> *tokens)
+  {
+    // Read numTokens null-terminated strings into tokens, returning the
+    // number actually found.
+    char const *p = chars;
+    tokens->clear();
+    tokens->resize(numTokens);
 
     WorkDispatcher wd;
     struct MakeToken
@@ -3697,20 +4779,18 @@ namespace Usd_CrateFile
     };
     size_t i = 0;
     for (; p < charsEnd && i != numTokens; ++i) {
-      MakeToken mt{&_tokens, i, p};
+      MakeToken mt{tokens, i, p};
       wd.Run(mt);
       p += strlen(p) + 1;
     }
     wd.Wait();
-    if (i != numTokens) {
-      TF_RUNTIME_ERROR("Crate file claims %zu tokens, found %zu", numTokens, i);
-    }
-
-    WorkSwapDestroyAsync(chars);
+    return i;
   }
 
   template<class Reader> void CrateFile::_ReadPaths(Reader reader)
   {
+    TRACE_FUNCTION();
+
     TfAutoMallocTag tag("_ReadPaths");
 
     auto pathsSection = _toc.GetSection(_PathsSectionName);
@@ -3788,57 +4868,76 @@ namespace Usd_CrateFile
     vector<uint32_t> pathIndexes;
     vector<int32_t> elementTokenIndexes;
     vector<int32_t> jumps;
+    if (!_ReadCompressedPathArrays(reader, &pathIndexes, &elementTokenIndexes, &jumps)) {
+      return;
+    }
+
+    // Now build the paths.
+    _BuildDecompressedPathsImpl(pathIndexes.data(),
+                                elementTokenIndexes.data(),
+                                jumps.data(),
+                                pathIndexes.size(),
+                                0,
+                                SdfPath(),
+                                dispatcher);
+
+    dispatcher.Wait();
+  }
 
+  template<class Reader>
+  bool CrateFile::_ReadCompressedPathArrays(Reader reader,
+                                            vector<uint32_t> *pathIndexes,
+                                            vector<int32_t> *elementTokenIndexes,
+                                            vector<int32_t> *jumps) const
+  {
     // Read number of encoded paths.
     size_t numPaths = reader.template Read<uint64_t>();
 
     _CompressedIntsReader cr;
 
     // pathIndexes.
-    pathIndexes.resize(numPaths);
-    cr.Read(reader, pathIndexes.data(), numPaths);
+    pathIndexes->resize(numPaths);
+    cr.Read(reader, pathIndexes->data(), numPaths);
 
 #ifdef WABI_PREFER_SAFETY_OVER_SPEED
     // Range check the pathIndexes, which index into _paths.
-    for (const uint32_t pathIndex : pathIndexes) {
+    for (const uint32_t pathIndex : *pathIndexes) {
       if (pathIndex >= _paths.size()) {
         TF_RUNTIME_ERROR("Corrupt path index in crate file (%u >= %zu)", pathIndex, _paths.size());
-        return;
+        return false;
       }
     }
 #endif  // WABI_PREFER_SAFETY_OVER_SPEED
 
     // elementTokenIndexes.
-    elementTokenIndexes.resize(numPaths);
-    cr.Read(reader, elementTokenIndexes.data(), numPaths);
+    elementTokenIndexes->resize(numPaths);
+    cr.Read(reader, elementTokenIndexes->data(), numPaths);
 
 #ifdef WABI_PREFER_SAFETY_OVER_SPEED
     // Range check the pathIndexes, which index (by absolute value) into _tokens.
-    for (const int32_t elementTokenIndex : elementTokenIndexes) {
+    for (const int32_t elementTokenIndex : *elementTokenIndexes) {
       if (static_cast<size_t>(std::abs(elementTokenIndex)) >= _tokens.size()) {
         TF_RUNTIME_ERROR(
           "Corrupt path element token index in crate file "
           "(%d >= %zu)",
           std::abs(elementTokenIndex),
           _tokens.size());
-        return;
+        return false;
       }
     }
 #endif  // WABI_PREFER_SAFETY_OVER_SPEED
 
     // jumps.
-    jumps.resize(numPaths);
-    cr.Read(reader, jumps.data(), numPaths);
+    jumps->resize(numPaths);
+    cr.Read(reader, jumps->data(), numPaths);
 
-    // Now build the paths.
-    _BuildDecompressedPathsImpl(pathIndexes, elementTokenIndexes, jumps, 0, SdfPath(), dispatcher);
-
-    dispatcher.Wait();
+    return true;
   }
 
-  void CrateFile::_BuildDecompressedPathsImpl(vector<uint32_t> const &pathIndexes,
-                                              vector<int32_t> const &elementTokenIndexes,
-                                              vector<int32_t> const &jumps,
+  void CrateFile::_BuildDecompressedPathsImpl(uint32_t const *pathIndexes,
+                                              int32_t const *elementTokenIndexes,
+                                              int32_t const *jumps,
+                                              size_t numPaths,
                                               size_t curIndex,
                                               SdfPath parentPath,
                                               WorkDispatcher &dispatcher)
@@ -3873,23 +4972,31 @@ namespace Usd_CrateFile
           auto siblingIndex = thisIndex + jumps[thisIndex];
 #ifdef WABI_PREFER_SAFETY_OVER_SPEED
           // Range check siblingIndex, which indexes into pathIndexes.
-          if (siblingIndex >= pathIndexes.size()) {
+          if (siblingIndex >= numPaths) {
             TF_RUNTIME_ERROR(
               "Corrupt paths jumps table in crate file (jump:%d + "
               "thisIndex:%zu >= %zu)",
               jumps[thisIndex],
               thisIndex,
-              pathIndexes.size());
+              numPaths);
             return;
           }
 #endif
-          dispatcher.Run([&]() {
+          dispatcher.Run([this,
+                          pathIndexes,
+                          elementTokenIndexes,
+                          jumps,
+                          numPaths,
+                          siblingIndex,
+                          parentPath,
+                          &dispatcher]() {
             // XXX Remove these tags when bug #132031 is addressed
             TfAutoMallocTag2 tag("Usd", "Usd_CrateDataImpl::Open");
             TfAutoMallocTag2 tag2("Usd_CrateFile::CrateFile::Open", "_ReadPaths");
             _BuildDecompressedPathsImpl(pathIndexes,
                                         elementTokenIndexes,
                                         jumps,
+                                        numPaths,
                                         siblingIndex,
                                         parentPath,
                                         dispatcher);
@@ -4156,6 +5263,11 @@ namespace Usd_CrateFile
       return valueHandler->PackVtValue(_Writer(this), val);
     };
 
+    _encodeArrayValueFunctions[std::type_index(typeid(T))] =
+      [](VtValue const &val, Version ver, _ArrayEncodings *encodings) {
+        _ValueHandler<T>::EncodeVtValue(val, ver, encodings);
+      };
+
     _unpackValueFunctionsPread[typeEnumIndex] = [this, valueHandler](ValueRep rep, VtValue *out) {
       valueHandler->UnpackVtValue(_MakeReader(_PreadStream(_preadSrc)), rep, out);
     };
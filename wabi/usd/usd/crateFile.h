@@ -787,6 +787,9 @@ namespace Usd_CrateFile
     static std::unique_ptr<CrateFile> Open(string const &assetPath);
     static std::unique_ptr<CrateFile> Open(string const &assetPath, ArAssetSharedPtr const &asset);
 
+    // A spec to pack: its path, spec type and fields.
+    using SpecToPack = tuple<SdfPath, SdfSpecType, vector<FieldValuePair> const *>;
+
     // Helper for saving to a file.
     struct Packer
     {
@@ -805,6 +808,13 @@ namespace Usd_CrateFile
         _crate->_AddSpec(path, type, fields);
       }
 
+      // Pack the given (path, type, fields) specs in order.  This produces
+      // the same file as calling PackSpec for each of them, but lets large
+      // array values of upcoming specs be hashed and compressed on worker
+      // threads while earlier specs are written, see
+      // USDC_PARALLEL_ARRAY_PACKING.
+      void PackSpecs(vector<SpecToPack> const &specs);
+
       // Write remaining data and structural sections to disk to produce a
       // complete file.  Return true if the writing completed successfully,
       // false otherwise.
@@ -944,6 +954,22 @@ namespace Usd_CrateFile
 
     vector<tuple<string, int64_t, int64_t>> GetSectionsNameStartSize() const;
 
+    // Statistics for the cache of decompressed array values shared between
+    // reads of the same compressed array, see
+    // USDC_DECOMPRESSED_ARRAY_CACHE_MB.
+    struct DecompressedArrayCacheStats
+    {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t evictions = 0;
+      size_t numEntries = 0;
+      size_t numBytes = 0;
+    };
+
+    // Return the current statistics for this file's decompressed array
+    // cache.  All values are zero if the cache is disabled.
+    DecompressedArrayCacheStats GetDecompressedArrayCacheStats() const;
+
     inline VtValue GetTimeSampleValue(TimeSamples const &ts, size_t i) const
     {
       return ts.IsInMemory() ? ts.values[i] : _GetTimeSampleValueImpl(ts, i);
@@ -1016,6 +1042,7 @@ namespace Usd_CrateFile
     void _AddSpec(const SdfPath &path,
                   SdfSpecType type,
                   const std::vector<FieldValuePair> &fields);
+    void _AddSpecs(vector<SpecToPack> const &specs);
 
     VtValue _GetTimeSampleValueImpl(TimeSamples const &ts, size_t i) const;
     void _MakeTimeSampleValuesMutableImpl(TimeSamples &ts) const;
@@ -1040,6 +1067,7 @@ namespace Usd_CrateFile
     inline void _WriteTokens(_Writer &w);
 
     template<class Reader> void _ReadStructuralSections(Reader src, int64_t fileSize);
+    template<class Reader> void _ReadStructuralSectionsParallel(Reader src);
 
     template<class ByteStream> static _BootStrap _ReadBootStrap(ByteStream src, int64_t fileSize);
 
@@ -1051,17 +1079,36 @@ namespace Usd_CrateFile
     template<class Reader> void _ReadSpecs(Reader src);
     template<class Reader> void _ReadStrings(Reader src);
     template<class Reader> void _ReadTokens(Reader src);
+    size_t _MakeTokens(char const *chars,
+                       char const *charsEnd,
+                       size_t numTokens,
+                       std::vector<TfToken> *tokens);
     template<class Reader> void _ReadPaths(Reader src);
     template<class Header, class Reader>
     void _ReadPathsImpl(Reader reader, WorkDispatcher &dispatcher, SdfPath parentPath = SdfPath());
     template<class Reader> void _ReadCompressedPaths(Reader reader, WorkDispatcher &dispatcher);
-    void _BuildDecompressedPathsImpl(std::vector<uint32_t> const &pathIndexes,
-                                     std::vector<int32_t> const &elementTokenIndexes,
-                                     std::vector<int32_t> const &jumps,
+    template<class Reader>
+    bool _ReadCompressedPathArrays(Reader reader,
+                                   std::vector<uint32_t> *pathIndexes,
+                                   std::vector<int32_t> *elementTokenIndexes,
+                                   std::vector<int32_t> *jumps) const;
+    void _BuildDecompressedPathsImpl(uint32_t const *pathIndexes,
+                                     int32_t const *elementTokenIndexes,
+                                     int32_t const *jumps,
+                                     size_t numPaths,
                                      size_t curIndex,
                                      SdfPath parentPath,
                                      WorkDispatcher &dispatcher);
 
+    // Structural section decompression cache.  See USDC_DECOMPRESSION_CACHE_DIR.
+    struct _DecompressionCacheHeader;
+    std::string _GetDecompressionCachePath() const;
+    bool _ReadDecompressionCache(std::string const &cachePath, int64_t fileSize);
+    template<class Reader>
+    void _WriteDecompressionCache(Reader reader,
+                                  std::string const &cachePath,
+                                  int64_t fileSize) const;
+
     void _ReadRawBytes(int64_t start, int64_t size, char *buf) const;
 
     PathIndex _AddPath(const SdfPath &path);
@@ -1092,6 +1139,15 @@ namespace Usd_CrateFile
     template<class T> inline ValueRep _PackValue(VtArray<T> const &v);
     ValueRep _PackValue(VtValue const &v);
 
+    // Array values hashed, and possibly compressed, on worker threads ahead
+    // of being packed.  See _PackPipelined.
+    struct _ArrayEncodings;
+    template<class EncodeFn, class PackFn>
+    void _PackPipelined(size_t numItems, EncodeFn const &encodeItem, PackFn const &packItem);
+    void _EncodeArrayValue(VtValue const &val,
+                           Version writeVersion,
+                           _ArrayEncodings *encodings) const;
+
     template<class T> void _UnpackValue(ValueRep rep, T *out) const;
     template<class T> void _UnpackValue(ValueRep rep, VtArray<T> *out) const;
     void _UnpackValue(ValueRep rep, VtValue *result) const;
@@ -1172,10 +1228,21 @@ namespace Usd_CrateFile
     mutable unordered_map<ValueRep, TimeSamples::SharedTimes, _Hasher> _sharedTimes;
     mutable tbb::spin_rw_mutex _sharedTimesMutex;
 
+    // Bounded LRU cache of decompressed array values keyed by ValueRep, or
+    // null if disabled.
+    class _DecompressedArrayCache;
+    std::unique_ptr<_DecompressedArrayCache> _decompressedArrayCache;
+
     // functions to write VtValues to file by type.
     boost::container::flat_map<std::type_index, std::function<ValueRep(VtValue const &)>>
       _packValueFunctions;
 
+    // functions to hash and encode array VtValues ahead of packing by type.
+    boost::container::flat_map<
+      std::type_index,
+      std::function<void(VtValue const &, Version, _ArrayEncodings *)>>
+      _encodeArrayValueFunctions;
+
     // functions to read VtValues from file by type.
     std::function<void(ValueRep, VtValue *)>
       _unpackValueFunctionsPread[static_cast<int>(TypeEnum::NumTypes)];
@@ -649,6 +649,14 @@ UsdStageRefPtr UsdStage::_InstantiateStage(const SdfLayerRefPtr &rootLayer,
   Usd_InstanceChanges instanceChanges;
   const SdfPath &absoluteRootPath = SdfPath::AbsoluteRootPath();
 
+  // Start opening the layers the stage depends on in the background, so
+  // composition doesn't have to wait on each of them in turn.
+  stage->_cache->PrefetchLayerDependencies(/* includePayloads = */ load == LoadAll);
+
+  // Restore prim indexes persisted by an earlier open of the same layers
+  // where possible.
+  stage->_cache->OpenPrimIndexDiskCache();
+
   // Populate the stage, request payloads according to InitialLoadSet load.
   stage->_ComposePrimIndexesInParallel({absoluteRootPath},
                                        "instantiating stage",
@@ -675,6 +683,8 @@ UsdStageRefPtr UsdStage::_InstantiateStage(const SdfLayerRefPtr &rootLayer,
   }
 
   stage->_ComposeSubtreesInParallel(subtreesToCompose, &primIndexPathsForSubtrees);
+  stage->_cache->ReleasePrefetchedLayers();
+  stage->_cache->ClosePrimIndexDiskCache();
 
   stage->_RegisterPerLayerNotices();
   stage->_RegisterResolverChangeNotice();
@@ -33,7 +33,9 @@
 
 #include <tbb/concurrent_hash_map.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 WABI_NAMESPACE_BEGIN
 
@@ -195,6 +197,105 @@ namespace
     }
   };
 
+  // Asset for a compressed file in a zip archive. Sequential reads decompress
+  // the file incrementally. The first read that is not sequential, or a call
+  // to GetBuffer(), decompresses the whole file into memory once; every read
+  // after that is a copy out of that buffer and does not lock.
+  //
+  // Crate files are read out of order (table of contents first, then the
+  // sections, in parallel), so streaming them would restart decompression
+  // from the beginning of the file for every backward seek.
+  class _CompressedAsset : public ArAsset
+  {
+   private:
+
+    std::shared_ptr<ArAsset> _sourceAsset;
+    UsdZipFile _zipFile;
+    UsdZipFile::FileReader _reader;
+
+    mutable std::mutex _bufferMutex;
+    mutable std::shared_ptr<const char> _buffer;
+    // Offset at which the next sequential read is expected.  Only used
+    // while there is no buffer.
+    mutable size_t _nextOffset = 0;
+    // _buffer's data once it has been filled; never changes after that.
+    mutable std::atomic<const char *> _bufferData{nullptr};
+
+    // Decompress the whole file into _buffer.  _bufferMutex must be held.
+    bool _FillBuffer() const
+    {
+      if (_buffer) {
+        return true;
+      }
+      const size_t size = _reader.GetSize();
+      std::unique_ptr<char[]> buffer(new char[size]);
+      if (_reader.Read(buffer.get(), size, 0) != size) {
+        return false;
+      }
+      _buffer = std::shared_ptr<const char>(buffer.release(), std::default_delete<char[]>());
+      _bufferData.store(_buffer.get(), std::memory_order_release);
+      return true;
+    }
+
+   public:
+
+    explicit _CompressedAsset(std::shared_ptr<ArAsset> &&sourceAsset,
+                              UsdZipFile &&zipFile,
+                              const UsdZipFile::Iterator &file)
+      : _sourceAsset(std::move(sourceAsset)),
+        _zipFile(std::move(zipFile)),
+        _reader(file)
+    {}
+
+    explicit operator bool() const
+    {
+      return static_cast<bool>(_reader);
+    }
+
+    size_t GetSize() _CONST override
+    {
+      return _reader.GetSize();
+    }
+
+    std::shared_ptr<const char> GetBuffer() _CONST override
+    {
+      std::lock_guard<std::mutex> lock(_bufferMutex);
+      if (!_FillBuffer()) {
+        return nullptr;
+      }
+      return _buffer;
+    }
+
+    size_t Read(void *buffer, size_t count, size_t offset) _CONST override
+    {
+      if (ARCH_UNLIKELY(offset + count > _reader.GetSize())) {
+        return 0;
+      }
+
+      const char *data = _bufferData.load(std::memory_order_acquire);
+      if (!data) {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        if (!_buffer && offset == _nextOffset) {
+          const size_t numRead = _reader.Read(buffer, count, offset);
+          _nextOffset = offset + numRead;
+          return numRead;
+        }
+        if (!_FillBuffer()) {
+          return 0;
+        }
+        data = _buffer.get();
+      }
+      memcpy(buffer, data + offset, count);
+      return count;
+    }
+
+    std::pair<FILE *, size_t> GetFileUnsafe() _CONST override
+    {
+      // The file's contents are not stored as-is in the zip archive.
+      return std::pair<FILE *, size_t>(nullptr, 0);
+    }
+  };
+
 }  // end anonymous namespace
 
 std::shared_ptr<ArAsset> Usd_UsdzResolver::OpenAsset(const std::string &packagePath,
@@ -215,10 +316,11 @@ std::shared_ptr<ArAsset> Usd_UsdzResolver::OpenAsset(const std::string &packageP
 
   const UsdZipFile::FileInfo info = iter.GetFileInfo();
 
-  if (info.compressionMethod != 0) {
-    TF_RUNTIME_ERROR("Cannot open %s in %s: compressed files are not supported",
+  if (!UsdZipFile::IsSupportedCompressionMethod(info.compressionMethod)) {
+    TF_RUNTIME_ERROR("Cannot open %s in %s: compression method %d is not supported",
                      packagedPath.c_str(),
-                     packagePath.c_str());
+                     packagePath.c_str(),
+                     int(info.compressionMethod));
     return nullptr;
   }
 
@@ -229,6 +331,20 @@ std::shared_ptr<ArAsset> Usd_UsdzResolver::OpenAsset(const std::string &packageP
     return nullptr;
   }
 
+  if (info.compressionMethod != UsdZipFile::CompressionMethodNone) {
+    std::shared_ptr<_CompressedAsset> compressedAsset(
+      new _CompressedAsset(std::move(asset), std::move(zipFile), iter));
+    if (!*compressedAsset) {
+      TF_RUNTIME_ERROR("Cannot open %s in %s: failed to initialize decompression",
+                       packagedPath.c_str(),
+                       packagePath.c_str());
+      return nullptr;
+    }
+    return compressedAsset;
+  }
+
+  // Files stored with no compression are read directly out of the zip
+  // archive's buffer.
   return std::shared_ptr<ArAsset>(
     new _Asset(std::move(asset), std::move(zipFile), iter.GetFile(), info.dataOffset, info.size));
 }
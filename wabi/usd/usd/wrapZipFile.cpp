@@ -29,6 +29,7 @@
 #include <boost/noncopyable.hpp>
 #include <boost/python/class.hpp>
 #include <boost/python/def.hpp>
+#include <boost/python/enum.hpp>
 #include <boost/python/manage_new_object.hpp>
 #include <boost/python/return_arg.hpp>
 #include <boost/python/return_value_policy.hpp>
@@ -102,7 +103,17 @@ void wrapUsdZipFile()
                 .def("GetFile", &_GetFile, arg("path"))
                 .def("GetFileInfo", &_GetFileInfo, arg("path"))
 
-                .def("DumpContents", &UsdZipFile::DumpContents);
+                .def("DumpContents", &UsdZipFile::DumpContents)
+
+                .def("IsSupportedCompressionMethod",
+                     &UsdZipFile::IsSupportedCompressionMethod,
+                     arg("compressionMethod"))
+                .staticmethod("IsSupportedCompressionMethod");
+
+    enum_<UsdZipFile::CompressionMethod>("CompressionMethod")
+      .value("CompressionMethodNone", UsdZipFile::CompressionMethodNone)
+      .value("CompressionMethodDeflate", UsdZipFile::CompressionMethodDeflate)
+      .export_values();
 
     class_<UsdZipFile::FileInfo>("FileInfo", no_init)
       .def_readonly("dataOffset", &UsdZipFile::FileInfo::dataOffset)
@@ -118,7 +129,9 @@ void wrapUsdZipFile()
 
     .def("AddFile",
          &UsdZipFileWriter::AddFile,
-         (arg("filePath"), arg("filePathInArchive") = std::string()))
+         (arg("filePath"),
+          arg("filePathInArchive") = std::string(),
+          arg("compressionMethod") = UsdZipFile::CompressionMethodNone))
     .def("Save", &UsdZipFileWriter::Save)
     .def("Discard", &UsdZipFileWriter::Discard)
 
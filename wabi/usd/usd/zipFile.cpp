@@ -35,8 +35,13 @@
 
 #include <boost/crc.hpp>
 
+#include <zlib.h>
+
+#include <algorithm>
+#include <climits>
 #include <cstdint>
 #include <ctime>
+#include <mutex>
 #include <shared_mutex>
 #include <vector>
 #include <unordered_map>
@@ -725,6 +730,147 @@ UsdZipFile::FileInfo UsdZipFile::Iterator::GetFileInfo() const
 
 // ------------------------------------------------------------
 
+bool UsdZipFile::IsSupportedCompressionMethod(uint16_t compressionMethod)
+{
+  return compressionMethod == CompressionMethodNone ||
+         compressionMethod == CompressionMethodDeflate;
+}
+
+class UsdZipFile::FileReader::_Impl
+{
+ public:
+
+  _Impl(const char *data_, const FileInfo &info_) : data(data_), info(info_)
+  {
+    if (info.compressionMethod == CompressionMethodDeflate) {
+      // Negative window bits select a raw deflate stream with no zlib
+      // header, as stored in zip archives.
+      memset(&stream, 0, sizeof(stream));
+      streamInitialized = (inflateInit2(&stream, -MAX_WBITS) == Z_OK);
+      _Rewind();
+    }
+  }
+
+  ~_Impl()
+  {
+    if (streamInitialized) {
+      inflateEnd(&stream);
+    }
+  }
+
+  size_t Read(char *buffer, size_t count, size_t offset)
+  {
+    if (offset >= info.uncompressedSize) {
+      return 0;
+    }
+    count = std::min(count, info.uncompressedSize - offset);
+
+    if (info.compressionMethod == CompressionMethodNone) {
+      memcpy(buffer, data + offset, count);
+      return count;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!streamInitialized) {
+      return 0;
+    }
+
+    // Restart from the beginning of the file to read backwards, and
+    // decompress and discard data to skip forwards.
+    if (offset < position) {
+      _Rewind();
+    }
+    if (position < offset) {
+      char scratch[16384];
+      while (position < offset) {
+        const size_t n = std::min(sizeof(scratch), offset - position);
+        if (_Inflate(scratch, n) != n) {
+          return 0;
+        }
+      }
+    }
+    return _Inflate(buffer, count);
+  }
+
+  const char *data;
+  const FileInfo info;
+
+  std::mutex mutex;
+  z_stream stream;
+  bool streamInitialized = false;
+  bool streamEnded = false;
+
+  // Number of uncompressed bytes produced so far by stream.
+  size_t position = 0;
+
+ private:
+
+  void _Rewind()
+  {
+    inflateReset(&stream);
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = static_cast<uInt>(info.size);
+    streamEnded = false;
+    position = 0;
+  }
+
+  // Decompress up to count bytes into buffer, returning the number of
+  // bytes produced.
+  size_t _Inflate(char *buffer, size_t count)
+  {
+    size_t produced = 0;
+    while (produced < count && !streamEnded) {
+      const uInt chunk = static_cast<uInt>(std::min<size_t>(count - produced, UINT_MAX));
+      stream.next_out = reinterpret_cast<Bytef *>(buffer + produced);
+      stream.avail_out = chunk;
+      const int status = inflate(&stream, Z_NO_FLUSH);
+      const size_t n = chunk - stream.avail_out;
+      produced += n;
+      position += n;
+      if (status == Z_STREAM_END) {
+        streamEnded = true;
+      } else if (status != Z_OK || n == 0) {
+        TF_RUNTIME_ERROR("Failed to decompress data in zip archive: %s",
+                         stream.msg ? stream.msg : "unexpected end of data");
+        // Force a rewind on the next read.
+        position = SIZE_MAX;
+        break;
+      }
+    }
+    return produced;
+  }
+};
+
+UsdZipFile::FileReader::FileReader(const Iterator &file)
+{
+  const FileInfo info = file.GetFileInfo();
+  if (!file.GetFile() || info.encrypted || !IsSupportedCompressionMethod(info.compressionMethod)) {
+    return;
+  }
+  if (info.compressionMethod == CompressionMethodNone && info.size != info.uncompressedSize) {
+    return;
+  }
+
+  _impl.reset(new _Impl(file.GetFile(), info));
+  if (info.compressionMethod == CompressionMethodDeflate && !_impl->streamInitialized) {
+    _impl.reset();
+  }
+}
+
+UsdZipFile::FileReader::~FileReader() = default;
+
+size_t UsdZipFile::FileReader::GetSize() const
+{
+  return _impl ? _impl->info.uncompressedSize : 0;
+}
+
+size_t UsdZipFile::FileReader::Read(void *buffer, size_t count, size_t offset) const
+{
+  return _impl ? _impl->Read(static_cast<char *>(buffer), count, offset) : 0;
+}
+
+// ------------------------------------------------------------
+
 namespace
 {
   // Compute last modified date and time for given file in MS-DOS format.
@@ -763,6 +909,39 @@ namespace
     return result.checksum();
   }
 
+  // Compress the given file with raw deflate, as stored in zip archives.
+  // Returns false if compression failed or did not reduce the file's size.
+  bool _Deflate(const ArchConstFileMapping &file, std::vector<char> *compressed)
+  {
+    const size_t size = ArchGetFileMappingLength(file);
+    if (size > UINT_MAX) {
+      return false;
+    }
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream,
+                     Z_DEFAULT_COMPRESSION,
+                     Z_DEFLATED,
+                     -MAX_WBITS,
+                     /* memLevel = */ 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      return false;
+    }
+
+    compressed->resize(deflateBound(&stream, static_cast<uLong>(size)));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(file.get()));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef *>(compressed->data());
+    stream.avail_out = static_cast<uInt>(compressed->size());
+
+    const int status = deflate(&stream, Z_FINISH);
+    compressed->resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return status == Z_STREAM_END && compressed->size() < size;
+  }
+
   // Sanitize the given path to conform to zip file specifications:
   //
   //   4.4.17.1 The name of the file, with optional relative path.
@@ -834,7 +1013,8 @@ UsdZipFileWriter::~UsdZipFileWriter()
 }
 
 std::string UsdZipFileWriter::AddFile(const std::string &filePath,
-                                      const std::string &filePathInArchiveIn)
+                                      const std::string &filePathInArchiveIn,
+                                      UsdZipFile::CompressionMethod compressionMethod)
 {
   if (!_impl) {
     TF_CODING_ERROR("File is not open for writing");
@@ -867,15 +1047,22 @@ std::string UsdZipFileWriter::AddFile(const std::string &filePath,
     return std::string();
   }
 
+  // Compress the file if requested. Files that don't get any smaller are
+  // stored instead.
+  std::vector<char> compressed;
+  const bool deflate = compressionMethod == UsdZipFile::CompressionMethodDeflate &&
+                       _Deflate(mapping, &compressed);
+
   // Set up local file header
   _LocalFileHeader h;
   h.f.signature = _LocalFileHeader::Signature;
-  h.f.versionForExtract = 10;  // Default value
+  h.f.versionForExtract = deflate ? 20 : 10;  // Per 4.4.3.2
   h.f.bits = 0;
-  h.f.compressionMethod = 0;  // No compression
+  h.f.compressionMethod = deflate ? UsdZipFile::CompressionMethodDeflate :
+                                    UsdZipFile::CompressionMethodNone;
   std::tie(h.f.lastModTime, h.f.lastModDate) = _ModTimeAndDate(filePath);
   h.f.crc32 = _Crc32(mapping);
-  h.f.compressedSize = ArchGetFileMappingLength(mapping);
+  h.f.compressedSize = deflate ? compressed.size() : ArchGetFileMappingLength(mapping);
   h.f.uncompressedSize = ArchGetFileMappingLength(mapping);
   h.f.filenameLength = zipFilePath.length();
 
@@ -888,7 +1075,7 @@ std::string UsdZipFileWriter::AddFile(const std::string &filePath,
   char extraFieldBuffer[_PaddingBufferSize] = {0};
   h.extraFieldStart = _PrepareExtraFieldPadding(extraFieldBuffer, h.f.extraFieldLength);
 
-  h.dataStart = mapping.get();
+  h.dataStart = deflate ? compressed.data() : mapping.get();
 
   _WriteLocalFileHeader(outStream, h);
   _impl->addedFiles.emplace_back(zipFilePath, h.f, offset);
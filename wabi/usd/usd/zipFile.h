@@ -27,6 +27,7 @@
 #include "wabi/wabi.h"
 #include "wabi/usd/usd/api.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -42,8 +43,9 @@ class ArAsset;
 /// the .usdz file format. It is not a general-purpose zip reader, as it does
 /// not implement the full zip file specification. In particular:
 ///
-/// - This class does not natively support decompressing data from a zip
-///   archive. Clients may access the data exactly as stored in the file and
+/// - This class only supports decompressing files that are stored with no
+///   compression or with the deflate compression method, via FileReader.
+///   Clients may also access the data exactly as stored in the file and
 ///   perform their own decompression if desired.
 ///
 /// - This class does not rely on the central directory in order to read the
@@ -85,6 +87,20 @@ class UsdZipFile
     return static_cast<bool>(_impl);
   }
 
+  /// Compression methods for files in a zip archive that this class can
+  /// read and UsdZipFileWriter can write. Values are as defined in section
+  /// 4.4.5 of the zip file specification.
+  enum CompressionMethod : uint16_t
+  {
+    CompressionMethodNone = 0,
+    CompressionMethodDeflate = 8
+  };
+
+  /// Returns true if files stored with \p compressionMethod can be read
+  /// with FileReader.
+  USD_API
+  static bool IsSupportedCompressionMethod(uint16_t compressionMethod);
+
   /// \class FileInfo
   /// Information for a file in the zip archive.
   class FileInfo
@@ -201,6 +217,55 @@ class UsdZipFile
     std::unique_ptr<_IteratorData> _data;
   };
 
+  /// \class FileReader
+  /// Reads the uncompressed contents of a file in the zip archive.
+  ///
+  /// Files stored with no compression are copied directly out of the zip
+  /// archive. Deflated files are decompressed incrementally as they are
+  /// read, so reading a file sequentially decompresses it only once.
+  /// Reading backwards restarts decompression from the beginning of the
+  /// file. Reads may be issued from multiple threads but are serialized.
+  ///
+  /// The UsdZipFile containing the file must outlive the reader.
+  class FileReader
+  {
+   public:
+
+    /// Create a reader for the file at \p file. The reader is invalid if
+    /// \p file is the end iterator, or if the file is encrypted or uses an
+    /// unsupported compression method.
+    USD_API
+    explicit FileReader(const Iterator &file);
+
+    USD_API
+    ~FileReader();
+
+    FileReader(const FileReader &) = delete;
+    FileReader &operator=(const FileReader &) = delete;
+
+    /// Return true if this object is valid, false otherwise.
+    explicit operator bool() const
+    {
+      return static_cast<bool>(_impl);
+    }
+
+    /// Returns the uncompressed size of the file.
+    USD_API
+    size_t GetSize() const;
+
+    /// Read up to \p count bytes of uncompressed data starting at
+    /// \p offset into \p buffer. Returns the number of bytes read, which
+    /// is 0 if \p offset is past the end of the file or if the file's data
+    /// is corrupt.
+    USD_API
+    size_t Read(void *buffer, size_t count, size_t offset) const;
+
+   private:
+
+    class _Impl;
+    std::unique_ptr<_Impl> _impl;
+  };
+
   /// Returns iterator pointing to the first file in the zip archive.
   USD_API
   Iterator begin() const;
@@ -281,18 +346,25 @@ class UsdZipFileWriter
     return static_cast<bool>(_impl);
   }
 
-  /// Adds the file at \p filePath to the zip archive with no compression
-  /// applied. If \p filePathInArchive is non-empty, the file will be
-  /// added at that path in the archive. Otherwise, it will be added
-  /// at \p filePath.
+  /// Adds the file at \p filePath to the zip archive with the given
+  /// \p compressionMethod applied. If \p filePathInArchive is non-empty,
+  /// the file will be added at that path in the archive. Otherwise, it will
+  /// be added at \p filePath.
+  ///
+  /// If compressing the file would not make it smaller, it is stored with
+  /// no compression instead. Note that the usdz file format requires files
+  /// to be stored with no compression, so compressed packages can only be
+  /// read by readers that support decompression, like UsdZipFile.
   ///
   /// Returns the file path used to identify the file in the zip archive
   /// on success. This path conforms to the zip file specification and may
   /// not be the same as \p filePath or \p filePathInArchive. Returns an
   /// empty string on failure.
   USD_API
-  std::string AddFile(const std::string &filePath,
-                      const std::string &filePathInArchive = std::string());
+  std::string AddFile(
+    const std::string &filePath,
+    const std::string &filePathInArchive = std::string(),
+    UsdZipFile::CompressionMethod compressionMethod = UsdZipFile::CompressionMethodNone);
 
   /// Finalizes the zip archive and saves it to the destination file path.
   /// Once saved, the file writer is invalid and may not be reused.
@@ -30,6 +30,7 @@
 #include "wabi/usd/usdGeom/debugCodes.h"
 #include "wabi/usd/usdGeom/modelAPI.h"
 #include "wabi/usd/usdGeom/pointBased.h"
+#include "wabi/usd/usdGeom/tokens.h"
 #include "wabi/usd/usdGeom/xform.h"
 
 #include "wabi/usd/usd/modelAPI.h"
@@ -39,9 +40,11 @@
 
 #include "wabi/base/work/withScopedParallelism.h"
 
+#include "wabi/base/tf/notice.h"
 #include "wabi/base/tf/pyLock.h"
 #include "wabi/base/tf/stringUtils.h"
 #include "wabi/base/tf/token.h"
+#include "wabi/base/tf/weakBase.h"
 
 #include <atomic>
 #include <algorithm>
@@ -281,6 +284,34 @@ static const UsdAttributeQuery &_GetOrCreateExtentsHintQuery(UsdGeomModelAPI &ge
 // UsdGeomBBoxCache Public API
 // -------------------------------------------------------------------------- //
 
+// -------------------------------------------------------------------------- //
+// _ChangeListener
+// -------------------------------------------------------------------------- //
+class UsdGeomBBoxCache::_ChangeListener : public TfWeakBase
+{
+ public:
+
+  _ChangeListener(UsdGeomBBoxCache *owner, const UsdStageWeakPtr &stage) : _owner(owner)
+  {
+    _key = TfNotice::Register(TfCreateWeakPtr(this), &_ChangeListener::_OnObjectsChanged, stage);
+  }
+
+  ~_ChangeListener()
+  {
+    TfNotice::Revoke(_key);
+  }
+
+ private:
+
+  void _OnObjectsChanged(const UsdNotice::ObjectsChanged &notice, const UsdStageWeakPtr &)
+  {
+    _owner->InvalidateForChanges(notice);
+  }
+
+  UsdGeomBBoxCache *_owner;
+  TfNotice::Key _key;
+};
+
 UsdGeomBBoxCache::UsdGeomBBoxCache(UsdTimeCode time,
                                    TfTokenVector includedPurposes,
                                    bool useExtentsHint,
@@ -621,6 +652,105 @@ void UsdGeomBBoxCache::Clear()
   _bboxCache.clear();
 }
 
+void UsdGeomBBoxCache::TrackStageChanges(const UsdStageWeakPtr &stage)
+{
+  _changeListener.reset();
+  if (!stage) {
+    TF_CODING_ERROR("Invalid stage");
+    return;
+  }
+  _changeListener.reset(new _ChangeListener(this, stage));
+}
+
+void UsdGeomBBoxCache::StopTrackingStageChanges()
+{
+  _changeListener.reset();
+}
+
+void UsdGeomBBoxCache::InvalidateForChanges(const UsdNotice::ObjectsChanged &notice)
+{
+  TRACE_FUNCTION();
+
+  if (_bboxCache.empty()) {
+    return;
+  }
+
+  // Entries are invalidated in one of three ways:
+  // * entries for prims at or beneath a resynced prim, or a prim whose
+  //   inherited state (purpose, visibility or metadata such as kind) changed,
+  //   are removed,
+  // * entries for prims with other changed properties are removed, since
+  //   their cached attribute queries may be stale,
+  // * entries for ancestors of any of these prims are marked incomplete, to
+  //   be recomputed from the (mostly cached) bounds of their children.
+  // Removed entries are recreated when their ancestors are next resolved.
+  SdfPathSet subtreeRoots;
+  SdfPathSet primPaths;
+  TfHashSet<SdfPath, SdfPath::Hash> ancestorPaths;
+
+  auto addChange = [&](const SdfPath &path, bool isResync) {
+    const SdfPath primPath = path.GetPrimPath();
+    const bool inheritedChange = isResync || !path.IsPropertyPath() ||
+                                 path.GetNameToken() == UsdGeomTokens->purpose ||
+                                 path.GetNameToken() == UsdGeomTokens->visibility;
+    (inheritedChange ? subtreeRoots : primPaths).insert(primPath);
+    for (SdfPath p = primPath.GetParentPath(); !p.IsEmpty(); p = p.GetParentPath()) {
+      if (!ancestorPaths.insert(p).second) {
+        break;
+      }
+    }
+  };
+
+  for (const SdfPath &path : notice.GetResyncedPaths()) {
+    addChange(path, /* isResync = */ true);
+  }
+  for (const SdfPath &path : notice.GetChangedInfoOnlyPaths()) {
+    addChange(path, /* isResync = */ false);
+  }
+
+  // Bounds of instances are computed from the bounds of their prototypes,
+  // which have no ancestors to invalidate.  Fall back to clearing.
+  auto inPrototype = [](const SdfPath &path) {
+    return path == SdfPath::AbsoluteRootPath() || UsdPrim::IsPathInPrototype(path);
+  };
+  if (std::any_of(subtreeRoots.begin(), subtreeRoots.end(), inPrototype) ||
+      std::any_of(primPaths.begin(), primPaths.end(), inPrototype)) {
+    Clear();
+    return;
+  }
+
+  const UsdStageWeakPtr &stage = notice.GetStage();
+  for (auto it = _bboxCache.begin(); it != _bboxCache.end();) {
+    const UsdPrim &prim = it->first.prim;
+    if (prim.GetStage() != stage) {
+      ++it;
+      continue;
+    }
+
+    const SdfPath &path = prim.GetPath();
+    auto rootIt = SdfPathFindLongestPrefix(subtreeRoots, path);
+    if (rootIt != subtreeRoots.end() || primPaths.count(path)) {
+      TF_DEBUG(USDGEOM_BBOX)
+        .Msg("[BBox Cache] removing %s for change\n", it->first.ToString().c_str());
+      _bboxCache.erase(it++);
+      continue;
+    }
+
+    if (ancestorPaths.count(path)) {
+      TF_DEBUG(USDGEOM_BBOX)
+        .Msg("[BBox Cache] invalidating %s for change\n", it->first.ToString().c_str());
+      _Entry &entry = it->second;
+      entry.isComplete = false;
+      entry.isVarying = false;
+      entry.bboxes.clear();
+    }
+    ++it;
+  }
+
+  // Cached transforms of the changed prims' descendants may be stale too.
+  _ctmCache.Clear();
+}
+
 void UsdGeomBBoxCache::SetIncludedPurposes(const TfTokenVector &includedPurposes)
 {
   _includedPurposes = includedPurposes;
@@ -29,6 +29,7 @@
 #include "wabi/usd/usdGeom/xformCache.h"
 #include "wabi/usd/usdGeom/pointInstancer.h"
 #include "wabi/usd/usd/attributeQuery.h"
+#include "wabi/usd/usd/notice.h"
 #include "wabi/base/gf/bbox3d.h"
 #include "wabi/base/tf/hashmap.h"
 #include "wabi/base/work/dispatcher.h"
@@ -36,6 +37,8 @@
 #include <boost/optional.hpp>
 #include <boost/shared_array.hpp>
 
+#include <memory>
+
 WABI_NAMESPACE_BEGIN
 
 
@@ -76,8 +79,9 @@ class UsdGeomModelAPI;
 /// Warnings:
 ///  * This class should only be used with valid UsdPrim objects.
 ///
-///  * This cache does not listen for change notifications; the user is
-///    responsible for clearing the cache when changes occur.
+///  * This cache does not listen for change notifications unless
+///    TrackStageChanges() is called; otherwise the user is responsible for
+///    clearing the cache when changes occur.
 ///
 ///  * Thread safety: instances of this class may not be used concurrently.
 ///
@@ -294,6 +298,27 @@ class UsdGeomBBoxCache
   USDGEOM_API
   void Clear();
 
+  /// Invalidate cached values affected by changes to \p stage as they are
+  /// made, instead of requiring Clear() to be called.  Only entries for the
+  /// changed prims, their ancestors and, where the change is inherited,
+  /// their descendants are invalidated, so bounds of unaffected subtrees are
+  /// reused.  Changes to instance prototypes clear the cache.
+  ///
+  /// The cache must not be in use while \p stage is being edited.  Copies of
+  /// this cache do not track changes.
+  USDGEOM_API
+  void TrackStageChanges(const UsdStageWeakPtr &stage);
+
+  /// Stop invalidating cached values for changes to the stage passed to
+  /// TrackStageChanges(), if any.
+  USDGEOM_API
+  void StopTrackingStageChanges();
+
+  /// Invalidate cached values affected by the changes described by
+  /// \p notice, as TrackStageChanges() does for each change to its stage.
+  USDGEOM_API
+  void InvalidateForChanges(const UsdNotice::ObjectsChanged &notice);
+
   /// Indicate the set of \p includedPurposes to use when resolving child
   /// bounds. Each child's purpose must match one of the elements of this set
   /// to be included in the computation; if it does not, child is excluded.
@@ -379,6 +404,9 @@ class UsdGeomBBoxCache
   // Helper object for computing bounding boxes for instance prototypes.
   class _PrototypeBBoxResolver;
 
+  // Listener for the stage passed to TrackStageChanges().
+  class _ChangeListener;
+
   // Map of purpose tokens to associated bboxes.
   typedef std::map<TfToken, GfBBox3d, TfTokenFastArbitraryLessThan> _PurposeToBBoxMap;
 
@@ -539,6 +567,7 @@ class UsdGeomBBoxCache
   _PrimBBoxHashMap _bboxCache;
   bool _useExtentsHint;
   bool _ignoreVisibility;
+  std::unique_ptr<_ChangeListener> _changeListener;
 };
 
 
@@ -0,0 +1,226 @@
+//
+// Copyright 2016 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "wabi/wabi.h"
+#include "wabi/usd/usdGeom/concurrentXformCache.h"
+
+#include "wabi/base/gf/batch.h"
+#include "wabi/base/trace/trace.h"
+#include "wabi/base/work/loops.h"
+
+#include "wabi/base/tf/diagnostic.h"
+
+#include <tuple>
+#include <vector>
+
+WABI_NAMESPACE_BEGIN
+
+
+UsdGeomConcurrentXformCache::UsdGeomConcurrentXformCache(const UsdTimeCode time) : _time(time) {}
+
+UsdGeomConcurrentXformCache::UsdGeomConcurrentXformCache() : _time(UsdTimeCode::Default()) {}
+
+UsdGeomConcurrentXformCache::~UsdGeomConcurrentXformCache() = default;
+
+GfMatrix4d UsdGeomConcurrentXformCache::GetLocalToWorldTransform(const UsdPrim &prim)
+{
+  TRACE_FUNCTION();
+  return *_GetCtm(prim);
+}
+
+GfMatrix4d UsdGeomConcurrentXformCache::GetParentToWorldTransform(const UsdPrim &prim)
+{
+  TRACE_FUNCTION();
+  return *_GetCtm(prim.GetParent());
+}
+
+GfMatrix4d UsdGeomConcurrentXformCache::GetLocalTransformation(const UsdPrim &prim,
+                                                               bool *resetsXformStack)
+{
+  if (!resetsXformStack) {
+    TF_CODING_ERROR("'resetsXformStack' pointer is null.");
+    return GfMatrix4d(1);
+  }
+
+  _Entry *entry = _GetCacheEntryForPrim(prim);
+  GfMatrix4d xform(1.);
+  entry->query.GetLocalTransformation(&xform, _time);
+  *resetsXformStack = entry->query.GetResetXformStack();
+  return xform;
+}
+
+void UsdGeomConcurrentXformCache::ComputeLocalToWorldTransforms(const UsdPrimRange &range,
+                                                                std::vector<UsdPrim> *prims,
+                                                                std::vector<GfMatrix4d> *xforms)
+{
+  TRACE_FUNCTION();
+
+  if (!prims) {
+    TF_CODING_ERROR("'prims' pointer is null.");
+    return;
+  }
+
+  // Traversal is serial, gather the prims before computing in parallel.
+  prims->assign(range.begin(), range.end());
+  ComputeLocalToWorldTransforms(*prims, xforms);
+}
+
+void UsdGeomConcurrentXformCache::ComputeLocalToWorldTransforms(const std::vector<UsdPrim> &prims,
+                                                                std::vector<GfMatrix4d> *xforms)
+{
+  TRACE_FUNCTION();
+
+  if (!xforms) {
+    TF_CODING_ERROR("'xforms' pointer is null.");
+    return;
+  }
+
+  xforms->resize(prims.size());
+
+  // Process the prims one namespace depth at a time, so the ctms of any
+  // parents in \p prims are cached before their children need them.  Each
+  // chunk of a level gathers its local transforms and parent ctms into
+  // arrays and composes them with one batch multiply.
+  std::vector<std::vector<size_t>> levels;
+  for (size_t i = 0; i != prims.size(); ++i) {
+    if (!prims[i]) {
+      (*xforms)[i].SetIdentity();
+      continue;
+    }
+    const size_t depth = prims[i].GetPath().GetPathElementCount();
+    if (depth >= levels.size()) {
+      levels.resize(depth + 1);
+    }
+    levels[depth].push_back(i);
+  }
+
+  for (const std::vector<size_t> &level : levels) {
+    WorkParallelForN(level.size(), [this, &level, &prims, xforms](size_t begin, size_t end) {
+      const size_t count = end - begin;
+      std::vector<_Entry *> entries(count);
+      std::vector<GfMatrix4d> locals(count, GfMatrix4d(1.));
+      std::vector<GfMatrix4d> parentCtms(count, GfMatrix4d(1.));
+      for (size_t j = 0; j != count; ++j) {
+        const UsdPrim &prim = prims[level[begin + j]];
+        entries[j] = _GetCacheEntryForPrim(prim);
+        entries[j]->query.GetLocalTransformation(&locals[j], _time);
+        if (!entries[j]->query.GetResetXformStack()) {
+          parentCtms[j] = *_GetCtm(prim.GetParent());
+        }
+      }
+
+      GfMultiplyMatrices(locals.data(), parentCtms.data(), count, locals.data());
+
+      // Cache the results, unless another thread computed them first.
+      for (size_t j = 0; j != count; ++j) {
+        _Entry *entry = entries[j];
+        const GfMatrix4d &ctm = locals[j];
+        std::call_once(*entry->ctmOnce, [entry, &ctm]() {
+          entry->ctm = ctm;
+        });
+        (*xforms)[level[begin + j]] = entry->ctm;
+      }
+    });
+  }
+}
+
+bool UsdGeomConcurrentXformCache::TransformMightBeTimeVarying(const UsdPrim &prim)
+{
+  return _GetCacheEntryForPrim(prim)->query.TransformMightBeTimeVarying();
+}
+
+bool UsdGeomConcurrentXformCache::GetResetXformStack(const UsdPrim &prim)
+{
+  return _GetCacheEntryForPrim(prim)->query.GetResetXformStack();
+}
+
+UsdGeomConcurrentXformCache::_Entry *UsdGeomConcurrentXformCache::_GetCacheEntryForPrim(
+  const UsdPrim &prim)
+{
+  auto iter = _ctmCache.find(prim);
+  if (iter == _ctmCache.end()) {
+    // If another thread inserts the prim first, this returns its entry.
+    iter = _ctmCache
+             .emplace(std::piecewise_construct, std::forward_as_tuple(prim), std::forward_as_tuple())
+             .first;
+  }
+
+  _Entry *result = &iter->second;
+  std::call_once(result->queryOnce, [result, &prim]() {
+    if (UsdGeomXformable xf = UsdGeomXformable(prim)) {
+      result->query = UsdGeomXformable::XformQuery(xf);
+    }
+  });
+  return result;
+}
+
+GfMatrix4d const *UsdGeomConcurrentXformCache::_GetCtm(const UsdPrim &prim)
+{
+  // Local identity matrix to return by pointer.
+  static GfMatrix4d const IDENTITY(1.0);
+
+  // Base case: check for the pseudo root, which is always implicitly
+  // identity.
+  if (!prim)
+    return &IDENTITY;
+
+  // Compute the ctm if no other thread has, recursing to the parent.  Other
+  // threads that need this ctm wait for the result.
+  _Entry *entry = _GetCacheEntryForPrim(prim);
+  std::call_once(*entry->ctmOnce, [this, entry, &prim]() {
+    GfMatrix4d xform(1.);
+    entry->query.GetLocalTransformation(&xform, _time);
+    if (!entry->query.GetResetXformStack()) {
+      xform *= *_GetCtm(prim.GetParent());
+    }
+    entry->ctm = xform;
+  });
+
+  return &entry->ctm;
+}
+
+void UsdGeomConcurrentXformCache::SetTime(UsdTimeCode time)
+{
+  if (time == _time)
+    return;
+
+  // Mark all cached CTMs as invalid, but leave the queries behind.
+  for (auto &p : _ctmCache) {
+    p.second.ctmOnce.reset(new std::once_flag);
+  }
+
+  _time = time;
+}
+
+void UsdGeomConcurrentXformCache::Clear()
+{
+  _ctmCache.clear();
+}
+
+void UsdGeomConcurrentXformCache::Swap(UsdGeomConcurrentXformCache &other)
+{
+  _ctmCache.swap(other._ctmCache);
+  std::swap(_time, other._time);
+}
+
+WABI_NAMESPACE_END
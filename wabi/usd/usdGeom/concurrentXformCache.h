@@ -0,0 +1,166 @@
+//
+// Copyright 2016 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef WABI_USD_USD_GEOM_CONCURRENT_XFORM_CACHE_H
+#define WABI_USD_USD_GEOM_CONCURRENT_XFORM_CACHE_H
+
+#include "wabi/wabi.h"
+#include "wabi/usd/usdGeom/api.h"
+#include "wabi/usd/usd/prim.h"
+#include "wabi/usd/usd/primRange.h"
+#include "wabi/usd/usdGeom/xformable.h"
+
+#include "wabi/base/gf/matrix4d.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <tbb/concurrent_unordered_map.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+WABI_NAMESPACE_BEGIN
+
+/// \class UsdGeomConcurrentXformCache
+///
+/// A caching mechanism for transform matrices that, unlike
+/// UsdGeomXformCache, may be shared by many threads.  Each prim's transform
+/// query and local-to-world transform are computed once, by the first thread
+/// that needs them, and other threads requesting them wait for and reuse the
+/// result.  In particular, ancestor transforms are shared by all threads
+/// computing transforms of their descendants.
+///
+/// The Get* and Compute* methods may be called concurrently.  SetTime(),
+/// Clear() and Swap() may not be called concurrently with any other method.
+///
+/// It is valid to cache prims from multiple stages in a single cache.
+///
+/// WARNING: this class does not automatically invalidate cached values based
+/// on changes to the stage from which values were cached.
+///
+class UsdGeomConcurrentXformCache
+{
+ public:
+
+  /// Construct a new cache for the specified \p time.
+  USDGEOM_API
+  explicit UsdGeomConcurrentXformCache(const UsdTimeCode time);
+
+  /// Construct a new cache for UsdTimeCode::Default().
+  USDGEOM_API
+  UsdGeomConcurrentXformCache();
+
+  USDGEOM_API
+  ~UsdGeomConcurrentXformCache();
+
+  /// Compute the transformation matrix for the given \p prim, including the
+  /// transform authored on the Prim itself, if present.
+  USDGEOM_API
+  GfMatrix4d GetLocalToWorldTransform(const UsdPrim &prim);
+
+  /// Compute the transformation matrix for the given \p prim, but do NOT
+  /// include the transform authored on the prim itself.
+  USDGEOM_API
+  GfMatrix4d GetParentToWorldTransform(const UsdPrim &prim);
+
+  /// Returns the local transformation of the prim. The \p resetsXformStack
+  /// pointer must be valid. It will be set to true if \p prim resets the
+  /// transform stack.
+  USDGEOM_API
+  GfMatrix4d GetLocalTransformation(const UsdPrim &prim, bool *resetsXformStack);
+
+  /// Compute the local-to-world transforms of all the prims in \p range in
+  /// parallel.  The prims are stored in \p prims and their transforms at the
+  /// same indices in \p xforms, in traversal order.
+  USDGEOM_API
+  void ComputeLocalToWorldTransforms(const UsdPrimRange &range,
+                                     std::vector<UsdPrim> *prims,
+                                     std::vector<GfMatrix4d> *xforms);
+
+  /// Compute the local-to-world transforms of \p prims in parallel, storing
+  /// them at the same indices in \p xforms.  Prims are processed one
+  /// namespace depth at a time, composing their local transforms with their
+  /// parents' in batches, and the results are cached.
+  USDGEOM_API
+  void ComputeLocalToWorldTransforms(const std::vector<UsdPrim> &prims,
+                                     std::vector<GfMatrix4d> *xforms);
+
+  /// Whether the local transformation value at the prim may vary over time.
+  USDGEOM_API
+  bool TransformMightBeTimeVarying(const UsdPrim &prim);
+
+  /// Whether the xform stack is reset at the given prim.
+  USDGEOM_API
+  bool GetResetXformStack(const UsdPrim &prim);
+
+  /// Clears all pre-cached values.
+  USDGEOM_API
+  void Clear();
+
+  /// Use the new \p time when computing values.  Transforms cached for the
+  /// previous time are invalidated, transform queries are kept.  Setting
+  /// \p time to the current time is a no-op.
+  USDGEOM_API
+  void SetTime(UsdTimeCode time);
+
+  /// Get the current time from which this cache is reading values.
+  UsdTimeCode GetTime() const
+  {
+    return _time;
+  }
+
+  /// Swap the contents of this cache with \p other.
+  USDGEOM_API
+  void Swap(UsdGeomConcurrentXformCache &other);
+
+ private:
+
+  // Map of cached values.  Entries are never moved or removed while the
+  // cache is shared, so their fields can be initialized in place.
+  struct _Entry
+  {
+    std::once_flag queryOnce;
+    UsdGeomXformable::XformQuery query;
+
+    // Replaced by SetTime() so the ctm is recomputed for the new time.
+    std::unique_ptr<std::once_flag> ctmOnce{new std::once_flag};
+    GfMatrix4d ctm;
+  };
+
+  // Get or create the entry for \p prim, with an initialized query.
+  _Entry *_GetCacheEntryForPrim(const UsdPrim &prim);
+
+  // Compute or return the cached ctm for \p prim.
+  GfMatrix4d const *_GetCtm(const UsdPrim &prim);
+
+  using _PrimHashMap = tbb::concurrent_unordered_map<UsdPrim, _Entry, boost::hash<UsdPrim>>;
+  _PrimHashMap _ctmCache;
+
+  // The time at which this cache is querying and caching attribute values.
+  UsdTimeCode _time;
+};
+
+WABI_NAMESPACE_END
+
+#endif  // WABI_USD_USD_GEOM_CONCURRENT_XFORM_CACHE_H
@@ -187,6 +187,7 @@ WABI_NAMESPACE_END
 #include "wabi/usd/usdGeom/boundableComputeExtent.h"
 #include "wabi/usd/usdGeom/motionAPI.h"
 #include "wabi/base/tf/registryManager.h"
+#include "wabi/base/gf/batch.h"
 #include "wabi/base/gf/transform.h"
 #include "wabi/base/work/loops.h"
 #include "wabi/base/work/reduce.h"
@@ -247,10 +248,7 @@ namespace
 bool UsdGeomPointBased::ComputeExtent(const VtVec3fArray &points, VtVec3fArray *extent)
 {
   return _ComputeExtentImpl(points, extent, [&points](size_t b, size_t e, GfRange3d init) {
-    for (size_t i = b; i != e; ++i) {
-      init.UnionWith(points[i]);
-    }
-    return init;
+    return init.UnionWith(GfComputeRange(points.cdata() + b, e - b));
   });
 }
 
@@ -261,10 +259,8 @@ bool UsdGeomPointBased::ComputeExtent(const VtVec3fArray &points,
   return _ComputeExtentImpl(points,
                             extent,
                             [&points, &transform](size_t b, size_t e, GfRange3d init) {
-                              for (size_t i = b; i != e; ++i) {
-                                init.UnionWith(transform.Transform(points[i]));
-                              }
-                              return init;
+                              return init.UnionWith(
+                                GfComputeTransformedRange(transform, points.cdata() + b, e - b));
                             });
 }
 
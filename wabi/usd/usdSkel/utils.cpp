@@ -23,12 +23,14 @@
 //
 #include "wabi/usd/usdSkel/utils.h"
 
+#include "wabi/base/arch/defines.h"
 #include "wabi/base/arch/hints.h"
 #include "wabi/base/gf/range3f.h"
 #include "wabi/base/gf/rotation.h"
 #include "wabi/base/gf/vec3d.h"
 #include "wabi/base/gf/vec3f.h"
 #include "wabi/base/tf/diagnostic.h"
+#include "wabi/base/tf/envSetting.h"
 #include "wabi/base/work/loops.h"
 
 #include "wabi/usd/usd/prim.h"
@@ -55,9 +57,18 @@
 
 #include <atomic>
 
+#if defined(ARCH_CPU_INTEL)
+#  include <immintrin.h>
+#endif
+
 
 WABI_NAMESPACE_BEGIN
 
+TF_DEFINE_ENV_SETTING(USDSKEL_ENABLE_SIMD_SKINNING,
+                      true,
+                      "Use SIMD kernels when skinning points and normals with "
+                      "single precision joint transforms.");
+
 
 bool UsdSkelIsSkelAnimationPrim(const UsdPrim &prim)
 {
@@ -1249,6 +1260,142 @@ namespace
     }
   };
 
+#if defined(ARCH_CPU_INTEL)
+
+  // SIMD skinning kernels.
+  //
+  // These hold the x, y and z components of a point or normal in the lanes
+  // of a single register, so that transforming it by a joint matrix takes
+  // one multiply per matrix row.  The operations are performed in the same
+  // order as with GfMatrix4f and GfMatrix3f, so the results are identical
+  // to those of the scalar loops.  The kernels are instantiated for common
+  // numbers of influences per point, to allow the influence loop to be
+  // unrolled.  NumInfluences == 0 handles any other number.
+
+  inline void _StoreVec3f(__m128 v, GfVec3f *result)
+  {
+    alignas(16) float tmp[4];
+    _mm_store_ps(tmp, v);
+    result->Set(tmp[0], tmp[1], tmp[2]);
+  }
+
+  template<int NumInfluences, typename InfluenceFn>
+  bool _SkinPointsLBSSimd(const GfMatrix4f &geomBindTransform,
+                          TfSpan<const GfMatrix4f> jointXforms,
+                          const InfluenceFn &influenceFn,
+                          int numInfluencesPerPoint,
+                          TfSpan<GfVec3f> points,
+                          bool inSerial)
+  {
+    const int numInfluences = NumInfluences > 0 ? NumInfluences : numInfluencesPerPoint;
+
+    // Flag for marking error state from within threads.
+    std::atomic_bool errors(false);
+
+    _ParallelForN(points.size(), /* inSerial = */ inSerial, [&](size_t start, size_t end) {
+      for (size_t pi = start; pi < end; ++pi) {
+
+        const GfVec3f initialP = geomBindTransform.Transform(points[pi]);
+        const __m128 x = _mm_set1_ps(initialP[0]);
+        const __m128 y = _mm_set1_ps(initialP[1]);
+        const __m128 z = _mm_set1_ps(initialP[2]);
+        __m128 p = _mm_setzero_ps();
+
+        for (int wi = 0; wi < numInfluences; ++wi) {
+          const size_t influenceIdx = pi * numInfluences + wi;
+          const int jointIdx = influenceFn.GetIndex(influenceIdx);
+
+          if (jointIdx >= 0 && static_cast<size_t>(jointIdx) < jointXforms.size()) {
+
+            const float w = influenceFn.GetWeight(influenceIdx);
+            if (w != 0.0f) {
+              // As with TransformAffine(); the fourth lane is unused.
+              const float *m = jointXforms[jointIdx].data();
+              const __m128 xformed = _mm_add_ps(
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_loadu_ps(m)),
+                                      _mm_mul_ps(y, _mm_loadu_ps(m + 4))),
+                           _mm_mul_ps(z, _mm_loadu_ps(m + 8))),
+                _mm_loadu_ps(m + 12));
+              p = _mm_add_ps(p, _mm_mul_ps(xformed, _mm_set1_ps(w)));
+            }
+          } else {
+            TF_WARN(
+              "Out of range joint index %d at index %zu"
+              " (num joints = %zu).",
+              jointIdx,
+              influenceIdx,
+              jointXforms.size());
+            errors = true;
+            return;
+          }
+        }
+
+        _StoreVec3f(p, &points[pi]);
+      }
+    });
+
+    return !errors;
+  }
+
+#endif  // ARCH_CPU_INTEL
+
+  /// Skin \p points with a SIMD kernel, if one applies, storing whether
+  /// skinning succeeded in \p result.  Returns false if no kernel applies.
+  template<typename Matrix4, typename InfluenceFn>
+  bool _TrySkinPointsLBSSimd(const Matrix4 &,
+                             TfSpan<const Matrix4>,
+                             const InfluenceFn &,
+                             int,
+                             TfSpan<GfVec3f>,
+                             bool,
+                             bool *)
+  {
+    return false;
+  }
+
+#if defined(ARCH_CPU_INTEL)
+
+  template<typename InfluenceFn>
+  bool _TrySkinPointsLBSSimd(const GfMatrix4f &geomBindTransform,
+                             TfSpan<const GfMatrix4f> jointXforms,
+                             const InfluenceFn &influenceFn,
+                             int numInfluencesPerPoint,
+                             TfSpan<GfVec3f> points,
+                             bool inSerial,
+                             bool *result)
+  {
+    static const bool enabled = TfGetEnvSetting(USDSKEL_ENABLE_SIMD_SKINNING);
+    if (!enabled) {
+      return false;
+    }
+
+    switch (numInfluencesPerPoint) {
+      case 1:
+        *result = _SkinPointsLBSSimd<1>(
+          geomBindTransform, jointXforms, influenceFn, numInfluencesPerPoint, points, inSerial);
+        break;
+      case 2:
+        *result = _SkinPointsLBSSimd<2>(
+          geomBindTransform, jointXforms, influenceFn, numInfluencesPerPoint, points, inSerial);
+        break;
+      case 4:
+        *result = _SkinPointsLBSSimd<4>(
+          geomBindTransform, jointXforms, influenceFn, numInfluencesPerPoint, points, inSerial);
+        break;
+      case 8:
+        *result = _SkinPointsLBSSimd<8>(
+          geomBindTransform, jointXforms, influenceFn, numInfluencesPerPoint, points, inSerial);
+        break;
+      default:
+        *result = _SkinPointsLBSSimd<0>(
+          geomBindTransform, jointXforms, influenceFn, numInfluencesPerPoint, points, inSerial);
+        break;
+    }
+    return true;
+  }
+
+#endif  // ARCH_CPU_INTEL
+
   template<typename Matrix4, typename InfluenceFn>
   bool _SkinPointsLBS(const Matrix4 &geomBindTransform,
                       TfSpan<const Matrix4> jointXforms,
@@ -1259,6 +1406,17 @@ namespace
   {
     TRACE_FUNCTION();
 
+    bool result = false;
+    if (_TrySkinPointsLBSSimd(geomBindTransform,
+                              jointXforms,
+                              influenceFn,
+                              numInfluencesPerPoint,
+                              points,
+                              inSerial,
+                              &result)) {
+      return result;
+    }
+
     // Flag for marking error state from within threads.
     std::atomic_bool errors(false);
 
@@ -1508,6 +1666,166 @@ namespace
 {
 
 
+#if defined(ARCH_CPU_INTEL)
+
+  /// The rows of a GfMatrix3f, each padded to a full register.
+  struct _PaddedMatrix3fRows
+  {
+    __m128 rows[3];
+  };
+
+  template<int NumInfluences, typename InfluenceFn, typename PointIndexFn>
+  bool _SkinNormalsLBSSimd(const GfMatrix3f &geomBindTransform,
+                           TfSpan<const GfMatrix3f> jointXforms,
+                           const InfluenceFn &influenceFn,
+                           const PointIndexFn &pointIndexFn,
+                           int numInfluencesPerPoint,
+                           TfSpan<GfVec3f> normals,
+                           bool inSerial)
+  {
+    const int numInfluences = NumInfluences > 0 ? NumInfluences : numInfluencesPerPoint;
+
+    std::vector<_PaddedMatrix3fRows> jointRows(jointXforms.size());
+    for (size_t i = 0; i < jointXforms.size(); ++i) {
+      const GfMatrix3f &m = jointXforms[i];
+      for (int r = 0; r < 3; ++r) {
+        jointRows[i].rows[r] = _mm_setr_ps(m[r][0], m[r][1], m[r][2], 0.0f);
+      }
+    }
+
+    // Flag for marking error state from within threads.
+    std::atomic_bool errors(false);
+
+    _ParallelForN(normals.size(), inSerial, [&](size_t start, size_t end) {
+      for (size_t ni = start; ni < end; ++ni) {
+
+        const GfVec3f initialN = normals[ni] * geomBindTransform;
+        const size_t pi = pointIndexFn.GetPointIndex(ni);
+        const __m128 x = _mm_set1_ps(initialN[0]);
+        const __m128 y = _mm_set1_ps(initialN[1]);
+        const __m128 z = _mm_set1_ps(initialN[2]);
+        __m128 n = _mm_setzero_ps();
+
+        for (int wi = 0; wi < numInfluences; ++wi) {
+          const size_t influenceIdx = pi * numInfluences + wi;
+          const int jointIdx = influenceFn.GetIndex(influenceIdx);
+
+          if (jointIdx >= 0 && static_cast<size_t>(jointIdx) < jointXforms.size()) {
+
+            const float w = influenceFn.GetWeight(influenceIdx);
+            if (w != 0.0f) {
+              const __m128 *rows = jointRows[jointIdx].rows;
+              const __m128 xformed = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(x, rows[0]), _mm_mul_ps(y, rows[1])),
+                _mm_mul_ps(z, rows[2]));
+              n = _mm_add_ps(n, _mm_mul_ps(xformed, _mm_set1_ps(w)));
+            }
+          } else {
+            TF_WARN(
+              "Out of range joint index %d at index %zu"
+              " (num joints = %zu).",
+              jointIdx,
+              influenceIdx,
+              jointXforms.size());
+            errors = true;
+            return;
+          }
+        }
+
+        _StoreVec3f(n, &normals[ni]);
+        normals[ni].Normalize();
+      }
+    });
+
+    return !errors;
+  }
+
+#endif  // ARCH_CPU_INTEL
+
+  /// Skin \p normals with a SIMD kernel, if one applies, storing whether
+  /// skinning succeeded in \p result.  Returns false if no kernel applies.
+  template<typename Matrix3, typename InfluenceFn, typename PointIndexFn>
+  bool _TrySkinNormalsLBSSimd(const Matrix3 &,
+                              TfSpan<const Matrix3>,
+                              const InfluenceFn &,
+                              const PointIndexFn &,
+                              int,
+                              TfSpan<GfVec3f>,
+                              bool,
+                              bool *)
+  {
+    return false;
+  }
+
+#if defined(ARCH_CPU_INTEL)
+
+  template<typename InfluenceFn, typename PointIndexFn>
+  bool _TrySkinNormalsLBSSimd(const GfMatrix3f &geomBindTransform,
+                              TfSpan<const GfMatrix3f> jointXforms,
+                              const InfluenceFn &influenceFn,
+                              const PointIndexFn &pointIndexFn,
+                              int numInfluencesPerPoint,
+                              TfSpan<GfVec3f> normals,
+                              bool inSerial,
+                              bool *result)
+  {
+    static const bool enabled = TfGetEnvSetting(USDSKEL_ENABLE_SIMD_SKINNING);
+    if (!enabled) {
+      return false;
+    }
+
+    switch (numInfluencesPerPoint) {
+      case 1:
+        *result = _SkinNormalsLBSSimd<1>(geomBindTransform,
+                                         jointXforms,
+                                         influenceFn,
+                                         pointIndexFn,
+                                         numInfluencesPerPoint,
+                                         normals,
+                                         inSerial);
+        break;
+      case 2:
+        *result = _SkinNormalsLBSSimd<2>(geomBindTransform,
+                                         jointXforms,
+                                         influenceFn,
+                                         pointIndexFn,
+                                         numInfluencesPerPoint,
+                                         normals,
+                                         inSerial);
+        break;
+      case 4:
+        *result = _SkinNormalsLBSSimd<4>(geomBindTransform,
+                                         jointXforms,
+                                         influenceFn,
+                                         pointIndexFn,
+                                         numInfluencesPerPoint,
+                                         normals,
+                                         inSerial);
+        break;
+      case 8:
+        *result = _SkinNormalsLBSSimd<8>(geomBindTransform,
+                                         jointXforms,
+                                         influenceFn,
+                                         pointIndexFn,
+                                         numInfluencesPerPoint,
+                                         normals,
+                                         inSerial);
+        break;
+      default:
+        *result = _SkinNormalsLBSSimd<0>(geomBindTransform,
+                                         jointXforms,
+                                         influenceFn,
+                                         pointIndexFn,
+                                         numInfluencesPerPoint,
+                                         normals,
+                                         inSerial);
+        break;
+    }
+    return true;
+  }
+
+#endif  // ARCH_CPU_INTEL
+
   template<typename Matrix3, typename InfluenceFn, typename PointIndexFn>
   bool _SkinNormalsLBS(const Matrix3 &geomBindTransform,
                        TfSpan<const Matrix3> jointXforms,
@@ -1519,6 +1837,18 @@ namespace
   {
     TRACE_FUNCTION();
 
+    bool result = false;
+    if (_TrySkinNormalsLBSSimd(geomBindTransform,
+                               jointXforms,
+                               influenceFn,
+                               pointIndexFn,
+                               numInfluencesPerPoint,
+                               normals,
+                               inSerial,
+                               &result)) {
+      return result;
+    }
+
     // Flag for marking error state from within threads.
     std::atomic_bool errors(false);
 
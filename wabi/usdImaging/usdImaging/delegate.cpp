@@ -872,6 +872,10 @@ void UsdImagingDelegate::SetTime(UsdTimeCode time)
 
   UsdImagingIndexProxy indexProxy(this, nullptr);
 
+  // Rprims are handed to the change tracker in one batch at the end, so
+  // that they can be marked dirty in parallel.
+  indexProxy._DeferRprimDirtying();
+
   // Mark varying attributes as dirty.
   if (_timeVaryingPrimCacheValid) {
     for (SdfPath const &path : _timeVaryingPrimCache) {
@@ -894,6 +898,8 @@ void UsdImagingDelegate::SetTime(UsdTimeCode time)
     }
     _timeVaryingPrimCacheValid = true;
   }
+
+  indexProxy._FlushRprimDirtying();
 }
 
 void UsdImagingDelegate::SetTimes(const std::vector<UsdImagingDelegate *> &delegates,
@@ -297,11 +297,30 @@ void UsdImagingIndexProxy::MarkRprimDirty(SdfPath const &cachePath, HdDirtyBits
     _delegate->_dirtyCachePaths.insert(cachePath);
   }
 
-  HdChangeTracker &tracker = _delegate->GetRenderIndex().GetChangeTracker();
   SdfPath indexPath = _delegate->ConvertCachePathToIndexPath(cachePath);
+  if (_deferRprimDirtying) {
+    _dirtyRprimIndexPaths.push_back(indexPath);
+    _dirtyRprimBits.push_back(dirtyBits);
+    return;
+  }
+
+  HdChangeTracker &tracker = _delegate->GetRenderIndex().GetChangeTracker();
   tracker.MarkRprimDirty(indexPath, dirtyBits);
 }
 
+void UsdImagingIndexProxy::_FlushRprimDirtying()
+{
+  HD_TRACE_FUNCTION();
+
+  if (!_dirtyRprimIndexPaths.empty()) {
+    HdChangeTracker &tracker = _delegate->GetRenderIndex().GetChangeTracker();
+    tracker.MarkRprimsDirty(_dirtyRprimIndexPaths, _dirtyRprimBits);
+    _dirtyRprimIndexPaths.clear();
+    _dirtyRprimBits.clear();
+  }
+  _deferRprimDirtying = false;
+}
+
 void UsdImagingIndexProxy::MarkSprimDirty(SdfPath const &cachePath, HdDirtyBits dirtyBits)
 {
   UsdImagingDelegate::_HdPrimInfo *primInfo = _delegate->_GetHdPrimInfo(cachePath);
@@ -225,6 +225,15 @@ class UsdImagingIndexProxy
 
   void _AddTask(SdfPath const &usdPath);
 
+  // While enabled, MarkRprimDirty() queues the change tracker update, and
+  // _FlushRprimDirtying() hands the queued rprims to the change tracker in
+  // one batch.  Used by UsdImagingDelegate::SetTime.
+  void _DeferRprimDirtying()
+  {
+    _deferRprimDirtying = true;
+  }
+  void _FlushRprimDirtying();
+
   struct _TypeAndPath
   {
     TfToken primType;
@@ -244,6 +253,9 @@ class UsdImagingIndexProxy
   SdfPathVector _instancersToRemove;
   SdfPathVector _hdPrimInfoToRemove;
   _DependencyVector _dependenciesToRemove;
+  bool _deferRprimDirtying = false;
+  SdfPathVector _dirtyRprimIndexPaths;
+  std::vector<HdDirtyBits> _dirtyRprimBits;
 };
 
 